@@ -18,159 +18,321 @@ ________________________________________________________________________________
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
 namespace LLD
 {
-    /*  Node to hold the binary data of the double linked list. */
-    struct BinaryNode
+    /* The list a cached record is held in. */
+    enum SEGMENT
     {
-    public:
+        WINDOW    = 0,
+        PROBATION = 1,
+        PROTECTED = 2,
+    };
 
-        /** Linked list pointers. **/
-        BinaryNode* pprev;
-        BinaryNode* pnext;
 
+    /*  Node to hold the binary data of a cached record. */
+    struct BinaryNode
+    {
         /** Store the key as 64-bit hash, since we have checksum to verify against too. **/
         uint64_t hashKey;
 
         /** The data in the binary node. **/
         std::vector<uint8_t> vData;
 
+        /** The segment the node is linked into. **/
+        uint8_t nSegment;
+
         /** Default constructor **/
-        BinaryNode(const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vDataIn)
-        : pprev   (nullptr)
-        , pnext   (nullptr)
-        , hashKey (XXH64(&vKey[0], vKey.size(), 0))
-        , vData   (vDataIn)
+        BinaryNode(const uint64_t hashKeyIn, const std::vector<uint8_t>& vDataIn)
+        : hashKey  (hashKeyIn)
+        , vData    (vDataIn)
+        , nSegment (WINDOW)
         {
         }
 
-        /** bucket Node is Assigned to. **/
-        uint32_t Bucket(const uint64_t nBuckets)
+        /** The bytes charged to the cache for this node. **/
+        uint64_t Cost() const
         {
-            return static_cast<uint32_t>(hashKey % static_cast<uint64_t>(nBuckets));
+            return vData.size() + BINARY_CACHE_OVERHEAD;
         }
+    };
 
 
-        /** Erase the data. **/
-        void Erase()
+    /*  Count-min sketch of 4-bit access frequencies, halved periodically so old popularity fades. */
+    class FrequencySketch
+    {
+        /* The counters, packed two to a byte and saturating at 15. */
+        std::vector<uint8_t> vCounters;
+
+        /* The counters per row, a power of two. */
+        uint64_t nWidth;
+
+        /* The increments between halvings. */
+        uint64_t nSample;
+
+        /* The increments since the last halving. */
+        uint64_t nAdditions;
+
+    public:
+
+        /** Construct for an expected number of records. **/
+        FrequencySketch(const uint64_t nExpected)
+        : vCounters  ( )
+        , nWidth     (64)
+        , nSample    (std::max(uint64_t(64), nExpected) * 10)
+        , nAdditions (0)
         {
-            std::vector<uint8_t>().swap(vData);
+            /* Four counters per record and row keeps collisions from inflating cold keys. */
+            while(nWidth < nExpected * 4)
+                nWidth <<= 1;
+
+            vCounters.resize(nWidth * 2, 0);
         }
 
+        /** Count an access to a key. **/
+        void Increment(const uint64_t hashKey)
+        {
+            /* Conservative update, only raise the counters that hold the current estimate. */
+            const uint8_t nMin = Estimate(hashKey);
+            if(nMin < 15)
+            {
+                for(uint32_t nRow = 0; nRow < 4; ++nRow)
+                {
+                    const uint64_t nIndex = index(hashKey, nRow);
+                    if(get(nIndex) == nMin)
+                        vCounters[nIndex / 2] += (nIndex % 2 ? 0x10 : 0x01);
+                }
+            }
+
+            /* Age every counter once the sample is full. */
+            if(++nAdditions >= nSample)
+            {
+                for(auto& nCounts : vCounters)
+                    nCounts = (nCounts >> 1) & 0x77;
+
+                nAdditions /= 2;
+            }
+        }
 
-        /** Check if node is in null state. **/
-        bool IsNull() const
+        /** Estimate the accesses to a key. **/
+        uint8_t Estimate(const uint64_t hashKey) const
         {
-            return hashKey == 0;
+            uint8_t nMin = 15;
+            for(uint32_t nRow = 0; nRow < 4; ++nRow)
+                nMin = std::min(nMin, get(index(hashKey, nRow)));
+
+            return nMin;
+        }
+
+    private:
+
+        /** The counter of a key in a row, using a different seed per row. **/
+        uint64_t index(const uint64_t hashKey, const uint32_t nRow) const
+        {
+            static const uint64_t SEEDS[4] =
+            {
+                0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL
+            };
+
+            const uint64_t nMixed = (hashKey ^ SEEDS[nRow]) * 0x9E3779B97F4A7C15ULL;
+            return nRow * nWidth + ((nMixed >> 32) & (nWidth - 1));
+        }
+
+        /** Read a packed counter. **/
+        uint8_t get(const uint64_t nIndex) const
+        {
+            return (vCounters[nIndex / 2] >> ((nIndex % 2) * 4)) & 0x0f;
+        }
+    };
+
+
+    /*  One independently locked part of the cache. */
+    struct CacheShard
+    {
+        /** Mutex for thread concurrency. **/
+        mutable std::mutex MUTEX;
+
+        /** The recency lists, most recently used at the front. **/
+        std::list<BinaryNode> lists[3];
+
+        /** The bytes held in each list. **/
+        uint64_t nSize[3];
+
+        /** Map of key hashes to their nodes. **/
+        std::unordered_map<uint64_t, std::list<BinaryNode>::iterator> mapNodes;
+
+        /** The access frequencies used for admission. **/
+        FrequencySketch sketch;
+
+        /** The byte limits of the window, the protected segment and the whole shard. **/
+        uint64_t nMaxWindow;
+        uint64_t nMaxProtected;
+        uint64_t nMaxSize;
+
+        /** Lookup statistics. **/
+        uint64_t nLookups;
+        uint64_t nHits;
+
+
+        /** Construct with the bytes this shard may hold. **/
+        CacheShard(const uint64_t nMaxSizeIn)
+        : MUTEX         ( )
+        , lists         ( )
+        , nSize         { 0, 0, 0 }
+        , mapNodes      ( )
+        , sketch        (nMaxSizeIn / 128)
+        , nMaxWindow    (std::max(nMaxSizeIn / 100, std::min(nMaxSizeIn / 8, uint64_t(8192))))
+        , nMaxProtected ((nMaxSizeIn - nMaxWindow) * 4 / 5)
+        , nMaxSize      (nMaxSizeIn)
+        , nLookups      (0)
+        , nHits         (0)
+        {
+        }
+
+
+        /** The bytes held by the probation and protected segments. **/
+        uint64_t MainSize() const
+        {
+            return nSize[PROBATION] + nSize[PROTECTED];
+        }
+
+
+        /** Move a node to the front of another list. **/
+        void Move(std::list<BinaryNode>::iterator it, const uint8_t nSegment)
+        {
+            nSize[it->nSegment] -= it->Cost();
+            nSize[nSegment]     += it->Cost();
+
+            lists[nSegment].splice(lists[nSegment].begin(), lists[it->nSegment], it);
+            it->nSegment = nSegment;
+        }
+
+
+        /** Unlink and free a node. **/
+        void Erase(std::list<BinaryNode>::iterator it)
+        {
+            nSize[it->nSegment] -= it->Cost();
+            mapNodes.erase(it->hashKey);
+
+            lists[it->nSegment].erase(it);
+        }
+
+
+        /** Record a hit on a node, promoting it through the segments. **/
+        void Touch(std::list<BinaryNode>::iterator it)
+        {
+            /* Records hit again while on probation have proven themselves. */
+            if(it->nSegment == PROBATION)
+            {
+                Move(it, PROTECTED);
+
+                /* Demote the coldest protected records back to probation. */
+                while(nSize[PROTECTED] > nMaxProtected && lists[PROTECTED].size() > 1)
+                    Move(std::prev(lists[PROTECTED].end()), PROBATION);
+            }
+            else
+                Move(it, it->nSegment);
         }
 
 
-        /** Set node into null state. **/
-        void SetNull()
+        /** Evict until the shard is within its limits. **/
+        void Evict()
         {
-            pprev   = nullptr;
-            pnext   = nullptr;
-            hashKey = 0;
+            /* Records falling out of the window compete for a place in the main segments. */
+            while(nSize[WINDOW] > nMaxWindow && !lists[WINDOW].empty())
+            {
+                auto itCandidate = std::prev(lists[WINDOW].end());
+
+                /* Admit straight away while there is room. */
+                if(nSize[WINDOW] + MainSize() <= nMaxSize)
+                    break;
+
+                /* Drop the candidate if there is nothing to compete with. */
+                if(lists[PROBATION].empty() && lists[PROTECTED].empty())
+                {
+                    Erase(itCandidate);
+                    continue;
+                }
+
+                /* The victim is the coldest record on probation. */
+                auto itVictim = lists[PROBATION].empty() ? std::prev(lists[PROTECTED].end()) : std::prev(lists[PROBATION].end());
+
+                /* Only admit the candidate if it has been seen more often than what it would replace. */
+                if(sketch.Estimate(itCandidate->hashKey) > sketch.Estimate(itVictim->hashKey))
+                    Erase(itVictim);
+                else
+                    Erase(itCandidate);
+            }
 
-            Erase();
+            /* Move what is left over the window limit into probation, there is room for it now. */
+            while(nSize[WINDOW] > nMaxWindow && !lists[WINDOW].empty())
+                Move(std::prev(lists[WINDOW].end()), PROBATION);
+
+            /* Updates can grow records in place, trim the main segments if that pushed us over. */
+            while(nSize[WINDOW] + MainSize() > nMaxSize && (!lists[PROBATION].empty() || !lists[PROTECTED].empty()))
+                Erase(lists[PROBATION].empty() ? std::prev(lists[PROTECTED].end()) : std::prev(lists[PROBATION].end()));
         }
     };
 
 
     /** Cache Size Constructor **/
     BinaryLRU::BinaryLRU(const uint32_t nCacheSizeIn)
-    : MAX_CACHE_SIZE    (nCacheSizeIn)
-    , MAX_CACHE_BUCKETS (nCacheSizeIn / 128)
-    , nCurrentSize      (MAX_CACHE_BUCKETS * 16)
-    , MUTEX             ( )
-    , hashmap           (MAX_CACHE_BUCKETS, nullptr)
-    , indexes           (MAX_CACHE_BUCKETS, 0)
-    , pfirst            (nullptr)
-    , plast             (nullptr)
+    : MAX_CACHE_SIZE (nCacheSizeIn)
+    , vShards        ( )
     {
+        /* Split the capacity evenly across the shards. */
+        vShards.reserve(BINARY_CACHE_SHARDS);
+        for(uint32_t n = 0; n < BINARY_CACHE_SHARDS; ++n)
+            vShards.push_back(new CacheShard(MAX_CACHE_SIZE / BINARY_CACHE_SHARDS));
     }
 
 
     /** Class Destructor. **/
     BinaryLRU::~BinaryLRU()
     {
-        LOCK(MUTEX);
-
-        /* Loop through the linked list. */
-        for(auto& item : hashmap)
-            if(item != nullptr)
-                delete item;
+        for(auto& pshard : vShards)
+            delete pshard;
     }
 
 
     /*  Check if data exists. */
     bool BinaryLRU::Has(const std::vector<uint8_t>& vKey) const
     {
-        LOCK(MUTEX);
-
-        /* Get the data. */
-        const uint64_t& nIndex  = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
-
-        /* Check if the Record Exists. */
-        const BinaryNode* pthis = hashmap[slot(nIndex)];
-        if(pthis == nullptr)
-            return false;
-
-        /* Check for null state. */
-        if(pthis->IsNull())
-            return false;
-
-        /* Check the data is expected. */
-        return (pthis->hashKey == XXH64(&vKey[0], vKey.size(), 0));
-    }
-
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-    /*  Find a bucket for cache key management. */
-    uint32_t BinaryLRU::bucket(const std::vector<uint8_t>& vKey) const
-    {
-        /* Get an xxHash. */
-        uint64_t nBucket = XXH64(&vKey[0], vKey.size(), 0);
+        CacheShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        return static_cast<uint32_t>(nBucket % static_cast<uint64_t>(MAX_CACHE_BUCKETS));
+        return pshard->mapNodes.count(hashKey);
     }
 
 
     /*  Get the data by index */
     bool BinaryLRU::Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-        /* Check for data. */
-        uint64_t& nIndex  = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
-
-        /* Get the binary node. */
-        BinaryNode* pthis = hashmap[slot(nIndex)];
-        if(pthis == nullptr)
-        {
-            nIndex = 0; //reset by reference
-            return false;
-        }
+        CacheShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Check for null state. */
-        if(pthis->IsNull())
-        {
-            nIndex = 0; //reset by reference
-            return false;
-        }
+        /* Misses count toward the frequency too, so a record read from disk can earn its place. */
+        pshard->sketch.Increment(hashKey);
+        ++pshard->nLookups;
 
-        /* Check the keys are correct. */
-        if(pthis->hashKey != XXH64(&vKey[0], vKey.size(), 0))
+        /* Check for data. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
             return false;
 
         /* Get the data. */
-        vData = pthis->vData;
+        vData = it->second->vData;
+        ++pshard->nHits;
 
-        /* Move to front of double linked list. */
-        move_to_front(pthis);
+        /* Promote the node. */
+        pshard->Touch(it->second);
 
         return true;
     }
@@ -179,90 +341,33 @@ namespace LLD
     /*  Add data in the Pool. */
     void BinaryLRU::Put(const SectorKey& key, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData, bool fReserve)
     {
-        LOCK(MUTEX);
-
-        /* Get the binary node. */
-        uint64_t& nIndex = indexes[bucket(vKey)];
-        if(nIndex != 0)
-        {
-            /* Get the node from checksum. */
-            uint32_t nSlot    = slot(nIndex);
-            BinaryNode* pthis = hashmap[nSlot];
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-            /* Check for dereferencing nullptr. */
-            if(pthis != nullptr && !pthis->IsNull())
-            {
-                /* Reduce the current size. */
-                nCurrentSize -= static_cast<uint32_t>(pthis->vData.size());
-
-                /* Free the memory. */
-                remove_node(pthis);
-                pthis->SetNull();
-            }
-        }
+        CacheShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Update index hashmap through reference: NOTE nSectorFile and nSectorStart are 0-based so we add 1 to it to ensure we always have an index */
-        nIndex = ((key.nSectorFile + 1) * (key.nSectorStart + 1));
-
-        /* Cleanup if colliding with another bucket. */
-        uint32_t nSlot = slot(nIndex);
-        if(hashmap[nSlot] != nullptr)
+        /* Update an existing record in place. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it != pshard->mapNodes.end())
         {
-            /* Claiming an empty hashmap slot. */
-            if(!hashmap[nSlot]->IsNull())
-            {
-                /* Erase data on collision. */
-                nCurrentSize -= static_cast<uint32_t>(hashmap[nSlot]->vData.size());
-                hashmap[nSlot]->Erase();
-            }
-
-            /* Set new values. */
-            hashmap[nSlot]->hashKey = XXH64(&vKey[0], vKey.size(), 0);
-            hashmap[nSlot]->vData   = vData;
+            auto itNode = it->second;
+            pshard->nSize[itNode->nSegment] -= itNode->Cost();
+            itNode->vData = vData;
+            pshard->nSize[itNode->nSegment] += itNode->Cost();
 
-            /* Move to front of list. */
-            move_to_front(hashmap[nSlot]);
+            pshard->Touch(itNode);
         }
         else
         {
-            /* Add cache node to objects map. */
-            hashmap[nSlot] = new BinaryNode(vKey, vData);;
-            move_to_front(hashmap[nSlot]);
-
-            /* Account for the node's memory size. */
-            nCurrentSize += sizeof(*hashmap[nSlot]);
-        }
-
-        /* Remove the last node if cache too large. */
-        while(nCurrentSize > MAX_CACHE_SIZE)
-        {
-            /* Get last pointer. */
-            BinaryNode* pnode = plast;
-            if(!pnode || pnode->IsNull())
-                break;
-
-            /* Set the new links. */
-            plast = plast->pprev;
-            if (plast)
-                plast->pnext = nullptr;
-
-            /* Reset the memory linking. */
-            pnode->pprev = nullptr;
-            pnode->pnext = nullptr;
-
-            /* Reduce memory size. */
-            nCurrentSize -= static_cast<uint32_t>(pnode->vData.size());
-
-            /* Calculate the buckets for the node being deleted */
-            uint32_t  nBucket = pnode->Bucket(MAX_CACHE_BUCKETS);
-            uint64_t& nRemove = indexes[nBucket];
-
-            /* Reset the slot. */
-            hashmap[slot(nRemove)]->SetNull();
-            nRemove                = 0;
+            /* Writes count as an access, new records always start in the window. */
+            pshard->sketch.Increment(hashKey);
+            pshard->lists[WINDOW].emplace_front(hashKey, vData);
+            pshard->mapNodes[hashKey] = pshard->lists[WINDOW].begin();
+            pshard->nSize[WINDOW]    += pshard->lists[WINDOW].front().Cost();
         }
 
-        nCurrentSize += static_cast<uint32_t>(vData.size());
+        /* Remove the coldest nodes if cache too large. */
+        pshard->Evict();
     }
 
 
@@ -275,103 +380,59 @@ namespace LLD
     /*  Force Remove Object by Index. */
     bool BinaryLRU::Remove(const std::vector<uint8_t>& vKey)
     {
-        LOCK(MUTEX);
+        const uint64_t hashKey = XXH64(&vKey[0], vKey.size(), 0);
 
-        /* Get the data. */
-        uint64_t& nIndex = indexes[bucket(vKey)];
-        if(nIndex == 0)
-            return false;
+        CacheShard* pshard = shard(hashKey);
+        LOCK(pshard->MUTEX);
 
-        /* Get the binary node. */
-        uint32_t nSlot = slot(nIndex);
-        if(hashmap[nSlot] == nullptr)
-        {
-            nIndex = 0; //reset by reference
+        /* Get the data. */
+        auto it = pshard->mapNodes.find(hashKey);
+        if(it == pshard->mapNodes.end())
             return false;
-        }
-
-        /* Remove from the linked list. */
-        BinaryNode* pthis = hashmap[nSlot];
-        remove_node(pthis);
-
-        /* Set to null state. */
-        hashmap[nSlot]->SetNull();
 
         /* Free the memory. */
-        nCurrentSize  -= static_cast<uint32_t>(pthis->vData.size() + 48);
-        nIndex         = 0; //reset by reference
+        pshard->Erase(it->second);
 
         return true;
     }
 
 
-    /*  Find a bucket for checksum key management. */
-    uint32_t BinaryLRU::slot(const uint64_t nIndex) const
+    /*  Get the bytes currently charged against the cache. */
+    uint64_t BinaryLRU::Size() const
     {
-        return static_cast<uint32_t>(nIndex % static_cast<uint64_t>(MAX_CACHE_BUCKETS));
+        uint64_t nTotal = 0;
+        for(const auto& pshard : vShards)
+        {
+            LOCK(pshard->MUTEX);
+            nTotal += pshard->nSize[WINDOW] + pshard->MainSize();
+        }
+
+        return nTotal;
     }
 
 
-    /*  Remove a node from the double linked list. */
-    void BinaryLRU::remove_node(BinaryNode* pthis)
+    /*  Get the fraction of lookups that were served from the cache. */
+    double BinaryLRU::HitRate() const
     {
-        /* Relink last pointer. */
-        if(pthis == plast)
-        {
-            plast = plast->pprev;
-            if(plast)
-                plast->pnext = nullptr;
-        }
-
-        /* Relink first pointer. */
-        if(pthis == pfirst)
+        uint64_t nLookups = 0, nHits = 0;
+        for(const auto& pshard : vShards)
         {
-            pfirst = pfirst->pnext;
-            if(pfirst)
-                pfirst->pprev = nullptr;
+            LOCK(pshard->MUTEX);
+            nLookups += pshard->nLookups;
+            nHits    += pshard->nHits;
         }
 
-        /* Link the next pointer if not null */
-        if (pthis->pnext)
-            pthis->pnext->pprev = pthis->pprev;
+        if(nLookups == 0)
+            return 0.0;
 
-        /* Link the previous pointer if not null. */
-        if (pthis->pprev)
-            pthis->pprev->pnext = pthis->pnext;
-
-        /* Unlink next and prev. */
-        pthis->pnext = nullptr;
-        pthis->pprev = nullptr;
+        return static_cast<double>(nHits) / nLookups;
     }
 
 
-    /*  Move the node in double linked list to front. */
-    void BinaryLRU::move_to_front(BinaryNode* pthis)
+    /*  Find the shard responsible for a key hash. */
+    CacheShard* BinaryLRU::shard(const uint64_t hashKey) const
     {
-        /* Don't move to front if already in the front. */
-        if(pthis == pfirst)
-            return;
-
-        /* Move last pointer if moving from back. */
-        remove_node(pthis);
-
-        /* Link to front. */
-        pthis->pprev = nullptr;
-        pthis->pnext = pfirst;
-
-        /* Update the first reference prev */
-        if(pfirst)
-        {
-            /* Set last for second iteration. */
-            pfirst->pprev = pthis;
-            if(!plast)
-            {
-                plast = pfirst;
-                plast->pnext = nullptr;
-            }
-        }
-
-        /* Update the first reference. */
-        pfirst        = pthis;
+        /* Use the top bits, the sketch and map use the rest. */
+        return vShards[(hashKey >> 58) % BINARY_CACHE_SHARDS];
     }
 }
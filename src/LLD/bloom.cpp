@@ -0,0 +1,88 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/bloom.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace LLD
+{
+
+    /* Size Constructor. */
+    BloomFilter::BloomFilter(const uint64_t nBitsIn)
+    : nBits (std::max(uint64_t(64), (nBitsIn + 63) & ~uint64_t(63)))
+    , pBits (new std::atomic<uint64_t>[nBits / 64]())
+    {
+    }
+
+
+    /* Add a key hash to the filter. */
+    void BloomFilter::Insert(const uint64_t nHash)
+    {
+        /* Double hashing, the upper half of the hash gives the stride between bits. */
+        const uint64_t nStride = (nHash >> 32) | 1;
+        for(uint32_t i = 0; i < BLOOM_FILTER_HASHES; ++i)
+        {
+            const uint64_t nBit = (nHash + i * nStride) % nBits;
+            pBits[nBit / 64].fetch_or(uint64_t(1) << (nBit % 64), std::memory_order_relaxed);
+        }
+    }
+
+
+    /* Determines if a key hash might be in the filter. */
+    bool BloomFilter::Contains(const uint64_t nHash) const
+    {
+        const uint64_t nStride = (nHash >> 32) | 1;
+        for(uint32_t i = 0; i < BLOOM_FILTER_HASHES; ++i)
+        {
+            const uint64_t nBit = (nHash + i * nStride) % nBits;
+            if(!(pBits[nBit / 64].load(std::memory_order_relaxed) & (uint64_t(1) << (nBit % 64))))
+                return false;
+        }
+
+        return true;
+    }
+
+
+    /* Get the total bits in the filter. */
+    uint64_t BloomFilter::Bits() const
+    {
+        return nBits;
+    }
+
+
+    /* Read the filter bits from a file. */
+    bool BloomFilter::Read(const BinaryFile& file, const uint64_t nPos)
+    {
+        std::vector<uint64_t> vWords(nBits / 64, 0);
+        if(!file.Read((uint8_t*)&vWords[0], nBits / 8, nPos))
+            return false;
+
+        for(uint64_t i = 0; i < vWords.size(); ++i)
+            pBits[i].store(vWords[i], std::memory_order_relaxed);
+
+        return true;
+    }
+
+
+    /* Write the filter bits to a file. */
+    bool BloomFilter::Write(BinaryFile& file, const uint64_t nPos) const
+    {
+        std::vector<uint64_t> vWords(nBits / 64, 0);
+        for(uint64_t i = 0; i < vWords.size(); ++i)
+            vWords[i] = pBits[i].load(std::memory_order_relaxed);
+
+        return file.Write((uint8_t*)&vWords[0], nBits / 8, nPos);
+    }
+}
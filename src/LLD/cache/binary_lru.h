@@ -25,53 +25,44 @@ namespace LLD
     class SectorKey;
 
 
-    /** BinaryNode
+    /** The total shards a binary cache is split into. **/
+    const uint32_t BINARY_CACHE_SHARDS = 64;
+
+
+    /** The bytes charged to a cached record on top of its data. **/
+    const uint32_t BINARY_CACHE_OVERHEAD = 96;
+
+
+    /** CacheShard
      *
-     *  Node to hold the binary data of the double linked list.
+     *  One independently locked part of the cache, holding its own lists and frequency sketch.
      *
      **/
-    struct BinaryNode;
+    struct CacheShard;
 
 
     /** BinaryLRU
     *
-    *   LRU - Least Recently Used.
+    *   Sharded cache of binary records, keyed by a 64-bit hash of the binary key.
     *   This class is responsible for holding data that is partially processed.
     *   This class has no types, all objects are in binary forms.
     *
+    *   Each shard has its own lock so readers on different keys don't contend.
+    *   Eviction is W-TinyLFU: new records enter a small LRU window, and only move into the
+    *   main segmented LRU if they have been seen more often than the record they would evict.
+    *   A scan of records read once can only churn the window, not the working set.
+    *
+    *   Capacity is accounted in bytes of record data plus a fixed node overhead.
+    *
     **/
     class BinaryLRU
     {
-        /* The Maximum Size of the Cache. */
-        uint32_t MAX_CACHE_SIZE;
-
-
-        /* The total buckets available. */
-        uint32_t MAX_CACHE_BUCKETS;
-
-
-        /* The current size of the pool. */
-        uint32_t nCurrentSize;
-
-
-        /* Mutex for thread concurrency. */
-        mutable std::mutex MUTEX;
-
-
-        /* Map of the current holding data. */
-        std::vector<BinaryNode*> hashmap;
+        /* The Maximum Size of the Cache in bytes. */
+        uint64_t MAX_CACHE_SIZE;
 
 
-        /* Map of the current data indexes. */
-        std::vector<uint64_t> indexes;
-
-
-        /* Keep track of the first object in linked list. */
-        BinaryNode* pfirst;
-
-
-        /* Keep track of the last object in linked list. */
-        BinaryNode* plast;
+        /* The independently locked shards. */
+        std::vector<CacheShard*> vShards;
 
 
     public:
@@ -103,7 +94,7 @@ namespace LLD
 
         /** Cache Size Constructor
          *
-         *  @param[in] nCacheSizeIn The maximum size of this Cache Pool
+         *  @param[in] nCacheSizeIn The maximum size of this Cache Pool in bytes.
          *
          **/
         BinaryLRU(const uint32_t nCacheSizeIn);
@@ -169,46 +160,32 @@ namespace LLD
         bool Remove(const std::vector<uint8_t>& vKey);
 
 
-    private:
-
-        /** RemoveNode
-         *
-         *  Remove a node from the double linked list.
+        /** Size
          *
-         *  @param[in] pthis The node to remove from list.
+         *  Get the bytes currently charged against the cache.
          *
          **/
-        void remove_node(BinaryNode* pthis);
+        uint64_t Size() const;
 
 
-        /** MoveToFront
+        /** HitRate
          *
-         *  Move the node in double linked list to front.
-         *
-         *  @param[in] pthis The node to move to front.
+         *  Get the fraction of lookups that were served from the cache.
          *
          **/
-        void move_to_front(BinaryNode* pthis);
+        double HitRate() const;
 
 
-        /** Bucket
-         *
-         *  Find a bucket for cache key management.
-         *
-         *  @param[in] vKey The key to get bucket for.
-         *
-         **/
-        uint32_t bucket(const std::vector<uint8_t>& vKey) const;
-
+    private:
 
-        /** Bucket
+        /** Shard
          *
-         *  Find a bucket for checksum key management.
+         *  Find the shard responsible for a key hash.
          *
-         *  @param[in] nIndex The checksum to get bucket for.
+         *  @param[in] hashKey The 64-bit hash of the key.
          *
          **/
-        uint32_t slot(const uint64_t nIndex) const;
+        CacheShard* shard(const uint64_t hashKey) const;
     };
 }
 
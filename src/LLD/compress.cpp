@@ -0,0 +1,81 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/compress.h>
+#include <LLD/include/version.h>
+#include <LLD/compress/lz4.h>
+
+#include <Util/templates/datastream.h>
+
+namespace LLD
+{
+
+    /* LZ4 compress a sector record. */
+    bool Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vCompressed)
+    {
+        /* Small records don't gain anything from the extra header. */
+        if(vData.size() < MIN_COMPRESS_SIZE || vData.size() > MAX_DECOMPRESS_SIZE)
+            return false;
+
+        /* Write the raw size header. */
+        DataStream ssHeader(SER_LLD, DATABASE_VERSION);
+        WriteCompactSize(ssHeader, vData.size());
+
+        /* Allocate for the worst case so compression can't fail on space. */
+        const int32_t nBound = LZ4_compressBound(static_cast<int32_t>(vData.size()));
+        vCompressed.resize(ssHeader.size() + nBound);
+        std::copy(ssHeader.begin(), ssHeader.end(), vCompressed.begin());
+
+        /* Compress after the header. */
+        const int32_t nCompressed = LZ4_compress_default((const char*)&vData[0],
+            (char*)&vCompressed[ssHeader.size()], static_cast<int32_t>(vData.size()), nBound);
+
+        if(nCompressed <= 0)
+            return false;
+
+        /* Only keep the compressed form if it saves space. */
+        vCompressed.resize(ssHeader.size() + nCompressed);
+        return vCompressed.size() < vData.size();
+    }
+
+
+    /* Decompress a sector record written by Compress. */
+    bool Decompress(const std::vector<uint8_t>& vCompressed, std::vector<uint8_t>& vData)
+    {
+        /* Read the raw size header. */
+        uint64_t nSize = 0;
+        uint64_t nHeader = 0;
+        try
+        {
+            DataStream ssHeader(vCompressed, SER_LLD, DATABASE_VERSION);
+            nSize   = ReadCompactSize(ssHeader);
+            nHeader = GetSizeOfCompactSize(nSize);
+        }
+        catch(const std::exception& e)
+        {
+            return false;
+        }
+
+        /* Check the header against the record bounds. */
+        if(nSize == 0 || nSize > MAX_DECOMPRESS_SIZE || nHeader >= vCompressed.size())
+            return false;
+
+        /* Decompress into a buffer of the exact raw size. */
+        vData.resize(nSize);
+        const int32_t nDecompressed = LZ4_decompress_safe((const char*)&vCompressed[nHeader], (char*)&vData[0],
+            static_cast<int32_t>(vCompressed.size() - nHeader), static_cast<int32_t>(nSize));
+
+        return nDecompressed >= 0 && static_cast<uint64_t>(nDecompressed) == nSize;
+    }
+
+}
@@ -0,0 +1,250 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/file.h>
+
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace LLD
+{
+
+    /* Open the file for reading and writing. */
+    BinaryFile::BinaryFile(const std::string& strPathIn, const bool fCreate)
+    : nDescriptor (-1)
+    , strPath     (strPathIn)
+    , pMapped     (nullptr)
+    , nMapped     (0)
+    {
+    #ifdef WIN32
+        nDescriptor = _open(strPath.c_str(), _O_RDWR | _O_BINARY | (fCreate ? _O_CREAT : 0), _S_IREAD | _S_IWRITE);
+    #else
+        nDescriptor = open(strPath.c_str(), O_RDWR | (fCreate ? O_CREAT : 0), 0644);
+    #endif
+    }
+
+
+    /* Default Destructor. Closes the descriptor. */
+    BinaryFile::~BinaryFile()
+    {
+    #ifndef WIN32
+        /* Release the memory mapping. */
+        if(pMapped)
+            munmap(pMapped, nMapped);
+    #endif
+
+        if(nDescriptor < 0)
+            return;
+
+    #ifdef WIN32
+        _close(nDescriptor);
+    #else
+        close(nDescriptor);
+    #endif
+    }
+
+
+    /* Determines if the descriptor was opened successfully. */
+    bool BinaryFile::IsOpen() const
+    {
+        return nDescriptor >= 0;
+    }
+
+
+    /* Returns the path of the file. */
+    const std::string& BinaryFile::Path() const
+    {
+        return strPath;
+    }
+
+
+    /* Read bytes from a given binary position. */
+    bool BinaryFile::Read(uint8_t* pData, const uint64_t nLength, const uint64_t nPos) const
+    {
+        if(nDescriptor < 0)
+            return false;
+
+        /* Copy straight out of the mapping if it covers the whole range. */
+        if(pMapped && nPos + nLength <= nMapped)
+        {
+            std::copy(pMapped + nPos, pMapped + nPos + nLength, pData);
+            return true;
+        }
+
+    #ifdef WIN32
+        LOCK(FILE_MUTEX);
+
+        /* Seek to the binary position. */
+        if(_lseeki64(nDescriptor, nPos, SEEK_SET) < 0)
+            return false;
+    #endif
+
+        /* Loop until all bytes are read, reads can return short. */
+        uint64_t nRead = 0;
+        while(nRead < nLength)
+        {
+        #ifdef WIN32
+            int64_t nRet = _read(nDescriptor, pData + nRead, static_cast<uint32_t>(nLength - nRead));
+        #else
+            int64_t nRet = pread(nDescriptor, pData + nRead, nLength - nRead, nPos + nRead);
+        #endif
+
+            /* Retry on signal interrupts. */
+            if(nRet < 0 && errno == EINTR)
+                continue;
+
+            /* Check for errors or end of file. */
+            if(nRet <= 0)
+                return false;
+
+            nRead += nRet;
+        }
+
+        return true;
+    }
+
+
+    /* Write bytes to a given binary position. */
+    bool BinaryFile::Write(const uint8_t* pData, const uint64_t nLength, const uint64_t nPos)
+    {
+        if(nDescriptor < 0)
+            return false;
+
+    #ifdef WIN32
+        LOCK(FILE_MUTEX);
+
+        /* Seek to the binary position. */
+        if(_lseeki64(nDescriptor, nPos, SEEK_SET) < 0)
+            return false;
+    #endif
+
+        /* Loop until all bytes are written. */
+        uint64_t nWrote = 0;
+        while(nWrote < nLength)
+        {
+        #ifdef WIN32
+            int64_t nRet = _write(nDescriptor, pData + nWrote, static_cast<uint32_t>(nLength - nWrote));
+        #else
+            int64_t nRet = pwrite(nDescriptor, pData + nWrote, nLength - nWrote, nPos + nWrote);
+        #endif
+
+            /* Retry on signal interrupts. */
+            if(nRet < 0 && errno == EINTR)
+                continue;
+
+            /* Check for errors. */
+            if(nRet <= 0)
+                return false;
+
+            nWrote += nRet;
+        }
+
+        return true;
+    }
+
+
+    /* Get the current size of the file in bytes. */
+    uint64_t BinaryFile::Size() const
+    {
+        if(nDescriptor < 0)
+            return 0;
+
+    #ifdef WIN32
+        struct _stat64 stat;
+        if(_fstat64(nDescriptor, &stat) != 0)
+            return 0;
+    #else
+        struct stat stat;
+        if(fstat(nDescriptor, &stat) != 0)
+            return 0;
+    #endif
+
+        return static_cast<uint64_t>(stat.st_size);
+    }
+
+
+    /* Truncate or extend the file to a given size. */
+    bool BinaryFile::Truncate(const uint64_t nSize)
+    {
+        if(nDescriptor < 0)
+            return false;
+
+    #ifdef WIN32
+        return _chsize_s(nDescriptor, nSize) == 0;
+    #else
+        return ftruncate(nDescriptor, nSize) == 0;
+    #endif
+    }
+
+
+    /* Flush the file data to stable storage. */
+    bool BinaryFile::Sync()
+    {
+        if(nDescriptor < 0)
+            return false;
+
+    #if defined(WIN32)
+        return _commit(nDescriptor) == 0;
+    #elif defined(MAC_OSX) || defined(IPHONE)
+        return fsync(nDescriptor) == 0;
+    #else
+        return fdatasync(nDescriptor) == 0;
+    #endif
+    }
+
+
+    /* Memory map the current contents of the file read-only. */
+    bool BinaryFile::Map()
+    {
+    #ifdef WIN32
+        return false;
+    #else
+        if(nDescriptor < 0 || pMapped)
+            return false;
+
+        /* Nothing to map for an empty file. */
+        uint64_t nSize = Size();
+        if(nSize == 0)
+            return false;
+
+        /* Map the file as shared so writes through the descriptor stay visible. */
+        void* pMap = mmap(nullptr, nSize, PROT_READ, MAP_SHARED, nDescriptor, 0);
+        if(pMap == MAP_FAILED)
+            return false;
+
+        pMapped = static_cast<uint8_t*>(pMap);
+        nMapped = nSize;
+
+        return true;
+    #endif
+    }
+
+
+    /* Determines if the file is memory mapped. */
+    bool BinaryFile::IsMapped() const
+    {
+        return pMapped != nullptr;
+    }
+}
@@ -12,9 +12,14 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/include/global.h>
+#include <LLD/include/snapshot.h>
 
+#include <TAO/Ledger/include/blockindex.h>
+#include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/enum.h> //for internal flags
 
+#include <Util/include/filesystem.h>
+
 namespace LLD
 {
     /* The LLD global instance pointers. */
@@ -28,12 +33,95 @@ namespace LLD
     TrustDB*      Trust;
     LegacyDB*     Legacy;
 
+    /* The write-ahead journal shared by all LLD instances. */
+    Journal*      TxnJournal;
+
+
+    /* Mutex to keep checkpoints out of an in-flight coordinated commit. */
+    std::mutex TXN_MUTEX;
+
+
+    /* Flag to hold off checkpoints after a commit failed to apply, until the journal is replayed. */
+    bool fRecovery = false;
+
+
+    /* Get the LLD instance that owns a journal record. */
+    SectorDatabase<BinaryHashMap, BinaryLRU>* GetInstance(const std::string& strName)
+    {
+        if(Contract && Contract->GetName() == strName)
+            return Contract;
+
+        if(Register && Register->GetName() == strName)
+            return Register;
+
+        if(Ledger && Ledger->GetName() == strName)
+            return Ledger;
+
+        if(Local && Local->GetName() == strName)
+            return Local;
+
+        if(Client && Client->GetName() == strName)
+            return Client;
+
+        if(Trust && Trust->GetName() == strName)
+            return Trust;
+
+        if(Legacy && Legacy->GetName() == strName)
+            return Legacy;
+
+        return nullptr;
+    }
+
+
+    /* Release the disk transactions of every LLD instance. */
+    void Release()
+    {
+        /* Abort the contract DB transaction. */
+        if(Contract)
+            Contract->TxnRelease();
+
+        /* Abort the register DB transaction. */
+        if(Register)
+            Register->TxnRelease();
+
+        /* Abort the ledger DB transaction. */
+        if(Ledger)
+            Ledger->TxnRelease();
+
+        /* Abort the local DB transaction. */
+        if(Local)
+            Local->TxnRelease();
+
+        /* Abort the client DB transaction. */
+        if(Client)
+            Client->TxnRelease();
+
+        /* Abort the trust DB transaction. */
+        if(Trust)
+            Trust->TxnRelease();
+
+        /* Abort the legacy DB transaction. */
+        if(Legacy)
+            Legacy->TxnRelease();
+    }
+
 
     /*  Initialize the global LLD instances. */
     void Initialize()
     {
         debug::log(0, FUNCTION, "Initializing LLD");
 
+        /* Open the shared transaction journal. */
+        std::string strJournal = config::GetDataDir() + "_JOURNAL/";
+        if(!filesystem::exists(strJournal))
+            filesystem::create_directories(strJournal);
+
+        TxnJournal = new Journal(strJournal + "journal.dat",
+            static_cast<uint32_t>(config::GetArg("-journalsynccommits", JOURNAL_SYNC_COMMITS)),
+            static_cast<uint64_t>(config::GetArg("-journalsyncms", JOURNAL_SYNC_INTERVAL)));
+        if(!TxnJournal->IsOpen())
+            debug::error(FUNCTION, "failed to open transaction journal");
+
         /* Create the contract database instance. */
         uint32_t nContractCacheSize = config::GetArg("-contractcache", 1);
         Contract = new ContractDB(
@@ -41,17 +129,28 @@ namespace LLD
                         77773,
                         nContractCacheSize * 1024 * 1024);
 
-        /* Create the contract database instance. */
+        /* Create the contract database instance. Registers are indexed by type for the API's typed scans. */
         uint32_t nRegisterCacheSize = config::GetArg("-registercache", 2);
         Register = new RegisterDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | FLAGS::INDEX,
                         77773,
                         nRegisterCacheSize * 1024 * 1024);
 
+        /* Extra flags for the ledger and legacy databases. */
+        uint8_t nBlockFlags = 0;
+
+        /* Memory map completed sector files. */
+        if(config::GetBoolArg("-lldmmap", false))
+            nBlockFlags |= FLAGS::MMAP;
+
+        /* Compress records, the ledger is dominated by redundant transaction data. */
+        if(config::GetBoolArg("-lldcompress", false))
+            nBlockFlags |= FLAGS::COMPRESS;
+
         /* Create the ledger database instance. */
         uint32_t nLedgerCacheSize = config::GetArg("-ledgercache", 2);
         Ledger    = new LedgerDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nBlockFlags,
                         config::fClient.load() ? 77773 : (256 * 256 * 64),
                         nLedgerCacheSize * 1024 * 1024);
 
@@ -59,7 +158,7 @@ namespace LLD
         /* Create the legacy database instance. */
         uint32_t nLegacyCacheSize = config::GetArg("-legacycache", 1);
         Legacy = new LegacyDB(
-                        FLAGS::CREATE | FLAGS::FORCE,
+                        FLAGS::CREATE | FLAGS::FORCE | nBlockFlags,
                         config::fClient.load() ? 77773 : 256 * 256 * 64,
                         nLegacyCacheSize * 1024 * 1024);
 
@@ -82,8 +181,39 @@ namespace LLD
                             77773);
         }
 
+        /* Log the keys of the ledger databases so they can be exported to a snapshot. */
+        if(!config::fClient.load() && config::GetBoolArg("-snapshotkeys", true))
+        {
+            Contract->LogKeys();
+            Register->LogKeys();
+            Ledger->LogKeys();
+            Legacy->LogKeys();
+            Trust->LogKeys();
+        }
+
         /* Handle database recovery mode. */
-        TxnRecovery();
+        if(!TxnRecovery())
+        {
+            debug::error(FUNCTION, "failed to recover transaction journal, shutting down");
+            config::fShutdown = true;
+
+            return;
+        }
+
+        /* Bootstrap empty databases from a snapshot. */
+        if(config::mapArgs.count("-snapshot"))
+        {
+            if(!Snapshot::Import(config::GetArg("-snapshot", "")))
+            {
+                debug::error(FUNCTION, "failed to load snapshot, shutting down");
+                config::fShutdown = true;
+            }
+        }
+        else if(Snapshot::Pending())
+        {
+            debug::error(FUNCTION, "a snapshot load was interrupted, restart with the same -snapshot to resume it");
+            config::fShutdown = true;
+        }
     }
 
 
@@ -92,6 +222,14 @@ namespace LLD
     {
         debug::log(0, FUNCTION, "Shutting down LLD");
 
+        /* Flush all instances so the journal is empty for the next start. */
+        if(TxnJournal)
+        {
+            /* Keep the deferred commits if the checkpoint can't run. */
+            TxnJournal->Sync();
+            TxnCheckpoint();
+        }
+
         /* Cleanup the contract database. */
         if(Contract)
         {
@@ -145,79 +283,110 @@ namespace LLD
             debug::log(2, FUNCTION, "Shutting down TrustDB");
             delete Trust;
         }
+
+
+        /* Cleanup the transaction journal. */
+        if(TxnJournal)
+            delete TxnJournal;
     }
 
 
-    /* Check the transactions for recovery. */
-    void TxnRecovery()
+    /* Replay the journal records since the last checkpoint. */
+    bool TxnRecovery()
     {
-        /* Flag to determine if there are any failures. */
-        bool fRecovery = true;
+        /* Check for an open journal. */
+        if(!TxnJournal)
+            return true;
 
-        /* Check the contract DB journal. */
-        if(Contract && !Contract->TxnRecovery())
-            fRecovery = false;
+        /* Read the journal. */
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
+        if(!TxnJournal->Read(vRecords))
+            return debug::error(FUNCTION, "failed to read transaction journal");
 
-        /* Check the register DB journal. */
-        if(Register && !Register->TxnRecovery())
-            fRecovery = false;
+        /* Nothing to do after a clean shutdown. */
+        if(vRecords.empty())
+            return true;
 
-        /* Check the ledger DB journal. */
-        if(Ledger && !Ledger->TxnRecovery())
-            fRecovery = false;
+        debug::log(0, FUNCTION, "transaction journal has ", vRecords.size(), " records, recovering...");
 
-        /* Check the local DB journal. */
-        if(Local && !Local->TxnRecovery())
-            fRecovery = false;
+        /* Replay in the order they were committed, each record is idempotent. */
+        for(const auto& record : vRecords)
+        {
+            /* Keep the journal for the next start if any record can't be replayed. */
+            SectorDatabase<BinaryHashMap, BinaryLRU>* pdb = GetInstance(record.first);
+            if(!pdb)
+                return debug::error(FUNCTION, "no database for journal record ", record.first, ", keeping journal");
 
-        /* Check the client DB journal. */
-        if(Client && !Client->TxnRecovery())
-            fRecovery = false;
+            if(!pdb->TxnRecovery(record.second))
+                return debug::error(FUNCTION, "failed to replay journal record for ", record.first, ", keeping journal");
+        }
 
-        /* Check the ledger DB journal. */
-        if(Trust && !Trust->TxnRecovery())
+        /* Every commit that failed to apply has now been replayed. */
+        {
+            LOCK(TXN_MUTEX);
             fRecovery = false;
+        }
 
-        /* Check the ledger DB journal. */
-        if(Legacy && !Legacy->TxnRecovery())
-            fRecovery = false;
+        /* Make the replayed data durable and clear the journal. */
+        return TxnCheckpoint();
+    }
+
+
+    /* Flush all LLD instances and clear the journal, the commit lock must be held. */
+    bool Checkpoint()
+    {
+        /* Check for an open journal. */
+        if(!TxnJournal)
+            return false;
 
-        /* Commit the transactions if journals are recovered. */
+        /* Keep the journal of a commit that failed to apply until it is replayed. */
         if(fRecovery)
-        {
-            debug::log(0, FUNCTION, "all transactions are complete, recovering...");
+            return debug::error(FUNCTION, "a commit failed to apply, keeping journal for recovery");
 
-            /* Commit contract DB transaction. */
-            if(Contract)
-                Contract->TxnCommit();
+        /* Flag to determine if there are any failures. */
+        bool fFlushed = true;
 
-            /* Commit register DB transaction. */
-            if(Register)
-                Register->TxnCommit();
+        /* Flush the contract DB. */
+        if(Contract && !Contract->Flush())
+            fFlushed = false;
 
-            /* Commit ledger DB transaction. */
-            if(Ledger)
-                Ledger->TxnCommit();
+        /* Flush the register DB. */
+        if(Register && !Register->Flush())
+            fFlushed = false;
 
-            /* Commit the local DB transaction. */
-            if(Local)
-                Local->TxnCommit();
+        /* Flush the ledger DB. */
+        if(Ledger && !Ledger->Flush())
+            fFlushed = false;
 
-            /* Commit the client DB transaction. */
-            if(Client)
-                Client->TxnCommit();
+        /* Flush the local DB. */
+        if(Local && !Local->Flush())
+            fFlushed = false;
 
-            /* Commit the trust DB transaction. */
-            if(Trust)
-                Trust->TxnCommit();
+        /* Flush the client DB. */
+        if(Client && !Client->Flush())
+            fFlushed = false;
 
-            /* Commit the legacy DB transaction. */
-            if(Legacy)
-                Legacy->TxnCommit();
-        }
+        /* Flush the trust DB. */
+        if(Trust && !Trust->Flush())
+            fFlushed = false;
+
+        /* Flush the legacy DB. */
+        if(Legacy && !Legacy->Flush())
+            fFlushed = false;
+
+        /* Keep the journal if anything failed to reach disk. */
+        if(!fFlushed)
+            return debug::error(FUNCTION, "failed to flush databases, keeping journal");
 
-        /* Abort all the transactions. */
-        TxnAbort();
+        return TxnJournal->Checkpoint();
+    }
+
+
+    /* Flush all LLD instances and clear the journal. */
+    bool TxnCheckpoint()
+    {
+        LOCK(TXN_MUTEX);
+        return Checkpoint();
     }
 
 
@@ -267,6 +436,9 @@ namespace LLD
         /* Start the legacy DB transaction. */
         if(Legacy)
             Legacy->TxnBegin();
+
+        /* Journal the block index until the transaction ends. */
+        TAO::Ledger::BlockIndex::TxnBegin();
     }
 
 
@@ -289,38 +461,16 @@ namespace LLD
         if(nFlags == TAO::Ledger::FLAGS::MEMPOOL || nFlags == TAO::Ledger::FLAGS::MINER)
             return;
 
-        /* Abort the contract DB transaction. */
-        if(Contract)
-            Contract->TxnRelease();
-
-        /* Abort the register DB transaction. */
-        if(Register)
-            Register->TxnRelease();
-
-        /* Abort the ledger DB transaction. */
-        if(Ledger)
-            Ledger->TxnRelease();
+        /* Release the transactions of every instance. */
+        Release();
 
-        /* Abort the local DB transaction. */
-        if(Local)
-            Local->TxnRelease();
-
-        /* Abort the client DB transaction. */
-        if(Client)
-            Client->TxnRelease();
-
-        /* Abort the trust DB transaction. */
-        if(Trust)
-            Trust->TxnRelease();
-
-        /* Abort the legacy DB transaction. */
-        if(Legacy)
-            Legacy->TxnRelease();
+        /* Revert the block index. */
+        TAO::Ledger::BlockIndex::TxnAbort();
     }
 
 
     /* Global handler for all LLD instances. */
-    void TxnCommit(const uint8_t nFlags)
+    bool TxnCommit(const uint8_t nFlags)
     {
         /* Commit the contract DB transaction. */
         if(Contract)
@@ -336,92 +486,114 @@ namespace LLD
 
         /* Handle memory commits if in memory mode. */
         if(nFlags == TAO::Ledger::FLAGS::MEMPOOL)
-            return;
+            return true;
+
+        /* Hold off checkpoints until the commit is applied everywhere. */
+        LOCK(TXN_MUTEX);
+
+        /* Collect the records of every instance into a single commit. */
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
 
-        /* Set a checkpoint for contract DB. */
+        /* Add the contract DB record. */
         if(Contract)
-            Contract->TxnCheckpoint();
+            Contract->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for register DB. */
+        /* Add the register DB record. */
         if(Register)
-            Register->TxnCheckpoint();
+            Register->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for ledger DB. */
+        /* Add the ledger DB record. */
         if(Ledger)
-            Ledger->TxnCheckpoint();
+            Ledger->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for local DB. */
+        /* Add the local DB record. */
         if(Local)
-            Local->TxnCheckpoint();
+            Local->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for client DB. */
+        /* Add the client DB record. */
         if(Client)
-            Client->TxnCheckpoint();
+            Client->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for trust DB. */
+        /* Add the trust DB record. */
         if(Trust)
-            Trust->TxnCheckpoint();
+            Trust->TxnCheckpoint(vRecords);
 
-        /* Set a checkpoint for legacy DB. */
+        /* Add the legacy DB record. */
         if(Legacy)
-            Legacy->TxnCheckpoint();
+            Legacy->TxnCheckpoint(vRecords);
 
 
+        /* Group the commits of a sync under one flush, blocks lost in a crash are downloaded again. */
+        const bool fForce = !TAO::Ledger::ChainState::Synchronizing();
+
+        /* The single commit point. Once synced, recovery replays every database or none. */
+        if(TxnJournal && !vRecords.empty() && (!TxnJournal->Write(vRecords) || !TxnJournal->Sync(fForce)))
+        {
+            /* Nothing is applied without a journal record. */
+            Release();
+            TAO::Ledger::BlockIndex::TxnAbort();
+
+            return debug::error(FUNCTION, "failed to write transaction journal, commit aborted");
+        }
+
+
+        /* Flag to determine if any database failed to apply. */
+        bool fApplied = true;
+
         /* Commit contract DB transaction. */
-        if(Contract)
-            Contract->TxnCommit();
+        if(Contract && !Contract->TxnCommit())
+            fApplied = false;
 
         /* Commit register DB transaction. */
-        if(Register)
-            Register->TxnCommit();
+        if(Register && !Register->TxnCommit())
+            fApplied = false;
 
-        /* Commit legacy DB transaction. */
-        if(Ledger)
-            Ledger->TxnCommit();
+        /* Commit ledger DB transaction. */
+        if(Ledger && !Ledger->TxnCommit())
+            fApplied = false;
 
         /* Commit the local DB transaction. */
-        if(Local)
-            Local->TxnCommit();
+        if(Local && !Local->TxnCommit())
+            fApplied = false;
 
         /* Commit the client DB transaction. */
-        if(Client)
-            Client->TxnCommit();
+        if(Client && !Client->TxnCommit())
+            fApplied = false;
 
         /* Commit the trust DB transaction. */
-        if(Trust)
-            Trust->TxnCommit();
+        if(Trust && !Trust->TxnCommit())
+            fApplied = false;
 
         /* Commit the legacy DB transaction. */
-        if(Legacy)
-            Legacy->TxnCommit();
+        if(Legacy && !Legacy->TxnCommit())
+            fApplied = false;
 
 
-        /* Abort the contract DB transaction. */
-        if(Contract)
-            Contract->TxnRelease();
+        /* Release the transactions of every instance. */
+        Release();
 
-        /* Abort the register DB transaction. */
-        if(Register)
-            Register->TxnRelease();
 
-        /* Abort the ledger DB transaction. */
-        if(Ledger)
-            Ledger->TxnRelease();
+        /* A failed apply stays in the journal to be replayed on restart, checkpoints would truncate it. */
+        if(!fApplied)
+        {
+            /* The block index reads back whatever was applied on demand. */
+            TAO::Ledger::BlockIndex::TxnAbort();
 
-        /* Abort the local DB transaction. */
-        if(Local)
-            Local->TxnRelease();
+            /* Recovery needs the commit on disk even if its sync was deferred. */
+            if(TxnJournal)
+                TxnJournal->Sync();
 
-        /* Abort the client DB transaction. */
-        if(Client)
-            Client->TxnRelease();
+            fRecovery = true;
+            return debug::error(FUNCTION, "failed to apply commit, keeping journal for recovery");
+        }
 
-        /* Abort the trust DB transaction. */
-        if(Trust)
-            Trust->TxnRelease();
+        /* Keep the block index changes. */
+        TAO::Ledger::BlockIndex::TxnCommit();
 
-        /* Abort the legacy DB transaction. */
-        if(Legacy)
-            Legacy->TxnRelease();
+        /* Checkpoint once the journal grows past its limit. */
+        if(TxnJournal && TxnJournal->Size() > MAX_JOURNAL_SIZE)
+            Checkpoint();
+
+        return true;
     }
 }
@@ -20,24 +20,48 @@ ________________________________________________________________________________
 #include <Util/include/filesystem.h>
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
+#include <Util/include/runtime.h>
 
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
 #include <iomanip>
+#include <limits>
 
 namespace LLD
 {
 
+    /** Version of the split state file. **/
+    const uint8_t HASHMAP_STATE_VERSION = 1;
+
+
     /* The Database Constructor. To determine file location and the Bytes per Record. */
     BinaryHashMap::BinaryHashMap(const std::string& strBaseLocationIn, const uint8_t nFlagsIn, const uint64_t nBucketsIn)
-    : KEY_MUTEX              ( )
+    : FILE_MUTEX             ( )
     , strBaseLocation        (strBaseLocationIn)
-    , fileCache              (new TemplateLRU<uint16_t, std::fstream*>(8))
+    , fileCache              (new TemplateLRU<uint16_t, std::shared_ptr<BinaryFile>>(8))
     , pindex                 (nullptr)
-    , hashmap                (nBucketsIn)
+    , pmeta                  (nullptr)
+    , hashmap                (MAX_HASHMAP_LEVELS + 1)
     , HASHMAP_TOTAL_BUCKETS  (nBucketsIn)
     , HASHMAP_MAX_KEY_SIZE   (32)
     , HASHMAP_KEY_ALLOCATION (static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13))
     , nFlags                 (nFlagsIn)
     , RECORD_MUTEX           (1024)
+    , fResizable             (false)
+    , nSplitState            (0)
+    , nDurableState          (0)
+    , META_MUTEX             ( )
+    , nSlots                 (0)
+    , nHashmaps              (0)
+    , vBloom                 (std::numeric_limits<uint16_t>::max() + 1)
+    , nLookups               (0)
+    , nProbes                (0)
+    , REHASH_CONDITION       ( )
+    , REHASH_MUTEX           ( )
+    , RehashThread           ( )
+    , fDestruct              (false)
     {
         Initialize();
     }
@@ -45,16 +69,30 @@ namespace LLD
 
     /* Copy Constructor */
     BinaryHashMap::BinaryHashMap(const BinaryHashMap& map)
-    : KEY_MUTEX              ( )
+    : FILE_MUTEX             ( )
     , strBaseLocation        (map.strBaseLocation)
     , fileCache              (map.fileCache)
     , pindex                 (map.pindex)
+    , pmeta                  (nullptr)
     , hashmap                (map.hashmap)
     , HASHMAP_TOTAL_BUCKETS  (map.HASHMAP_TOTAL_BUCKETS)
     , HASHMAP_MAX_KEY_SIZE   (map.HASHMAP_MAX_KEY_SIZE)
     , HASHMAP_KEY_ALLOCATION (map.HASHMAP_KEY_ALLOCATION)
     , nFlags                 (map.nFlags)
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , fResizable             (false)
+    , nSplitState            (0)
+    , nDurableState          (0)
+    , META_MUTEX             ( )
+    , nSlots                 (0)
+    , nHashmaps              (0)
+    , vBloom                 (std::numeric_limits<uint16_t>::max() + 1)
+    , nLookups               (0)
+    , nProbes                (0)
+    , REHASH_CONDITION       ( )
+    , REHASH_MUTEX           ( )
+    , RehashThread           ( )
+    , fDestruct              (false)
     {
         Initialize();
     }
@@ -62,16 +100,30 @@ namespace LLD
 
     /* Move Constructor */
     BinaryHashMap::BinaryHashMap(BinaryHashMap&& map)
-    : KEY_MUTEX              ( )
+    : FILE_MUTEX             ( )
     , strBaseLocation        (std::move(map.strBaseLocation))
     , fileCache              (std::move(map.fileCache))
     , pindex                 (std::move(map.pindex))
+    , pmeta                  (nullptr)
     , hashmap                (std::move(map.hashmap))
     , HASHMAP_TOTAL_BUCKETS  (std::move(map.HASHMAP_TOTAL_BUCKETS))
     , HASHMAP_MAX_KEY_SIZE   (std::move(map.HASHMAP_MAX_KEY_SIZE))
     , HASHMAP_KEY_ALLOCATION (std::move(map.HASHMAP_KEY_ALLOCATION))
     , nFlags                 (std::move(map.nFlags))
     , RECORD_MUTEX           (map.RECORD_MUTEX.size())
+    , fResizable             (false)
+    , nSplitState            (0)
+    , nDurableState          (0)
+    , META_MUTEX             ( )
+    , nSlots                 (0)
+    , nHashmaps              (0)
+    , vBloom                 (std::numeric_limits<uint16_t>::max() + 1)
+    , nLookups               (0)
+    , nProbes                (0)
+    , REHASH_CONDITION       ( )
+    , REHASH_MUTEX           ( )
+    , RehashThread           ( )
+    , fDestruct              (false)
     {
         Initialize();
     }
@@ -116,11 +168,31 @@ namespace LLD
     /* Default Destructor */
     BinaryHashMap::~BinaryHashMap()
     {
+        /* Stop the rehash thread. */
+        fDestruct.store(true);
+        REHASH_CONDITION.notify_all();
+        if(RehashThread.joinable())
+            RehashThread.join();
+
+        /* Persist the split state so the next start doesn't need to replay splits. */
+        if(fResizable && pindex)
+            Flush();
+
+        /* Write the bloom filters so they don't need to be rebuilt. */
+        if(pindex)
+            SaveBloom();
+
+        for(auto& pbloom : vBloom)
+            delete pbloom.load();
+
         if(fileCache)
             delete fileCache;
 
         if(pindex)
             delete pindex;
+
+        if(pmeta)
+            delete pmeta;
     }
 
 
@@ -146,12 +218,9 @@ namespace LLD
 
 
     /* Calculates a bucket to be used for the hashmap allocation. */
-    uint32_t BinaryHashMap::GetBucket(const std::vector<uint8_t>& vKey)
+    uint64_t BinaryHashMap::GetBucket(const std::vector<uint8_t>& vKey)
     {
-        /* Get an xxHash. */
-        uint64_t nBucket = XXH64(&vKey[0], vKey.size(), 0) / 7;
-
-        return static_cast<uint32_t>(nBucket % HASHMAP_TOTAL_BUCKETS);
+        return GetBucket(GetHash(vKey));
     }
 
 
@@ -164,7 +233,9 @@ namespace LLD
 
         /* Build the hashmap indexes. */
         std::string index = debug::safe_printstr(strBaseLocation, "_hashmap.index");
-        if(!filesystem::exists(index))
+        std::string meta  = debug::safe_printstr(strBaseLocation, "_hashmap.meta");
+        bool fNew = !filesystem::exists(index);
+        if(fNew)
         {
             /* Generate empty space for new file. */
             const static std::vector<uint8_t> vSpace(HASHMAP_TOTAL_BUCKETS * 4, 0);
@@ -176,13 +247,61 @@ namespace LLD
 
             /* Debug output showing generation of disk index. */
             debug::log(0, FUNCTION, "Generated Disk Index of ", vSpace.size(), " bytes");
+
+            /* New keychains split online, append mode keeps every version of a key in one bucket so it doesn't. */
+            if(!(nFlags & FLAGS::APPEND))
+            {
+                std::vector<uint8_t> vState(17, 0);
+                vState[0] = HASHMAP_STATE_VERSION;
+
+                std::fstream stream(meta, std::ios::out | std::ios::binary | std::ios::trunc);
+                stream.write((char*)&vState[0], vState.size());
+                stream.close();
+            }
         }
 
+        /* Load the split state, keychains without one keep their fixed bucket layout. */
+        fResizable = filesystem::exists(meta);
+        if(fResizable)
+        {
+            /* Slots also hold the key's hash, since a split can't rebuild it from a compressed key. */
+            HASHMAP_KEY_ALLOCATION = static_cast<uint16_t>(HASHMAP_MAX_KEY_SIZE + 13 + 8);
+
+            if(pmeta)
+                delete pmeta;
+
+            pmeta = new BinaryFile(meta);
+
+            /* Read the volatile and durable states. */
+            std::vector<uint8_t> vState(17, 0);
+            if(!pmeta->Read(&vState[0], vState.size(), 0) || vState[0] != HASHMAP_STATE_VERSION)
+                debug::error(FUNCTION, "invalid split state in ", meta);
+
+            uint64_t nState = 0;
+            std::copy(&vState[1], &vState[1] + 8, (uint8_t *)&nState);
+            std::copy(&vState[9], &vState[9] + 8, (uint8_t *)&nDurableState);
+
+            nSplitState.store(nState);
+        }
+
+        /* Allocate the chain lengths up to the level currently being split into. */
+        const uint32_t nLevel = static_cast<uint32_t>(nSplitState.load() >> 32);
+        if(hashmap[0].empty())
+            hashmap[0].resize(HASHMAP_TOTAL_BUCKETS, 0);
+
+        for(uint32_t nBlock = 1; nBlock <= std::min(nLevel + 1, MAX_HASHMAP_LEVELS); ++nBlock)
+            if(hashmap[nBlock].empty())
+                hashmap[nBlock].resize(uint64_t(HASHMAP_TOTAL_BUCKETS) << (nBlock - 1), 0);
+
         /* Read the hashmap indexes. */
-        else
+        uint16_t nMaxChain = 1;
+        if(!fNew)
         {
+            /* Total buckets addressed at the current split state. */
+            const uint64_t nBuckets = (uint64_t(HASHMAP_TOTAL_BUCKETS) << nLevel) + (nSplitState.load() & 0xffffffff);
+
             /* Build a vector to read the disk index. */
-            std::vector<uint8_t> vIndex(HASHMAP_TOTAL_BUCKETS * 2, 0);
+            std::vector<uint8_t> vIndex(nBuckets * 2, 0);
 
             /* Read the disk index bytes. */
             std::fstream stream(index, std::ios::in | std::ios::binary);
@@ -190,14 +309,18 @@ namespace LLD
             stream.close();
 
             /* Deserialize the values into memory index. */
-            uint32_t nTotalKeys = 0;
-            for(uint32_t nBucket = 0; nBucket < HASHMAP_TOTAL_BUCKETS; ++nBucket)
+            uint64_t nTotalKeys = 0;
+            for(uint64_t nBucket = 0; nBucket < nBuckets; ++nBucket)
             {
-                std::copy((uint8_t *)&vIndex[nBucket * 2], (uint8_t *)&vIndex[nBucket * 2] + 2, (uint8_t *)&hashmap[nBucket]);
+                uint16_t& nChain = Index(nBucket);
+                std::copy((uint8_t *)&vIndex[nBucket * 2], (uint8_t *)&vIndex[nBucket * 2] + 2, (uint8_t *)&nChain);
 
-                nTotalKeys += hashmap[nBucket];
+                nTotalKeys += nChain;
+                nMaxChain   = std::max(nMaxChain, nChain);
             }
 
+            nSlots.store(nTotalKeys);
+
             /* Debug output showing loading of disk index. */
             debug::log(0, FUNCTION, "Loaded Disk Index of ", vIndex.size(), " bytes and ", nTotalKeys, " keys");
         }
@@ -218,59 +341,115 @@ namespace LLD
             debug::log(0, FUNCTION, "Generated Disk Hash Map 0 of ", vSpace.size(), " bytes");
         }
 
-        /* Create the stream index object. */
-        pindex = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
+        /* Track the total hashmap files for syncing. */
+        {
+            LOCK(FILE_MUTEX);
+            nHashmaps = nMaxChain;
+        }
+
+        /* Create the index file handle. */
+        pindex = new BinaryFile(index);
+
+        /* Load the file handle into the file LRU cache. */
+        fileCache->Put(0, std::make_shared<BinaryFile>(file));
+
+        /* Load the bloom filters. */
+        LoadBloom();
+
+        /* Replay the splits past the durable state, their images may not have reached the disk. */
+        if(fResizable && nSplitState.load() > nDurableState)
+        {
+            const uint64_t nState = nSplitState.load();
+            debug::log(0, FUNCTION, "Replaying ", (nState - nDurableState) & 0xffffffff, " bucket splits");
+
+            nSplitState.store(nDurableState);
+            while(nSplitState.load() < nState)
+            {
+                if(!Split(nSplitState.load(), true))
+                    break;
+            }
+
+            Flush();
+        }
+
+        /* Start the rehash thread. */
+        if(fResizable && !RehashThread.joinable())
+            RehashThread = std::thread(std::bind(&BinaryHashMap::Rehash, this));
+    }
+
+
+    /* Get a file handle for a hashmap file, opening it into the file cache if needed. */
+    std::shared_ptr<BinaryFile> BinaryHashMap::GetFile(const uint16_t nHashmap, const bool fCreate)
+    {
+        /* Check the file cache first. */
+        std::shared_ptr<BinaryFile> pfile;
+        if(fileCache->Get(nHashmap, pfile))
+            return pfile;
+
+        /* Open a new file handle. */
+        pfile = std::make_shared<BinaryFile>(
+            debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nHashmap), fCreate);
+
+        if(!pfile->IsOpen())
+            return nullptr;
+
+        /* Track the new file for syncing. */
+        if(fCreate)
+        {
+            LOCK(FILE_MUTEX);
+            nHashmaps = std::max(nHashmaps, uint16_t(nHashmap + 1));
+        }
+
+        /* Add to the file cache. */
+        fileCache->Put(nHashmap, pfile);
 
-        /* Load the stream object into the stream LRU cache. */
-        fileCache->Put(0, new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary));
+        return pfile;
     }
 
 
     /* Read a key index from the disk hashmaps. */
     bool BinaryHashMap::Get(const std::vector<uint8_t>& vKey, SectorKey &cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+
+        /* Lock the bucket for reading, readers of the same bucket don't block each other. */
+        const uint64_t nHash = GetHash(vKey);
+        READER_LOCK(GetStripe(nHash));
 
         /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+        const uint64_t nBucket = GetBucket(nHash);
 
         /* Get the file binary position. */
-        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+        uint64_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
         /* Set the cKey return value non compressed. */
         cKey.vKey = vKey;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+        /* Get the bloom filter hash of the compressed key. */
+        const uint64_t nBloom = XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0);
 
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
+        const uint16_t nChain = Index(nBucket);
+        uint32_t nReads = 0;
+        for(int16_t i = nChain - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
+            /* Skip over files that don't hold the key. */
+            BloomFilter* pbloom = vBloom[i].load();
+            if(pbloom && !pbloom->Contains(nBloom))
+                continue;
 
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    continue;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg(nFilePos, std::ios::beg);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            ++nReads;
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -283,13 +462,17 @@ namespace LLD
                 if(!cKey.Ready())
                     continue;
 
+                /* Track the files probed for the meters. */
+                ++nLookups;
+                nProbes += nReads;
+
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
                     debug::log(4, FUNCTION, "State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
                         " | Length: ", cKey.nLength,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap[nBucket] - 1,
+                        " | File: ", nChain - 1,
                         " | Sector File: ", cKey.nSectorFile,
                         " | Sector Size: ", cKey.nSectorSize,
                         " | Sector Start: ", cKey.nSectorStart, "\n",
@@ -299,6 +482,10 @@ namespace LLD
             }
         }
 
+        /* Track the files probed for the meters. */
+        ++nLookups;
+        nProbes += nReads;
+
         return false;
     }
 
@@ -306,85 +493,63 @@ namespace LLD
     /* Write a key to the disk hashmaps. */
     bool BinaryHashMap::Put(const SectorKey& cKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = cKey.vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+
+        /* Lock the bucket for writing. */
+        const uint64_t nHash = GetHash(cKey.vKey);
+        WRITER_LOCK(GetStripe(nHash));
 
         /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(cKey.vKey);
+        const uint64_t nBucket = GetBucket(nHash);
+        uint16_t& nChain = Index(nBucket);
 
         /* Get the file binary position. */
-        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+        uint64_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = cKey.vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+        /* Get the bloom filter hash of the compressed key. */
+        const uint64_t nBloom = XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0);
+
+        /* Serialize the key. */
+        DataStream ssKey(SER_LLD, DATABASE_VERSION);
+        ssKey << cKey;
+
+        /* Serialize the key into the end of the vector. */
+        ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
+
+        /* Serialize the hash after the maximum key size so splits can readdress the key. */
+        if(fResizable)
+        {
+            std::vector<uint8_t> vSpace(HASHMAP_MAX_KEY_SIZE + 13 - ssKey.size(), 0);
+            ssKey.write((char*)&vSpace[0], vSpace.size());
+            ssKey.write((char*)&nHash, 8);
+        }
 
         /* Handle if not in append mode which will update the key. */
         if(!(nFlags & FLAGS::APPEND))
         {
             /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
             std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-            for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
+            for(int16_t i = nChain - 1; i >= 0; --i)
             {
-                /* Find the file stream for LRU cache. */
-                std::fstream* pstream;
-                if(!fileCache->Get(i, pstream))
-                {
-                    std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
-
-                    /* Set the new stream pointer. */
-                    pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        return debug::error(FUNCTION, "couldn't create hashmap object at: ",
-                            filename, " (", strerror(errno), ")");
-                    }
+                /* Find the file handle from the LRU cache. */
+                std::shared_ptr<BinaryFile> pfile = GetFile(i);
+                if(!pfile)
+                    return debug::error(FUNCTION, "couldn't create hashmap object at: ",
+                        strBaseLocation, " file ", i, " (", strerror(errno), ")");
 
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(i, pstream);
-                }
-
-                /* Seek to the hashmap index in file. */
-                pstream->seekg (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
-                pstream->read((char*) &vBucket[0], vBucket.size());
+                /* Read the bucket binary data from file. */
+                if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                    return debug::error(FUNCTION, "failed to read hashmap ", i, " (", strerror(errno), ")");
 
                 /* Check if this bucket has the key or is in an empty state. */
                 if(vBucket[0] == STATE::EMPTY || std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
                 {
-                    /* Serialize the key and return if found. */
-                    DataStream ssKey(SER_LLD, DATABASE_VERSION);
-                    ssKey << cKey;
-
-                    /* Serialize the key into the end of the vector. */
-                    ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
-
-                    /* Find the file stream for LRU cache. */
-                    std::fstream* pstream;
-                    if(!fileCache->Get(i, pstream))
-                    {
-                        std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i);
-
-                        /* Set the new stream pointer. */
-                        pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                        if(!pstream->is_open())
-                        {
-                            delete pstream;
-                            return debug::error(FUNCTION, "couldn't create hashmap object at: ",
-                                filename, " (", strerror(errno), ")");
-                        }
-
-                        /* If file not found add to LRU cache. */
-                        fileCache->Put(i, pstream);
-                    }
-
-
                     /* Handle the disk writing operations. */
-                    pstream->seekp (nFilePos, std::ios::beg);
-                    pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-                    pstream->flush();
-
+                    GetBloom(i)->Insert(nBloom);
+                    if(!pfile->Write(ssKey.data(), ssKey.size(), nFilePos))
+                        return debug::error(FUNCTION, "failed to write hashmap ", i, " (", strerror(errno), ")");
 
                     /* Debug Output of Sector Key Information. */
                     if(config::nVerbose >= 4)
@@ -392,7 +557,7 @@ namespace LLD
                             " | Length: ", cKey.nLength,
                             " | Bucket ", nBucket,
                             " | Location: ", nFilePos,
-                            " | File: ", hashmap[nBucket] - 1,
+                            " | File: ", nChain - 1,
                             " | Sector File: ", cKey.nSectorFile,
                             " | Sector Size: ", cKey.nSectorSize,
                             " | Sector Start: ", cKey.nSectorStart, "\n",
@@ -403,74 +568,62 @@ namespace LLD
             }
         }
 
-        /* Create a new disk hashmap object in linked list if it doesn't exist. */
-        std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), hashmap[nBucket]);
-        if(!filesystem::exists(file))
         {
-            /* Blank vector to write empty space in new disk file. */
-            std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION, 0);
-
-            /* Write the blank data to the new file handle. */
-            std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::app);
-            if(!stream)
-                return debug::error(FUNCTION, strerror(errno));
+            LOCK(FILE_MUTEX);
 
-            for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; ++i)
-                stream.write((char*)&vSpace[0], vSpace.size());
+            /* Create a new disk hashmap object in linked list if it doesn't exist. */
+            std::string file = debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), nChain);
+            if(!filesystem::exists(file))
+            {
+                /* Blank vector to write empty space in new disk file. */
+                std::vector<uint8_t> vSpace(HASHMAP_KEY_ALLOCATION, 0);
 
-            //stream.flush();
-            stream.close();
-        }
+                /* Write the blank data to the new file handle. */
+                std::ofstream stream(file, std::ios::out | std::ios::binary | std::ios::app);
+                if(!stream)
+                    return debug::error(FUNCTION, strerror(errno));
 
-        /* Read the State and Size of Sector Header. */
-        DataStream ssKey(SER_LLD, DATABASE_VERSION);
-        ssKey << cKey;
+                for(uint32_t i = 0; i < HASHMAP_TOTAL_BUCKETS; ++i)
+                    stream.write((char*)&vSpace[0], vSpace.size());
 
-        /* Serialize the key into the end of the vector. */
-        ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
-
-        /* Find the file stream for LRU cache. */
-        std::fstream* pstream;
-        if(!fileCache->Get(hashmap[nBucket], pstream))
-        {
-            /* Set the new stream pointer. */
-            pstream = new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream->is_open())
-            {
-                delete pstream;
-                return debug::error(FUNCTION, "Failed to generate file object");
+                //stream.flush();
+                stream.close();
             }
 
-            /* If not in cache, add to the LRU. */
-            fileCache->Put(hashmap[nBucket], pstream);
+            /* Track the total hashmap files for syncing. */
+            nHashmaps = std::max(nHashmaps, uint16_t(nChain + 1));
         }
 
-        /* Flush the key file to disk. */
-        pstream->seekp (nFilePos, std::ios::beg);
-        pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-        pstream->flush();
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(nChain);
+        if(!pfile)
+            return debug::error(FUNCTION, "Failed to generate file object");
 
-        /* Seek to the index position. */
-        pindex->seekp((nBucket * 2), std::ios::beg);
+        /* Write the key to the hashmap file. */
+        GetBloom(nChain)->Insert(nBloom);
+        if(!pfile->Write(ssKey.data(), ssKey.size(), nFilePos))
+            return debug::error(FUNCTION, "failed to write hashmap ", nChain, " (", strerror(errno), ")");
 
         /* Write the index to disk. */
-        uint16_t nIndex = ++hashmap[nBucket];
-
-        /* Get the bucket data. */
-        std::vector<uint8_t> vBucket((uint8_t*)&nIndex, (uint8_t*)&nIndex + 2);
+        uint16_t nIndex = ++nChain;
+        ++nSlots;
 
         /* Write the index into hashmap. */
-        pindex->write((char*)&vBucket[0], vBucket.size());
-        pindex->flush();
+        if(!pindex->Write((uint8_t*)&nIndex, 2, nBucket * 2))
+            return debug::error(FUNCTION, "failed to write disk index (", strerror(errno), ")");
+
+        /* Wake up the rehash thread once the chains get too long. */
+        if(Overloaded())
+            REHASH_CONDITION.notify_one();
 
         /* Debug Output of Sector Key Information. */
         if(config::nVerbose >= 4)
             debug::log(4, FUNCTION, "State: ", cKey.nState == STATE::READY ? "Valid" : "Invalid",
                 " | Length: ", cKey.nLength,
                 " | Bucket ", nBucket,
-                " | Hashmap ", hashmap[nBucket],
+                " | Hashmap ", nChain,
                 " | Location: ", nFilePos,
-                " | File: ", hashmap[nBucket] - 1,
+                " | File: ", nChain - 1,
                 " | Sector File: ", cKey.nSectorFile,
                 " | Sector Size: ", cKey.nSectorSize,
                 " | Sector Start: ", cKey.nSectorStart,
@@ -483,19 +636,15 @@ namespace LLD
     /* Flush all buffers to disk if using ACID transaction. */
     void BinaryHashMap::Flush()
     {
-        /* Flush the index files. */
-        pindex->flush();
+        /* Take the split state first, every split it covers has already written its image. */
+        const uint64_t nState = nSplitState.load();
 
-        /* Iterate the linked list until end. */
-        TemplateNode<uint16_t, std::fstream*>* pnode = fileCache->pfirst;
-        while(pnode && pnode->pnext)
-        {
-            /* Flush to disk. */
-            pnode->Data->flush();
+        /* Sync the index and hashmap files. */
+        SyncFiles();
 
-            /* Set to next. */
-            pnode = pnode->pnext;
-        }
+        /* The splits are on disk, so lookups can be addressed by them after a crash. */
+        if(fResizable)
+            WriteState(nState, true);
     }
 
 
@@ -503,40 +652,43 @@ namespace LLD
      *  TODO: This should be optimized further. */
     bool BinaryHashMap::Erase(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+
+        /* Lock the bucket for writing. */
+        const uint64_t nHash = GetHash(vKey);
+        WRITER_LOCK(GetStripe(nHash));
 
         /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+        const uint64_t nBucket = GetBucket(nHash);
 
         /* Get the file binary position. */
-        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+        uint64_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+        /* Get the bloom filter hash of the compressed key. */
+        const uint64_t nBloom = XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0);
 
-        /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
+        /* Reverse iterate the linked file list from the most recent copy. Append mode keeps older copies as
+         * history, so only the newest is erased. Other keychains only hold stale copies after an update into
+         * a free slot or an interrupted compaction, so every copy is erased for an older one not to resurface. */
+        bool fErased = false;
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
+        for(int16_t i = Index(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(
-                  debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i),
-                  std::ios::in | std::ios::out | std::ios::binary);
+            /* Skip over files that don't hold the key. */
+            BloomFilter* pbloom = vBloom[i].load();
+            if(pbloom && !pbloom->Contains(nBloom))
+                continue;
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -546,13 +698,10 @@ namespace LLD
                 SectorKey cKey;
                 ssKey >> cKey;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Write empty bytes over the bucket. */
                 std::vector<uint8_t> vEmpty(HASHMAP_KEY_ALLOCATION, 0);
-                pstream->write((char*) &vEmpty[0], vEmpty.size());
-                pstream->flush();
+                if(!pfile->Write(&vEmpty[0], vEmpty.size(), nFilePos))
+                    return debug::error(FUNCTION, "failed to erase hashmap ", i, " (", strerror(errno), ")");
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -560,57 +709,61 @@ namespace LLD
                         " | Length: ", cKey.nLength,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap[nBucket] - 1,
+                        " | File: ", i,
                         " | Sector File: ", cKey.nSectorFile,
                         " | Sector Size: ", cKey.nSectorSize,
                         " | Sector Start: ", cKey.nSectorStart,
                         " | Key: ", HexStr(vKeyCompressed.begin(), vKeyCompressed.end()));
 
-                return true;
+                /* Bring back the previous version in append mode. */
+                if(nFlags & FLAGS::APPEND)
+                    return true;
+
+                fErased = true;
             }
         }
 
-        return false;
+        return fErased;
     }
 
 
     /* Restore an index in the hashmap if it is found. */
     bool BinaryHashMap::Restore(const std::vector<uint8_t> &vKey)
     {
-        LOCK(KEY_MUTEX);
+        /* Compress any keys larger than max size. */
+        std::vector<uint8_t> vKeyCompressed = vKey;
+        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+
+        /* Lock the bucket for writing. */
+        const uint64_t nHash = GetHash(vKey);
+        WRITER_LOCK(GetStripe(nHash));
 
         /* Get the assigned bucket for the hashmap. */
-        uint32_t nBucket = GetBucket(vKey);
+        const uint64_t nBucket = GetBucket(nHash);
 
         /* Get the file binary position. */
-        uint32_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+        uint64_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
 
-        /* Compress any keys larger than max size. */
-        std::vector<uint8_t> vKeyCompressed = vKey;
-        CompressKey(vKeyCompressed, HASHMAP_MAX_KEY_SIZE);
+        /* Get the bloom filter hash of the compressed key. */
+        const uint64_t nBloom = XXH64(&vKeyCompressed[0], vKeyCompressed.size(), 0);
 
         /* Reverse iterate the linked file list from hashmap to get most recent keys first. */
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
-        for(int16_t i = hashmap[nBucket] - 1; i >= 0; --i)
+        for(int16_t i = Index(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(i, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(
-                  debug::safe_printstr(strBaseLocation, "_hashmap.", std::setfill('0'), std::setw(5), i),
-                  std::ios::in | std::ios::out | std::ios::binary);
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(i, pstream);
-            }
+            /* Skip over files that don't hold the key. */
+            BloomFilter* pbloom = vBloom[i].load();
+            if(pbloom && !pbloom->Contains(nBloom))
+                continue;
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -624,13 +777,10 @@ namespace LLD
                 if(cKey.Ready())
                     return true;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Write the ready state into the bucket. */
                 std::vector<uint8_t> vReady(STATE::READY);
-                pstream->write((char*) &vReady[0], vReady.size());
-                pstream->flush();
+                if(!pfile->Write(&vReady[0], vReady.size(), nFilePos))
+                    return debug::error(FUNCTION, "failed to restore hashmap ", i, " (", strerror(errno), ")");
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -638,7 +788,7 @@ namespace LLD
                         " | Length: ", cKey.nLength,
                         " | Bucket ", nBucket,
                         " | Location: ", nFilePos,
-                        " | File: ", hashmap[nBucket] - 1,
+                        " | File: ", i,
                         " | Sector File: ", cKey.nSectorFile,
                         " | Sector Size: ", cKey.nSectorSize,
                         " | Sector Start: ", cKey.nSectorStart,
@@ -650,4 +800,590 @@ namespace LLD
 
         return false;
     }
+
+
+    /* Get the average hashmap files read per lookup since the last call. */
+    double BinaryHashMap::AverageProbes()
+    {
+        const uint64_t nTotal = nLookups.exchange(0);
+        const uint64_t nRead  = nProbes.exchange(0);
+
+        if(nTotal == 0)
+            return 0;
+
+        return static_cast<double>(nRead) / nTotal;
+    }
+
+
+    /* Calculates the hash a bucket is addressed from. */
+    uint64_t BinaryHashMap::GetHash(const std::vector<uint8_t>& vKey) const
+    {
+        return XXH64(&vKey[0], vKey.size(), 0) / 7;
+    }
+
+
+    /* Calculates the hash of a key stored in a hashmap slot. */
+    bool BinaryHashMap::GetHash(const std::vector<uint8_t>& vSlot, uint64_t& nHash) const
+    {
+        /* Check for erased or unused slots. */
+        if(vSlot[0] == STATE::EMPTY)
+            return false;
+
+        /* The hash is stored right after the maximum key size. */
+        std::copy(&vSlot[HASHMAP_MAX_KEY_SIZE + 13], &vSlot[HASHMAP_MAX_KEY_SIZE + 13] + 8, (uint8_t *)&nHash);
+
+        return true;
+    }
+
+
+    /* Determines if two hashmap slots hold the same key. */
+    bool BinaryHashMap::SameKey(const std::vector<uint8_t>& vA, const std::vector<uint8_t>& vB) const
+    {
+        /* Compare the key lengths. */
+        if(vA[1] != vB[1] || vA[2] != vB[2])
+            return false;
+
+        /* Compare the stored compressed keys. */
+        const uint16_t nSize = std::min(static_cast<uint16_t>(vA[1] | (vA[2] << 8)), HASHMAP_MAX_KEY_SIZE);
+        return std::equal(vA.begin() + 13, vA.begin() + 13 + nSize, vB.begin() + 13);
+    }
+
+
+    /* Calculates the bucket for a given hash at the current split state. */
+    uint64_t BinaryHashMap::GetBucket(const uint64_t nHash) const
+    {
+        const uint64_t nState   = nSplitState.load();
+        const uint64_t nBuckets = uint64_t(HASHMAP_TOTAL_BUCKETS) << (nState >> 32);
+
+        /* Buckets before the split pointer have already moved half their keys up a level. */
+        uint64_t nBucket = nHash % nBuckets;
+        if(nBucket < (nState & 0xffffffff))
+            nBucket = nHash % (nBuckets << 1);
+
+        return nBucket;
+    }
+
+
+    /* Get the lock for a given hash. */
+    shared_mutex& BinaryHashMap::GetStripe(const uint64_t nHash) const
+    {
+        /* Every level is a multiple of the initial buckets, so this is the same for a bucket and its images. */
+        return RECORD_MUTEX[(nHash % HASHMAP_TOTAL_BUCKETS) % RECORD_MUTEX.size()];
+    }
+
+
+    /* Get the chain length for a bucket. */
+    uint16_t& BinaryHashMap::Index(const uint64_t nBucket)
+    {
+        /* The first block holds the initial buckets, each block after doubles the total. */
+        uint32_t nBlock = 0;
+        while((uint64_t(HASHMAP_TOTAL_BUCKETS) << nBlock) <= nBucket)
+            ++nBlock;
+
+        if(nBlock == 0)
+            return hashmap[0][nBucket];
+
+        return hashmap[nBlock][nBucket - (uint64_t(HASHMAP_TOTAL_BUCKETS) << (nBlock - 1))];
+    }
+
+
+    /* Determines if the hashmap is past its load factor and has levels left to split into. */
+    bool BinaryHashMap::Overloaded() const
+    {
+        if(!fResizable)
+            return false;
+
+        /* Check that there is a level left to split into. */
+        const uint64_t nState = nSplitState.load();
+        if((nState >> 32) >= MAX_HASHMAP_LEVELS)
+            return false;
+
+        /* Split while there is more than one key per bucket on average. */
+        const uint64_t nBuckets = (uint64_t(HASHMAP_TOTAL_BUCKETS) << (nState >> 32)) + (nState & 0xffffffff);
+        return nSlots.load() > nBuckets;
+    }
+
+
+    /* Write the split state to disk. */
+    bool BinaryHashMap::WriteState(const uint64_t nState, const bool fDurable)
+    {
+        LOCK(META_MUTEX);
+
+        if(!pmeta)
+            return false;
+
+        /* The volatile state follows every split so a process crash doesn't lose it. */
+        if(!fDurable)
+            return pmeta->Write((uint8_t*)&nState, 8, 1);
+
+        /* The durable state only moves forward once the buckets it covers are synced. */
+        if(nState <= nDurableState)
+            return true;
+
+        if(!pmeta->Write((uint8_t*)&nState, 8, 9) || !pmeta->Sync())
+            return debug::error(FUNCTION, "failed to write split state (", strerror(errno), ")");
+
+        nDurableState = nState;
+
+        return true;
+    }
+
+
+    /* Split the next bucket in line into its image at the next level. */
+    bool BinaryHashMap::Split(const uint64_t nState, const bool fRecover)
+    {
+        const uint32_t nLevel   = static_cast<uint32_t>(nState >> 32);
+        const uint64_t nBucket  = nState & 0xffffffff;
+        const uint64_t nBuckets = uint64_t(HASHMAP_TOTAL_BUCKETS) << nLevel;
+        const uint64_t nImage   = nBucket + nBuckets;
+
+        /* Allocate the chain lengths for the images before any of them can be addressed. */
+        if(hashmap[nLevel + 1].empty())
+            hashmap[nLevel + 1].resize(nBuckets, 0);
+
+        /* Lock the bucket, its image shares the same stripe. */
+        WRITER_LOCK(GetStripe(nBucket));
+
+        /* Get the file binary positions. */
+        const uint64_t nFilePos  = nBucket * HASHMAP_KEY_ALLOCATION;
+        const uint64_t nImagePos = nImage  * HASHMAP_KEY_ALLOCATION;
+
+        /* Keys already in the image are newer than the source, this is only non-empty when replaying a split. */
+        std::vector< std::vector<uint8_t> > vImage;
+        for(uint16_t i = 0; i < Index(nImage); ++i)
+        {
+            std::vector<uint8_t> vSlot(HASHMAP_KEY_ALLOCATION, 0);
+            std::shared_ptr<BinaryFile> pfile = GetFile(i);
+
+            uint64_t nHash = 0;
+            if(pfile && pfile->Read(&vSlot[0], vSlot.size(), nImagePos) && GetHash(vSlot, nHash) && nHash % (nBuckets << 1) == nImage)
+                vImage.push_back(vSlot);
+        }
+
+        /* Copy the source keys that address to the image, newest first so older duplicates are dropped. */
+        std::vector< std::vector<uint8_t> > vMoved;
+        for(int16_t i = Index(nBucket) - 1; i >= 0; --i)
+        {
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(i);
+            if(!pfile)
+                return debug::error(FUNCTION, "couldn't open hashmap ", i, " (", strerror(errno), ")");
+
+            /* Read the bucket binary data from file. */
+            std::vector<uint8_t> vSlot(HASHMAP_KEY_ALLOCATION, 0);
+            if(!pfile->Read(&vSlot[0], vSlot.size(), nFilePos))
+                return debug::error(FUNCTION, "failed to read hashmap ", i, " (", strerror(errno), ")");
+
+            /* Check that the key moves to the image. */
+            uint64_t nHash = 0;
+            if(!GetHash(vSlot, nHash) || nHash % (nBuckets << 1) != nImage)
+                continue;
+
+            /* Skip keys that already have a newer copy. */
+            auto fNewer = [&](const std::vector<uint8_t>& vNewer) { return SameKey(vNewer, vSlot); };
+            if(std::any_of(vImage.begin(), vImage.end(), fNewer) || std::any_of(vMoved.begin(), vMoved.end(), fNewer))
+                continue;
+
+            vMoved.push_back(vSlot);
+        }
+
+        /* The image chain is the moved keys oldest first, followed by any newer keys it already held. */
+        std::reverse(vMoved.begin(), vMoved.end());
+        vMoved.insert(vMoved.end(), vImage.begin(), vImage.end());
+
+        /* Write the image chain. */
+        for(uint16_t i = 0; i < vMoved.size(); ++i)
+        {
+            uint64_t nBloom = 0;
+            if(GetBloomHash(&vMoved[i][0], nBloom))
+                GetBloom(i)->Insert(nBloom);
+
+            std::shared_ptr<BinaryFile> pfile = GetFile(i, true);
+            if(!pfile || !pfile->Write(&vMoved[i][0], vMoved[i].size(), nImagePos))
+                return debug::error(FUNCTION, "failed to write hashmap ", i, " (", strerror(errno), ")");
+        }
+
+        /* Write the image index to disk. */
+        uint16_t& nChain = Index(nImage);
+        nSlots += vMoved.size();
+        nSlots -= nChain;
+
+        nChain = static_cast<uint16_t>(vMoved.size());
+        if(!pindex->Write((uint8_t*)&nChain, 2, nImage * 2))
+            return debug::error(FUNCTION, "failed to write disk index (", strerror(errno), ")");
+
+        /* Advance the split state, rolling over to the next level once every bucket is split. */
+        const uint64_t nNext = (nBucket + 1 == nBuckets) ? (uint64_t(nLevel + 1) << 32) : (nState + 1);
+        if(!fRecover && !WriteState(nNext, false))
+            return debug::error(FUNCTION, "failed to write split state (", strerror(errno), ")");
+
+        nSplitState.store(nNext);
+
+        return true;
+    }
+
+
+    /* Drop the keys that were split out of a batch of buckets and shorten their chains. */
+    void BinaryHashMap::Compact(const std::vector<uint64_t>& vBuckets)
+    {
+        /* Track the moves for each bucket so they can be checked after syncing. */
+        struct Compaction
+        {
+            uint64_t nBucket;
+            uint16_t nChain;
+            uint16_t nKept;
+            std::vector< std::pair<uint16_t, uint16_t> > vMoves;
+        };
+
+        /* Copy the remaining keys down into the slots of the moved ones, never over a live key. */
+        std::vector<Compaction> vCompact;
+        for(const auto& nBucket : vBuckets)
+        {
+            WRITER_LOCK(GetStripe(nBucket));
+
+            Compaction compact;
+            compact.nBucket = nBucket;
+            compact.nChain  = Index(nBucket);
+
+            /* Read the chain, sorting the slots into kept and free. */
+            const uint64_t nFilePos = nBucket * HASHMAP_KEY_ALLOCATION;
+            std::vector< std::vector<uint8_t> > vSlots(compact.nChain, std::vector<uint8_t>(HASHMAP_KEY_ALLOCATION, 0));
+            std::vector<uint16_t> vKept, vFree;
+
+            bool fSkip = false;
+            for(uint16_t i = 0; i < compact.nChain && !fSkip; ++i)
+            {
+                std::shared_ptr<BinaryFile> pfile = GetFile(i);
+                if(!pfile || !pfile->Read(&vSlots[i][0], HASHMAP_KEY_ALLOCATION, nFilePos))
+                {
+                    fSkip = true;
+                    break;
+                }
+
+                /* Keys that now address to another bucket were moved by the split. */
+                uint64_t nHash = 0;
+                if(!GetHash(vSlots[i], nHash) || GetBucket(nHash) != nBucket)
+                {
+                    vFree.push_back(i);
+                    continue;
+                }
+
+                /* Leave buckets with duplicate keys alone, their order decides which one is read. */
+                for(const auto& nKept : vKept)
+                    if(SameKey(vSlots[nKept], vSlots[i]))
+                        fSkip = true;
+
+                vKept.push_back(i);
+            }
+
+            /* Check there is anything to compact. */
+            compact.nKept = static_cast<uint16_t>(vKept.size());
+            if(fSkip || compact.nKept == compact.nChain)
+                continue;
+
+            /* Move the highest kept keys into the lowest free slots. */
+            auto itFree = vFree.begin();
+            for(auto itKept = vKept.rbegin(); itKept != vKept.rend() && itFree != vFree.end() && *itFree < *itKept; ++itKept, ++itFree)
+            {
+                uint64_t nBloom = 0;
+                if(GetBloomHash(&vSlots[*itKept][0], nBloom))
+                    GetBloom(*itFree)->Insert(nBloom);
+
+                std::shared_ptr<BinaryFile> pfile = GetFile(*itFree);
+                if(!pfile || !pfile->Write(&vSlots[*itKept][0], HASHMAP_KEY_ALLOCATION, nFilePos))
+                {
+                    fSkip = true;
+                    break;
+                }
+
+                compact.vMoves.push_back(std::make_pair(*itKept, *itFree));
+            }
+
+            if(!fSkip)
+                vCompact.push_back(compact);
+        }
+
+        /* The copies need to be on disk before the originals fall off the end of the chain. */
+        SyncFiles();
+
+        /* Shorten the chains, unless a key past the new end was written since it was copied. */
+        for(const auto& compact : vCompact)
+        {
+            WRITER_LOCK(GetStripe(compact.nBucket));
+
+            uint16_t& nChain = Index(compact.nBucket);
+            if(nChain != compact.nChain)
+                continue;
+
+            /* Check every live key past the new end still matches its copy. */
+            const uint64_t nFilePos = compact.nBucket * HASHMAP_KEY_ALLOCATION;
+            std::vector<uint8_t> vSlot(HASHMAP_KEY_ALLOCATION, 0), vCopy(HASHMAP_KEY_ALLOCATION, 0);
+
+            bool fValid = true;
+            for(uint16_t i = compact.nKept; i < compact.nChain && fValid; ++i)
+            {
+                std::shared_ptr<BinaryFile> pfile = GetFile(i);
+                if(!pfile || !pfile->Read(&vSlot[0], vSlot.size(), nFilePos))
+                {
+                    fValid = false;
+                    break;
+                }
+
+                /* Skip over slots that don't belong to this bucket. */
+                uint64_t nHash = 0;
+                if(!GetHash(vSlot, nHash) || GetBucket(nHash) != compact.nBucket)
+                    continue;
+
+                /* Find the copy of this key. */
+                auto it = std::find_if(compact.vMoves.begin(), compact.vMoves.end(),
+                    [i](const std::pair<uint16_t, uint16_t>& move) { return move.first == i; });
+
+                std::shared_ptr<BinaryFile> pcopy = (it == compact.vMoves.end()) ? nullptr : GetFile(it->second);
+                if(!pcopy || !pcopy->Read(&vCopy[0], vCopy.size(), nFilePos) || vCopy != vSlot)
+                    fValid = false;
+            }
+
+            if(!fValid)
+                continue;
+
+            /* Write the shorter chain to the index. */
+            nChain = compact.nKept;
+            nSlots -= (compact.nChain - compact.nKept);
+
+            if(!pindex->Write((uint8_t*)&nChain, 2, compact.nBucket * 2))
+                debug::error(FUNCTION, "failed to write disk index (", strerror(errno), ")");
+        }
+    }
+
+
+    /* Get the bloom filter for a hashmap file, creating an empty one if needed. */
+    BloomFilter* BinaryHashMap::GetBloom(const uint16_t nHashmap)
+    {
+        BloomFilter* pbloom = vBloom[nHashmap].load();
+        if(pbloom)
+            return pbloom;
+
+        LOCK(FILE_MUTEX);
+
+        /* Check again now that we hold the lock. */
+        pbloom = vBloom[nHashmap].load();
+        if(!pbloom)
+        {
+            /* Size the filter by the buckets a file can currently hold. */
+            const uint64_t nState = nSplitState.load();
+            pbloom = new BloomFilter(((uint64_t(HASHMAP_TOTAL_BUCKETS) << (nState >> 32)) + (nState & 0xffffffff)) * HASHMAP_BLOOM_BITS);
+
+            vBloom[nHashmap].store(pbloom);
+        }
+
+        return pbloom;
+    }
+
+
+    /* Calculates the bloom filter hash of the key stored in a hashmap slot. */
+    bool BinaryHashMap::GetBloomHash(const uint8_t* pSlot, uint64_t& nHash) const
+    {
+        /* Check for erased or unused slots. */
+        if(pSlot[0] == STATE::EMPTY)
+            return false;
+
+        /* The stored key is the compressed key, at most the maximum key size. */
+        const uint16_t nLength = static_cast<uint16_t>(pSlot[1] | (pSlot[2] << 8));
+        nHash = XXH64(pSlot + 13, std::min(nLength, HASHMAP_MAX_KEY_SIZE), 0);
+
+        return true;
+    }
+
+
+    /* Load the bloom filters written at the last shutdown, or rebuild them from the hashmap files. */
+    void BinaryHashMap::LoadBloom()
+    {
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_hashmap.bloom");
+
+        /* Get the total hashmap files. */
+        uint16_t nTotal = 1;
+        {
+            LOCK(FILE_MUTEX);
+            nTotal = std::max(nHashmaps, uint16_t(1));
+        }
+
+        /* Load the filters if they were written at a clean shutdown. */
+        bool fLoaded = false;
+        bool fExists = filesystem::exists(strBloom);
+        if(fExists)
+        {
+            BinaryFile file(strBloom);
+
+            /* Read the header, the version, clean flag and total filters. */
+            std::vector<uint8_t> vHeader(4, 0);
+            if(file.Read(&vHeader[0], vHeader.size(), 0) && vHeader[0] == HASHMAP_STATE_VERSION && vHeader[1] == 1
+            && static_cast<uint16_t>(vHeader[2] | (vHeader[3] << 8)) >= nTotal)
+            {
+                const uint16_t nFilters = static_cast<uint16_t>(vHeader[2] | (vHeader[3] << 8));
+
+                fLoaded = true;
+                uint64_t nPos = vHeader.size();
+                for(uint16_t nHashmap = 0; nHashmap < nFilters && fLoaded; ++nHashmap)
+                {
+                    /* Each filter is prefixed by its total bits. */
+                    uint64_t nBits = 0;
+                    if(!file.Read((uint8_t*)&nBits, 8, nPos) || nBits == 0 || nBits % 64 != 0)
+                    {
+                        fLoaded = false;
+                        break;
+                    }
+
+                    BloomFilter* pbloom = new BloomFilter(nBits);
+                    fLoaded = pbloom->Read(file, nPos + 8);
+
+                    delete vBloom[nHashmap].exchange(pbloom);
+                    nPos += 8 + nBits / 8;
+                }
+            }
+        }
+
+        /* Rebuild the filters by reading every slot of the hashmap files. */
+        if(!fLoaded)
+        {
+            for(auto& pbloom : vBloom)
+                delete pbloom.exchange(nullptr);
+
+            const uint64_t nChunk = uint64_t(HASHMAP_KEY_ALLOCATION) * 16384;
+            std::vector<uint8_t> vChunk(nChunk, 0);
+            for(uint16_t nHashmap = 0; nHashmap < nTotal; ++nHashmap)
+            {
+                BloomFilter* pbloom = GetBloom(nHashmap);
+
+                std::shared_ptr<BinaryFile> pfile = GetFile(nHashmap);
+                if(!pfile)
+                    continue;
+
+                /* Read the file in large chunks of whole slots. */
+                const uint64_t nSize = pfile->Size();
+                for(uint64_t nPos = 0; nPos + HASHMAP_KEY_ALLOCATION <= nSize; nPos += nChunk)
+                {
+                    const uint64_t nRead = std::min(nChunk, ((nSize - nPos) / HASHMAP_KEY_ALLOCATION) * HASHMAP_KEY_ALLOCATION);
+                    if(!pfile->Read(&vChunk[0], nRead, nPos))
+                        break;
+
+                    for(uint64_t nSlot = 0; nSlot < nRead; nSlot += HASHMAP_KEY_ALLOCATION)
+                    {
+                        uint64_t nHash = 0;
+                        if(GetBloomHash(&vChunk[nSlot], nHash))
+                            pbloom->Insert(nHash);
+                    }
+                }
+            }
+
+            if(fExists)
+                debug::log(0, FUNCTION, "Rebuilt bloom filters for ", nTotal, " hashmap files");
+        }
+
+        /* Mark the filters on disk as stale until they are written again at shutdown. */
+        BinaryFile file(strBloom, true);
+        std::vector<uint8_t> vHeader = { HASHMAP_STATE_VERSION, 0, 0, 0 };
+        if(!file.Write(&vHeader[0], vHeader.size(), 0) || !file.Sync())
+            debug::error(FUNCTION, "failed to write bloom filter header (", strerror(errno), ")");
+    }
+
+
+    /* Write the bloom filters to disk and mark them as current. */
+    void BinaryHashMap::SaveBloom()
+    {
+        std::string strBloom = debug::safe_printstr(strBaseLocation, "_hashmap.bloom");
+
+        /* Get the total hashmap files. */
+        uint16_t nTotal = 1;
+        {
+            LOCK(FILE_MUTEX);
+            nTotal = std::max(nHashmaps, uint16_t(1));
+        }
+
+        /* Write every filter prefixed by its total bits. */
+        BinaryFile file(strBloom, true);
+        uint64_t nPos = 4;
+        for(uint16_t nHashmap = 0; nHashmap < nTotal; ++nHashmap)
+        {
+            BloomFilter* pbloom = GetBloom(nHashmap);
+
+            const uint64_t nBits = pbloom->Bits();
+            if(!file.Write((uint8_t*)&nBits, 8, nPos) || !pbloom->Write(file, nPos + 8))
+            {
+                debug::error(FUNCTION, "failed to write bloom filter ", nHashmap, " (", strerror(errno), ")");
+                return;
+            }
+
+            nPos += 8 + nBits / 8;
+        }
+
+        /* The filters have to be on disk before the header marks them as current. */
+        std::vector<uint8_t> vHeader = { HASHMAP_STATE_VERSION, 1, uint8_t(nTotal & 0xff), uint8_t(nTotal >> 8) };
+        if(!file.Sync() || !file.Write(&vHeader[0], vHeader.size(), 0) || !file.Sync())
+            debug::error(FUNCTION, "failed to write bloom filter header (", strerror(errno), ")");
+    }
+
+
+    /* Flush the hashmap files and index to stable storage. */
+    void BinaryHashMap::SyncFiles()
+    {
+        /* Sync the index file. */
+        pindex->Sync();
+
+        /* Get the total hashmap files. */
+        uint16_t nTotal = 1;
+        {
+            LOCK(FILE_MUTEX);
+            nTotal = std::max(nHashmaps, uint16_t(1));
+        }
+
+        /* Sync every hashmap file, reopening an evicted file still syncs its dirty pages. */
+        for(uint16_t nHashmap = 0; nHashmap < nTotal; ++nHashmap)
+        {
+            std::shared_ptr<BinaryFile> pfile = GetFile(nHashmap);
+            if(pfile)
+                pfile->Sync();
+        }
+    }
+
+
+    /* Background thread splitting buckets while the hashmap is overloaded. */
+    void BinaryHashMap::Rehash()
+    {
+        while(!fDestruct.load())
+        {
+            /* Wait until the chains get too long. */
+            {
+                std::unique_lock<std::mutex> lk(REHASH_MUTEX);
+                REHASH_CONDITION.wait_for(lk, std::chrono::seconds(1), [this]{ return fDestruct.load() || Overloaded(); });
+            }
+
+            /* Split a batch of buckets. */
+            std::vector<uint64_t> vBuckets;
+            while(!fDestruct.load() && vBuckets.size() < HASHMAP_SPLIT_BATCH && Overloaded())
+            {
+                const uint64_t nState = nSplitState.load();
+                if(!Split(nState))
+                    break;
+
+                vBuckets.push_back(nState & 0xffffffff);
+            }
+
+            /* Back off on errors so a failing disk isn't hammered. */
+            if(vBuckets.empty())
+            {
+                if(Overloaded())
+                    runtime::sleep(1000);
+
+                continue;
+            }
+
+            /* Make the splits durable before the source buckets give up their moved keys. */
+            Flush();
+            Compact(vBuckets);
+
+            /* Debug output of the split progress. */
+            const uint64_t nState = nSplitState.load();
+            debug::log(3, FUNCTION, "Split ", vBuckets.size(), " buckets | Level ", (nState >> 32), " | Next ", (nState & 0xffffffff));
+        }
+    }
 }
@@ -0,0 +1,60 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_INCLUDE_COMPRESS_H
+#define NEXUS_LLD_INCLUDE_COMPRESS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace LLD
+{
+
+    /** Records smaller than this are never compressed. **/
+    const uint32_t MIN_COMPRESS_SIZE = 64;
+
+
+    /** Upper bound on a decompressed record, guards against corrupted size headers. **/
+    const uint32_t MAX_DECOMPRESS_SIZE = 1024 * 1024 * 64;
+
+
+    /** Compress
+     *
+     *  LZ4 compress a sector record. The output is the compact size of the raw record
+     *  followed by the LZ4 block.
+     *
+     *  @param[in] vData The raw record to compress.
+     *  @param[out] vCompressed The compressed record.
+     *
+     *  @return True if the record was compressed and is smaller than the original.
+     *
+     **/
+    bool Compress(const std::vector<uint8_t>& vData, std::vector<uint8_t>& vCompressed);
+
+
+    /** Decompress
+     *
+     *  Decompress a sector record written by Compress.
+     *
+     *  @param[in] vCompressed The compressed record.
+     *  @param[out] vData The raw record.
+     *
+     *  @return True if the record decompressed to its recorded size.
+     *
+     **/
+    bool Decompress(const std::vector<uint8_t>& vCompressed, std::vector<uint8_t>& vData);
+
+}
+
+#endif
@@ -25,11 +25,14 @@ namespace LLD
      **/
     enum FLAGS
     {
+        INDEX         = (1 << 0),
         APPEND        = (1 << 1),
         READONLY      = (1 << 2),
         CREATE        = (1 << 3),
         WRITE         = (1 << 4),
-        FORCE         = (1 << 5)
+        FORCE         = (1 << 5),
+        MMAP          = (1 << 6),
+        COMPRESS      = (1 << 7)
     };
 
 
@@ -42,7 +45,10 @@ namespace LLD
     {
         EMPTY 			= 0,
         READY 			= 1,
-        TRANSACTION     = 2
+        TRANSACTION     = 2,
+
+        /* Flag bit set on top of the state when the sector data is LZ4 compressed. */
+        COMPRESSED      = (1 << 7)
     };
 
 }
@@ -36,6 +36,13 @@ namespace LLD
     extern TrustDB*      Trust;
     extern LegacyDB*     Legacy;
 
+    //write-ahead journal
+    extern Journal*      TxnJournal;
+
+
+    /** Mutex to keep checkpoints out of an in-flight coordinated commit. **/
+    extern std::mutex    TXN_MUTEX;
+
 
     /** Initialize
      *
@@ -55,10 +62,23 @@ namespace LLD
 
     /** TxnRecover
      *
-     *  Check the transactions for recovery.
+     *  Replay the journal records since the last checkpoint. The journal is only cleared
+     *  once every record has replayed, so a failed replay can be retried on the next start.
+     *
+     *  @return True if every record was replayed.
+     *
+     **/
+    bool TxnRecovery();
+
+
+    /** TxnCheckpoint
+     *
+     *  Flush all LLD instances and clear the journal.
+     *
+     *  @return True if the journal was cleared.
      *
      **/
-    void TxnRecovery();
+    bool TxnCheckpoint();
 
 
     /** Txn Begin
@@ -79,10 +99,14 @@ namespace LLD
 
     /** Txn Commit
      *
-     *  Global handler for all LLD instances.
+     *  Global handler for all LLD instances. Nothing is applied unless the commit reached
+     *  the journal, and a commit that fails to apply holds off checkpoints until recovery.
+     *  While synchronizing the journal sync is deferred, so one flush covers many blocks.
+     *
+     *  @return True if the commit was applied.
      *
      */
-    void TxnCommit(const uint8_t nFlags = 0);
+    bool TxnCommit(const uint8_t nFlags = 0);
 }
 
 #endif
@@ -0,0 +1,214 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_INCLUDE_SNAPSHOT_H
+#define NEXUS_LLD_INCLUDE_SNAPSHOT_H
+
+#include <LLC/types/uint1024.h>
+
+#include <LLD/templates/sector.h>
+#include <LLD/cache/binary_lru.h>
+#include <LLD/keychain/hashmap.h>
+
+#include <Util/templates/serialize.h>
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** Snapshot
+     *
+     *  Export and import of the databases at a block, to bootstrap a node without replaying the chain.
+     *
+     *  A snapshot is a header followed by chunks of records and a footer. Each chunk holds the
+     *  records of one database in the format of a journal record, so it is loaded with TxnRecovery.
+     *  Records are sorted by key from the key log of each database, so the same databases always
+     *  give the same snapshot. The keys of a database are sorted in memory.
+     *
+     *  Every chunk carries its hash, and the commitment chains the header with the hash of every
+     *  chunk in order. A snapshot is checked against the commitment before anything is written.
+     *
+     **/
+    namespace Snapshot
+    {
+
+        /** The version of the snapshot format. **/
+        const uint32_t SNAPSHOT_VERSION = 1;
+
+
+        /** The size a chunk of records is closed at. **/
+        const uint32_t SNAPSHOT_CHUNK_SIZE = 1024 * 1024 * 4; //4 MB chunks
+
+
+        /** The largest frame accepted when reading a snapshot. **/
+        const uint32_t MAX_SNAPSHOT_FRAME = 1024 * 1024 * 64;
+
+
+        /** Header
+         *
+         *  The block a snapshot was taken at and the databases it holds.
+         *
+         **/
+        struct Header
+        {
+            /** The version of the snapshot format. **/
+            uint32_t nVersion;
+
+
+            /** The height of the best chain the snapshot was taken at. **/
+            uint32_t nHeight;
+
+
+            /** The best chain the snapshot was taken at. **/
+            uint1024_t hashBlock;
+
+
+            /** The names of the databases in the snapshot, in order. **/
+            std::vector<std::string> vNames;
+
+
+            IMPLEMENT_SERIALIZE
+            (
+                READWRITE(nVersion);
+                READWRITE(nHeight);
+                READWRITE(hashBlock);
+                READWRITE(vNames);
+            )
+
+
+            /** Default Constructor. **/
+            Header()
+            : nVersion  (SNAPSHOT_VERSION)
+            , nHeight   (0)
+            , hashBlock (0)
+            , vNames    ( )
+            {
+            }
+        };
+
+
+        /** Write
+         *
+         *  Write a snapshot of databases with complete key logs.
+         *  Writes have to be held off until it returns.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *  @param[in] vDatabases The databases to write, in order.
+         *  @param[in] hashBlock The best chain of the databases.
+         *  @param[in] nHeight The height of the best chain.
+         *  @param[out] hashCommit The commitment of the snapshot.
+         *
+         *  @return True if the snapshot was written.
+         *
+         **/
+        bool Write(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                   const uint1024_t& hashBlock, const uint32_t nHeight, uint256_t& hashCommit);
+
+
+        /** Write
+         *
+         *  Write a snapshot of databases with complete key logs while they take writes.
+         *
+         *  Writes are held off only to note where each key log ends, and again at the end to read
+         *  the keys logged after that. Records up to the cut are staged next to the snapshot
+         *  without holding anything off, then merged with the changed keys, so the snapshot is the
+         *  same as one written with writes held off at the end. The changed records are kept in
+         *  memory until the merge.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *  @param[in] vDatabases The databases to write, in order.
+         *  @param[in] MUTEX The mutex writes to the databases are held off with.
+         *  @param[in] fnBlock Reads the best chain and its height, called with writes held off.
+         *  @param[out] header The header of the snapshot.
+         *  @param[out] hashCommit The commitment of the snapshot.
+         *
+         *  @return True if the snapshot was written.
+         *
+         **/
+        bool Write(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                   std::mutex& MUTEX, const std::function<bool(uint1024_t&, uint32_t&)>& fnBlock,
+                   Header& header, uint256_t& hashCommit);
+
+
+        /** Verify
+         *
+         *  Check the chunks of a snapshot against their hashes and its commitment.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *  @param[out] header The header of the snapshot.
+         *  @param[out] hashCommit The commitment of the snapshot.
+         *
+         *  @return True if the snapshot is whole.
+         *
+         **/
+        bool Verify(const std::string& strPath, Header& header, uint256_t& hashCommit);
+
+
+        /** Read
+         *
+         *  Load a snapshot into databases after checking it against a commitment.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *  @param[in] vDatabases The databases to load, found by name.
+         *  @param[in] hashTrusted The commitment to check against, obtained from a trusted source.
+         *  @param[out] header The header of the snapshot.
+         *
+         *  @return True if the snapshot was loaded.
+         *
+         **/
+        bool Read(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                  const uint256_t& hashTrusted, Header& header);
+
+
+        /** Export
+         *
+         *  Write a snapshot of the ledger databases at the best chain, while they keep taking commits.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *  @param[out] header The header of the snapshot.
+         *  @param[out] hashCommit The commitment of the snapshot.
+         *
+         *  @return True if the snapshot was written.
+         *
+         **/
+        bool Export(const std::string& strPath, Header& header, uint256_t& hashCommit);
+
+
+        /** Import
+         *
+         *  Load a snapshot into the ledger databases if they are empty, or resume an interrupted load.
+         *  The snapshot has to match the commitment given with -snapshothash.
+         *
+         *  @param[in] strPath The path of the snapshot file.
+         *
+         *  @return True if the databases are ready to use.
+         *
+         **/
+        bool Import(const std::string& strPath);
+
+
+        /** Pending
+         *
+         *  Determines if a snapshot load was interrupted.
+         *
+         **/
+        bool Pending();
+    }
+}
+
+#endif
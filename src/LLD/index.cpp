@@ -0,0 +1,275 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/index.h>
+#include <LLD/templates/file.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/templates/datastream.h>
+
+#include <algorithm>
+
+namespace LLD
+{
+
+    /* Entries hold the position above two flag bits. */
+    const uint64_t ENTRY_ERASED     = (1 << 0);
+    const uint64_t ENTRY_COMPRESSED = (1 << 1);
+
+
+    /* Path Constructor. */
+    SectorIndex::SectorIndex(const std::string& strPathIn)
+    : INDEX_MUTEX ( )
+    , strPath     (strPathIn)
+    , mapTypes    ( )
+    , mapErased   ( )
+    {
+    }
+
+
+    /* Read the type string from the front of a raw record. */
+    bool SectorIndex::GetType(const std::vector<uint8_t>& vData, std::string& strType)
+    {
+        if(vData.empty())
+            return false;
+
+        /* Decode the compact size of the string by hand to avoid copying the record into a stream. */
+        uint64_t nLength = vData[0];
+        uint64_t nOffset = 1;
+        if(nLength == 253)
+        {
+            if(vData.size() < 3)
+                return false;
+
+            nLength = vData[1] | (static_cast<uint64_t>(vData[2]) << 8);
+            nOffset = 3;
+        }
+        else if(nLength > 253)
+            return false;
+
+        /* Check the string fits in the record. */
+        if(nOffset + nLength > vData.size())
+            return false;
+
+        strType.assign(vData.begin() + nOffset, vData.begin() + nOffset + nLength);
+
+        return true;
+    }
+
+
+    /* Load the index from disk, marking the file unclean unless read-only. */
+    bool SectorIndex::Load(const bool fReadonly)
+    {
+        LOCK(INDEX_MUTEX);
+
+        /* Check for an existing index. */
+        BinaryFile file(strPath, !fReadonly);
+        if(!file.IsOpen())
+            return false;
+
+        /* Read the whole index. */
+        const uint64_t nSize = file.Size();
+        if(nSize < 2)
+            return false;
+
+        DataStream ssIndex(SER_LLD, DATABASE_VERSION);
+        ssIndex.resize(nSize);
+        if(!file.Read(ssIndex.data(), nSize, 0))
+            return debug::error(FUNCTION, "failed to read ", strPath);
+
+        /* Check the version and that it was saved cleanly. */
+        uint8_t nVersion = 0, fClean = 0;
+        ssIndex >> nVersion >> fClean;
+        if(nVersion != SECTOR_INDEX_VERSION || !fClean)
+            return false;
+
+        /* Read the entries. */
+        try
+        {
+            ssIndex >> mapTypes;
+        }
+        catch(const std::exception& e)
+        {
+            mapTypes.clear();
+            return debug::error(FUNCTION, "failed to parse ", strPath, ": ", e.what());
+        }
+
+        /* Mark the index unclean until it is saved again. */
+        if(!fReadonly)
+        {
+            const uint8_t fUnclean = 0;
+            if(!file.Write(&fUnclean, 1, 1) || !file.Sync())
+                return debug::error(FUNCTION, "failed to mark ", strPath, " unclean");
+        }
+
+        return true;
+    }
+
+
+    /* Write the index to disk and mark it clean. */
+    bool SectorIndex::Save() const
+    {
+        LOCK(INDEX_MUTEX);
+
+        /* Serialize the live entries, still marked unclean. */
+        DataStream ssIndex(SER_LLD, DATABASE_VERSION);
+        ssIndex << SECTOR_INDEX_VERSION << uint8_t(0);
+
+        std::map<std::string, std::vector<uint64_t>> mapLive;
+        for(const auto& type : mapTypes)
+        {
+            std::vector<uint64_t>& vEntries = mapLive[type.first];
+            vEntries.reserve(type.second.size());
+
+            for(const auto& nEntry : type.second)
+                if(!(nEntry & ENTRY_ERASED))
+                    vEntries.push_back(nEntry);
+        }
+        ssIndex << mapLive;
+
+        /* Write and sync the entries before flagging them clean. */
+        BinaryFile file(strPath, true);
+        if(!file.Write(ssIndex.data(), ssIndex.size(), 0) || !file.Truncate(ssIndex.size()) || !file.Sync())
+            return debug::error(FUNCTION, "failed to write ", strPath);
+
+        const uint8_t fClean = 1;
+        if(!file.Write(&fClean, 1, 1) || !file.Sync())
+            return debug::error(FUNCTION, "failed to mark ", strPath, " clean");
+
+        return true;
+    }
+
+
+    /* Remove all entries before a rebuild. */
+    void SectorIndex::Clear()
+    {
+        LOCK(INDEX_MUTEX);
+
+        mapTypes.clear();
+        mapErased.clear();
+    }
+
+
+    /* Add a record position to the entries of its type. */
+    void SectorIndex::Insert(const std::string& strType, const uint64_t nPosition, const bool fCompressed)
+    {
+        LOCK(INDEX_MUTEX);
+
+        const uint64_t nEntry = (nPosition << 2) | (fCompressed ? ENTRY_COMPRESSED : 0);
+
+        /* Appends are almost always past the last entry. */
+        std::vector<uint64_t>& vEntries = mapTypes[strType];
+        if(vEntries.empty() || (vEntries.back() >> 2) < nPosition)
+        {
+            vEntries.push_back(nEntry);
+            return;
+        }
+
+        /* Replace an entry at the same position, it may have been erased. */
+        auto it = std::lower_bound(vEntries.begin(), vEntries.end(), nPosition << 2);
+        if(it != vEntries.end() && (*it >> 2) == nPosition)
+        {
+            if(*it & ENTRY_ERASED)
+                --mapErased[strType];
+
+            *it = nEntry;
+            return;
+        }
+
+        vEntries.insert(it, nEntry);
+    }
+
+
+    /* Remove a record position from whatever type holds it. */
+    void SectorIndex::Erase(const uint64_t nPosition)
+    {
+        LOCK(INDEX_MUTEX);
+
+        /* There are only a handful of types, check each of them. */
+        for(auto& type : mapTypes)
+        {
+            std::vector<uint64_t>& vEntries = type.second;
+
+            auto it = std::lower_bound(vEntries.begin(), vEntries.end(), nPosition << 2);
+            if(it == vEntries.end() || (*it >> 2) != nPosition || (*it & ENTRY_ERASED))
+                continue;
+
+            /* Flag the entry and compact once half the type is erased. */
+            *it |= ENTRY_ERASED;
+            if(++mapErased[type.first] > std::max(uint64_t(64), vEntries.size() / 2))
+                Compact(type.first);
+        }
+    }
+
+
+    /* Find the first entry for a cursor at or after its position. */
+    bool SectorIndex::Next(const SectorCursor& cursor, uint64_t& nPosition, bool& fCompressed) const
+    {
+        LOCK(INDEX_MUTEX);
+
+        /* Take the earliest entry over every matching type. */
+        bool fFound = false;
+        for(auto type = mapTypes.lower_bound(cursor.strType); type != mapTypes.end(); ++type)
+        {
+            /* Check the type matches. */
+            if(cursor.fPrefix ? (type->first.compare(0, cursor.strType.size(), cursor.strType) != 0) : (type->first != cursor.strType))
+                break;
+
+            /* Find the first live entry at the cursor. */
+            const std::vector<uint64_t>& vEntries = type->second;
+            auto it = std::lower_bound(vEntries.begin(), vEntries.end(), cursor.nPosition << 2);
+            while(it != vEntries.end() && (*it & ENTRY_ERASED))
+                ++it;
+
+            if(it == vEntries.end())
+                continue;
+
+            /* Keep the earliest. */
+            if(!fFound || (*it >> 2) < nPosition)
+            {
+                nPosition   = (*it >> 2);
+                fCompressed = (*it & ENTRY_COMPRESSED);
+                fFound      = true;
+            }
+        }
+
+        return fFound;
+    }
+
+
+    /* Get the live entries of a type. */
+    uint64_t SectorIndex::Count(const std::string& strType) const
+    {
+        LOCK(INDEX_MUTEX);
+
+        auto it = mapTypes.find(strType);
+        if(it == mapTypes.end())
+            return 0;
+
+        auto itErased = mapErased.find(strType);
+        return it->second.size() - (itErased == mapErased.end() ? 0 : itErased->second);
+    }
+
+
+    /* Drop the erased entries of a type. */
+    void SectorIndex::Compact(const std::string& strType)
+    {
+        std::vector<uint64_t>& vEntries = mapTypes[strType];
+        vEntries.erase(std::remove_if(vEntries.begin(), vEntries.end(),
+            [](const uint64_t nEntry){ return (nEntry & ENTRY_ERASED) != 0; }), vEntries.end());
+
+        mapErased[strType] = 0;
+    }
+}
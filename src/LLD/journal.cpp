@@ -0,0 +1,226 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/journal.h>
+#include <LLD/include/version.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/templates/datastream.h>
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace LLD
+{
+
+    /* The size of a record frame header: length and checksum. */
+    const uint32_t JOURNAL_HEADER_SIZE = 12;
+
+
+    /* Opens or creates the journal file. */
+    Journal::Journal(const std::string& strPath, const uint32_t nSyncCommitsIn, const uint64_t nSyncIntervalIn)
+    : JOURNAL_MUTEX ( )
+    , pfile         (new BinaryFile(strPath, true))
+    , nOffset       (pfile->Size())
+    , nSynced       (0)
+    , nUnsynced     (0)
+    , nLastSync     (runtime::timestamp(true))
+    , nSyncCommits  (nSyncCommitsIn)
+    , nSyncInterval (nSyncIntervalIn)
+    , fFailed       (false)
+    {
+    }
+
+
+    /* Default Destructor. */
+    Journal::~Journal()
+    {
+        delete pfile;
+    }
+
+
+    /* Determines if the journal file was opened successfully. */
+    bool Journal::IsOpen() const
+    {
+        return pfile->IsOpen();
+    }
+
+
+    /* Append a commit to the journal. */
+    bool Journal::Write(const std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords)
+    {
+        /* Serialize the commit payload. */
+        DataStream ssPayload(SER_LLD, DATABASE_VERSION);
+        ssPayload << vRecords;
+
+        /* Build the frame header. */
+        const uint32_t nLength   = static_cast<uint32_t>(ssPayload.size());
+        const uint64_t nChecksum = XXH64(ssPayload.data(), ssPayload.size(), 0);
+
+        DataStream ssFrame(SER_LLD, DATABASE_VERSION);
+        ssFrame << nLength << nChecksum;
+        ssFrame.write((char*)ssPayload.data(), ssPayload.size());
+
+        LOCK(JOURNAL_MUTEX);
+
+        /* Don't write past a frame that may be torn. */
+        if(fFailed)
+            return debug::error(FUNCTION, "journal is in a failed state");
+
+        /* Write the frame at the end of the journal. */
+        if(!pfile->Write(ssFrame.data(), ssFrame.size(), nOffset))
+        {
+            fFailed = true;
+            return debug::error(FUNCTION, "failed to write ", ssFrame.size(), " bytes (", strerror(errno), ")");
+        }
+
+        nOffset += ssFrame.size();
+        ++nUnsynced;
+
+        return true;
+    }
+
+
+    /* Make every commit written so far durable, or defer it to group the commits that follow. */
+    bool Journal::Sync(const bool fForce)
+    {
+        LOCK(JOURNAL_MUTEX);
+
+        /* Don't report durability after a failed write. */
+        if(fFailed)
+            return debug::error(FUNCTION, "journal is in a failed state");
+
+        /* Another sync already covered every commit. */
+        if(nSynced == nOffset)
+            return true;
+
+        /* Leave the commits for a later sync until a limit is reached. */
+        const uint64_t nNow = runtime::timestamp(true);
+        if(!fForce && nUnsynced < nSyncCommits && nNow < nLastSync + nSyncInterval)
+            return true;
+
+        if(!pfile->Sync())
+        {
+            fFailed = true;
+            return debug::error(FUNCTION, "failed to sync journal (", strerror(errno), ")");
+        }
+
+        nSynced   = nOffset;
+        nUnsynced = 0;
+        nLastSync = nNow;
+
+        return true;
+    }
+
+
+    /* Get the number of commits written since the last sync. */
+    uint32_t Journal::Pending()
+    {
+        LOCK(JOURNAL_MUTEX);
+        return nUnsynced;
+    }
+
+
+    /* Read all valid records from the journal for recovery. */
+    bool Journal::Read(std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords)
+    {
+        LOCK(JOURNAL_MUTEX);
+
+        /* Read the whole journal. */
+        const uint64_t nSize = pfile->Size();
+        if(nSize == 0)
+            return true;
+
+        std::vector<uint8_t> vBuffer(nSize, 0);
+        if(!pfile->Read(&vBuffer[0], vBuffer.size(), 0))
+            return debug::error(FUNCTION, "failed to read ", nSize, " bytes (", strerror(errno), ")");
+
+        /* Walk the frames until the end or the first bad one. */
+        uint64_t nPos = 0;
+        while(nPos + JOURNAL_HEADER_SIZE <= nSize)
+        {
+            /* Read the frame header. */
+            uint32_t nLength   = 0;
+            uint64_t nChecksum = 0;
+
+            DataStream ssHeader(std::vector<uint8_t>(vBuffer.begin() + nPos, vBuffer.begin() + nPos + JOURNAL_HEADER_SIZE),
+                SER_LLD, DATABASE_VERSION);
+            ssHeader >> nLength >> nChecksum;
+
+            /* Check the frame is complete and intact. */
+            if(nPos + JOURNAL_HEADER_SIZE + nLength > nSize
+            || XXH64(&vBuffer[nPos + JOURNAL_HEADER_SIZE], nLength, 0) != nChecksum)
+            {
+                debug::log(0, FUNCTION, "dropping torn journal record at ", nPos);
+                break;
+            }
+
+            /* Deserialize the payload. */
+            try
+            {
+                DataStream ssPayload(std::vector<uint8_t>(vBuffer.begin() + nPos + JOURNAL_HEADER_SIZE,
+                    vBuffer.begin() + nPos + JOURNAL_HEADER_SIZE + nLength), SER_LLD, DATABASE_VERSION);
+
+                std::vector< std::pair<std::string, std::vector<uint8_t>> > vCommit;
+                ssPayload >> vCommit;
+
+                vRecords.insert(vRecords.end(), vCommit.begin(), vCommit.end());
+            }
+            catch(const std::exception& e)
+            {
+                debug::log(0, FUNCTION, "dropping corrupted journal record at ", nPos, ": ", e.what());
+                break;
+            }
+
+            nPos += JOURNAL_HEADER_SIZE + nLength;
+        }
+
+        /* Cut off anything past the last good record. */
+        if(nPos < nSize && !pfile->Truncate(nPos))
+            return debug::error(FUNCTION, "failed to truncate journal (", strerror(errno), ")");
+
+        nOffset = nPos;
+        nSynced = std::min(nSynced, nPos);
+
+        return true;
+    }
+
+
+    /* Get the total bytes written to the journal since the last checkpoint. */
+    uint64_t Journal::Size()
+    {
+        LOCK(JOURNAL_MUTEX);
+        return nOffset;
+    }
+
+
+    /* Clear the journal. */
+    bool Journal::Checkpoint()
+    {
+        LOCK(JOURNAL_MUTEX);
+
+        /* Truncate and sync so recovery never replays checkpointed records. */
+        if(!pfile->Truncate(0) || !pfile->Sync())
+            return debug::error(FUNCTION, "failed to truncate journal (", strerror(errno), ")");
+
+        nOffset   = 0;
+        nSynced   = 0;
+        nUnsynced = 0;
+        nLastSync = runtime::timestamp(true);
+
+        return true;
+    }
+}
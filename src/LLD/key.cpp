@@ -149,14 +149,21 @@ namespace LLD
     /*  Determines if the key is in a ready state. */
     bool SectorKey::Ready() const
     {
-        return (nState == STATE::READY);
+        return ((nState & ~STATE::COMPRESSED) == STATE::READY);
     }
 
 
     /*  Determines if the key is in a transaction state. */
     bool SectorKey::IsTxn() const
     {
-        return (nState == STATE::TRANSACTION);
+        return ((nState & ~STATE::COMPRESSED) == STATE::TRANSACTION);
+    }
+
+
+    /*  Determines if the sector data is compressed. */
+    bool SectorKey::IsCompressed() const
+    {
+        return (nState & STATE::COMPRESSED);
     }
 
 
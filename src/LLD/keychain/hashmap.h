@@ -18,16 +18,35 @@ ________________________________________________________________________________
 #include <LLD/keychain/keychain.h>
 #include <LLD/cache/template_lru.h>
 #include <LLD/include/enum.h>
+#include <LLD/templates/bloom.h>
+#include <LLD/templates/file.h>
 
+#include <Util/include/shared_mutex.h>
+
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <string>
-#include <fstream>
 #include <vector>
+#include <memory>
 #include <mutex>
+#include <thread>
 
 namespace LLD
 {
 
+    /** Maximum number of times the hashmap buckets can double through online splits. **/
+    const uint32_t MAX_HASHMAP_LEVELS = 8;
+
+
+    /** Total buckets split by the rehash thread before the splits are made durable. **/
+    const uint32_t HASHMAP_SPLIT_BATCH = 4096;
+
+
+    /** Bloom filter bits per bucket for each hashmap file. **/
+    const uint32_t HASHMAP_BLOOM_BITS = 8;
+
+
     /** BinaryHashMap
      *
      *  This class is responsible for managing the keys to the sector database.
@@ -36,32 +55,48 @@ namespace LLD
      *  It uses a linked file list based on index to iterate trhough files and binary Positions
      *  when there is a collision that is found.
      *
+     *  New keychains grow online with linear hashing: once the average chain passes one key per
+     *  bucket, a background thread splits buckets in order into their image at the next level,
+     *  so lookups stay at O(1) probes no matter how many keys are written. Keychains created
+     *  before this have no split state on disk and keep their fixed bucket layout.
+     *
+     *  Keys only keep a compressed copy on disk, so slots of resizable keychains also store
+     *  the key's hash for the splits to readdress it from.
+     *
+     *  Each hashmap file has a bloom filter over the keys written to it, so lookups only read
+     *  the files that might hold the key and most misses are answered without disk reads.
+     *  The filters are written on shutdown and rebuilt from the hashmap files after a crash.
+     *
      **/
     class BinaryHashMap : public Keychain
     {
     protected:
 
-        /** Mutex for Thread Synchronization. **/
-        mutable std::mutex KEY_MUTEX;
+        /** Mutex for creating new hashmap files. **/
+        mutable std::mutex FILE_MUTEX;
 
 
         /** The string to hold the database location. **/
         std::string strBaseLocation;
 
 
-        /** Keychain stream object. **/
-        TemplateLRU<uint16_t, std::fstream*> *fileCache;
+        /** Keychain file handles. **/
+        TemplateLRU<uint16_t, std::shared_ptr<BinaryFile>> *fileCache;
+
+
+        /** Keychain index file handle. **/
+        BinaryFile* pindex;
 
 
-        /** Keychain index stream. **/
-        std::fstream* pindex;
+        /** Keychain split state file handle. **/
+        BinaryFile* pmeta;
 
 
-        /** Total elements in hashmap for quick inserts. **/
-        std::vector<uint16_t> hashmap;
+        /** Total elements in hashmap for quick inserts, one block per split level. **/
+        std::vector< std::vector<uint16_t> > hashmap;
 
 
-        /** The Maximum buckets allowed in the hashmap. */
+        /** The initial buckets in the hashmap, before any splits. */
         uint32_t HASHMAP_TOTAL_BUCKETS;
 
 
@@ -77,8 +112,57 @@ namespace LLD
         uint8_t nFlags;
 
 
-        /* The key level locking hashmap. */
-        mutable std::vector<std::mutex> RECORD_MUTEX;
+        /** The bucket level reader / writer locks, striped by bucket. **/
+        mutable std::vector<shared_mutex> RECORD_MUTEX;
+
+
+        /** Flag to determine if this keychain splits its buckets online. **/
+        bool fResizable;
+
+
+        /** The split level in the upper 32 bits and the next bucket to split in the lower. **/
+        std::atomic<uint64_t> nSplitState;
+
+
+        /** The split state last synced to disk along with the buckets it covers. **/
+        uint64_t nDurableState;
+
+
+        /** Mutex for writing the split state file. **/
+        std::mutex META_MUTEX;
+
+
+        /** Total chain slots in use across every bucket. **/
+        std::atomic<uint64_t> nSlots;
+
+
+        /** Total hashmap files on disk, guarded by FILE_MUTEX. **/
+        uint16_t nHashmaps;
+
+
+        /** Bloom filters for each hashmap file, created with the file. **/
+        std::vector< std::atomic<BloomFilter*> > vBloom;
+
+
+        /** Total lookups and files probed since the last meter reading. **/
+        std::atomic<uint64_t> nLookups;
+        std::atomic<uint64_t> nProbes;
+
+
+        /** Condition to wake the rehash thread when the load factor is passed. **/
+        std::condition_variable REHASH_CONDITION;
+
+
+        /** Mutex for the rehash condition. **/
+        std::mutex REHASH_MUTEX;
+
+
+        /** Thread that splits and compacts buckets in the background. **/
+        std::thread RehashThread;
+
+
+        /** Flag to stop the rehash thread. **/
+        std::atomic<bool> fDestruct;
 
 
     public:
@@ -133,7 +217,7 @@ namespace LLD
          *  @return The bucket assigned to the key.
          *
          **/
-        uint32_t GetBucket(const std::vector<uint8_t>& vKey);
+        uint64_t GetBucket(const std::vector<uint8_t>& vKey);
 
 
         /** Initialize
@@ -144,6 +228,19 @@ namespace LLD
         void Initialize();
 
 
+        /** GetFile
+         *
+         *  Get a file handle for a hashmap file, opening it into the file cache if needed.
+         *
+         *  @param[in] nHashmap The hashmap file number.
+         *  @param[in] fCreate Flag to create the file if it doesn't exist.
+         *
+         *  @return The file handle, nullptr if it couldn't be opened.
+         *
+         **/
+        std::shared_ptr<BinaryFile> GetFile(const uint16_t nHashmap, const bool fCreate = false);
+
+
         /** Get
          *
          *  Read a key index from the disk hashmaps.
@@ -191,7 +288,8 @@ namespace LLD
 
         /** Erase
          *
-         *  Erase a key from the disk hashmaps.
+         *  Erase a key from the disk hashmaps. In append mode only the newest copy is erased, bringing
+         *  back the version before it, otherwise every copy of the key is erased.
          *  TODO: This should be optimized further.
          *
          *  @param[in] vKey the key to erase.
@@ -200,6 +298,168 @@ namespace LLD
          *
          **/
         bool Erase(const std::vector<uint8_t> &vKey);
+
+
+        /** AverageProbes
+         *
+         *  Get the average hashmap files read per lookup since the last call.
+         *
+         **/
+        double AverageProbes();
+
+
+    private:
+
+        /** GetHash
+         *
+         *  Calculates the hash a bucket is addressed from.
+         *
+         *  @param[in] vKey The binary data of key.
+         *
+         **/
+        uint64_t GetHash(const std::vector<uint8_t>& vKey) const;
+
+
+        /** GetHash
+         *
+         *  Calculates the hash of a key stored in a hashmap slot.
+         *
+         *  @param[in] vSlot The binary data of the slot.
+         *  @param[out] nHash The hash of the stored key.
+         *
+         *  @return False if the slot is empty.
+         *
+         **/
+        bool GetHash(const std::vector<uint8_t>& vSlot, uint64_t& nHash) const;
+
+
+        /** SameKey
+         *
+         *  Determines if two hashmap slots hold the same key.
+         *
+         **/
+        bool SameKey(const std::vector<uint8_t>& vA, const std::vector<uint8_t>& vB) const;
+
+
+        /** GetBucket
+         *
+         *  Calculates the bucket for a given hash at the current split state.
+         *
+         **/
+        uint64_t GetBucket(const uint64_t nHash) const;
+
+
+        /** GetStripe
+         *
+         *  Get the lock for a given hash. A bucket and all of its split images share a stripe,
+         *  so the bucket can be calculated safely once the lock is held.
+         *
+         **/
+        shared_mutex& GetStripe(const uint64_t nHash) const;
+
+
+        /** Index
+         *
+         *  Get the chain length for a bucket.
+         *
+         **/
+        uint16_t& Index(const uint64_t nBucket);
+
+
+        /** Overloaded
+         *
+         *  Determines if the hashmap is past its load factor and has levels left to split into.
+         *
+         **/
+        bool Overloaded() const;
+
+
+        /** WriteState
+         *
+         *  Write the split state to disk.
+         *
+         *  @param[in] nState The split state to write.
+         *  @param[in] fDurable Flag to write and sync the durable state.
+         *
+         **/
+        bool WriteState(const uint64_t nState, const bool fDurable);
+
+
+        /** Split
+         *
+         *  Split the next bucket in line into its image at the next level and advance the split state.
+         *  Keys stay in the source bucket until the split is durable and the bucket is compacted.
+         *
+         *  @param[in] nState The split state to advance from.
+         *  @param[in] fRecover Flag to replay a split after a crash without writing the state.
+         *
+         **/
+        bool Split(const uint64_t nState, const bool fRecover = false);
+
+
+        /** Compact
+         *
+         *  Drop the keys that were split out of a batch of buckets and shorten their chains.
+         *
+         *  @param[in] vBuckets The source buckets of durable splits.
+         *
+         **/
+        void Compact(const std::vector<uint64_t>& vBuckets);
+
+
+        /** GetBloom
+         *
+         *  Get the bloom filter for a hashmap file, creating an empty one if needed.
+         *
+         *  @param[in] nHashmap The hashmap file number.
+         *
+         **/
+        BloomFilter* GetBloom(const uint16_t nHashmap);
+
+
+        /** GetBloomHash
+         *
+         *  Calculates the bloom filter hash of the key stored in a hashmap slot.
+         *
+         *  @param[in] pSlot The binary data of the slot.
+         *  @param[out] nHash The bloom filter hash.
+         *
+         *  @return False if the slot is empty.
+         *
+         **/
+        bool GetBloomHash(const uint8_t* pSlot, uint64_t& nHash) const;
+
+
+        /** LoadBloom
+         *
+         *  Load the bloom filters written at the last shutdown, or rebuild them from the hashmap files.
+         *
+         **/
+        void LoadBloom();
+
+
+        /** SaveBloom
+         *
+         *  Write the bloom filters to disk and mark them as current.
+         *
+         **/
+        void SaveBloom();
+
+
+        /** SyncFiles
+         *
+         *  Flush the hashmap files and index to stable storage.
+         *
+         **/
+        void SyncFiles();
+
+
+        /** Rehash
+         *
+         *  Background thread splitting buckets while the hashmap is overloaded.
+         *
+         **/
+        void Rehash();
     };
 }
 
@@ -18,11 +18,12 @@ ________________________________________________________________________________
 #include <LLD/templates/key.h>
 #include <LLD/cache/template_lru.h>
 #include <LLD/include/enum.h>
+#include <LLD/templates/file.h>
 
 #include <cstdint>
 #include <string>
-#include <fstream>
 #include <vector>
+#include <memory>
 #include <mutex>
 
 //TODO: Abstract base class for all keychains
@@ -51,7 +52,7 @@ namespace LLD
 
 
         /** Keychain stream object. **/
-        TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>* fileCache;
+        TemplateLRU<std::pair<uint16_t, uint16_t>, std::shared_ptr<BinaryFile>>* fileCache;
 
 
         /** Disk index shard LRU cache **/
@@ -59,7 +60,7 @@ namespace LLD
 
 
         /** Keychain index stream. **/
-        TemplateLRU<uint16_t, std::fstream*>* indexCache;
+        TemplateLRU<uint16_t, std::shared_ptr<BinaryFile>>* indexCache;
 
 
         /** The Maximum buckets allowed in the hashmap. */
@@ -141,6 +142,31 @@ namespace LLD
         void LoadShardIndex(const uint32_t nShard);
 
 
+        /** GetFile
+         *
+         *  Get a file handle for a hashmap file, opening it into the file cache if needed.
+         *
+         *  @param[in] nShard The shard the hashmap file belongs to.
+         *  @param[in] nHashmap The hashmap file number.
+         *
+         *  @return The file handle, nullptr if it couldn't be opened.
+         *
+         **/
+        std::shared_ptr<BinaryFile> GetFile(const uint16_t nShard, const uint16_t nHashmap);
+
+
+        /** GetIndex
+         *
+         *  Get a file handle for a shard's disk index, opening it into the index cache if needed.
+         *
+         *  @param[in] nShard The shard to get index for.
+         *
+         *  @return The file handle, nullptr if it couldn't be opened.
+         *
+         **/
+        std::shared_ptr<BinaryFile> GetIndex(const uint16_t nShard);
+
+
         /** Initialize
          *
          *  Initialize the binary hash map keychain.
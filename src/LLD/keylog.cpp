@@ -0,0 +1,304 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/keylog.h>
+#include <LLD/templates/file.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/templates/datastream.h>
+
+#include <algorithm>
+
+namespace LLD
+{
+
+    /* The header holds the version, the complete flag and the clean flag. */
+    const uint64_t KEY_LOG_HEADER = 3;
+
+
+    /* Path Constructor. */
+    KeyLog::KeyLog(const std::string& strPathIn)
+    : KEYLOG_MUTEX ( )
+    , strPath      (strPathIn)
+    , pfile        (nullptr)
+    , nSize        (0)
+    , fComplete    (false)
+    , fTracking    (false)
+    {
+    }
+
+
+    /* Default Destructor. Marks the log clean. */
+    KeyLog::~KeyLog()
+    {
+        LOCK(KEYLOG_MUTEX);
+
+        if(!pfile)
+            return;
+
+        /* Sync the entries before flagging them clean. */
+        const uint8_t fClean = 1;
+        if(!pfile->Sync() || !pfile->Write(&fClean, 1, 2) || !pfile->Sync())
+            debug::error(FUNCTION, "failed to mark ", strPath, " clean");
+
+        delete pfile;
+    }
+
+
+    /* Open the log, creating it if it doesn't exist yet. */
+    bool KeyLog::Open(const bool fEmpty)
+    {
+        LOCK(KEYLOG_MUTEX);
+
+        pfile = new BinaryFile(strPath, true);
+        if(!pfile->IsOpen())
+        {
+            delete pfile;
+            pfile = nullptr;
+
+            return debug::error(FUNCTION, "failed to open ", strPath);
+        }
+
+        /* Read the header of an existing log. */
+        uint8_t vHeader[KEY_LOG_HEADER] = { 0, 0, 0 };
+        const uint64_t nFileSize = pfile->Size();
+        if(nFileSize < KEY_LOG_HEADER || !pfile->Read(vHeader, KEY_LOG_HEADER, 0) || vHeader[0] != KEY_LOG_VERSION)
+        {
+            /* Start a new log, it can only list every key if there were none before it. */
+            fComplete = fEmpty;
+            nSize     = KEY_LOG_HEADER;
+
+            const uint8_t vNew[KEY_LOG_HEADER] = { KEY_LOG_VERSION, static_cast<uint8_t>(fComplete ? 1 : 0), 0 };
+            if(!pfile->Write(vNew, KEY_LOG_HEADER, 0) || !pfile->Truncate(KEY_LOG_HEADER) || !pfile->Sync())
+                return debug::error(FUNCTION, "failed to create ", strPath);
+
+            if(!fComplete)
+                debug::log(0, FUNCTION, strPath, " started on a database with records, it can't be exported to a snapshot");
+
+            return true;
+        }
+        fComplete = (vHeader[1] == 1);
+
+        /* Find the end of the last whole entry if the log wasn't closed cleanly. */
+        nSize = nFileSize;
+        if(vHeader[2] != 1)
+        {
+            if(!Scan([](const uint8_t, std::vector<uint8_t>&, std::vector<uint8_t>&){ }, KEY_LOG_HEADER, nFileSize, nSize))
+                return debug::error(FUNCTION, "failed to scan ", strPath);
+
+            /* Drop a torn entry so new entries follow the last whole one. */
+            if(nSize < nFileSize)
+            {
+                debug::log(0, FUNCTION, "truncating ", nFileSize - nSize, " bytes from the end of ", strPath);
+                if(!pfile->Truncate(nSize))
+                    return debug::error(FUNCTION, "failed to truncate ", strPath);
+            }
+        }
+
+        /* Mark the log unclean until it is closed. */
+        const uint8_t fUnclean = 0;
+        if(!pfile->Write(&fUnclean, 1, 2) || !pfile->Sync())
+            return debug::error(FUNCTION, "failed to mark ", strPath, " unclean");
+
+        return true;
+    }
+
+
+    /* Determines if the log holds every key of its database. */
+    bool KeyLog::Complete() const
+    {
+        LOCK(KEYLOG_MUTEX);
+        return fComplete;
+    }
+
+
+    /* Add an entry to the end of the log. */
+    bool KeyLog::Append(const uint8_t nType, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vIndex)
+    {
+        /* Serialize the entry outside of the lock. */
+        DataStream ssEntry(SER_LLD, DATABASE_VERSION);
+        ssEntry << nType << vKey;
+        if(nType == KEYLOG::INDEXED)
+            ssEntry << vIndex;
+
+        LOCK(KEYLOG_MUTEX);
+
+        if(!pfile)
+            return false;
+
+        /* Write the entry after the last one. A log missing an entry can't list every key. */
+        if(!pfile->Write(ssEntry.data(), ssEntry.size(), nSize))
+        {
+            Incomplete();
+            return debug::error(FUNCTION, "failed to write ", ssEntry.size(), " bytes to ", strPath);
+        }
+
+        nSize += ssEntry.size();
+
+        return true;
+    }
+
+
+    /* Sync the log to disk. */
+    bool KeyLog::Sync()
+    {
+        LOCK(KEYLOG_MUTEX);
+
+        if(!pfile)
+            return false;
+
+        /* Entries lost from the page cache can't be told apart from ones never written. */
+        if(!pfile->Sync())
+        {
+            Incomplete();
+            return debug::error(FUNCTION, "failed to sync ", strPath);
+        }
+
+        return true;
+    }
+
+
+    /* Get the end of the last entry. */
+    uint64_t KeyLog::Size() const
+    {
+        LOCK(KEYLOG_MUTEX);
+        return nSize;
+    }
+
+
+    /* Start or stop logging records updated in place. */
+    void KeyLog::Track(const bool fTrack)
+    {
+        fTracking.store(fTrack);
+    }
+
+
+    /* Determines if records updated in place are logged. */
+    bool KeyLog::Tracking() const
+    {
+        return fTracking.load();
+    }
+
+
+    /* Replay part of the log into the last entry of every key. */
+    bool KeyLog::Read(std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>>& mapKeys,
+                      const uint64_t nBegin, const uint64_t nEnd, const bool fErased) const
+    {
+        /* Find the range under the lock, the entries before the end don't change once written. */
+        uint64_t nLimit = nEnd;
+        {
+            LOCK(KEYLOG_MUTEX);
+
+            if(!pfile)
+                return false;
+
+            if(nLimit == 0 || nLimit > nSize)
+                nLimit = nSize;
+        }
+
+        /* Later entries of a key replace the earlier ones. */
+        uint64_t nLast = 0;
+        return Scan([&mapKeys, fErased](const uint8_t nType, std::vector<uint8_t>& vKey, std::vector<uint8_t>& vIndex)
+        {
+            if(nType == KEYLOG::ERASED && !fErased)
+            {
+                mapKeys.erase(vKey);
+                return;
+            }
+
+            std::pair<uint8_t, std::vector<uint8_t>>& entry = mapKeys[vKey];
+            entry.first = nType;
+            entry.second.swap(vIndex);
+        }, std::max(nBegin, KEY_LOG_HEADER), nLimit, nLast);
+    }
+
+
+    /* Mark the log as no longer holding every key, on disk as well so it stays that way. */
+    void KeyLog::Incomplete()
+    {
+        if(!fComplete)
+            return;
+
+        fComplete = false;
+
+        const uint8_t fFlag = 0;
+        if(!pfile->Write(&fFlag, 1, 1) || !pfile->Sync())
+            debug::error(FUNCTION, "failed to mark ", strPath, " incomplete");
+
+        debug::log(0, FUNCTION, strPath, " missed a key, it can't be exported to a snapshot");
+    }
+
+
+    /* Visit the entries of the log in order. */
+    bool KeyLog::Scan(const std::function<void(const uint8_t, std::vector<uint8_t>&, std::vector<uint8_t>&)>& fnEntry,
+                      const uint64_t nBegin, const uint64_t nLimit, uint64_t& nEnd) const
+    {
+        nEnd = nBegin;
+
+        /* Read the log a buffer at a time, an entry left over starts the next buffer. */
+        uint64_t nBufferSize = 1024 * 1024; //1 MB read buffer
+        while(nEnd < nLimit)
+        {
+            const uint64_t nRead = std::min(nBufferSize, nLimit - nEnd);
+
+            DataStream ssLog(SER_LLD, DATABASE_VERSION);
+            ssLog.resize(nRead);
+            if(!pfile->Read(ssLog.data(), nRead, nEnd))
+                return debug::error(FUNCTION, "failed to read ", nRead, " bytes from ", strPath);
+
+            /* Visit the whole entries in the buffer. */
+            uint64_t nParsed = 0;
+            while(!ssLog.End())
+            {
+                try
+                {
+                    uint8_t nType = 0;
+                    std::vector<uint8_t> vKey, vIndex;
+
+                    ssLog >> nType >> vKey;
+                    if(nType == KEYLOG::INDEXED)
+                        ssLog >> vIndex;
+
+                    /* An unknown type can only be garbage from a torn write. */
+                    if(nType < KEYLOG::RECORD || nType > KEYLOG::ERASED)
+                        break;
+
+                    fnEntry(nType, vKey, vIndex);
+                    nParsed = ssLog.GetPos();
+                }
+                catch(const std::exception& e)
+                {
+                    break;
+                }
+            }
+
+            /* Nothing whole in the buffer. */
+            if(nParsed == 0)
+            {
+                /* The rest of the file is a torn entry. */
+                if(nEnd + nRead >= nLimit)
+                    break;
+
+                /* Allocate a larger buffer if the entry exceeds the default buffer. */
+                nBufferSize *= 2;
+                continue;
+            }
+
+            nEnd += nParsed;
+        }
+
+        return true;
+    }
+}
@@ -20,6 +20,7 @@ ________________________________________________________________________________
 #include <TAO/Register/include/constants.h>
 
 #include <TAO/Ledger/types/transaction.h>
+#include <TAO/Ledger/include/blockindex.h>
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/constants.h>
 #include <TAO/Ledger/types/state.h>
@@ -896,7 +897,13 @@ namespace LLD
     /* Writes a block state object to disk. */
     bool LedgerDB::WriteBlock(const uint1024_t& hashBlock, const TAO::Ledger::BlockState& state)
     {
-        return Write(hashBlock, state, "block");
+        if(!Write(hashBlock, state, "block"))
+            return false;
+
+        /* Keep the resident header index current. */
+        TAO::Ledger::BlockIndex::Update(state);
+
+        return true;
     }
 
 
@@ -959,6 +966,9 @@ namespace LLD
     /* Erase a block from disk. */
     bool LedgerDB::EraseBlock(const uint1024_t& hashBlock)
     {
+        /* Drop the header from the resident index. */
+        TAO::Ledger::BlockIndex::Erase(hashBlock);
+
         return Erase(hashBlock);
     }
 
@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 #include <LLD/templates/sector.h>
+#include <LLD/include/compress.h>
 
 #include <LLD/cache/binary_lfu.h>
 #include <LLD/cache/binary_lru.h>
@@ -45,9 +46,12 @@ namespace LLD
     , pTransaction(nullptr)
     , pSectorKeys(new KeychainType((config::GetDataDir() + strName + "/keychain/"), nFlagsIn, nBucketsIn))
     , cachePool(new CacheType(nCacheIn))
-    , fileCache(new TemplateLRU<uint32_t, std::fstream*>(8))
+    , pIndex(nullptr)
+    , pKeys(nullptr)
+    , fileCache(new TemplateLRU<uint32_t, std::shared_ptr<BinaryFile>>(8))
     , nCurrentFile(0)
     , nCurrentFileSize(0)
+    , setDirty()
     , CacheWriterThread()
     , MeterThread()
     , vDiskBuffer()
@@ -93,6 +97,19 @@ namespace LLD
         if(pTransaction)
             delete pTransaction;
 
+        /* Save the type index once every buffered write has reached it. */
+        if(pIndex)
+        {
+            if(!(nFlags & FLAGS::READONLY))
+                pIndex->Save();
+
+            delete pIndex;
+        }
+
+        /* Close the key log once every buffered write has reached it. */
+        if(pKeys)
+            delete pKeys;
+
         if(cachePool)
             delete cachePool;
 
@@ -144,11 +161,317 @@ namespace LLD
             ++nCurrentFile;
         }
 
+        /* Load the type index, rebuilding it if it wasn't saved cleanly. */
+        if(nFlags & FLAGS::INDEX)
+        {
+            pIndex = new SectorIndex(strBaseLocation + "_index");
+            if(!pIndex->Load(nFlags & FLAGS::READONLY) && (nCurrentFile > 0 || nCurrentFileSize > 0))
+                Reindex();
+        }
+
         pTransaction = nullptr;
         fInitialized = true;
     }
 
 
+    /*  Get the name of the database. */
+    template<class KeychainType, class CacheType>
+    const std::string& SectorDatabase<KeychainType, CacheType>::GetName() const
+    {
+        return strName;
+    }
+
+
+    /*  Start logging the raw keys written, so the database can be exported to a snapshot. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::LogKeys()
+    {
+        if(pKeys)
+            return true;
+
+        /* A new log only lists every key if nothing was written before it. */
+        KeyLog* pLog = new KeyLog(strBaseLocation + "_keys");
+        if(!pLog->Open(nCurrentFile == 0 && nCurrentFileSize == 0))
+        {
+            delete pLog;
+            return debug::error(FUNCTION, "failed to open key log for ", strName);
+        }
+
+        pKeys = pLog;
+
+        return true;
+    }
+
+
+    /*  Get the last entry of every live key from part of the key log. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::ReadKeys(std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>>& mapKeys,
+                                                           const uint64_t nBegin, const uint64_t nEnd)
+    {
+        /* Check for a log holding every key. */
+        if(!pKeys || !pKeys->Complete())
+            return debug::error(FUNCTION, strName, " has no complete key log");
+
+        if(!pKeys->Read(mapKeys, nBegin, nEnd, nBegin != 0))
+            return debug::error(FUNCTION, "failed to read key log for ", strName);
+
+        /* Drop keys the keychain no longer has, a crash can lose the log entry of an erase. */
+        for(auto it = mapKeys.begin(); it != mapKeys.end(); )
+        {
+            SectorKey cKey;
+            if(it->second.first != KEYLOG::ERASED && !pSectorKeys->Get(it->first, cKey))
+            {
+                if(nBegin == 0)
+                {
+                    it = mapKeys.erase(it);
+                    continue;
+                }
+
+                it->second.first = KEYLOG::ERASED;
+            }
+
+            ++it;
+        }
+
+        return true;
+    }
+
+
+    /*  Start or stop logging records updated in place. */
+    template<class KeychainType, class CacheType>
+    uint64_t SectorDatabase<KeychainType, CacheType>::TrackKeys(const bool fTrack)
+    {
+        if(!pKeys)
+            return 0;
+
+        pKeys->Track(fTrack);
+
+        /* An incomplete log can't list the keys changed either. */
+        if(!pKeys->Complete())
+            return 0;
+
+        return pKeys->Size();
+    }
+
+
+    /*  Get a file handle for a sector file, opening it into the file cache if needed. */
+    template<class KeychainType, class CacheType>
+    std::shared_ptr<BinaryFile> SectorDatabase<KeychainType, CacheType>::GetFile(const uint32_t nFile) const
+    {
+        /* Check the file cache first. */
+        std::shared_ptr<BinaryFile> pfile;
+        if(fileCache->Get(nFile, pfile))
+            return pfile;
+
+        /* Open a new file handle. */
+        pfile = std::make_shared<BinaryFile>(
+            debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile));
+
+        if(!pfile->IsOpen())
+            return nullptr;
+
+        /* Completed sector files are never appended to again, so they can be memory mapped. */
+        if((nFlags & FLAGS::MMAP) && nFile < nCurrentFile)
+            pfile->Map();
+
+        /* Add to the file cache. */
+        fileCache->Put(nFile, pfile);
+
+        return pfile;
+    }
+
+
+    /*  Read the raw record at a cursor and advance it. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::NextRecord(SectorCursor& cursor, std::vector<uint8_t>& vData)
+    {
+        if(!pIndex)
+            return false;
+
+        /* Walk the entries, skipping any that no longer hold a record of the type. */
+        uint64_t nPosition = 0;
+        bool fCompressed   = false;
+        while(pIndex->Next(cursor, nPosition, fCompressed))
+        {
+            cursor.nPosition = nPosition + 1;
+
+            /* Read the record. */
+            if(!ReadSector(nPosition, fCompressed, vData))
+                continue;
+
+            /* Check the record still has a matching type. */
+            std::string strType;
+            if(!SectorIndex::GetType(vData, strType))
+                continue;
+
+            if(cursor.fPrefix ? (strType.compare(0, cursor.strType.size(), cursor.strType) != 0) : (strType != cursor.strType))
+                continue;
+
+            cursor.strFound = strType;
+
+            return true;
+        }
+
+        return false;
+    }
+
+
+    /*  Read the raw record at a sector position. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::ReadSector(const uint64_t nPosition, const bool fCompressed, std::vector<uint8_t>& vData)
+    {
+        const uint32_t nFile  = static_cast<uint32_t>(nPosition >> 32);
+        const uint32_t nStart = static_cast<uint32_t>(nPosition);
+
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(nFile);
+        if(!pfile)
+            return false;
+
+        /* Read the size of record. */
+        const uint64_t nFileSize = pfile->Size();
+        if(nStart >= nFileSize)
+            return false;
+
+        DataStream ssSize(SER_LLD, DATABASE_VERSION);
+        ssSize.resize(std::min(nFileSize - nStart, uint64_t(9)));
+        if(!pfile->Read(ssSize.data(), ssSize.size(), nStart))
+            return false;
+
+        uint64_t nSize = 0;
+        try
+        {
+            nSize = ReadCompactSize(ssSize);
+        }
+        catch(const std::exception& e)
+        {
+            return false;
+        }
+
+        /* Check the record fits in the file. */
+        const uint64_t nHeader = GetSizeOfCompactSize(nSize);
+        if(nSize == 0 || nStart + nHeader + nSize > nFileSize)
+            return false;
+
+        /* Read the record. */
+        vData.resize(nSize);
+        if(!pfile->Read(&vData[0], nSize, nStart + nHeader))
+            return debug::error(FUNCTION, "failed to read ", nSize, " bytes (", strerror(errno), ")");
+
+        nBytesRead += static_cast<uint32_t>(nSize);
+
+        /* Decompress the record if it was stored compressed. */
+        if(fCompressed)
+        {
+            std::vector<uint8_t> vCompressed;
+            vCompressed.swap(vData);
+
+            if(!Decompress(vCompressed, vData))
+                return debug::error(FUNCTION, "failed to decompress ", vCompressed.size(), " bytes");
+        }
+
+        return true;
+    }
+
+
+    /*  Rebuild the type index by scanning every sector file. */
+    template<class KeychainType, class CacheType>
+    void SectorDatabase<KeychainType, CacheType>::Reindex()
+    {
+        debug::log(0, FUNCTION, "Rebuilding ", strName, " type index...");
+
+        runtime::timer timer;
+        timer.Start();
+
+        pIndex->Clear();
+
+        /* Scan every record of every file. */
+        uint64_t nRecords = 0;
+        for(uint32_t nFile = 0; nFile <= nCurrentFile; ++nFile)
+        {
+            std::shared_ptr<BinaryFile> pfile = GetFile(nFile);
+            if(!pfile)
+                continue;
+
+            /* Read through a buffer, refilling it whenever a record runs past its end. */
+            const uint64_t nFileSize = pfile->Size();
+            std::vector<uint8_t> vBuffer;
+            uint64_t nBufferStart = 0;
+
+            uint64_t nStart = 0;
+            while(nStart < nFileSize)
+            {
+                /* Make sure the size of the record is buffered. */
+                uint64_t nNeed = std::min(nFileSize - nStart, uint64_t(9));
+                if(nStart < nBufferStart || nStart + nNeed > nBufferStart + vBuffer.size())
+                {
+                    vBuffer.resize(std::min(nFileSize - nStart, uint64_t(1024 * 1024)));
+                    nBufferStart = nStart;
+
+                    if(!pfile->Read(&vBuffer[0], vBuffer.size(), nStart))
+                        break;
+                }
+
+                /* Read compact size. */
+                DataStream ssSize(std::vector<uint8_t>(vBuffer.begin() + (nStart - nBufferStart),
+                    vBuffer.begin() + (nStart - nBufferStart) + nNeed), SER_LLD, DATABASE_VERSION);
+
+                uint64_t nSize = 0;
+                try
+                {
+                    nSize = ReadCompactSize(ssSize);
+                }
+                catch(const std::exception& e)
+                {
+                    break;
+                }
+
+                /* Reached the unwritten end of the file. */
+                const uint64_t nHeader = GetSizeOfCompactSize(nSize);
+                if(nSize == 0 || nStart + nHeader + nSize > nFileSize)
+                    break;
+
+                /* Make sure the whole record is buffered. */
+                if(nStart + nHeader + nSize > nBufferStart + vBuffer.size())
+                {
+                    vBuffer.resize(std::max(nHeader + nSize, std::min(nFileSize - nStart, uint64_t(1024 * 1024))));
+                    nBufferStart = nStart;
+
+                    if(!pfile->Read(&vBuffer[0], vBuffer.size(), nStart))
+                        break;
+                }
+
+                std::vector<uint8_t> vRecord(vBuffer.begin() + (nStart - nBufferStart) + nHeader,
+                    vBuffer.begin() + (nStart - nBufferStart) + nHeader + nSize);
+
+                /* Type strings are short, so a record opening with a raw size too big to be one was compressed. */
+                bool fCompressed = false;
+                if(vRecord[0] >= MIN_COMPRESS_SIZE)
+                {
+                    std::vector<uint8_t> vData;
+                    if(Decompress(vRecord, vData))
+                    {
+                        vRecord.swap(vData);
+                        fCompressed = true;
+                    }
+                }
+
+                /* Add the record to its type. */
+                std::string strType;
+                if(SectorIndex::GetType(vRecord, strType))
+                {
+                    pIndex->Insert(strType, SectorIndex::Position(nFile, static_cast<uint32_t>(nStart)), fCompressed);
+                    ++nRecords;
+                }
+
+                nStart += nHeader + nSize;
+            }
+        }
+
+        debug::log(0, FUNCTION, "Indexed ", nRecords, " ", strName, " records in ", timer.Elapsed(), " seconds");
+    }
+
+
     /*  Get a record from cache or from disk */
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Get(const std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
@@ -164,38 +487,29 @@ namespace LLD
         SectorKey cKey;
         if(pSectorKeys->Get(vKey, cKey))
         {
-            {
-                LOCK(SECTOR_MUTEX);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(cKey.nSectorFile);
+            if(!pfile)
+                return debug::error(FUNCTION, "couldn't open sector file ", cKey.nSectorFile);
 
-                /* Find the file stream for LRU cache. */
-                std::fstream* pstream;
-                if(!fileCache->Get(cKey.nSectorFile, pstream))
-                {
-                    /* Set the new stream pointer. */
-                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cKey.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        return debug::error(FUNCTION, "couldn't create stream file");
-                    }
-
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(cKey.nSectorFile, pstream);
-                }
-
-                /* Get compact size from record. */
-                uint64_t nSize = GetSizeOfCompactSize(cKey.nSectorSize);
+            /* Get compact size from record. */
+            uint64_t nSize = GetSizeOfCompactSize(cKey.nSectorSize);
 
-                /* Seek to the Sector Position on Disk. */
-                pstream->seekg(cKey.nSectorStart + nSize, std::ios::beg);
+            /* Resize for proper record length. */
+            vData.resize(cKey.nSectorSize - nSize);
 
-                /* Resize for proper record length. */
-                vData.resize(cKey.nSectorSize - nSize);
+            /* Read the record from its sector position on disk. */
+            if(!pfile->Read(&vData[0], vData.size(), cKey.nSectorStart + nSize))
+                return debug::error(FUNCTION, "failed to read ", vData.size(), " bytes (", strerror(errno), ")");
 
-                /* Read the State and Size of Sector Header. */
-                if(!pstream->read((char*) &vData[0], vData.size()))
-                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes read");
+            /* Decompress the record if it was stored compressed. */
+            if(cKey.IsCompressed())
+            {
+                std::vector<uint8_t> vCompressed;
+                vCompressed.swap(vData);
 
+                if(!Decompress(vCompressed, vData))
+                    return debug::error(FUNCTION, "failed to decompress ", vCompressed.size(), " bytes");
             }
 
             /* Add to cache */
@@ -218,50 +532,42 @@ namespace LLD
     template<class KeychainType, class CacheType>
     bool SectorDatabase<KeychainType, CacheType>::Get(const SectorKey& cKey, std::vector<uint8_t>& vData)
     {
-        {
-            LOCK(SECTOR_MUTEX);
-
-            nBytesRead += static_cast<uint32_t>(cKey.vKey.size() + vData.size());
+        nBytesRead += static_cast<uint32_t>(cKey.vKey.size() + vData.size());
 
-            /* Check the cache pool for key first. */
-            if(cachePool->Get(cKey.vKey, vData))
-                return true;
-
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(cKey.nSectorFile, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), cKey.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    return false;
-                }
+        /* Check the cache pool for key first. */
+        if(cachePool->Get(cKey.vKey, vData))
+            return true;
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(cKey.nSectorFile, pstream);
-            }
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(cKey.nSectorFile);
+        if(!pfile)
+            return false;
 
-            /* Get compact size from record. */
-            uint64_t nSize = GetSizeOfCompactSize(cKey.nSectorSize);
+        /* Get compact size from record. */
+        uint64_t nSize = GetSizeOfCompactSize(cKey.nSectorSize);
 
-            /* Seek to the Sector Position on Disk. */
-            pstream->seekg(cKey.nSectorStart + nSize, std::ios::beg);
+        /* Resize for proper record length. */
+        vData.resize(cKey.nSectorSize - nSize);
 
-            /* Resize for proper record length. */
-            vData.resize(cKey.nSectorSize - nSize);
+        /* Read the record from its sector position on disk. */
+        if(!pfile->Read(&vData[0], vData.size(), cKey.nSectorStart + nSize))
+            return debug::error(FUNCTION, "failed to read ", vData.size(), " bytes (", strerror(errno), ")");
 
-            /* Read the State and Size of Sector Header. */
-            if(!pstream->read((char*) &vData[0], vData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes read");
+        /* Decompress the record if it was stored compressed. */
+        if(cKey.IsCompressed())
+        {
+            std::vector<uint8_t> vCompressed;
+            vCompressed.swap(vData);
 
-            /* Verboe output. */
-            if(config::nVerbose >= 5)
-                debug::log(5, FUNCTION, "Current File: ", cKey.nSectorFile,
-                    " | Current File Size: ", cKey.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
+            if(!Decompress(vCompressed, vData))
+                return debug::error(FUNCTION, "failed to decompress ", vCompressed.size(), " bytes");
         }
 
+        /* Verboe output. */
+        if(config::nVerbose >= 5)
+            debug::log(5, FUNCTION, "Current File: ", cKey.nSectorFile,
+                " | Current File Size: ", cKey.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
+
         return true;
     }
 
@@ -275,56 +581,64 @@ namespace LLD
         if(!pSectorKeys->Get(vKey, key))
             return false;
 
+        /* Compress the record if enabled, falling back to raw data when it doesn't shrink. */
+        std::vector<uint8_t> vCompressed;
+        const bool fCompressed = (nFlags & FLAGS::COMPRESS) && Compress(vData, vCompressed);
+        const std::vector<uint8_t>& vRecord = fCompressed ? vCompressed : vData;
+
         /* Get current size */
-        uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
+        uint64_t nSize = vRecord.size() + GetSizeOfCompactSize(vRecord.size());
 
-        /* Check data size constraints. */
-        if(nSize != key.nSectorSize)
+        /* Check data size constraints, the record must be stored the same way to overwrite it. */
+        if(nSize != key.nSectorSize || fCompressed != key.IsCompressed())
             return false;
 
         /* Write the data into the memory cache. */
         cachePool->Put(key, vKey, vData, false);
 
-        {
-            LOCK(SECTOR_MUTEX);
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(key.nSectorFile);
+        if(!pfile)
+            return false;
 
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(key.nSectorFile, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    return false;
-                }
+        /* Build the size and record for a single write. */
+        DataStream ssRecord(SER_LLD, DATABASE_VERSION);
+        WriteCompactSize(ssRecord, vRecord.size());
+        ssRecord.write((char*)&vRecord[0], vRecord.size());
 
-                /* If file not found add to LRU cache. */
-                fileCache->Put(key.nSectorFile, pstream);
-            }
+        /* Write the record into its sector. */
+        if(!pfile->Write(ssRecord.data(), ssRecord.size(), key.nSectorStart))
+            return debug::error(FUNCTION, "failed to write ", ssRecord.size(), " bytes (", strerror(errno), ")");
 
-            /* If it is a New Sector, Assign a Binary Position. */
-            pstream->seekp(key.nSectorStart, std::ios::beg);
+        /* Log the key again while a snapshot needs every key changed. */
+        if(pKeys && pKeys->Tracking())
+            pKeys->Append(KEYLOG::RECORD, vKey);
 
-            /* Write the size of record. */
-            WriteCompactSize(*pstream, vData.size());
+        /* The record may have changed type in place. */
+        if(pIndex)
+        {
+            const uint64_t nPosition = SectorIndex::Position(key.nSectorFile, key.nSectorStart);
+            pIndex->Erase(nPosition);
 
-            /* Write the data record. */
-            if(!pstream->write((char*) &vData[0], vData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+            std::string strType;
+            if(SectorIndex::GetType(vData, strType))
+                pIndex->Insert(strType, nPosition, fCompressed);
+        }
 
-            pstream->flush();
+        /* Track the file for the next flush. */
+        {
+            LOCK(SECTOR_MUTEX);
+            setDirty.insert(key.nSectorFile);
+        }
 
-            /* Records flushed indicator. */
-            ++nRecordsFlushed;
-            nBytesWrote += static_cast<uint32_t>(vData.size());
+        /* Records flushed indicator. */
+        ++nRecordsFlushed;
+        nBytesWrote += static_cast<uint32_t>(vRecord.size());
 
-            /* Verbose output. */
-            if(config::nVerbose >= 5)
-                debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
-                    " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
-        }
+        /* Verbose output. */
+        if(config::nVerbose >= 5)
+            debug::log(5, FUNCTION, "Current File: ", key.nSectorFile,
+                " | Current File Size: ", key.nSectorStart, "\n", HexStr(vData.begin(), vData.end(), true));
 
         return true;
     }
@@ -336,7 +650,22 @@ namespace LLD
     {
         if(nFlags & FLAGS::APPEND || !Update(vKey, vData))
         {
+            /* Compress the record if enabled, falling back to raw data when it doesn't shrink. */
+            std::vector<uint8_t> vCompressed;
+            const bool fCompressed = (nFlags & FLAGS::COMPRESS) && Compress(vData, vCompressed);
+            const std::vector<uint8_t>& vRecord = fCompressed ? vCompressed : vData;
+
+            /* Build the size and record for a single write. */
+            DataStream ssRecord(SER_LLD, DATABASE_VERSION);
+            WriteCompactSize(ssRecord, vRecord.size());
+            ssRecord.write((char*)&vRecord[0], vRecord.size());
 
+            /* Get current size */
+            uint64_t nSize = ssRecord.size();
+
+            /* The sector position assigned to this record. */
+            uint32_t nSectorFile  = 0;
+            uint32_t nSectorStart = 0;
             {
                 LOCK(SECTOR_MUTEX);
 
@@ -348,6 +677,10 @@ namespace LLD
                     ++nCurrentFile;
                     nCurrentFileSize = 0;
 
+                    /* Drop the completed file's handle so the next read can reopen it mapped. */
+                    if(nFlags & FLAGS::MMAP)
+                        fileCache->Remove(nCurrentFile - 1);
+
                     std::ofstream stream
                     (
                         debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile),
@@ -356,49 +689,49 @@ namespace LLD
                     stream.close();
                 }
 
-                /* Find the file stream for LRU cache. */
-                std::fstream* pstream;
-                if(!fileCache->Get(nCurrentFile, pstream))
-                {
-                    /* Set the new stream pointer. */
-                    pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        return false;
-                    }
-
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(nCurrentFile, pstream);
-                }
+                /* Find the file handle from the LRU cache. */
+                std::shared_ptr<BinaryFile> pfile = GetFile(nCurrentFile);
+                if(!pfile)
+                    return false;
 
-                /* If it is a New Sector, Assign a Binary Position. */
-                pstream->seekp(nCurrentFileSize, std::ios::beg);
+                /* Append the record to the end of the current file. */
+                if(!pfile->Write(ssRecord.data(), ssRecord.size(), nCurrentFileSize))
+                    return debug::error(FUNCTION, "failed to write ", ssRecord.size(), " bytes (", strerror(errno), ")");
 
-                /* Write the size of record. */
-                WriteCompactSize(*pstream, vData.size());
+                /* Reserve the sector and increment the current filesize. */
+                nSectorFile  = nCurrentFile;
+                nSectorStart = nCurrentFileSize;
 
-                /* Write the data record. */
-                if(!pstream->write((char*) &vData[0], vData.size()))
-                    return debug::error(FUNCTION, "only ", pstream->gcount(), "/", vData.size(), " bytes written");
+                nCurrentFileSize += static_cast<uint32_t>(nSize);
 
-                pstream->flush();
+                /* Track the file for the next flush. */
+                setDirty.insert(nCurrentFile);
             }
 
-            /* Get current size */
-            uint64_t nSize = vData.size() + GetSizeOfCompactSize(vData.size());
-
             /* Create a new Sector Key. */
-            SectorKey key(STATE::READY, vKey, static_cast<uint16_t>(nCurrentFile),
-                            nCurrentFileSize, static_cast<uint32_t>(nSize));
-
-            /* Increment the current filesize */
-            nCurrentFileSize += static_cast<uint32_t>(nSize);
+            SectorKey key(fCompressed ? (STATE::READY | STATE::COMPRESSED) : STATE::READY, vKey, static_cast<uint16_t>(nSectorFile),
+                            nSectorStart, static_cast<uint32_t>(nSize));
 
             /* Records flushed indicator. */
             ++nRecordsFlushed;
             nBytesWrote += static_cast<uint32_t>(nSize);
 
+            /* Move the record to its new sector in the type index. */
+            if(pIndex)
+            {
+                SectorKey cPrev;
+                if(pSectorKeys->Get(vKey, cPrev) && cPrev.nSectorSize > 0)
+                    pIndex->Erase(SectorIndex::Position(cPrev.nSectorFile, cPrev.nSectorStart));
+
+                std::string strType;
+                if(SectorIndex::GetType(vData, strType))
+                    pIndex->Insert(strType, SectorIndex::Position(nSectorFile, nSectorStart), fCompressed);
+            }
+
+            /* Log new keys ahead of the keychain, so a key on disk is always in the log. */
+            if(pKeys)
+                pKeys->Append(KEYLOG::RECORD, vKey);
+
             /* Assign the Key to Keychain. */
             if(!pSectorKeys->Put(key))
                 return debug::error(FUNCTION, "failed to write key to keychain");
@@ -459,49 +792,44 @@ namespace LLD
         if(!pSectorKeys->Erase(vKey))
             return false;
 
+        /* Log the erase for snapshots. */
+        if(pKeys)
+            pKeys->Append(KEYLOG::ERASED, vKey);
+
         /* Check that this key isn't a keychain only entry. */
         if(key.nSectorFile ==0 && key.nSectorSize == 0 && key.nSectorStart == 0)
             return true;
 
-        {
-            LOCK(SECTOR_MUTEX);
-
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(key.nSectorFile, pstream))
-            {
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), key.nSectorFile), std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    return false;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(key.nSectorFile, pstream);
-            }
+        /* The sector is blanked below, drop it from the type index. */
+        if(pIndex)
+            pIndex->Erase(SectorIndex::Position(key.nSectorFile, key.nSectorStart));
 
-            /* If it is a New Sector, Assign a Binary Position. */
-            pstream->seekg(key.nSectorStart, std::ios::beg);
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(key.nSectorFile);
+        if(!pfile)
+            return false;
 
-            /* Write the size of record. */
-            uint64_t nSize = ReadCompactSize(*pstream);
+        /* Read the size of record. */
+        DataStream ssSize(SER_LLD, DATABASE_VERSION);
+        ssSize.resize(std::min(key.nSectorSize, 9u));
+        if(!pfile->Read(ssSize.data(), ssSize.size(), key.nSectorStart))
+            return debug::error(FUNCTION, "failed to read record size (", strerror(errno), ")");
 
-            /* Seek to write at specific location. */
-            pstream->seekp(key.nSectorStart + GetSizeOfCompactSize(nSize), std::ios::beg);
+        uint64_t nSize = ReadCompactSize(ssSize);
 
-            /* Update the record with blank data. */
-            DataStream ssData(SER_LLD, DATABASE_VERSION);
-            ssData << std::string("NONE");
-            ssData.resize(nSize);
+        /* Update the record with blank data. */
+        DataStream ssData(SER_LLD, DATABASE_VERSION);
+        ssData << std::string("NONE");
+        ssData.resize(nSize);
 
-            /* Write the data record. */
-            if(!pstream->write((char*)ssData.data(), ssData.size()))
-                return debug::error(FUNCTION, "only ", pstream->gcount(), " bytes written");
+        /* Write the data record. */
+        if(!pfile->Write(ssData.data(), ssData.size(), key.nSectorStart + GetSizeOfCompactSize(nSize)))
+            return debug::error(FUNCTION, "failed to write ", ssData.size(), " bytes (", strerror(errno), ")");
 
-            /* Flush the rest of the write buffer in stream. */
-            pstream->flush();
+        /* Track the file for the next flush. */
+        {
+            LOCK(SECTOR_MUTEX);
+            setDirty.insert(key.nSectorFile);
         }
 
         return true;
@@ -556,6 +884,10 @@ namespace LLD
                 ++nCurrentFile;
                 nCurrentFileSize = 0;
 
+                /* Drop the completed file's handle so the next read can reopen it mapped. */
+                if(nFlags & FLAGS::MMAP)
+                    fileCache->Remove(nCurrentFile - 1);
+
                 /* Create a new file for next writes. */
                 std::fstream stream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nCurrentFile), std::ios::out | std::ios::binary | std::ios::trunc);
                 stream.close();
@@ -617,7 +949,9 @@ namespace LLD
                 ANSI_COLOR_FUNCTION, strName, " LLD : ", ANSI_COLOR_RESET,
                 "Writing ", WPS, " Kb/s | ",
                 "Reading ", RPS, " Kb/s | ",
-                "Records ", nRecordsFlushed.load());
+                "Records ", nRecordsFlushed.load(), " | ",
+                "Probes ", pSectorKeys->AverageProbes(), " | ",
+                "Cache Hits ", cachePool->HitRate() * 100.0, " %");
 
             TIMER.Reset();
             nBytesWrote.store(0);
@@ -642,9 +976,9 @@ namespace LLD
     }
 
 
-    /*  Write the transaction commitment message. */
+    /*  Add the transaction record to a coordinated commit across databases. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::TxnCheckpoint()
+    bool SectorDatabase<KeychainType, CacheType>::TxnCheckpoint(std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords)
     {
         LOCK(TRANSACTION_MUTEX);
 
@@ -652,24 +986,18 @@ namespace LLD
         if(!pTransaction)
             return false;
 
-        /* Set commit message into journal. */
-        pTransaction->ssJournal << std::string("commit");
-
-        /* Create an append only stream. */
-        std::ofstream stream = std::ofstream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::app | std::ios::binary);
-        if(!stream.is_open())
-            return debug::error(FUNCTION, "failed to open journal file");
+        /* Skip empty transactions, there is nothing to replay. */
+        if(pTransaction->ssJournal.size() == 0)
+            return true;
 
-        /* Write to the file.  */
-        const std::vector<uint8_t>& vBytes = pTransaction->ssJournal.Bytes();
-        stream.write((char*)&vBytes[0], vBytes.size());
-        stream.close();
+        /* Add the record under this database's name. */
+        vRecords.push_back(std::make_pair(strName, pTransaction->ssJournal.Bytes()));
 
         return true;
     }
 
 
-    /*  Release the transaction checkpoint. */
+    /*  Release the transaction object. */
     template<class KeychainType, class CacheType>
     void SectorDatabase<KeychainType, CacheType>::TxnRelease()
     {
@@ -681,10 +1009,6 @@ namespace LLD
 
         /** Set the transaction pointer to null also acting like a flag **/
         pTransaction = nullptr;
-
-        /* Delete the transaction journal file. */
-        std::ofstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::trunc);
-        stream.close();
     }
 
 
@@ -700,9 +1024,14 @@ namespace LLD
 
         /* Erase data set to be removed. */
         for(const auto& item : pTransaction->setErasedData)
+        {
             if(!pSectorKeys->Erase(item))
                 return debug::error(FUNCTION, "failed to erase from keychain");
 
+            if(pKeys)
+                pKeys->Append(KEYLOG::ERASED, item);
+        }
+
         /* Commit the sector data. */
         for(const auto& item : pTransaction->mapTransactions)
             if(!Force(item.first, item.second))
@@ -714,6 +1043,9 @@ namespace LLD
             SectorKey cKey(STATE::READY, item, 0, 0, 0);
             if(!pSectorKeys->Put(cKey))
                 return debug::error(FUNCTION, "failed to commit to keychain");
+
+            if(pKeys)
+                pKeys->Append(KEYLOG::KEYCHAIN, item);
         }
 
         /* Commit the index data. */
@@ -736,6 +1068,9 @@ namespace LLD
             cKey.SetKey(item.first);
             if(!pSectorKeys->Put(cKey))
                 return debug::error(FUNCTION, "failed to write indexing entry");
+
+            if(pKeys)
+                pKeys->Append(KEYLOG::INDEXED, item.first, item.second);
         }
 
         /* Cleanup the transaction object. */
@@ -746,112 +1081,144 @@ namespace LLD
     }
 
 
-    /*  Recover a transaction from the journal. */
+    /*  Replay a transaction record from the journal. */
     template<class KeychainType, class CacheType>
-    bool SectorDatabase<KeychainType, CacheType>::TxnRecovery()
+    bool SectorDatabase<KeychainType, CacheType>::TxnRecovery(const std::vector<uint8_t>& vRecord)
     {
-        /* Create an append only stream. */
-        std::ifstream stream(debug::safe_printstr(config::GetDataDir(), strName, "/journal.dat"), std::ios::in | std::ios::out | std::ios::binary);
-        if(!stream.is_open())
-            return false;
-
-        /* Get the Binary Size. */
-        stream.ignore(std::numeric_limits<std::streamsize>::max());
+        /* Create the transaction object. */
+        TxnBegin();
 
-        /* Get the data buffer. */
-        uint32_t nSize = static_cast<uint32_t>(stream.gcount());
+        /* Deserialize the record into the transaction. */
+        try
+        {
+            const DataStream ssJournal(vRecord, SER_LLD, DATABASE_VERSION);
+            while(!ssJournal.End())
+            {
+                /* Read the data entry type. */
+                std::string strType;
+                ssJournal >> strType;
 
-        /* Check journal size for 0. */
-        if(nSize == 0)
-            return false;
+                /* Check for Erase. */
+                if(strType == "erase")
+                {
+                    /* Get the key to erase. */
+                    std::vector<uint8_t> vKey;
+                    ssJournal >> vKey;
 
-        /* Create buffer to read into. */
-        std::vector<uint8_t> vBuffer(nSize, 0);
+                    /* Replays may cover erases that already reached disk. */
+                    SectorKey cKey;
+                    if(pSectorKeys->Get(vKey, cKey))
+                        pTransaction->EraseTransaction(vKey);
 
-        /* Read the keychain file. */
-        stream.seekg (0, std::ios::beg);
-        stream.read((char*) &vBuffer[0], vBuffer.size());
-        stream.close();
+                    /* Debug output. */
+                    debug::log(3, FUNCTION, "erasing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+                }
+                else if(strType == "key")
+                {
+                    /* Get the key to write. */
+                    std::vector<uint8_t> vKey;
+                    ssJournal >> vKey;
 
-        debug::log(0, FUNCTION, strName, " transaction journal detected of ", nSize, " bytes");
+                    /* Write the key. */
+                    pTransaction->setKeychain.insert(vKey);
 
-        /* Create the transaction object. */
-        TxnBegin();
+                    /* Debug output. */
+                    debug::log(3, FUNCTION, "writing keychain ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+                }
+                else if(strType == "write")
+                {
+                    /* Get the key to write. */
+                    std::vector<uint8_t> vKey;
+                    ssJournal >> vKey;
 
-        /* Serialize the key. */
-        const DataStream ssJournal(vBuffer, SER_LLD, DATABASE_VERSION);
-        while(!ssJournal.End())
-        {
-            /* Read the data entry type. */
-            std::string strType;
-            ssJournal >> strType;
+                    /* Get the data to write. */
+                    std::vector<uint8_t> vData;
+                    ssJournal >> vData;
 
-            /* Check for Erase. */
-            if(strType == "erase")
-            {
-                /* Get the key to erase. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
+                    /* Write the sector data. */
+                    pTransaction->mapTransactions[vKey] = vData;
 
-                /* Erase the key. */
-                pTransaction->EraseTransaction(vKey);
+                    /* Debug output. */
+                    debug::log(3, FUNCTION, "writing data ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+                }
+                else if(strType == "index")
+                {
+                    /* Get the key to index. */
+                    std::vector<uint8_t> vKey;
+                    ssJournal >> vKey;
 
-                /* Debug output. */
-                debug::log(0, FUNCTION, "erasing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            else if(strType == "key")
-            {
-                /* Get the key to write. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
+                    /* Get the data to index to. */
+                    std::vector<uint8_t> vIndex;
+                    ssJournal >> vIndex;
 
-                /* Write the key. */
-                pTransaction->setKeychain.insert(vKey);
+                    /* Set the indexing key. */
+                    pTransaction->mapIndex[vKey] = vIndex;
 
-                /* Debug output. */
-                debug::log(0, FUNCTION, "writing keychain ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+                    /* Debug output. */
+                    debug::log(3, FUNCTION, "indexing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
+                }
+                else
+                    throw debug::exception(FUNCTION, "unknown journal entry ", strType);
             }
-            else if(strType == "write")
-            {
-                /* Get the key to write. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
+        }
+        catch(const std::exception& e)
+        {
+            TxnRelease();
+            return debug::error(FUNCTION, strName, " journal record failed to parse: ", e.what());
+        }
 
-                /* Get the data to write. */
-                std::vector<uint8_t> vData;
-                ssJournal >> vData;
+        /* Log the replayed writes again, they update in place if the key reached disk but not the log. */
+        if(pKeys)
+        {
+            LOCK(TRANSACTION_MUTEX);
+            for(const auto& item : pTransaction->mapTransactions)
+                pKeys->Append(KEYLOG::RECORD, item.first);
+        }
 
-                /* Write the sector data. */
-                pTransaction->mapTransactions[vKey] = vData;
+        /* Apply the transaction to disk. */
+        if(!TxnCommit())
+        {
+            TxnRelease();
+            return debug::error(FUNCTION, strName, " journal record failed to replay");
+        }
 
-                /* Debug output. */
-                debug::log(0, FUNCTION, "writing data ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            else if(strType == "index")
-            {
-                /* Get the key to index. */
-                std::vector<uint8_t> vKey;
-                ssJournal >> vKey;
+        return true;
+    }
 
-                /* Get the data to index to. */
-                std::vector<uint8_t> vIndex;
-                ssJournal >> vIndex;
 
-                /* Set the indexing key. */
-                pTransaction->mapIndex[vKey] = vIndex;
+    /*  Sync the sector files written since the last flush and the keychain to disk. */
+    template<class KeychainType, class CacheType>
+    bool SectorDatabase<KeychainType, CacheType>::Flush()
+    {
+        /* Take the dirty set so new writes start a fresh one. */
+        std::set<uint32_t> setFiles;
+        {
+            LOCK(SECTOR_MUTEX);
+            setFiles.swap(setDirty);
+        }
 
-                /* Debug output. */
-                debug::log(0, FUNCTION, "indexing key ", HexStr(vKey.begin(), vKey.end()).substr(0, 20));
-            }
-            if(strType == "commit")
+        /* Sync the sector files. Reopening an evicted file still syncs its dirty pages. */
+        for(const auto& nFile : setFiles)
+        {
+            std::shared_ptr<BinaryFile> pfile = GetFile(nFile);
+            if(!pfile || !pfile->Sync())
             {
-                debug::log(0, FUNCTION, strName, " transaction journal ready to be restored");
+                /* Keep the files tracked so the next flush retries them. */
+                LOCK(SECTOR_MUTEX);
+                setDirty.insert(setFiles.begin(), setFiles.end());
 
-                return true;
+                return debug::error(FUNCTION, strName, " failed to sync sector file ", nFile);
             }
         }
 
-        return debug::error(FUNCTION, strName, " transaction journal never reached commit");
+        /* Sync the keychain. */
+        pSectorKeys->Flush();
+
+        /* Sync the key log, the journal is cleared after this so recovery can't log them again. */
+        if(pKeys && !pKeys->Sync())
+            return debug::error(FUNCTION, strName, " failed to sync key log");
+
+        return true;
     }
 
 
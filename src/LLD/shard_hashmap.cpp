@@ -21,6 +21,7 @@ ________________________________________________________________________________
 #include <Util/include/debug.h>
 #include <Util/include/hex.h>
 
+#include <fstream>
 #include <iomanip>
 
 namespace LLD
@@ -31,9 +32,9 @@ namespace LLD
         const uint64_t nBucketsIn, const uint32_t nShardsIn)
     : KEY_MUTEX()
     , strBaseLocation(strBaseLocationIn)
-    , fileCache(new TemplateLRU<std::pair<uint16_t, uint16_t>, std::fstream*>(8))
+    , fileCache(new TemplateLRU<std::pair<uint16_t, uint16_t>, std::shared_ptr<BinaryFile>>(8))
     , diskShards(new TemplateLRU<uint16_t, std::vector<uint16_t>*>(nShardsIn))
-    , indexCache(new TemplateLRU<uint16_t, std::fstream*>(nShardsIn))
+    , indexCache(new TemplateLRU<uint16_t, std::shared_ptr<BinaryFile>>(nShardsIn))
     , HASHMAP_TOTAL_BUCKETS(nBucketsIn)
     , HASHMAP_TOTAL_SHARDS(nShardsIn)
     , HASHMAP_MAX_KEY_SIZE(32)
@@ -158,25 +159,16 @@ namespace LLD
         /* Read the hashmap indexes. */
         else
         {
-            /* Create the stream index object. */
-            std::fstream* pstream;
-            if(!indexCache->Get(nShard, pstream))
-            {
-                pstream = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    throw debug::exception(FUNCTION, "index cache file could not be loaded");
-                }
-
-                indexCache->Put(nShard, pstream);
-            }
+            /* Create the index file handle. */
+            std::shared_ptr<BinaryFile> pindex = GetIndex(nShard);
+            if(!pindex)
+                throw debug::exception(FUNCTION, "index cache file could not be loaded");
 
             /* Build a vector to read the disk index. */
             std::vector<uint8_t> vIndex(HASHMAP_TOTAL_BUCKETS * 2, 0);
 
             /* Read the entire index shard. */
-            pstream->read((char*)&vIndex[0], vIndex.size());
+            pindex->Read(&vIndex[0], vIndex.size(), 0);
 
             /* Deserialize the values into memory index. */
             uint32_t nTotalKeys = 0;
@@ -201,6 +193,50 @@ namespace LLD
     }
 
 
+    /* Get a file handle for a hashmap file, opening it into the file cache if needed. */
+    std::shared_ptr<BinaryFile> ShardHashMap::GetFile(const uint16_t nShard, const uint16_t nHashmap)
+    {
+        /* Check the file cache first. */
+        std::shared_ptr<BinaryFile> pfile;
+        if(fileCache->Get(std::make_pair(nShard, nHashmap), pfile))
+            return pfile;
+
+        /* Open a new file handle. */
+        pfile = std::make_shared<BinaryFile>(debug::safe_printstr(strBaseLocation, "_hashmap.",
+            std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), nHashmap));
+
+        if(!pfile->IsOpen())
+            return nullptr;
+
+        /* Add to the file cache. */
+        fileCache->Put(std::make_pair(nShard, nHashmap), pfile);
+
+        return pfile;
+    }
+
+
+    /* Get a file handle for a shard's disk index, opening it into the index cache if needed. */
+    std::shared_ptr<BinaryFile> ShardHashMap::GetIndex(const uint16_t nShard)
+    {
+        /* Check the index cache first. */
+        std::shared_ptr<BinaryFile> pindex;
+        if(indexCache->Get(nShard, pindex))
+            return pindex;
+
+        /* Open a new file handle. */
+        pindex = std::make_shared<BinaryFile>(
+            debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard));
+
+        if(!pindex->IsOpen())
+            return nullptr;
+
+        /* Add to the index cache. */
+        indexCache->Put(nShard, pindex);
+
+        return pindex;
+    }
+
+
     /*  Read a key index from the disk hashmaps. */
     void ShardHashMap::Initialize()
     {
@@ -233,12 +269,9 @@ namespace LLD
                 debug::log(0, FUNCTION, "Generated Disk Hash Map 0 of ", vSpace.size(), " bytes");
             }
 
-            /* Load the stream object into the stream LRU cache. */
-            std::fstream* pstream = new std::fstream(file, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream->is_open())
+            /* Load the file handle into the file LRU cache. */
+            if(!GetFile(nShard, 0))
                 throw debug::exception(FUNCTION, "failed to open ", file);
-
-            fileCache->Put(std::make_pair(nShard, 0), pstream);
         }
 
         debug::log(0, FUNCTION, "Shard Hashmap Initialized with ", TOTAL_KEYS, " total keys");
@@ -277,30 +310,14 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    continue;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg(nFilePos, std::ios::beg);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(nShard, i);
+            if(!pfile)
+                continue;
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -363,30 +380,14 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream *pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    continue;
-                }
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(nShard, i);
+            if(!pfile)
+                continue;
 
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
-
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -456,30 +457,14 @@ namespace LLD
             std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
             for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
             {
-                /* Find the file stream for LRU cache. */
-                std::fstream *pstream;
-                if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-                {
-                    /* Set the new stream pointer. */
-                    std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                        std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                    pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                    if(!pstream->is_open())
-                    {
-                        delete pstream;
-                        continue;
-                    }
-
-                    /* If file not found add to LRU cache. */
-                    fileCache->Put(std::make_pair(nShard, i), pstream);
-                }
-
-                /* Seek to the hashmap index in file. */
-                pstream->seekg (nFilePos, std::ios::beg);
+                /* Find the file handle from the LRU cache. */
+                std::shared_ptr<BinaryFile> pfile = GetFile(nShard, i);
+                if(!pfile)
+                    continue;
 
-                /* Read the bucket binary data from file stream */
-                pstream->read((char*) &vBucket[0], vBucket.size());
+                /* Read the bucket binary data from file. */
+                if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                    continue;
 
                 /* Check if this bucket has the key or is in an empty state. */
                 if(vBucket[0] == STATE::EMPTY || std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -491,10 +476,9 @@ namespace LLD
                     /* Serialize the key into the end of the vector. */
                     ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
 
-                    /* Handle the disk writing operations. */
-                    pstream->seekp (nFilePos, std::ios::beg);
-                    pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-                    pstream->flush();
+                    /* Write the key to the hashmap file. */
+                    if(!pfile->Write(ssKey.data(), ssKey.size(), nFilePos))
+                        return debug::error(FUNCTION, "failed to write hashmap (", strerror(errno), ")");
 
                     /* Debug Output of Sector Key Information. */
                     if(config::nVerbose >= 4)
@@ -547,62 +531,26 @@ namespace LLD
         /* Serialize the key into the end of the vector. */
         ssKey.write((char*)&vKeyCompressed[0], vKeyCompressed.size());
 
-        /* Find the file stream for LRU cache. */
-        std::fstream* pstream;
-        if(!fileCache->Get(std::make_pair(nShard, hashmap->at(nBucket)), pstream))
-        {
-            /* Set the new stream pointer. */
-            std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
+        /* Find the file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pfile = GetFile(nShard, hashmap->at(nBucket));
+        if(!pfile)
+            return debug::error(FUNCTION, "Failed to generate file object");
 
-            /* Set the new stream pointer. */
-            pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pstream || !pstream->is_open())
-            {
-                delete pstream;
-                return debug::error(FUNCTION, "Failed to generate file object");
-            }
+        /* Write the key to the hashmap file. */
+        if(!pfile->Write(ssKey.data(), ssKey.size(), nFilePos))
+            return debug::error(FUNCTION, "failed to write hashmap (", strerror(errno), ")");
 
-            /* If not in cache, add to the LRU. */
-            fileCache->Put(std::make_pair(nShard, hashmap->at(nBucket)), pstream);
-        }
-
-        /* Flush the key file to disk. */
-        pstream->seekp (nFilePos, std::ios::beg);
-        pstream->write((char*)&ssKey.Bytes()[0], ssKey.size());
-        pstream->flush();
-
-        /* Seek to the index position. */
-        std::fstream* pindex;
-        if(!indexCache->Get(nShard, pindex))
-        {
-            /* Build the hashmap indexes. */
-            std::string index = debug::safe_printstr(strBaseLocation, "_index.", std::setfill('0'), std::setw(3), nShard);
-
-            /* Create new index file. */
-            pindex = new std::fstream(index, std::ios::in | std::ios::out | std::ios::binary);
-            if(!pindex->is_open())
-            {
-                delete pindex;
-                return debug::error(FUNCTION, "Failed to generate file object");
-            }
-
-            /* If not in cache, add to the LRU. */
-            indexCache->Put(nShard, pindex);
-        }
-
-        /* Seek to binary position in index file. */
-        pindex->seekp((nBucket * 2), std::ios::beg);
+        /* Find the index file handle from the LRU cache. */
+        std::shared_ptr<BinaryFile> pindex = GetIndex(nShard);
+        if(!pindex)
+            return debug::error(FUNCTION, "Failed to generate file object");
 
         /* Write the index to disk. */
         uint16_t nIndex = ++hashmap->at(nBucket);
 
-        /* Get the bucket data. */
-        std::vector<uint8_t> vBucket((uint8_t*)&nIndex, (uint8_t*)&nIndex + 2);
-
         /* Write the index into hashmap. */
-        pindex->write((char*)&vBucket[0], vBucket.size());
-        pindex->flush();
+        if(!pindex->Write((uint8_t*)&nIndex, 2, nBucket * 2))
+            return debug::error(FUNCTION, "failed to write disk index (", strerror(errno), ")");
 
         /* Debug Output of Sector Key Information. */
         if(config::nVerbose >= 4)
@@ -650,31 +598,14 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), i);
-
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-                if(!pstream->is_open())
-                {
-                    delete pstream;
-                    return debug::error(FUNCTION, "Failed to generate file object");
-                }
-
-                /* If not in cache, add to the LRU. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(nShard, i);
+            if(!pfile)
+                return debug::error(FUNCTION, "Failed to generate file object");
 
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -684,13 +615,10 @@ namespace LLD
                 SectorKey cKey;
                 ssKey >> cKey;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Write empty bytes over the bucket. */
                 std::vector<uint8_t> vEmpty(HASHMAP_KEY_ALLOCATION, 0);
-                pstream->write((char*) &vEmpty[0], vEmpty.size());
-                pstream->flush();
+                if(!pfile->Write(&vEmpty[0], vEmpty.size(), nFilePos))
+                    return debug::error(FUNCTION, "failed to erase hashmap (", strerror(errno), ")");
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -741,26 +669,14 @@ namespace LLD
         std::vector<uint8_t> vBucket(HASHMAP_KEY_ALLOCATION, 0);
         for(int16_t i = hashmap->at(nBucket) - 1; i >= 0; --i)
         {
-            /* Find the file stream for LRU cache. */
-            std::fstream* pstream;
-            if(!fileCache->Get(std::make_pair(nShard, i), pstream))
-            {
-                /* Set the new stream pointer. */
-                std::string filename = debug::safe_printstr(strBaseLocation, "_hashmap.",
-                    std::setfill('0'), std::setw(3), nShard, ".", std::setfill('0'), std::setw(5), hashmap->at(nBucket));
+            /* Find the file handle from the LRU cache. */
+            std::shared_ptr<BinaryFile> pfile = GetFile(nShard, i);
+            if(!pfile)
+                continue;
 
-                /* Set the new stream pointer. */
-                pstream = new std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
-
-                /* If file not found add to LRU cache. */
-                fileCache->Put(std::make_pair(nShard, i), pstream);
-            }
-
-            /* Seek to the hashmap index in file. */
-            pstream->seekg (nFilePos, std::ios::beg);
-
-            /* Read the bucket binary data from file stream */
-            pstream->read((char*) &vBucket[0], vBucket.size());
+            /* Read the bucket binary data from file. */
+            if(!pfile->Read(&vBucket[0], vBucket.size(), nFilePos))
+                continue;
 
             /* Check if this bucket has the key */
             if(std::equal(vBucket.begin() + 13, vBucket.begin() + 13 + vKeyCompressed.size(), vKeyCompressed.begin()))
@@ -774,13 +690,10 @@ namespace LLD
                 if(cKey.Ready())
                     return true;
 
-                /* Seek to the hashmap index in file. */
-                pstream->seekp (nFilePos, std::ios::beg);
-
-                /* Read the bucket binary data from file stream */
+                /* Write the ready state into the bucket. */
                 std::vector<uint8_t> vReady(STATE::READY);
-                pstream->write((char*) &vReady[0], vReady.size());
-                pstream->flush();
+                if(!pfile->Write(&vReady[0], vReady.size(), nFilePos))
+                    return debug::error(FUNCTION, "failed to restore hashmap (", strerror(errno), ")");
 
                 /* Debug Output of Sector Key Information. */
                 if(config::nVerbose >= 4)
@@ -0,0 +1,804 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/snapshot.h>
+#include <LLD/include/global.h>
+
+#include <LLC/hash/SK.h>
+
+#include <TAO/Ledger/types/state.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+#include <Util/templates/datastream.h>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace LLD
+{
+    namespace Snapshot
+    {
+
+        /* Frame types following the header. */
+        const uint8_t FRAME_END   = 0;
+        const uint8_t FRAME_CHUNK = 1;
+
+
+        /* The path of the mark left while a snapshot loads. */
+        std::string PendingPath()
+        {
+            return config::GetDataDir() + "_SNAPSHOT";
+        }
+
+
+        /* Write a frame prefixed with its size. */
+        bool WriteFrame(std::ofstream& stream, const DataStream& ssFrame)
+        {
+            DataStream ssSize(SER_LLD, DATABASE_VERSION);
+            ssSize << static_cast<uint32_t>(ssFrame.size());
+
+            stream.write((char*)&ssSize.Bytes()[0], ssSize.size());
+            stream.write((char*)&ssFrame.Bytes()[0], ssFrame.size());
+
+            return !stream.fail();
+        }
+
+
+        /* Read the next frame. */
+        bool ReadFrame(std::ifstream& stream, std::vector<uint8_t>& vFrame)
+        {
+            std::vector<uint8_t> vSize(4, 0);
+            if(!stream.read((char*)&vSize[0], vSize.size()))
+                return false;
+
+            uint32_t nSize = 0;
+            DataStream ssSize(vSize, SER_LLD, DATABASE_VERSION);
+            ssSize >> nSize;
+
+            /* Check the frame size before allocating it. */
+            if(nSize == 0 || nSize > MAX_SNAPSHOT_FRAME)
+                return debug::error(FUNCTION, "invalid frame size ", nSize);
+
+            vFrame.resize(nSize);
+            if(!stream.read((char*)&vFrame[0], nSize))
+                return debug::error(FUNCTION, "frame of ", nSize, " bytes is truncated");
+
+            return true;
+        }
+
+
+        /* Chain the hash of a chunk into the commitment. */
+        uint256_t Chain(const uint256_t& hashCommit, const std::string& strName, const uint256_t& hashChunk)
+        {
+            DataStream ssChain(SER_LLD, DATABASE_VERSION);
+            ssChain << hashCommit << strName << hashChunk;
+
+            return LLC::SK256(ssChain.Bytes());
+        }
+
+
+        /* Read a committed record, skipping any open transaction. */
+        template<typename Key, typename Type>
+        bool ReadCommitted(SectorDatabase<BinaryHashMap, BinaryLRU>* pdb, const Key& key, Type& value)
+        {
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            std::vector<uint8_t> vData;
+            if(!pdb->Get(ssKey.Bytes(), vData))
+                return false;
+
+            try
+            {
+                std::string strType;
+
+                DataStream ssData(vData, SER_LLD, DATABASE_VERSION);
+                ssData >> strType >> value;
+            }
+            catch(const std::exception& e)
+            {
+                return debug::error(FUNCTION, "failed to deserialize ", pdb->GetName(), " record: ", e.what());
+            }
+
+            return true;
+        }
+
+
+        /* Visit the chunks of a snapshot, checking them against their hashes and the commitment. */
+        bool Scan(const std::string& strPath, Header& header, uint256_t& hashCommit,
+                  const std::function<bool(const std::string&, const std::vector<uint8_t>&)>& fnChunk)
+        {
+            std::ifstream stream(strPath, std::ios::in | std::ios::binary);
+            if(!stream)
+                return debug::error(FUNCTION, "failed to open ", strPath);
+
+            try
+            {
+                /* Read the header, which seeds the commitment. */
+                std::vector<uint8_t> vFrame;
+                if(!ReadFrame(stream, vFrame))
+                    return debug::error(FUNCTION, strPath, " has no header");
+
+                DataStream ssHeader(vFrame, SER_LLD, DATABASE_VERSION);
+                ssHeader >> header;
+
+                if(header.nVersion != SNAPSHOT_VERSION)
+                    return debug::error(FUNCTION, strPath, " has unsupported version ", header.nVersion);
+
+                hashCommit = LLC::SK256(vFrame);
+
+                /* Read chunks up to the footer. */
+                uint64_t nChunks = 0;
+                while(true)
+                {
+                    if(!ReadFrame(stream, vFrame))
+                        return debug::error(FUNCTION, strPath, " ends before its footer");
+
+                    DataStream ssFrame(vFrame, SER_LLD, DATABASE_VERSION);
+
+                    uint8_t nFrame = 0;
+                    ssFrame >> nFrame;
+
+                    /* The footer holds the chunk count and the commitment. */
+                    if(nFrame == FRAME_END)
+                    {
+                        uint64_t nTotal = 0;
+                        uint256_t hashFooter = 0;
+                        ssFrame >> nTotal >> hashFooter;
+
+                        if(nTotal != nChunks)
+                            return debug::error(FUNCTION, strPath, " has ", nChunks, " chunks, expected ", nTotal);
+
+                        if(hashFooter != hashCommit)
+                            return debug::error(FUNCTION, strPath, " commitment mismatch ", hashCommit.SubString());
+
+                        return true;
+                    }
+
+                    if(nFrame != FRAME_CHUNK)
+                        return debug::error(FUNCTION, strPath, " has unknown frame type ", uint32_t(nFrame));
+
+                    /* Read the chunk. */
+                    std::string strName;
+                    std::vector<uint8_t> vChunk;
+                    uint256_t hashChunk = 0;
+                    ssFrame >> strName >> vChunk >> hashChunk;
+
+                    if(std::find(header.vNames.begin(), header.vNames.end(), strName) == header.vNames.end())
+                        return debug::error(FUNCTION, strPath, " chunk ", nChunks, " is for unknown database ", strName);
+
+                    if(LLC::SK256(vChunk) != hashChunk)
+                        return debug::error(FUNCTION, strPath, " chunk ", nChunks, " hash mismatch");
+
+                    if(!fnChunk(strName, vChunk))
+                        return false;
+
+                    hashCommit = Chain(hashCommit, strName, hashChunk);
+                    ++nChunks;
+                }
+            }
+            catch(const std::exception& e)
+            {
+                return debug::error(FUNCTION, "failed to parse ", strPath, ": ", e.what());
+            }
+        }
+
+
+        /* Writes the frames of a snapshot to a temporary file, moving it into place once whole. */
+        class Writer
+        {
+            /* The path of the snapshot and of the file it is written to. */
+            std::string strPath;
+            std::string strTemp;
+
+
+            /* The temporary file. */
+            std::ofstream stream;
+
+
+            /* The chunk being filled and the database it holds records of. */
+            DataStream ssChunk;
+            std::string strName;
+
+
+            /* The chunks and records written. */
+            uint64_t nChunks;
+            uint64_t nRecords;
+
+
+        public:
+
+            /* The commitment so far. */
+            uint256_t hashCommit;
+
+
+            /* Path Constructor. */
+            explicit Writer(const std::string& strPathIn)
+            : strPath    (strPathIn)
+            , strTemp    (strPathIn + ".tmp")
+            , stream     ( )
+            , ssChunk    (SER_LLD, DATABASE_VERSION)
+            , strName    ( )
+            , nChunks    (0)
+            , nRecords   (0)
+            , hashCommit (0)
+            {
+            }
+
+
+            /* Create the temporary file and write the header, which seeds the commitment. */
+            bool Open(const Header& header)
+            {
+                stream.open(strTemp, std::ios::out | std::ios::binary | std::ios::trunc);
+                if(!stream)
+                    return debug::error(FUNCTION, "failed to create ", strTemp);
+
+                DataStream ssHeader(SER_LLD, DATABASE_VERSION);
+                ssHeader << header;
+                if(!WriteFrame(stream, ssHeader))
+                    return debug::error(FUNCTION, "failed to write header to ", strTemp);
+
+                hashCommit = LLC::SK256(ssHeader.Bytes());
+
+                return true;
+            }
+
+
+            /* Start on the records of a database. */
+            void Begin(const std::string& strNameIn)
+            {
+                strName = strNameIn;
+            }
+
+
+            /* Add an entry in the format of a journal record, closing the chunk once it is full. */
+            bool Add(const uint8_t nType, const std::vector<uint8_t>& vKey, const std::vector<uint8_t>& vData)
+            {
+                if(nType == KEYLOG::RECORD)
+                    ssChunk << std::string("write") << vKey << vData;
+                else if(nType == KEYLOG::KEYCHAIN)
+                    ssChunk << std::string("key") << vKey;
+                else
+                    ssChunk << std::string("index") << vKey << vData;
+
+                ++nRecords;
+
+                if(ssChunk.size() >= SNAPSHOT_CHUNK_SIZE)
+                    return End();
+
+                return true;
+            }
+
+
+            /* Close the current chunk into a frame. */
+            bool End()
+            {
+                if(ssChunk.size() == 0)
+                    return true;
+
+                const uint256_t hashChunk = LLC::SK256(ssChunk.Bytes());
+
+                DataStream ssFrame(SER_LLD, DATABASE_VERSION);
+                ssFrame << FRAME_CHUNK << strName << ssChunk.Bytes() << hashChunk;
+                if(!WriteFrame(stream, ssFrame))
+                    return debug::error(FUNCTION, "failed to write chunk to ", strTemp);
+
+                hashCommit = Chain(hashCommit, strName, hashChunk);
+                ++nChunks;
+
+                ssChunk.clear();
+                return true;
+            }
+
+
+            /* Write the footer and move the whole snapshot into place. */
+            bool Close()
+            {
+                DataStream ssFooter(SER_LLD, DATABASE_VERSION);
+                ssFooter << FRAME_END << nChunks << hashCommit;
+                if(!WriteFrame(stream, ssFooter))
+                    return debug::error(FUNCTION, "failed to write footer to ", strTemp);
+
+                stream.close();
+                if(stream.fail())
+                    return debug::error(FUNCTION, "failed to close ", strTemp);
+
+                if(!filesystem::rename(strTemp, strPath))
+                    return debug::error(FUNCTION, "failed to rename ", strTemp, " to ", strPath);
+
+                debug::log(0, FUNCTION, "wrote ", nRecords, " records in ", nChunks, " chunks to ", strPath);
+
+                return true;
+            }
+        };
+
+
+        /* Reads the entries of a snapshot back in order, without checking them. */
+        class Reader
+        {
+            /* The snapshot file. */
+            std::ifstream stream;
+
+
+            /* The chunk being read and the database it holds records of. */
+            DataStream ssChunk;
+            std::string strName;
+
+
+        public:
+
+            /* Default Constructor. */
+            Reader()
+            : stream  ( )
+            , ssChunk (SER_LLD, DATABASE_VERSION)
+            , strName ( )
+            {
+            }
+
+
+            /* Open the file and skip its header. */
+            bool Open(const std::string& strPath)
+            {
+                stream.open(strPath, std::ios::in | std::ios::binary);
+                if(!stream)
+                    return debug::error(FUNCTION, "failed to open ", strPath);
+
+                std::vector<uint8_t> vFrame;
+                return ReadFrame(stream, vFrame);
+            }
+
+
+            /* Read the next entry, false once the footer is reached. Throws if the file is cut short. */
+            bool Next(std::string& strNameOut, uint8_t& nType, std::vector<uint8_t>& vKey, std::vector<uint8_t>& vData)
+            {
+                /* Move on to the next chunk. */
+                while(ssChunk.End())
+                {
+                    std::vector<uint8_t> vFrame;
+                    if(!ReadFrame(stream, vFrame))
+                        throw debug::exception(FUNCTION, "snapshot ends before its footer");
+
+                    DataStream ssFrame(vFrame, SER_LLD, DATABASE_VERSION);
+
+                    uint8_t nFrame = 0;
+                    ssFrame >> nFrame;
+                    if(nFrame == FRAME_END)
+                        return false;
+
+                    ssFrame >> strName >> ssChunk.Bytes();
+                    ssChunk.Reset();
+                }
+
+                /* Read the entry. */
+                std::string strType;
+                ssChunk >> strType >> vKey;
+
+                vData.clear();
+                if(strType == "write")
+                {
+                    nType = KEYLOG::RECORD;
+                    ssChunk >> vData;
+                }
+                else if(strType == "key")
+                    nType = KEYLOG::KEYCHAIN;
+                else
+                {
+                    nType = KEYLOG::INDEXED;
+                    ssChunk >> vData;
+                }
+
+                strNameOut = strName;
+                return true;
+            }
+        };
+
+
+        /* Add the records of a database up to an offset in its key log, sorted by key. */
+        bool Add(Writer& writer, SectorDatabase<BinaryHashMap, BinaryLRU>* pdb, const uint64_t nEnd,
+                 std::set<std::vector<uint8_t>>* pMissing)
+        {
+            const std::string& strName = pdb->GetName();
+
+            /* Get every live key, sorted. */
+            std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>> mapKeys;
+            if(!pdb->ReadKeys(mapKeys, 0, nEnd))
+                return debug::error(FUNCTION, strName, " can't be exported, it needs a key log from an empty database");
+
+            /* Records and keys go first, indexes copy the sector of their target so they follow. */
+            writer.Begin(strName);
+            for(uint32_t nPass = 0; nPass < 2; ++nPass)
+            {
+                for(const auto& entry : mapKeys)
+                {
+                    if((entry.second.first == KEYLOG::INDEXED) != (nPass == 1))
+                        continue;
+
+                    /* Read the record, one erased since the key log was read is left to the caller. */
+                    std::vector<uint8_t> vData;
+                    if(entry.second.first == KEYLOG::RECORD && !pdb->Get(entry.first, vData))
+                    {
+                        if(!pMissing)
+                            return debug::error(FUNCTION, "failed to read ", strName, " record for snapshot");
+
+                        pMissing->insert(entry.first);
+                        continue;
+                    }
+
+                    if(!writer.Add(entry.second.first, entry.first, entry.second.first == KEYLOG::RECORD ? vData : entry.second.second))
+                        return false;
+                }
+            }
+
+            /* Close the last chunk of the database. */
+            if(!writer.End())
+                return false;
+
+            debug::log(0, FUNCTION, "wrote ", mapKeys.size(), " keys from ", strName);
+
+            return true;
+        }
+
+
+        /* Write a snapshot of databases with complete key logs. */
+        bool Write(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                   const uint1024_t& hashBlock, const uint32_t nHeight, uint256_t& hashCommit)
+        {
+            /* Build the header. */
+            Header header;
+            header.nHeight   = nHeight;
+            header.hashBlock = hashBlock;
+            for(const auto& pdb : vDatabases)
+                header.vNames.push_back(pdb->GetName());
+
+            /* Write to a temporary file so a failed export never looks whole. */
+            Writer writer(strPath);
+            if(!writer.Open(header))
+                return false;
+
+            /* Write the records of each database in chunks. */
+            for(const auto& pdb : vDatabases)
+                if(!Add(writer, pdb, 0, nullptr))
+                    return false;
+
+            if(!writer.Close())
+                return false;
+
+            hashCommit = writer.hashCommit;
+
+            return true;
+        }
+
+
+        /* Write a snapshot from the records up to a cut in the key logs and the keys changed after it. */
+        bool Write(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                   const std::vector<uint64_t>& vCut, std::mutex& MUTEX, const std::function<bool(uint1024_t&, uint32_t&)>& fnBlock,
+                   Header& header, uint256_t& hashCommit)
+        {
+            header.vNames.clear();
+            for(uint32_t n = 0; n < vDatabases.size(); ++n)
+            {
+                if(vCut[n] == 0)
+                    return debug::error(FUNCTION, vDatabases[n]->GetName(), " can't be exported, it needs a key log from an empty database");
+
+                header.vNames.push_back(vDatabases[n]->GetName());
+            }
+
+            /* Stage the records up to the cut. Records changed meanwhile are logged after it and replaced below. */
+            const std::string strStage = strPath + ".stage";
+            std::vector<std::set<std::vector<uint8_t>>> vMissing(vDatabases.size());
+            {
+                Writer writer(strStage);
+                if(!writer.Open(header))
+                    return false;
+
+                for(uint32_t n = 0; n < vDatabases.size(); ++n)
+                    if(!Add(writer, vDatabases[n], vCut[n], &vMissing[n]))
+                        return false;
+
+                if(!writer.Close())
+                    return false;
+            }
+
+            /* Read the keys changed since the cut and the block they add up to, with writes held off again. */
+            std::vector<std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>>> vChanged(vDatabases.size());
+            {
+                LOCK(MUTEX);
+
+                if(!fnBlock(header.hashBlock, header.nHeight))
+                    return false;
+
+                for(uint32_t n = 0; n < vDatabases.size(); ++n)
+                {
+                    SectorDatabase<BinaryHashMap, BinaryLRU>* pdb = vDatabases[n];
+                    if(!pdb->ReadKeys(vChanged[n], vCut[n], 0))
+                        return debug::error(FUNCTION, pdb->GetName(), " lost its key log while exporting");
+
+                    /* Records hold their data rather than an index key. */
+                    for(auto& entry : vChanged[n])
+                        if(entry.second.first == KEYLOG::RECORD && !pdb->Get(entry.first, entry.second.second))
+                            return debug::error(FUNCTION, "failed to read ", pdb->GetName(), " record for snapshot");
+
+                    /* A record can only go missing from the stage if it changed after the cut. */
+                    for(const auto& vKey : vMissing[n])
+                        if(!vChanged[n].count(vKey))
+                            return debug::error(FUNCTION, "failed to read ", pdb->GetName(), " record for snapshot");
+                }
+            }
+
+            /* Merge the changed keys into the staged records, in the same order a held off write has. */
+            Writer writer(strPath);
+            if(!writer.Open(header))
+                return false;
+
+            try
+            {
+                Reader reader;
+                if(!reader.Open(strStage))
+                    return false;
+
+                std::string strName;
+                uint8_t nType = 0;
+                std::vector<uint8_t> vKey, vData;
+                bool fNext = reader.Next(strName, nType, vKey, vData);
+
+                for(uint32_t n = 0; n < vDatabases.size(); ++n)
+                {
+                    writer.Begin(header.vNames[n]);
+                    for(uint32_t nPass = 0; nPass < 2; ++nPass)
+                    {
+                        auto it = vChanged[n].begin();
+                        while(true)
+                        {
+                            /* Check the staged entry belongs to this database and pass. */
+                            const bool fStaged = fNext && strName == header.vNames[n] && (nType == KEYLOG::INDEXED) == (nPass == 1);
+
+                            /* Add the changed keys that sort before it. */
+                            for( ; it != vChanged[n].end() && (!fStaged || it->first < vKey); ++it)
+                            {
+                                if(it->second.first == KEYLOG::ERASED || (it->second.first == KEYLOG::INDEXED) != (nPass == 1))
+                                    continue;
+
+                                if(!writer.Add(it->second.first, it->first, it->second.second))
+                                    return false;
+                            }
+
+                            if(!fStaged)
+                                break;
+
+                            /* Keep the staged entry unless the key changed after the cut. */
+                            if(!vChanged[n].count(vKey) && !writer.Add(nType, vKey, vData))
+                                return false;
+
+                            fNext = reader.Next(strName, nType, vKey, vData);
+                        }
+                    }
+
+                    if(!writer.End())
+                        return false;
+                }
+            }
+            catch(const std::exception& e)
+            {
+                return debug::error(FUNCTION, "failed to read ", strStage, ": ", e.what());
+            }
+
+            if(!writer.Close())
+                return false;
+
+            hashCommit = writer.hashCommit;
+
+            filesystem::remove(strStage);
+
+            return true;
+        }
+
+
+        /* Write a snapshot of databases with complete key logs while they take writes. */
+        bool Write(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                   std::mutex& MUTEX, const std::function<bool(uint1024_t&, uint32_t&)>& fnBlock,
+                   Header& header, uint256_t& hashCommit)
+        {
+            /* Note where each key log ends and log updates in place from there, with writes held off. */
+            std::vector<uint64_t> vCut;
+            {
+                LOCK(MUTEX);
+                for(const auto& pdb : vDatabases)
+                    vCut.push_back(pdb->TrackKeys(true));
+            }
+
+            /* Stop tracking however the snapshot ends. */
+            const bool fWritten = Write(strPath, vDatabases, vCut, MUTEX, fnBlock, header, hashCommit);
+            for(const auto& pdb : vDatabases)
+                pdb->TrackKeys(false);
+
+            return fWritten;
+        }
+
+
+        /* Check the chunks of a snapshot against their hashes and its commitment. */
+        bool Verify(const std::string& strPath, Header& header, uint256_t& hashCommit)
+        {
+            return Scan(strPath, header, hashCommit,
+                [](const std::string&, const std::vector<uint8_t>&){ return true; });
+        }
+
+
+        /* Load a snapshot into databases after checking it against a commitment. */
+        bool Read(const std::string& strPath, const std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*>& vDatabases,
+                  const uint256_t& hashTrusted, Header& header)
+        {
+            /* A snapshot is only as good as the commitment it is checked against. */
+            if(hashTrusted == 0)
+                return debug::error(FUNCTION, "no trusted commitment to check ", strPath, " against");
+
+            /* Check the whole snapshot before writing anything. */
+            uint256_t hashCommit = 0;
+            if(!Verify(strPath, header, hashCommit))
+                return debug::error(FUNCTION, "snapshot ", strPath, " failed verification");
+
+            if(hashCommit != hashTrusted)
+                return debug::error(FUNCTION, "snapshot commitment ", hashCommit.SubString(), " doesn't match ", hashTrusted.SubString());
+
+            /* Find the database of every name in the snapshot. */
+            std::map<std::string, SectorDatabase<BinaryHashMap, BinaryLRU>*> mapDatabases;
+            for(const auto& strName : header.vNames)
+            {
+                auto it = std::find_if(vDatabases.begin(), vDatabases.end(),
+                    [&strName](SectorDatabase<BinaryHashMap, BinaryLRU>* pdb){ return pdb->GetName() == strName; });
+
+                if(it == vDatabases.end())
+                    return debug::error(FUNCTION, "no database for snapshot records of ", strName);
+
+                mapDatabases[strName] = *it;
+            }
+
+            /* Replay each chunk into its database. Chunks are hashed again in case the file changed. */
+            uint64_t nChunks = 0;
+            uint256_t hashLoaded = 0;
+            if(!Scan(strPath, header, hashLoaded,
+                [&mapDatabases, &nChunks](const std::string& strName, const std::vector<uint8_t>& vChunk)
+                {
+                    if(!mapDatabases[strName]->TxnRecovery(vChunk))
+                        return debug::error(FUNCTION, "failed to load snapshot chunk ", nChunks, " into ", strName);
+
+                    /* Progress output. */
+                    if(++nChunks % 256 == 0)
+                        debug::log(0, FUNCTION, "loaded ", nChunks, " snapshot chunks");
+
+                    return true;
+                }))
+                return false;
+
+            if(hashLoaded != hashCommit)
+                return debug::error(FUNCTION, "snapshot ", strPath, " changed while loading");
+
+            debug::log(0, FUNCTION, "loaded ", nChunks, " chunks at height ", header.nHeight, " commitment ", hashCommit.SubString());
+
+            return true;
+        }
+
+
+        /* The ledger databases that make up a snapshot, in order. */
+        std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*> Databases()
+        {
+            std::vector<SectorDatabase<BinaryHashMap, BinaryLRU>*> vDatabases;
+            if(Contract)
+                vDatabases.push_back(Contract);
+
+            if(Register)
+                vDatabases.push_back(Register);
+
+            if(Ledger)
+                vDatabases.push_back(Ledger);
+
+            if(Legacy)
+                vDatabases.push_back(Legacy);
+
+            if(Trust)
+                vDatabases.push_back(Trust);
+
+            return vDatabases;
+        }
+
+
+        /* Write a snapshot of the ledger databases at the best chain, while they keep taking commits. */
+        bool Export(const std::string& strPath, Header& header, uint256_t& hashCommit)
+        {
+            if(!Ledger || config::fClient.load())
+                return debug::error(FUNCTION, "snapshots need the full ledger databases");
+
+            /* Commits are only held off while the cut is taken and while the changes after it are read. */
+            return Write(strPath, Databases(), TXN_MUTEX,
+                [](uint1024_t& hashBlock, uint32_t& nHeight)
+                {
+                    /* Read the committed best chain, an open block transaction isn't part of the snapshot. */
+                    if(!ReadCommitted(Ledger, std::string("hashbestchain"), hashBlock))
+                        return debug::error(FUNCTION, "no best chain to snapshot");
+
+                    TAO::Ledger::BlockState state;
+                    if(!ReadCommitted(Ledger, hashBlock, state))
+                        return debug::error(FUNCTION, "failed to read best block ", hashBlock.SubString());
+
+                    nHeight = state.nHeight;
+
+                    return true;
+                },
+                header, hashCommit);
+        }
+
+
+        /* Load a snapshot into the ledger databases if they are empty, or resume an interrupted load. */
+        bool Import(const std::string& strPath)
+        {
+            if(!Ledger || config::fClient.load())
+                return debug::error(FUNCTION, "snapshots need the full ledger databases");
+
+            /* Leave databases that already hold a chain alone. */
+            uint1024_t hashBest = 0;
+            if(!Pending() && ReadCommitted(Ledger, std::string("hashbestchain"), hashBest))
+            {
+                debug::log(0, FUNCTION, "databases already hold a chain, skipping snapshot ", strPath);
+                return true;
+            }
+
+            /* Get the commitment to trust, the one inside the file proves nothing about where it came from. */
+            if(!config::mapArgs.count("-snapshothash"))
+                return debug::error(FUNCTION, "refusing to load ", strPath, " without a trusted -snapshothash");
+
+            uint256_t hashTrusted = 0;
+            hashTrusted.SetHex(config::GetArg("-snapshothash", ""));
+
+            /* Mark the load, a partial load has the records of a chain without all of them. */
+            {
+                std::ofstream stream(PendingPath(), std::ios::out | std::ios::trunc);
+                stream << strPath;
+                if(!stream)
+                    return debug::error(FUNCTION, "failed to mark snapshot load");
+            }
+
+            /* Load the records. Replays are idempotent, so an interrupted load just starts again. */
+            Header header;
+            if(!Read(strPath, Databases(), hashTrusted, header))
+                return false;
+
+            /* Make the records durable before clearing the mark. */
+            if(!TxnCheckpoint())
+                return debug::error(FUNCTION, "failed to flush snapshot records");
+
+            /* Check the snapshot brought the chain it claims. */
+            if(!ReadCommitted(Ledger, std::string("hashbestchain"), hashBest) || hashBest != header.hashBlock)
+                return debug::error(FUNCTION, "snapshot best chain doesn't match its header");
+
+            if(!filesystem::remove(PendingPath()))
+                return debug::error(FUNCTION, "failed to clear snapshot mark");
+
+            debug::log(0, FUNCTION, "bootstrapped from snapshot at height ", header.nHeight, " block ", header.hashBlock.SubString());
+
+            return true;
+        }
+
+
+        /* Determines if a snapshot load was interrupted. */
+        bool Pending()
+        {
+            return filesystem::exists(PendingPath());
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_BLOOM_H
+#define NEXUS_LLD_TEMPLATES_BLOOM_H
+
+#include <LLD/templates/file.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace LLD
+{
+
+    /** The bits to set per key in a bloom filter. **/
+    const uint32_t BLOOM_FILTER_HASHES = 4;
+
+
+    /** BloomFilter
+     *
+     *  Fixed size bloom filter over 64-bit key hashes.
+     *
+     *  A negative answer means the key was never inserted, a positive answer may be wrong.
+     *  Bits are set with atomic ors, so inserts and lookups can run from any thread.
+     *  Keys can't be removed, an erased key only costs a false positive.
+     *
+     **/
+    class BloomFilter
+    {
+        /** The total bits in the filter. **/
+        uint64_t nBits;
+
+
+        /** The filter bits. **/
+        std::unique_ptr<std::atomic<uint64_t>[]> pBits;
+
+    public:
+
+        /** Default Constructor. **/
+        BloomFilter() = delete;
+
+
+        /** Copy Constructor. **/
+        BloomFilter(const BloomFilter& bloom)            = delete;
+
+
+        /** Copy Assignment. **/
+        BloomFilter& operator=(const BloomFilter& bloom) = delete;
+
+
+        /** Size Constructor
+         *
+         *  @param[in] nBitsIn The total bits in the filter, rounded up to a multiple of 64.
+         *
+         **/
+        explicit BloomFilter(const uint64_t nBitsIn);
+
+
+        /** Insert
+         *
+         *  Add a key hash to the filter.
+         *
+         *  @param[in] nHash The hash of the key.
+         *
+         **/
+        void Insert(const uint64_t nHash);
+
+
+        /** Contains
+         *
+         *  Determines if a key hash might be in the filter.
+         *
+         *  @param[in] nHash The hash of the key.
+         *
+         *  @return False if the key was never inserted.
+         *
+         **/
+        bool Contains(const uint64_t nHash) const;
+
+
+        /** Bits
+         *
+         *  Get the total bits in the filter.
+         *
+         **/
+        uint64_t Bits() const;
+
+
+        /** Read
+         *
+         *  Read the filter bits from a file.
+         *
+         *  @param[in] file The file to read from.
+         *  @param[in] nPos The binary position of the bits.
+         *
+         *  @return True if all bits were read.
+         *
+         **/
+        bool Read(const BinaryFile& file, const uint64_t nPos);
+
+
+        /** Write
+         *
+         *  Write the filter bits to a file.
+         *
+         *  @param[in] file The file to write to.
+         *  @param[in] nPos The binary position of the bits.
+         *
+         *  @return True if all bits were written.
+         *
+         **/
+        bool Write(BinaryFile& file, const uint64_t nPos) const;
+    };
+}
+
+#endif
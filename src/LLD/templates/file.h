@@ -0,0 +1,184 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_FILE_H
+#define NEXUS_LLD_TEMPLATES_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <mutex>
+
+namespace LLD
+{
+
+    /** BinaryFile
+     *
+     *  Positional file handle for the sector and keychain files.
+     *
+     *  Reads and writes are given an explicit binary position (pread / pwrite), so there is no
+     *  shared stream position and any number of threads can read through the same descriptor
+     *  without holding a lock. Writes go straight to the kernel with no stream buffering.
+     *
+     *  A file can optionally be memory mapped read-only, in which case reads that fall inside
+     *  the mapping are copied straight out of the page cache without a system call.
+     *
+     **/
+    class BinaryFile
+    {
+        /** The file descriptor. **/
+        int nDescriptor;
+
+
+        /** The path the file was opened from. **/
+        std::string strPath;
+
+
+        /** The read-only memory mapping, if any. **/
+        uint8_t* pMapped;
+
+
+        /** The total bytes covered by the memory mapping. **/
+        uint64_t nMapped;
+
+
+    #ifdef WIN32
+        /** No positional IO on windows, so seek + read is guarded. **/
+        mutable std::mutex FILE_MUTEX;
+    #endif
+
+    public:
+
+        /** Default Constructor. **/
+        BinaryFile() = delete;
+
+
+        /** Copy Constructor. **/
+        BinaryFile(const BinaryFile& file)            = delete;
+
+
+        /** Copy Assignment. **/
+        BinaryFile& operator=(const BinaryFile& file) = delete;
+
+
+        /** Open Constructor
+         *
+         *  Opens the file for reading and writing.
+         *
+         *  @param[in] strPathIn The path to the file.
+         *  @param[in] fCreate Flag to create the file if it doesn't exist.
+         *
+         **/
+        BinaryFile(const std::string& strPathIn, const bool fCreate = false);
+
+
+        /** Default Destructor. Closes the descriptor. **/
+        ~BinaryFile();
+
+
+        /** IsOpen
+         *
+         *  Determines if the descriptor was opened successfully.
+         *
+         **/
+        bool IsOpen() const;
+
+
+        /** Path
+         *
+         *  Returns the path of the file.
+         *
+         **/
+        const std::string& Path() const;
+
+
+        /** Read
+         *
+         *  Read bytes from a given binary position.
+         *
+         *  @param[out] pData The buffer to read into.
+         *  @param[in] nLength The total bytes to read.
+         *  @param[in] nPos The binary position to read from.
+         *
+         *  @return True if all bytes were read, false otherwise.
+         *
+         **/
+        bool Read(uint8_t* pData, const uint64_t nLength, const uint64_t nPos) const;
+
+
+        /** Write
+         *
+         *  Write bytes to a given binary position.
+         *
+         *  @param[in] pData The buffer to write from.
+         *  @param[in] nLength The total bytes to write.
+         *  @param[in] nPos The binary position to write to.
+         *
+         *  @return True if all bytes were written, false otherwise.
+         *
+         **/
+        bool Write(const uint8_t* pData, const uint64_t nLength, const uint64_t nPos);
+
+
+        /** Size
+         *
+         *  Get the current size of the file in bytes.
+         *
+         **/
+        uint64_t Size() const;
+
+
+        /** Truncate
+         *
+         *  Truncate or extend the file to a given size.
+         *
+         *  @param[in] nSize The new size of the file in bytes.
+         *
+         *  @return True if the file was resized.
+         *
+         **/
+        bool Truncate(const uint64_t nSize);
+
+
+        /** Sync
+         *
+         *  Flush the file data to stable storage.
+         *
+         *  @return True if the data was synced.
+         *
+         **/
+        bool Sync();
+
+
+        /** Map
+         *
+         *  Memory map the current contents of the file read-only. Must be called before
+         *  the handle is shared with other threads. Bytes appended after mapping are
+         *  still served through regular reads.
+         *
+         *  @return True if the file was mapped.
+         *
+         **/
+        bool Map();
+
+
+        /** IsMapped
+         *
+         *  Determines if the file is memory mapped.
+         *
+         **/
+        bool IsMapped() const;
+    };
+}
+
+#endif
@@ -0,0 +1,229 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_INDEX_H
+#define NEXUS_LLD_TEMPLATES_INDEX_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** The version of the sector index file format. **/
+    const uint8_t SECTOR_INDEX_VERSION = 1;
+
+
+    /** SectorCursor
+     *
+     *  Position of an iteration over the records of one type, or of every type sharing a prefix.
+     *
+     **/
+    struct SectorCursor
+    {
+        /** The type, or type prefix, being iterated. **/
+        std::string strType;
+
+
+        /** Flag to match every type starting with strType. **/
+        bool fPrefix;
+
+
+        /** The sector position to continue from. **/
+        uint64_t nPosition;
+
+
+        /** The type of the record last returned. **/
+        std::string strFound;
+
+
+        /** Default Constructor. **/
+        SectorCursor()
+        : strType   ( )
+        , fPrefix   (false)
+        , nPosition (0)
+        , strFound  ( )
+        {
+        }
+    };
+
+
+    /** SectorIndex
+     *
+     *  Secondary index from record types to the sector positions holding them.
+     *
+     *  Positions are kept per type in a sorted vector. Appends to the sector files always
+     *  land at the end, so most inserts are a push_back. Erased positions are flagged and
+     *  compacted lazily.
+     *
+     *  An entry can go stale if its record is overwritten in place with another type, so
+     *  readers have to check the type of the record they read.
+     *
+     *  The index is saved on shutdown and marked unclean while open. An unclean index is
+     *  rebuilt from the sector files.
+     *
+     **/
+    class SectorIndex
+    {
+        /** Mutex for thread concurrency. **/
+        mutable std::mutex INDEX_MUTEX;
+
+
+        /** The path of the index file. **/
+        std::string strPath;
+
+
+        /** The sorted entries of each type. **/
+        std::map<std::string, std::vector<uint64_t>> mapTypes;
+
+
+        /** The erased entries of each type waiting to be compacted. **/
+        std::map<std::string, uint64_t> mapErased;
+
+
+    public:
+
+        /** Default Constructor. **/
+        SectorIndex() = delete;
+
+
+        /** Copy Constructor. **/
+        SectorIndex(const SectorIndex& index)            = delete;
+
+
+        /** Copy Assignment. **/
+        SectorIndex& operator=(const SectorIndex& index) = delete;
+
+
+        /** Path Constructor
+         *
+         *  @param[in] strPathIn The path of the index file.
+         *
+         **/
+        explicit SectorIndex(const std::string& strPathIn);
+
+
+        /** Position
+         *
+         *  Combine a sector file and start into an ordered position.
+         *
+         **/
+        static uint64_t Position(const uint32_t nFile, const uint32_t nStart)
+        {
+            return (static_cast<uint64_t>(nFile) << 32) | nStart;
+        }
+
+
+        /** GetType
+         *
+         *  Read the type string from the front of a raw record.
+         *
+         *  @param[in] vData The raw record.
+         *  @param[out] strType The type of the record.
+         *
+         *  @return True if a type string was read.
+         *
+         **/
+        static bool GetType(const std::vector<uint8_t>& vData, std::string& strType);
+
+
+        /** Load
+         *
+         *  Load the index from disk, marking the file unclean unless read-only.
+         *
+         *  @param[in] fReadonly Flag to leave the file untouched.
+         *
+         *  @return False if there was no clean index to load.
+         *
+         **/
+        bool Load(const bool fReadonly);
+
+
+        /** Save
+         *
+         *  Write the index to disk and mark it clean.
+         *
+         *  @return True if the index was written.
+         *
+         **/
+        bool Save() const;
+
+
+        /** Clear
+         *
+         *  Remove all entries before a rebuild.
+         *
+         **/
+        void Clear();
+
+
+        /** Insert
+         *
+         *  Add a record position to the entries of its type.
+         *
+         *  @param[in] strType The type of the record.
+         *  @param[in] nPosition The sector position of the record.
+         *  @param[in] fCompressed Flag for if the record is stored compressed.
+         *
+         **/
+        void Insert(const std::string& strType, const uint64_t nPosition, const bool fCompressed);
+
+
+        /** Erase
+         *
+         *  Remove a record position from whatever type holds it.
+         *
+         *  @param[in] nPosition The sector position of the record.
+         *
+         **/
+        void Erase(const uint64_t nPosition);
+
+
+        /** Next
+         *
+         *  Find the first entry for a cursor at or after its position.
+         *
+         *  @param[in] cursor The cursor to search for.
+         *  @param[out] nPosition The sector position found.
+         *  @param[out] fCompressed Flag for if the record is stored compressed.
+         *
+         *  @return True if an entry was found.
+         *
+         **/
+        bool Next(const SectorCursor& cursor, uint64_t& nPosition, bool& fCompressed) const;
+
+
+        /** Count
+         *
+         *  Get the live entries of a type.
+         *
+         **/
+        uint64_t Count(const std::string& strType) const;
+
+
+    private:
+
+        /** Compact
+         *
+         *  Drop the erased entries of a type.
+         *
+         **/
+        void Compact(const std::string& strType);
+    };
+}
+
+#endif
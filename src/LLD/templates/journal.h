@@ -0,0 +1,204 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_JOURNAL_H
+#define NEXUS_LLD_TEMPLATES_JOURNAL_H
+
+#include <LLD/templates/file.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+
+    /** The journal size that triggers a checkpoint. **/
+    const uint64_t MAX_JOURNAL_SIZE = 1024 * 1024 * 16;
+
+
+    /** The default number of commits a deferred sync may leave unsynced, set with -journalsynccommits. **/
+    const uint32_t JOURNAL_SYNC_COMMITS = 1000;
+
+
+    /** The default milliseconds a deferred sync may leave commits unsynced, set with -journalsyncms. **/
+    const uint64_t JOURNAL_SYNC_INTERVAL = 1000;
+
+
+    /** Journal
+     *
+     *  Append-only write-ahead journal for sector database transactions.
+     *
+     *  Each commit is framed with its length and checksum so a torn write at the tail is
+     *  detected and dropped on recovery. Commits are appended with Write() and made durable
+     *  with Sync(), which covers every commit written before it.
+     *
+     *  Commits are grouped under one sync by deferring it: Sync(false) only flushes once
+     *  nSyncCommits commits or nSyncInterval milliseconds have passed since the last sync.
+     *  Until then a crash can lose those commits, and the databases can hold part of them
+     *  the same as they could before the journal existed. Sync() always flushes.
+     *
+     *  A failed write or sync leaves the end of the file unknown, so every later Write() and
+     *  Sync() fails until the journal is opened again and its torn tail dropped by Read().
+     *
+     *  Records stay in the journal until a Checkpoint, after the owning databases have
+     *  flushed the changes they describe to disk.
+     *
+     **/
+    class Journal
+    {
+        /** Mutex for the file position and failed state. **/
+        std::mutex JOURNAL_MUTEX;
+
+
+        /** The journal file handle. **/
+        BinaryFile* pfile;
+
+
+        /** The binary position of the end of the journal. **/
+        uint64_t nOffset;
+
+
+        /** The binary position of the end of the last sync. **/
+        uint64_t nSynced;
+
+
+        /** The commits written since the last sync. **/
+        uint32_t nUnsynced;
+
+
+        /** The timestamp of the last sync in milliseconds. **/
+        uint64_t nLastSync;
+
+
+        /** The commits a deferred sync may leave unsynced. **/
+        const uint32_t nSyncCommits;
+
+
+        /** The milliseconds a deferred sync may leave commits unsynced. **/
+        const uint64_t nSyncInterval;
+
+
+        /** Flag to determine if a journal write or sync has failed. **/
+        bool fFailed;
+
+    public:
+
+        /** Default Constructor. **/
+        Journal() = delete;
+
+
+        /** Copy Constructor. **/
+        Journal(const Journal& journal)            = delete;
+
+
+        /** Copy Assignment. **/
+        Journal& operator=(const Journal& journal) = delete;
+
+
+        /** Open Constructor
+         *
+         *  Opens or creates the journal file.
+         *
+         *  @param[in] strPath The path to the journal file.
+         *  @param[in] nSyncCommitsIn The commits a deferred sync may leave unsynced.
+         *  @param[in] nSyncIntervalIn The milliseconds a deferred sync may leave commits unsynced.
+         *
+         **/
+        Journal(const std::string& strPath, const uint32_t nSyncCommitsIn = JOURNAL_SYNC_COMMITS,
+            const uint64_t nSyncIntervalIn = JOURNAL_SYNC_INTERVAL);
+
+
+        /** Default Destructor. **/
+        ~Journal();
+
+
+        /** IsOpen
+         *
+         *  Determines if the journal file was opened successfully.
+         *
+         **/
+        bool IsOpen() const;
+
+
+        /** Write
+         *
+         *  Append a commit to the journal. All records of the commit share a single frame,
+         *  so after a crash either every database replays it or none do.
+         *
+         *  @param[in] vRecords The database names and their serialized transaction records.
+         *
+         *  @return True if the commit was written.
+         *
+         **/
+        bool Write(const std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords);
+
+
+        /** Sync
+         *
+         *  Make every commit written so far durable, or defer it to group the commits that
+         *  follow under one sync.
+         *
+         *  @param[in] fForce Flag to sync now rather than wait for the sync limits.
+         *
+         *  @return True if the records are on stable storage, or their sync was deferred.
+         *
+         **/
+        bool Sync(const bool fForce = true);
+
+
+        /** Pending
+         *
+         *  Get the number of commits written since the last sync.
+         *
+         **/
+        uint32_t Pending();
+
+
+        /** Read
+         *
+         *  Read all valid records from the journal for recovery. Reading stops at the first
+         *  torn or corrupted record, which is overwritten by the next write.
+         *
+         *  @param[out] vRecords The database names and records in the order written, with
+         *                       the records of each commit kept together.
+         *
+         *  @return True if the journal was read.
+         *
+         **/
+        bool Read(std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords);
+
+
+        /** Size
+         *
+         *  Get the total bytes written to the journal since the last checkpoint.
+         *
+         **/
+        uint64_t Size();
+
+
+        /** Checkpoint
+         *
+         *  Clear the journal. Must only be called once every database with records in the
+         *  journal has flushed its data to disk.
+         *
+         *  @return True if the journal was cleared.
+         *
+         **/
+        bool Checkpoint();
+    };
+}
+
+#endif
@@ -159,6 +159,14 @@ namespace LLD
          **/
         bool IsTxn() const;
 
+
+        /** IsCompressed
+         *
+         *  Determines if the sector data is compressed.
+         *
+         **/
+        bool IsCompressed() const;
+
     };
 }
 
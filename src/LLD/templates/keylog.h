@@ -0,0 +1,237 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLD_TEMPLATES_KEYLOG_H
+#define NEXUS_LLD_TEMPLATES_KEYLOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace LLD
+{
+    class BinaryFile;
+
+
+    /** The version of the key log file format. **/
+    const uint8_t KEY_LOG_VERSION = 1;
+
+
+    /** KEYLOG
+     *
+     *  Types of the entries in a key log.
+     *
+     **/
+    enum KEYLOG
+    {
+        RECORD   = 1,
+        KEYCHAIN = 2,
+        INDEXED  = 3,
+        ERASED   = 4
+    };
+
+
+    /** KeyLog
+     *
+     *  Append-only log of the raw keys written to a sector database.
+     *
+     *  The keychains only keep a compressed copy of long keys, so the keys of a database can't
+     *  be listed from its keychain. The log keeps the raw keys in the order they were written,
+     *  so replaying it gives every live key of the database.
+     *
+     *  A log is complete only if it was created with an empty database. A log added to an
+     *  existing database still records new keys, but can't list the ones written before it.
+     *
+     *  A log that fails to write or sync an entry is marked incomplete for good, since it may be
+     *  missing a key. Callers don't need to check the result of Append for snapshots to stay safe.
+     *
+     *  Records updated in place keep their sector, so they aren't logged again unless the log is
+     *  tracking. A snapshot tracks while it is written, so the log lists every key changed after
+     *  the point it started from.
+     *
+     *  The log is marked unclean while open. The end of an unclean log is checked on open and
+     *  a torn entry from a crash is truncated.
+     *
+     **/
+    class KeyLog
+    {
+        /** Mutex for thread concurrency. **/
+        mutable std::mutex KEYLOG_MUTEX;
+
+
+        /** The path of the log file. **/
+        std::string strPath;
+
+
+        /** The open log file. **/
+        BinaryFile* pfile;
+
+
+        /** The end of the last entry. **/
+        uint64_t nSize;
+
+
+        /** Flag for if the log holds every key of its database. **/
+        bool fComplete;
+
+
+        /** Flag for if records updated in place are logged. **/
+        std::atomic<bool> fTracking;
+
+
+    public:
+
+        /** Default Constructor. **/
+        KeyLog() = delete;
+
+
+        /** Copy Constructor. **/
+        KeyLog(const KeyLog& log)            = delete;
+
+
+        /** Copy Assignment. **/
+        KeyLog& operator=(const KeyLog& log) = delete;
+
+
+        /** Path Constructor
+         *
+         *  @param[in] strPathIn The path of the log file.
+         *
+         **/
+        explicit KeyLog(const std::string& strPathIn);
+
+
+        /** Default Destructor. Marks the log clean. **/
+        ~KeyLog();
+
+
+        /** Open
+         *
+         *  Open the log, creating it if it doesn't exist yet.
+         *
+         *  @param[in] fEmpty Flag for if the database is empty, so a new log is complete.
+         *
+         *  @return True if the log was opened.
+         *
+         **/
+        bool Open(const bool fEmpty);
+
+
+        /** Complete
+         *
+         *  Determines if the log holds every key of its database.
+         *
+         **/
+        bool Complete() const;
+
+
+        /** Append
+         *
+         *  Add an entry to the end of the log.
+         *
+         *  @param[in] nType The type of the entry.
+         *  @param[in] vKey The raw key written.
+         *  @param[in] vIndex The raw key indexed to, for INDEXED entries.
+         *
+         *  @return True if the entry was written, the log is marked incomplete if not.
+         *
+         **/
+        bool Append(const uint8_t nType, const std::vector<uint8_t>& vKey,
+                    const std::vector<uint8_t>& vIndex = std::vector<uint8_t>());
+
+
+        /** Sync
+         *
+         *  Sync the log to disk.
+         *
+         **/
+        bool Sync();
+
+
+        /** Size
+         *
+         *  Get the end of the last entry.
+         *
+         **/
+        uint64_t Size() const;
+
+
+        /** Track
+         *
+         *  Start or stop logging records updated in place.
+         *
+         *  @param[in] fTrack Flag for if records updated in place are logged.
+         *
+         **/
+        void Track(const bool fTrack);
+
+
+        /** Tracking
+         *
+         *  Determines if records updated in place are logged.
+         *
+         **/
+        bool Tracking() const;
+
+
+        /** Read
+         *
+         *  Replay part of the log into the last entry of every key. Entries are only ever appended,
+         *  so the log keeps taking them while it is read.
+         *
+         *  @param[out] mapKeys The type and index key of every key, sorted by key.
+         *  @param[in] nBegin The offset of the first entry, 0 for the start of the log.
+         *  @param[in] nEnd The end of the last entry, 0 for the end of the log.
+         *  @param[in] fErased Flag to keep erased keys as ERASED entries rather than drop them.
+         *
+         *  @return True if the log was read.
+         *
+         **/
+        bool Read(std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>>& mapKeys,
+                  const uint64_t nBegin = 0, const uint64_t nEnd = 0, const bool fErased = false) const;
+
+
+    private:
+
+        /** Incomplete
+         *
+         *  Mark the log as no longer holding every key, on disk as well so it stays that way.
+         *  Must be called with the lock held.
+         *
+         **/
+        void Incomplete();
+
+
+        /** Scan
+         *
+         *  Visit the entries of the log in order.
+         *
+         *  @param[in] fnEntry The function called with each entry.
+         *  @param[in] nBegin The offset of the first entry.
+         *  @param[in] nLimit The offset to stop reading at.
+         *  @param[out] nEnd The end of the last whole entry.
+         *
+         *  @return True if the log could be read.
+         *
+         **/
+        bool Scan(const std::function<void(const uint8_t, std::vector<uint8_t>&, std::vector<uint8_t>&)>& fnEntry,
+                  const uint64_t nBegin, const uint64_t nLimit, uint64_t& nEnd) const;
+    };
+}
+
+#endif
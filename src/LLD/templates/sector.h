@@ -16,9 +16,14 @@ ________________________________________________________________________________
 #define NEXUS_LLD_TEMPLATES_SECTOR_H
 
 
+#include <LLD/include/compress.h>
 #include <LLD/include/enum.h>
 #include <LLD/include/version.h>
 #include <LLD/templates/key.h>
+#include <LLD/templates/file.h>
+#include <LLD/templates/index.h>
+#include <LLD/templates/journal.h>
+#include <LLD/templates/keylog.h>
 #include <LLD/templates/transaction.h>
 
 #include <LLD/cache/template_lru.h>
@@ -30,9 +35,11 @@ ________________________________________________________________________________
 #include <string>
 #include <cstdint>
 #include <atomic>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <set>
 
 namespace LLD
 {
@@ -117,8 +124,16 @@ namespace LLD
         CacheType* cachePool;
 
 
-        /* File stream object. */
-        mutable TemplateLRU<uint32_t, std::fstream*>* fileCache;
+        /* Index of record types to sector positions, null unless FLAGS::INDEX is set. */
+        SectorIndex* pIndex;
+
+
+        /* Log of the raw keys written, null unless LogKeys was called. */
+        KeyLog* pKeys;
+
+
+        /* Sector file handles. */
+        mutable TemplateLRU<uint32_t, std::shared_ptr<BinaryFile>>* fileCache;
 
 
         /* The current File Position. */
@@ -126,6 +141,10 @@ namespace LLD
         mutable uint32_t nCurrentFileSize;
 
 
+        /* Sector files written to since the last flush. */
+        std::set<uint32_t> setDirty;
+
+
         /* Cache Writer Thread. */
         std::thread CacheWriterThread;
 
@@ -178,6 +197,54 @@ namespace LLD
         void Initialize();
 
 
+        /** GetName
+         *
+         *  Get the name of the database.
+         *
+         **/
+        const std::string& GetName() const;
+
+
+        /** LogKeys
+         *
+         *  Start logging the raw keys written, so the database can be exported to a snapshot.
+         *  Has to be called before anything is written.
+         *
+         *  @return True if the key log was opened.
+         *
+         **/
+        bool LogKeys();
+
+
+        /** ReadKeys
+         *
+         *  Get the last entry of every live key from part of the key log. Reading from an offset
+         *  keeps erased keys as ERASED entries, since the log may list them before it.
+         *
+         *  @param[out] mapKeys The type and index key of every key, sorted by key.
+         *  @param[in] nBegin The offset in the key log to read from, 0 for the start.
+         *  @param[in] nEnd The offset in the key log to read to, 0 for the end.
+         *
+         *  @return False if there is no complete key log.
+         *
+         **/
+        bool ReadKeys(std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>>& mapKeys,
+                      const uint64_t nBegin = 0, const uint64_t nEnd = 0);
+
+
+        /** TrackKeys
+         *
+         *  Start or stop logging records updated in place, so the key log lists every key changed
+         *  after the offset returned.
+         *
+         *  @param[in] fTrack Flag for if records updated in place are logged.
+         *
+         *  @return The end of the key log, 0 if there is no complete key log.
+         *
+         **/
+        uint64_t TrackKeys(const bool fTrack);
+
+
         /** Exists
          *
          *  Determine if the entry identified by the given key exists.
@@ -342,90 +409,134 @@ namespace LLD
             /* Clear any remaining data. */
             vValues.clear();
 
+            /* Only visit the records of this type if they are indexed. */
+            if(pIndex)
+            {
+                SectorCursor cursor;
+                cursor.strType   = strType;
+                cursor.nPosition = SectorIndex::Position(nFile, static_cast<uint32_t>(nStart));
+
+                Type value;
+                while((nLimit == -1 || nLimit > 0) && Next(cursor, value))
+                {
+                    vValues.push_back(value);
+                    if(nLimit != -1)
+                        --nLimit;
+                }
+
+                return (vValues.size() > 0);
+            }
+
             /* Scan until limit is reached. */
             while(nLimit == -1 || nLimit > 0)
             {
-                /* Get filestream object. */
-                std::ifstream stream = std::ifstream(debug::safe_printstr(strBaseLocation, "_block.", std::setfill('0'), std::setw(5), nFile), std::ios::in | std::ios::binary);
-                if(!stream)
+                /* Get the file handle. */
+                std::shared_ptr<BinaryFile> pfile = GetFile(nFile);
+                if(!pfile)
                     break;
 
                 /* Check filesize. */
-                stream.seekg(0, std::ios::end);
-                uint64_t nFileSize = stream.tellg();
+                uint64_t nFileSize = pfile->Size();
                 uint64_t nBufferSize = (nLimit == -1) ? nFileSize : (1024 * 1024); //1 MB read buffer
-                stream.seekg(0, std::ios::beg); //reset seek position
 
-                /* Loop until stream encounters exceptions. */
-                while(stream)
+                /* Loop until the end of the file. */
+                bool fEnd = false;
+                while(!fEnd && nStart < nFileSize)
                 {
-                    /* Check that we aren't seeking past end of file. */
-                    if(nStart >= nFileSize)
-                        break;
+                    /* Don't read past the end of file. */
+                    uint64_t nRead = std::min(nBufferSize, nFileSize - nStart);
+                    fEnd = (nStart + nRead >= nFileSize);
 
                     /* Read into serialize stream. */
                     DataStream ssData(SER_LLD, DATABASE_VERSION);
-                    ssData.resize(nBufferSize);
+                    ssData.resize(nRead);
 
-                    {
-                        LOCK(SECTOR_MUTEX);
-
-                        /* Seek stream to beginning. */
-                        stream.seekg(nStart, std::ios::beg);
-
-                        /* Read the data into the buffer. */
-                        stream.read((char*)ssData.data(), nBufferSize);
-                        if(!stream)
-                            ssData.resize(stream.gcount());
+                    /* Read the data into the buffer. */
+                    if(!pfile->Read(ssData.data(), nRead, nStart))
+                        break;
 
-                        /* Iterate if meters are enabled. */
-                        nBytesRead += static_cast<uint32_t>(nBufferSize);
-                    }
+                    /* Iterate if meters are enabled. */
+                    nBytesRead += static_cast<uint32_t>(nRead);
 
                     /* Read records. */
                     while(!ssData.End())
                     {
+                        /* Get the current stream position. */
+                        const uint64_t nPos = ssData.GetPos();
+
+                        /* Read compact size. */
+                        uint64_t nSize = 0;
                         try
                         {
-                            /* Get the current stream position. */
-                            uint64_t nPos  = ssData.GetPos();
-
-                            /* Read compact size. */
-                            uint64_t nSize = ReadCompactSize(ssData);
-                            if(nSize == 0) //reached end of current file
-                                break;
-
-                            /* Deserialize the String. */
-                            std::string strThis;
-                            ssData >> strThis;
-
-                            /* Check the type. */
-                            if(strType == strThis)
-                            {
-                                /* Get the value. */
-                                Type value;
-                                ssData >> value;
-
-                                /* Push next value. */
-                                vValues.push_back(value);
-
-                                /* Check limits. */
-                                if(nLimit != -1 && --nLimit == 0)
-                                    return (vValues.size() > 0);
-                            }
-                            else
-                                ssData.SetPos(nPos + nSize + GetSizeOfCompactSize(nSize));
-
-                            /* Iterate to next position. */
-                            nStart += nSize + GetSizeOfCompactSize(nSize);
+                            nSize = ReadCompactSize(ssData);
                         }
                         catch(const std::exception& e)
                         {
-                            /* Allocate a larger buffer if full record exceeds default buffer. */
-                            nBufferSize *= 2;
+                            /* The size ran past the end of the buffer, read it again from its start. */
+                            break;
+                        }
+
+                        /* Reached end of current file. */
+                        if(nSize == 0)
+                        {
+                            fEnd = true;
+                            break;
+                        }
+
+                        /* Stop at a record torn by the end of the file. */
+                        const uint64_t nHeader = GetSizeOfCompactSize(nSize);
+                        if(nStart + nHeader + nSize > nFileSize)
+                        {
+                            fEnd = true;
+                            break;
+                        }
 
+                        /* Allocate a larger buffer if full record exceeds default buffer. */
+                        if(nPos + nHeader + nSize > ssData.size())
+                        {
+                            nBufferSize = std::max(nBufferSize * 2, nHeader + nSize);
                             break;
                         }
+
+                        /* Copy out the record and iterate to next position. */
+                        std::vector<uint8_t> vRecord(ssData.begin() + nPos + nHeader, ssData.begin() + nPos + nHeader + nSize);
+                        ssData.SetPos(nPos + nHeader + nSize);
+                        nStart += nHeader + nSize;
+
+                        /* Type strings are short, so a record opening with a raw size too big to be one was compressed. */
+                        if(vRecord[0] >= MIN_COMPRESS_SIZE)
+                        {
+                            std::vector<uint8_t> vData;
+                            if(Decompress(vRecord, vData))
+                                vRecord.swap(vData);
+                        }
+
+                        /* Check the type. */
+                        std::string strThis;
+                        if(!SectorIndex::GetType(vRecord, strThis) || strType != strThis)
+                            continue;
+
+                        try
+                        {
+                            /* Deserialize the value after the type string. */
+                            DataStream ssValue(vRecord, SER_LLD, DATABASE_VERSION);
+                            ssValue >> strThis;
+
+                            Type value;
+                            ssValue >> value;
+
+                            /* Push next value. */
+                            vValues.push_back(value);
+                        }
+                        catch(const std::exception& e)
+                        {
+                            debug::error(FUNCTION, "failed to deserialize ", strThis, ": ", e.what());
+                            continue;
+                        }
+
+                        /* Check limits. */
+                        if(nLimit != -1 && --nLimit == 0)
+                            return (vValues.size() > 0);
                     }
                 }
 
@@ -440,6 +551,109 @@ namespace LLD
         }
 
 
+        /** Seek
+         *
+         *  Position a cursor at the first record of a type.
+         *  Only available on databases opened with FLAGS::INDEX.
+         *
+         *  @param[out] cursor The cursor to position.
+         *  @param[in] strType The type, or type prefix, to iterate.
+         *  @param[in] fPrefix Flag to iterate every type starting with strType.
+         *
+         *  @return True if the cursor was positioned.
+         *
+         **/
+        bool Seek(SectorCursor& cursor, const std::string& strType, const bool fPrefix = false)
+        {
+            if(!pIndex)
+                return false;
+
+            cursor.strType   = strType;
+            cursor.fPrefix   = fPrefix;
+            cursor.nPosition = 0;
+            cursor.strFound.clear();
+
+            return true;
+        }
+
+
+        /** Seek
+         *
+         *  Position a cursor at another key's record.
+         *  Only available on databases opened with FLAGS::INDEX.
+         *
+         *  @param[out] cursor The cursor to position.
+         *  @param[in] key The key to start from.
+         *  @param[in] strType The type, or type prefix, to iterate.
+         *  @param[in] fPrefix Flag to iterate every type starting with strType.
+         *  @param[in] fExclude Flag to choose whether to exclude current key.
+         *
+         *  @return True if the key was found and the cursor positioned.
+         *
+         **/
+        template<typename Key>
+        bool Seek(SectorCursor& cursor, const Key& key, const std::string& strType,
+            const bool fPrefix = false, const bool fExclude = true)
+        {
+            if(!Seek(cursor, strType, fPrefix))
+                return false;
+
+            /* Serialize Key into Bytes. */
+            DataStream ssKey(SER_LLD, DATABASE_VERSION);
+            ssKey << key;
+
+            /* Get the key. */
+            SectorKey cKey;
+            if(!pSectorKeys->Get(ssKey.Bytes(), cKey))
+                return false;
+
+            /* Start at or just past the key's sector. */
+            cursor.nPosition = SectorIndex::Position(cKey.nSectorFile, cKey.nSectorStart) + (fExclude ? 1 : 0);
+
+            return true;
+        }
+
+
+        /** Next
+         *
+         *  Read the record at a cursor and advance it.
+         *
+         *  @param[in] cursor The cursor to read from.
+         *  @param[out] value The database entry value to read out.
+         *
+         *  @return True if a record was read, false at the end of the type.
+         *
+         **/
+        template<typename Type>
+        bool Next(SectorCursor& cursor, Type& value)
+        {
+            std::vector<uint8_t> vData;
+            while(NextRecord(cursor, vData))
+            {
+                try
+                {
+                    /* Deserialize Value. */
+                    DataStream ssValue(vData, SER_LLD, DATABASE_VERSION);
+
+                    /* Deserialize the String. */
+                    std::string strType;
+                    ssValue >> strType;
+
+                    /* Deseriazlie the Value. */
+                    ssValue >> value;
+
+                    return true;
+                }
+                catch(const std::exception& e)
+                {
+                    debug::error(FUNCTION, "failed to deserialize ", cursor.strFound, ": ", e.what());
+                }
+            }
+
+            return false;
+        }
+
+
         /** Read
          *
          *  Read a database entry identified by the given key.
@@ -569,7 +783,14 @@ namespace LLD
 
             /* Write the new sector key. */
             cKey.SetKey(vKey);
-            return pSectorKeys->Put(cKey);
+            if(!pSectorKeys->Put(cKey))
+                return false;
+
+            /* Log the index for snapshots. */
+            if(pKeys)
+                pKeys->Append(KEYLOG::INDEXED, vKey, vIndex);
+
+            return true;
         }
 
 
@@ -616,7 +837,14 @@ namespace LLD
 
             /* Return the Key existance in the Keychain Database. */
             SectorKey cKey(STATE::READY, vKey, 0, 0, 0);
-            return pSectorKeys->Put(cKey);
+            if(!pSectorKeys->Put(cKey))
+                return false;
+
+            /* Log the key for snapshots. */
+            if(pKeys)
+                pKeys->Append(KEYLOG::KEYCHAIN, vKey);
+
+            return true;
         }
 
 
@@ -672,6 +900,31 @@ namespace LLD
         }
 
 
+        /** GetFile
+         *
+         *  Get a file handle for a sector file, opening it into the file cache if needed.
+         *
+         *  @param[in] nFile The sector file number.
+         *
+         *  @return The file handle, nullptr if it couldn't be opened.
+         *
+         **/
+        std::shared_ptr<BinaryFile> GetFile(const uint32_t nFile) const;
+
+
+        /** NextRecord
+         *
+         *  Read the raw record at a cursor and advance it.
+         *
+         *  @param[in] cursor The cursor to read from.
+         *  @param[out] vData The binary data of the record, starting with its type.
+         *
+         *  @return True if a record was read, false at the end of the type.
+         *
+         **/
+        bool NextRecord(SectorCursor& cursor, std::vector<uint8_t>& vData);
+
+
         /** Get
          *
          *  Get a record from cache or from disk
@@ -751,6 +1004,28 @@ namespace LLD
         bool Delete(const std::vector<uint8_t>& vKey);
 
 
+        /** ReadSector
+         *
+         *  Read the raw record at a sector position.
+         *
+         *  @param[in] nPosition The sector position of the record.
+         *  @param[in] fCompressed Flag for if the record is stored compressed.
+         *  @param[out] vData The binary data of the record.
+         *
+         *  @return True if the record was read.
+         *
+         **/
+        bool ReadSector(const uint64_t nPosition, const bool fCompressed, std::vector<uint8_t>& vData);
+
+
+        /** Reindex
+         *
+         *  Rebuild the type index by scanning every sector file.
+         *
+         **/
+        void Reindex();
+
+
         /** CacheWriter
          *
          *  Flushes periodically data from the cache buffer to disk.
@@ -777,15 +1052,17 @@ namespace LLD
 
         /** TxnCheckpoint
          *
-         *  Write the transaction commitment message.
+         *  Add the transaction record to a coordinated commit across databases.
+         *
+         *  @param[out] vRecords The records of the commit to add to.
          *
          **/
-        bool TxnCheckpoint();
+        bool TxnCheckpoint(std::vector< std::pair<std::string, std::vector<uint8_t>> >& vRecords);
 
 
         /** TxnRelease
          *
-         *  Release the transaction checkpoint.
+         *  Release the transaction object.
          *
          **/
         void TxnRelease();
@@ -803,10 +1080,25 @@ namespace LLD
 
         /** TxnRecovery
          *
-         *  Recover a transaction from the journal.
+         *  Replay a transaction record from the journal.
+         *
+         *  @param[in] vRecord The transaction record written by TxnCheckpoint.
+         *
+         *  @return True if the transaction was replayed.
+         *
+         **/
+        bool TxnRecovery(const std::vector<uint8_t>& vRecord);
+
+
+        /** Flush
+         *
+         *  Sync the sector files written since the last flush and the keychain to disk,
+         *  so the journal records covering them can be checkpointed.
+         *
+         *  @return True if everything reached stable storage.
          *
          **/
-        bool TxnRecovery();
+        bool Flush();
 
     };
 }
@@ -191,29 +191,54 @@ namespace LLP
     template <class PacketType>
     void BaseConnection<PacketType>::WritePacket(const PacketType& PACKET)
     {
-        /* Get the bytes of the packet. */
-        const std::vector<uint8_t> vBytes = PACKET.GetBytes();
+        /* Get the header of the packet, and its data without copying it. */
+        const std::vector<uint8_t> vHeader = PACKET.GetHeader();
+        const std::vector<uint8_t>& vData  = PACKET.GetData();
+        const uint64_t nBytes = vHeader.size() + vData.size();
 
         /* Stop sending packets if send buffer is full. */
-        uint64_t nMaxSendBuffer = config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER);
-        if(Buffered() + vBytes.size() + 1024 < nMaxSendBuffer //reserve 1Kb of buffer for critical messages
-        || (fBufferFull.load() && Buffered() + vBytes.size() < nMaxSendBuffer)) //catch for critical messages (< 1 Kb)
+        if(reserve(nBytes))
         {
             /* Debug dump of message type. */
-            debug::log(4, NODE, "sent packet (", vBytes.size(), " bytes)");
+            debug::log(4, NODE, "sent packet (", nBytes, " bytes)");
 
             /* Debug dump of packet data. */
             if(config::nVerbose >= 5)
-                PrintHex(vBytes);
+                PrintHex(PACKET.GetBytes());
 
-            /* Write the packet to socket buffer. */
-            Write(vBytes, vBytes.size());
+            /* Write the header and data to socket buffer in one send. */
+            Write(vHeader, vData);
+
+            /* Update packet count. */
+            ++PACKETS;
+        }
+
+        /* Notify condition if available. */
+        if(FLUSH_CONDITION && Buffered())
+            FLUSH_CONDITION->notify_all();
+    }
+
+
+    /*  Write a packet that was framed once for many connections to the TCP stream. */
+    template <class PacketType>
+    void BaseConnection<PacketType>::WritePacket(const std::shared_ptr<std::vector<uint8_t>>& pBytes)
+    {
+        /* Stop sending packets if send buffer is full. */
+        if(reserve(pBytes->size()))
+        {
+            /* Debug dump of message type. */
+            debug::log(4, NODE, "sent relay packet (", pBytes->size(), " bytes)");
+
+            /* Debug dump of packet data. */
+            if(config::nVerbose >= 5)
+                PrintHex(*pBytes);
+
+            /* Write the shared bytes to socket buffer. */
+            Write(pBytes);
 
             /* Update packet count. */
             ++PACKETS;
         }
-        else //set buffer to full
-            fBufferFull.store(true);
 
         /* Notify condition if available. */
         if(FLUSH_CONDITION && Buffered())
@@ -287,6 +312,22 @@ namespace LLP
     }
 
 
+    /* Checks that the send buffer has room for a packet, flagging the buffer full if not. */
+    template <class PacketType>
+    bool BaseConnection<PacketType>::reserve(const uint64_t nBytes)
+    {
+        uint64_t nMaxSendBuffer = config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER);
+        if(Buffered() + nBytes + 1024 < nMaxSendBuffer //reserve 1Kb of buffer for critical messages
+        || (fBufferFull.load() && Buffered() + nBytes < nMaxSendBuffer)) //catch for critical messages (< 1 Kb)
+            return true;
+
+        /* Set buffer to full. */
+        fBufferFull.store(true);
+
+        return false;
+    }
+
+
     /* Explicity instantiate all template instances needed for compiler. */
     template class BaseConnection<Packet>;
     template class BaseConnection<MessagePacket>;
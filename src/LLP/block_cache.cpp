@@ -0,0 +1,333 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/include/block_cache.h>
+
+#include <LLD/templates/sector.h>
+#include <LLD/cache/binary_lru.h>
+#include <LLD/keychain/hashmap.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+
+#include <atomic>
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace LLP
+{
+
+    namespace BlockCache
+    {
+
+        /* The key of a packet, by block hash and specifier. */
+        typedef std::pair<uint1024_t, uint8_t> Key;
+
+
+        /* A packet in memory with its place in the recently used list. */
+        struct Entry
+        {
+            /* The serialized packet. */
+            std::shared_ptr<std::vector<uint8_t>> pPacket;
+
+            /* The place of the key in the recently used list. */
+            std::list<Key>::iterator it;
+        };
+
+
+        /* Mutex for thread concurrency. */
+        std::mutex CACHE_MUTEX;
+
+
+        /* The packets in memory. */
+        std::map<Key, Entry> mapPackets;
+
+
+        /* The keys in memory, most recently used first. */
+        std::list<Key> listRecent;
+
+
+        /* The total bytes of the packets in memory. */
+        uint64_t nBytes = 0;
+
+
+        /* A generation of packets on disk, its directory is removed once it is retired and no longer used. */
+        struct Generation
+        {
+            /* The database of packets. */
+            std::unique_ptr<LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>> pDatabase;
+
+            /* The number of the generation, which names its directory. */
+            uint32_t nGeneration;
+
+            /* The bytes of the packets written to the generation. */
+            std::atomic<uint64_t> nBytes;
+
+            /* Flag to remove the generation from disk once the last user lets it go. */
+            std::atomic<bool> fRetired;
+
+
+            /* Open the database of a generation. */
+            explicit Generation(const uint32_t nGenerationIn)
+            : pDatabase   ( )
+            , nGeneration (nGenerationIn)
+            , nBytes      (0)
+            , fRetired    (false)
+            {
+                pDatabase.reset(new LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+                    (debug::safe_printstr("_BLOCKCACHE/", nGeneration), LLD::FLAGS::CREATE | LLD::FLAGS::WRITE, 77773, 1024 * 1024));
+
+                /* Pick up the size written before a restart. */
+                uint64_t nSize = 0;
+                if(pDatabase->Read(std::string("bytes"), nSize))
+                    nBytes.store(nSize);
+            }
+
+
+            /* Close the database, removing it if retired. */
+            ~Generation()
+            {
+                pDatabase.reset();
+
+                if(fRetired.load())
+                    filesystem::remove_directories(debug::safe_printstr(config::GetDataDir(), "_BLOCKCACHE/", nGeneration, "/"));
+            }
+        };
+
+
+        /* The generation packets are written to, and the one before it. */
+        std::shared_ptr<Generation> pCurrent;
+        std::shared_ptr<Generation> pPrevious;
+
+
+        /* Flag to indicate the generations were opened or failed to open. */
+        bool fDatabase = false;
+
+
+        /* The path of the file holding the current generation. */
+        std::string GenerationPath()
+        {
+            return config::GetDataDir() + "_BLOCKCACHE/generation";
+        }
+
+
+        /* Open the current and previous generations on first use with -blockcachedisk. Must be called with CACHE_MUTEX held. */
+        void open()
+        {
+            if(fDatabase || !config::GetBoolArg("-blockcachedisk", false))
+                return;
+
+            fDatabase = true;
+
+            try
+            {
+                /* Find the current generation. */
+                uint32_t nGeneration = 1;
+                {
+                    std::ifstream stream(GenerationPath());
+                    if(stream)
+                        stream >> nGeneration;
+                }
+
+                pCurrent = std::make_shared<Generation>(nGeneration);
+                if(nGeneration > 1)
+                    pPrevious = std::make_shared<Generation>(nGeneration - 1);
+
+                /* Record the generation in case it is new. */
+                filesystem::create_directories(config::GetDataDir() + "_BLOCKCACHE/");
+                std::ofstream stream(GenerationPath(), std::ios::out | std::ios::trunc);
+                stream << nGeneration;
+            }
+            catch(const std::exception& e)
+            {
+                pCurrent.reset();
+                pPrevious.reset();
+
+                debug::error(FUNCTION, "failed to open block cache: ", e.what());
+            }
+        }
+
+
+        /* Start a new generation once the current one holds its half of -blockcachedisksize. The oldest is retired. */
+        void rotate(const std::shared_ptr<Generation>& pFull)
+        {
+            const uint64_t nLimit = config::GetArg("-blockcachedisksize", DEFAULT_BLOCK_CACHE_DISK) * 1024 * 1024;
+            if(pFull->nBytes.load() < nLimit / 2)
+                return;
+
+            LOCK(CACHE_MUTEX);
+
+            /* Check another writer didn't rotate first. */
+            if(pCurrent != pFull)
+                return;
+
+            try
+            {
+                const uint32_t nGeneration = pCurrent->nGeneration + 1;
+                std::shared_ptr<Generation> pNext = std::make_shared<Generation>(nGeneration);
+
+                /* The oldest generation is removed from disk once the last reader lets it go. */
+                if(pPrevious)
+                    pPrevious->fRetired.store(true);
+
+                pPrevious = pCurrent;
+                pCurrent  = pNext;
+
+                std::ofstream stream(GenerationPath(), std::ios::out | std::ios::trunc);
+                stream << nGeneration;
+
+                debug::log(2, FUNCTION, "block cache moved to generation ", nGeneration);
+            }
+            catch(const std::exception& e)
+            {
+                debug::error(FUNCTION, "failed to start a new block cache generation: ", e.what());
+            }
+        }
+
+
+        /* Write a packet to a generation, starting a new one when it is full. */
+        void write(const std::shared_ptr<Generation>& pDisk, const Key& key, const std::vector<uint8_t>& vPacket)
+        {
+            if(!pDisk->pDatabase->Write(key, vPacket))
+            {
+                debug::error(FUNCTION, "failed to write block ", key.first.SubString(), " to disk");
+                return;
+            }
+
+            /* Keep the size with the packets so it survives a restart. */
+            const uint64_t nSize = (pDisk->nBytes += vPacket.size());
+            pDisk->pDatabase->Write(std::string("bytes"), nSize);
+
+            rotate(pDisk);
+        }
+
+
+        /* Add a packet to memory, removing the least recently used over the limit. Must be called with CACHE_MUTEX held. */
+        void insert(const Key& key, const std::shared_ptr<std::vector<uint8_t>>& pPacket)
+        {
+            /* Check that the cache is enabled. */
+            const uint64_t nLimit = config::GetArg("-blockcache", DEFAULT_BLOCK_CACHE) * 1024 * 1024;
+            if(nLimit == 0 || mapPackets.count(key))
+                return;
+
+            /* Add the packet as most recently used. */
+            listRecent.push_front(key);
+            mapPackets[key] = { pPacket, listRecent.begin() };
+            nBytes += pPacket->size();
+
+            /* Remove the least recently used packets over the limit. */
+            while(nBytes > nLimit && !listRecent.empty())
+            {
+                auto it = mapPackets.find(listRecent.back());
+                nBytes -= it->second.pPacket->size();
+
+                mapPackets.erase(it);
+                listRecent.pop_back();
+            }
+        }
+
+
+        /* Get the packet of a block from the cache. */
+        bool Get(const uint1024_t& hashBlock, const uint8_t nSpecifier, std::shared_ptr<std::vector<uint8_t>>& pPacket)
+        {
+            const Key key = std::make_pair(hashBlock, nSpecifier);
+
+            /* Check memory, moving the packet to the front of the recently used list. */
+            std::shared_ptr<Generation> pDisk, pOld;
+            {
+                LOCK(CACHE_MUTEX);
+
+                auto it = mapPackets.find(key);
+                if(it != mapPackets.end())
+                {
+                    listRecent.splice(listRecent.begin(), listRecent, it->second.it);
+                    pPacket = it->second.pPacket;
+
+                    return true;
+                }
+
+                open();
+                pDisk = pCurrent;
+                pOld  = pPrevious;
+            }
+
+            /* Check disk without holding up the memory cache. */
+            if(!pDisk)
+                return false;
+
+            std::vector<uint8_t> vPacket;
+            if(!pDisk->pDatabase->Read(key, vPacket))
+            {
+                /* Carry a packet still in use forward from the previous generation. */
+                if(!pOld || !pOld->pDatabase->Read(key, vPacket))
+                    return false;
+
+                write(pDisk, key, vPacket);
+            }
+
+            /* Keep the packet in memory for the next peer. */
+            pPacket = std::make_shared<std::vector<uint8_t>>(std::move(vPacket));
+            {
+                LOCK(CACHE_MUTEX);
+                insert(key, pPacket);
+            }
+
+            return true;
+        }
+
+
+        /* Add the packet of a block to the cache. */
+        void Put(const uint1024_t& hashBlock, const uint8_t nSpecifier, const std::shared_ptr<std::vector<uint8_t>>& pPacket)
+        {
+            const Key key = std::make_pair(hashBlock, nSpecifier);
+
+            std::shared_ptr<Generation> pDisk;
+            {
+                LOCK(CACHE_MUTEX);
+
+                /* A packet already in memory is already on disk. */
+                if(mapPackets.count(key))
+                    return;
+
+                insert(key, pPacket);
+
+                open();
+                pDisk = pCurrent;
+            }
+
+            /* Write through to disk without holding up the memory cache. */
+            if(pDisk)
+                write(pDisk, key, *pPacket);
+        }
+
+
+        /* Clear the cache and close the database on disk. */
+        void Shutdown()
+        {
+            LOCK(CACHE_MUTEX);
+
+            mapPackets.clear();
+            listRecent.clear();
+            nBytes = 0;
+
+            pCurrent.reset();
+            pPrevious.reset();
+            fDatabase = false;
+        }
+    }
+}
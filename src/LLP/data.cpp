@@ -12,6 +12,7 @@
 ____________________________________________________________________________________________*/
 
 #include <LLP/include/base_address.h>
+#include <LLP/include/timer_wheel.h>
 #include <LLP/templates/data.h>
 
 #include <LLP/templates/socket.h>
@@ -25,6 +26,15 @@ ________________________________________________________________________________
 
 #include <Util/include/hex.h>
 
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
 
 namespace LLP
 {
@@ -35,6 +45,8 @@ namespace LLP
                                          uint32_t rScore, uint32_t cScore,
                                          uint32_t nTimeout, bool fMeter)
     : SLOT_MUTEX      ( )
+    , vGenerations    ( )
+    , nGeneration     (0)
     , fDDOS           (ffDDOSIn)
     , fMETER          (fMeter)
     , fDestruct       (false)
@@ -95,6 +107,25 @@ namespace LLP
      *  LLP Messaging Thread. */
     template <class ProtocolType>
     void DataThread<ProtocolType>::Thread()
+    {
+    #ifdef __linux__
+
+        /* Use epoll unless polling every socket was asked for. */
+        if(!config::GetBoolArg("-llppoll", false))
+        {
+            epoll_loop();
+            return;
+        }
+
+    #endif
+
+        poll_loop();
+    }
+
+
+    /* Polls every socket and checks every connection on each pass. */
+    template <class ProtocolType>
+    void DataThread<ProtocolType>::poll_loop()
     {
         /* Cache sleep time if applicable. */
         uint32_t nSleep = config::GetArg("-llpsleep", 0);
@@ -184,128 +215,351 @@ namespace LLP
 
             /* Check all connections for data and packets. */
             for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
+                check(nIndex, POLLFDS.at(nIndex).revents);
+        }
+    }
+
+
+#ifdef __linux__
+
+    /* Waits on an edge-triggered epoll set and only checks the connections with new data,
+     * plus idle connections once per interval from a timer wheel. */
+    template <class ProtocolType>
+    void DataThread<ProtocolType>::epoll_loop()
+    {
+        /* Cache sleep time if applicable. */
+        uint32_t nSleep = config::GetArg("-llpsleep", 0);
+
+        /* Cache the ticks between checks of an idle connection (for timeouts and generic events). */
+        const uint64_t nInterval = std::max(int64_t(1), config::GetArg("-llpinterval", 100) / WHEEL_RESOLUTION);
+
+        /* Create the epoll set, falling back to poll if the kernel doesn't give us one. */
+        int32_t nEpoll = epoll_create1(EPOLL_CLOEXEC);
+        if(nEpoll < 0)
+        {
+            debug::error(FUNCTION, "epoll_create1 failed: ", strerror(errno), "; falling back to poll");
+
+            poll_loop();
+            return;
+        }
+
+        /* The mutex for the condition. */
+        std::mutex CONDITION_MUTEX;
+
+        /* The events returned by each wait. */
+        std::vector<epoll_event> vEvents(256);
+
+        /* The generation of the connection registered in each slot, and the last generation registered. */
+        std::vector<uint32_t> vRegistered;
+        uint32_t nRegistered = 0;
+
+        /* Slots to check on this pass, with the poll events signaled for them.
+         * Edge-triggered sockets only signal new data once, so a slot stays ready until it is read dry.
+         */
+        std::vector<uint32_t> vReady;
+        std::vector<uint8_t>  vQueued;
+        std::vector<int16_t>  vSignaled;
+
+        /* Timer wheel of slots to check while idle. */
+        TimerWheel wheel(runtime::timestamp(true) / WHEEL_RESOLUTION);
+
+        /* The main connection handler loop. */
+        while(!fDestruct.load() && !config::fShutdown.load())
+        {
+            /* Check for data thread sleep (helps with cpu usage). */
+            if(nSleep > 0)
+                runtime::sleep(nSleep);
+
+            /* Keep data threads waiting for work. */
             {
-                try
+                std::unique_lock<std::mutex> CONDITION_LOCK(CONDITION_MUTEX);
+                CONDITION.wait(CONDITION_LOCK,
+                [this]
                 {
-                    /* Load the atomic pointer raw data. */
-                    ProtocolType* CONNECTION = CONNECTIONS->at(nIndex).load();
+                    return fDestruct.load()
+                    || config::fShutdown.load()
+                    || nIncoming.load() > 0
+                    || nOutbound.load() > 0;
+                });
+            }
 
-                    /* Skip over Inactive Connections. */
-                    if(!CONNECTION || !CONNECTION->Connected())
-                        continue;
+            /* Check for close. */
+            if(fDestruct.load() || config::fShutdown.load())
+                break;
 
-                    /* Disconnect if there was a polling error */
-                    if(POLLFDS.at(nIndex).revents & POLLERR)
-                    {
-                         disconnect_remove_event(nIndex, DISCONNECT::POLL_ERROR);
-                         continue;
-                    }
+            /* Skip the turns of the wheel missed while waiting for connections. */
+            wheel.Skip(runtime::timestamp(true) / WHEEL_RESOLUTION);
 
-                    /* Disconnect if the socket was disconnected by peer (need for Windows) */
-                    if(POLLFDS.at(nIndex).revents & POLLHUP)
-                    {
-                        disconnect_remove_event(nIndex, DISCONNECT::PEER);
-                        continue;
-                    }
+            /* Register the sockets of connections added since the last pass.
+             * Sockets leave the set on their own when a removed connection closes them.
+             */
+            if(nGeneration.load() != nRegistered)
+            {
+                LOCK(SLOT_MUTEX);
 
-                    /* Remove Connection if it has Timed out or had any read/write Errors. */
-                    if(CONNECTION->Errors())
-                    {
-                        disconnect_remove_event(nIndex, DISCONNECT::ERRORS);
-                        continue;
-                    }
+                nRegistered = nGeneration.load();
 
-                    /* Remove Connection if it has Timed out or had any Errors. */
-                    if(CONNECTION->Timeout(TIMEOUT * 1000, Socket::READ))
-                    {
-                        disconnect_remove_event(nIndex, DISCONNECT::TIMEOUT);
+                /* Size the slot state to the connections. */
+                const uint32_t nSize = static_cast<uint32_t>(CONNECTIONS->size());
+                if(vRegistered.size() < nSize)
+                {
+                    vRegistered.resize(nSize, 0);
+                    vQueued.resize(nSize, 0);
+                    vSignaled.resize(nSize, 0);
+                }
+
+                for(uint32_t nIndex = 0; nIndex < nSize && nIndex < vGenerations.size(); ++nIndex)
+                {
+                    /* Skip slots that kept the same connection. */
+                    if(vGenerations[nIndex] == vRegistered[nIndex])
                         continue;
-                    }
 
-                    /* Disconnect if pollin signaled with no data (This happens on Linux). */
-                    if((POLLFDS.at(nIndex).revents & POLLIN)
-                    && CONNECTION->Available() == 0 && !CONNECTION->IsSSL())
-                    {
-                        disconnect_remove_event(nIndex, DISCONNECT::POLL_EMPTY);
+                    /* Skip slots that were emptied again. */
+                    ProtocolType* CONNECTION = CONNECTIONS->at(nIndex).load();
+                    if(!CONNECTION)
                         continue;
-                    }
 
-                    /* Disconnect if buffer is full and remote host isn't reading at all. */
-                    if(CONNECTION->Buffered()
-                    && CONNECTION->Timeout(15000, Socket::WRITE))
+                    /* Tag the events with the slot and generation, to drop events of an older connection. */
+                    vRegistered[nIndex] = vGenerations[nIndex];
+
+                    epoll_event event;
+                    event.events   = EPOLLIN | EPOLLRDHUP | EPOLLET;
+                    event.data.u64 = (uint64_t(vRegistered[nIndex]) << 32) | nIndex;
+
+                    /* The timer wheel still checks the connection if it can't be registered. */
+                    if(epoll_ctl(nEpoll, EPOLL_CTL_ADD, CONNECTION->fd, &event) < 0
+                    && (errno != EEXIST || epoll_ctl(nEpoll, EPOLL_CTL_MOD, CONNECTION->fd, &event) < 0))
+                        debug::error(FUNCTION, "epoll_ctl failed: ", strerror(errno));
+
+                    /* Check the new connection now, since it may have data from before it was registered. */
+                    vSignaled[nIndex] = 0;
+                    if(!vQueued[nIndex])
                     {
-                        disconnect_remove_event(nIndex, DISCONNECT::TIMEOUT_WRITE);
-                        continue;
+                        vQueued[nIndex] = 1;
+                        vReady.push_back(nIndex);
                     }
 
-                    /* Check that write buffers aren't overflowed. */
-                    if(CONNECTION->Buffered() > config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER))
+                    /* Schedule the idle checks. */
+                    wheel.Schedule(nIndex, wheel.Tick() + nInterval);
+                }
+            }
+
+            /* Wait until the next idle check is due, without waiting if any sockets have data left. */
+            const uint64_t nNow = runtime::timestamp(true);
+
+            int32_t nWait = 100;
+            uint64_t nNext = 0;
+            if(!vReady.empty())
+                nWait = 0;
+            else if(wheel.Next((nNow + 100 + WHEEL_RESOLUTION - 1) / WHEEL_RESOLUTION, nNext))
+                nWait = static_cast<int32_t>(nNext * WHEEL_RESOLUTION > nNow ? nNext * WHEEL_RESOLUTION - nNow : 0);
+
+            int32_t nEvents = epoll_wait(nEpoll, vEvents.data(), static_cast<int32_t>(vEvents.size()), nWait);
+            if(nEvents < 0)
+            {
+                if(errno != EINTR)
+                    runtime::sleep(1);
+
+                continue;
+            }
+
+            /* Queue the slots with new events. */
+            for(int32_t nEvent = 0; nEvent < nEvents; ++nEvent)
+            {
+                const uint32_t nIndex = static_cast<uint32_t>(vEvents[nEvent].data.u64);
+                const uint32_t nTag   = static_cast<uint32_t>(vEvents[nEvent].data.u64 >> 32);
+
+                /* Skip events of a connection that has since left the slot. */
+                if(nIndex >= vRegistered.size() || vRegistered[nIndex] != nTag)
+                    continue;
+
+                /* Only a peer hangup counts as pollin for the empty socket check, since an edge
+                 * can arrive for data that was already read on an earlier pass. */
+                const uint32_t nFlags = vEvents[nEvent].events;
+                if(nFlags & EPOLLERR)
+                    vSignaled[nIndex] |= POLLERR;
+
+                if(nFlags & EPOLLHUP)
+                    vSignaled[nIndex] |= POLLHUP;
+
+                if(nFlags & EPOLLRDHUP)
+                    vSignaled[nIndex] |= POLLIN;
+
+                if(!vQueued[nIndex])
+                {
+                    vQueued[nIndex] = 1;
+                    vReady.push_back(nIndex);
+                }
+            }
+
+            /* Check the ready connections, keeping those with data left for the next pass. */
+            std::vector<uint32_t> vCheck;
+            vCheck.swap(vReady);
+            for(const uint32_t nIndex : vCheck)
+            {
+                const int16_t nSignaled = vSignaled[nIndex];
+                vSignaled[nIndex] = 0;
+                vQueued[nIndex]   = 0;
+
+                if(!check(nIndex, nSignaled))
+                    continue;
+
+                try
+                {
+                    /* Keep a hangup signaled until the data before it is read. */
+                    if(CONNECTIONS->at(nIndex)->Available() > 0)
                     {
-                        disconnect_remove_event(nIndex, DISCONNECT::BUFFER);
-                        continue;
+                        vSignaled[nIndex] = (nSignaled & POLLIN);
+                        vQueued[nIndex]   = 1;
+                        vReady.push_back(nIndex);
                     }
+                }
+                catch(const std::exception& e) { }
+            }
 
-                    /* Handle any DDOS Filters. */
-                    if(fDDOS && CONNECTION->DDOS)
-                    {
-                        /* Ban a node if it has too many Requests per Second. **/
-                        if(CONNECTION->DDOS->rSCORE.Score() > DDOS_rSCORE
-                        || CONNECTION->DDOS->cSCORE.Score() > DDOS_cSCORE)
-                            CONNECTION->DDOS->Ban();
+            /* Check the idle connections that are due, catching up at most one turn of the wheel. */
+            std::vector<uint32_t> vExpired;
+            wheel.Expire(runtime::timestamp(true) / WHEEL_RESOLUTION, vExpired);
 
-                        /* Remove a connection if it was banned by DDOS Protection. */
-                        if(CONNECTION->DDOS->Banned())
-                        {
-                            debug::log(0, ProtocolType::Name(), " BANNED: ", CONNECTION->GetAddress().ToString());
-                            disconnect_remove_event(nIndex, DISCONNECT::DDOS);
-                            continue;
-                        }
-                    }
+            /* Schedule the next check while the connection stays active. */
+            for(const uint32_t nIndex : vExpired)
+                if(check(nIndex, 0))
+                    wheel.Schedule(nIndex, wheel.Tick() + nInterval);
+        }
 
-                    /* Generic event for Connection. */
-                    CONNECTION->Event(EVENTS::GENERIC);
+        close(nEpoll);
+    }
 
-                    /* Work on Reading a Packet. **/
-                    CONNECTION->ReadPacket();
+#endif
 
-                    /* If a Packet was received successfully, increment request count [and DDOS count if enabled]. */
-                    if(CONNECTION->PacketComplete())
-                    {
-                        /* Debug dump of message type. */
-                        if(config::nVerbose.load() >= 4)
-                            debug::log(4, FUNCTION, "Received Message (", CONNECTION->INCOMING.GetBytes().size(), " bytes)");
 
-                        /* Debug dump of packet data. */
-                        if(config::nVerbose.load() >= 5)
-                            PrintHex(CONNECTION->INCOMING.GetBytes());
+    /* Checks a connection for errors, timeouts and DDOS, fires its generic event, and reads and processes a packet. */
+    template <class ProtocolType>
+    bool DataThread<ProtocolType>::check(uint32_t nIndex, int16_t nEvents)
+    {
+        try
+        {
+            /* Load the atomic pointer raw data. */
+            ProtocolType* CONNECTION = CONNECTIONS->at(nIndex).load();
 
-                        /* Handle Meters and DDOS. */
-                        if(fMETER)
-                            ++ProtocolType::REQUESTS;
+            /* Skip over Inactive Connections. */
+            if(!CONNECTION || !CONNECTION->Connected())
+                return false;
 
-                        /* Increment rScore. */
-                        if(fDDOS && CONNECTION->DDOS)
-                            CONNECTION->DDOS->rSCORE += 1;
+            /* Disconnect if there was a polling error */
+            if(nEvents & POLLERR)
+            {
+                 disconnect_remove_event(nIndex, DISCONNECT::POLL_ERROR);
+                 return false;
+            }
 
-                        /* Packet Process return value of False will flag Data Thread to Disconnect. */
-                        if(!CONNECTION->ProcessPacket())
-                        {
-                            disconnect_remove_event(nIndex, DISCONNECT::FORCE);
-                            continue;
-                        }
+            /* Disconnect if the socket was disconnected by peer (need for Windows) */
+            if(nEvents & POLLHUP)
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::PEER);
+                return false;
+            }
 
-                        /* Run procssed event for connection triggers. */
-                        CONNECTION->Event(EVENTS::PROCESSED);
-                        CONNECTION->ResetPacket();
-                    }
+            /* Remove Connection if it has Timed out or had any read/write Errors. */
+            if(CONNECTION->Errors())
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::ERRORS);
+                return false;
+            }
+
+            /* Remove Connection if it has Timed out or had any Errors. */
+            if(CONNECTION->Timeout(TIMEOUT * 1000, Socket::READ))
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::TIMEOUT);
+                return false;
+            }
+
+            /* Disconnect if pollin signaled with no data (This happens on Linux). */
+            if((nEvents & POLLIN)
+            && CONNECTION->Available() == 0 && !CONNECTION->IsSSL())
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::POLL_EMPTY);
+                return false;
+            }
+
+            /* Disconnect if buffer is full and remote host isn't reading at all. */
+            if(CONNECTION->Buffered()
+            && CONNECTION->Timeout(15000, Socket::WRITE))
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::TIMEOUT_WRITE);
+                return false;
+            }
+
+            /* Check that write buffers aren't overflowed. */
+            if(CONNECTION->Buffered() > config::GetArg("-maxsendbuffer", MAX_SEND_BUFFER))
+            {
+                disconnect_remove_event(nIndex, DISCONNECT::BUFFER);
+                return false;
+            }
+
+            /* Handle any DDOS Filters. */
+            if(fDDOS && CONNECTION->DDOS)
+            {
+                /* Ban a node if it has too many Requests per Second. **/
+                if(CONNECTION->DDOS->rSCORE.Score() > DDOS_rSCORE
+                || CONNECTION->DDOS->cSCORE.Score() > DDOS_cSCORE)
+                    CONNECTION->DDOS->Ban();
+
+                /* Remove a connection if it was banned by DDOS Protection. */
+                if(CONNECTION->DDOS->Banned())
+                {
+                    debug::log(0, ProtocolType::Name(), " BANNED: ", CONNECTION->GetAddress().ToString());
+                    disconnect_remove_event(nIndex, DISCONNECT::DDOS);
+                    return false;
                 }
-                catch(const std::exception& e)
+            }
+
+            /* Generic event for Connection. */
+            CONNECTION->Event(EVENTS::GENERIC);
+
+            /* Work on Reading a Packet. **/
+            CONNECTION->ReadPacket();
+
+            /* If a Packet was received successfully, increment request count [and DDOS count if enabled]. */
+            if(CONNECTION->PacketComplete())
+            {
+                /* Debug dump of message type. */
+                if(config::nVerbose.load() >= 4)
+                    debug::log(4, FUNCTION, "Received Message (", CONNECTION->INCOMING.GetBytes().size(), " bytes)");
+
+                /* Debug dump of packet data. */
+                if(config::nVerbose.load() >= 5)
+                    PrintHex(CONNECTION->INCOMING.GetBytes());
+
+                /* Handle Meters and DDOS. */
+                if(fMETER)
+                    ++ProtocolType::REQUESTS;
+
+                /* Increment rScore. */
+                if(fDDOS && CONNECTION->DDOS)
+                    CONNECTION->DDOS->rSCORE += 1;
+
+                /* Packet Process return value of False will flag Data Thread to Disconnect. */
+                if(!CONNECTION->ProcessPacket())
                 {
-                    debug::error(FUNCTION, "Data Connection: ", e.what());
-                    disconnect_remove_event(nIndex, DISCONNECT::ERRORS);
+                    disconnect_remove_event(nIndex, DISCONNECT::FORCE);
+                    return false;
                 }
+
+                /* Run procssed event for connection triggers. */
+                CONNECTION->Event(EVENTS::PROCESSED);
+                CONNECTION->ResetPacket();
             }
         }
+        catch(const std::exception& e)
+        {
+            debug::error(FUNCTION, "Data Connection: ", e.what());
+            disconnect_remove_event(nIndex, DISCONNECT::ERRORS);
+
+            return false;
+        }
+
+        return true;
     }
 
 
@@ -368,28 +622,44 @@ namespace LLP
                 RELAY->pop();
             }
 
+            /* Frame the relay once, to be written by reference to every connection that takes all of it. */
+            std::shared_ptr<std::vector<uint8_t>> pRelay;
+            if(qRelay.second.size() != 0)
+            {
+                typename ProtocolType::packet_t PACKET = typename ProtocolType::packet_t(qRelay.first);
+                PACKET.SetData(qRelay.second);
+
+                pRelay = std::make_shared<std::vector<uint8_t>>(PACKET.GetBytes());
+            }
+
             /* Check all connections for data and packets. */
             uint32_t nSize = CONNECTIONS->size();
             for(uint32_t nIndex = 0; nIndex < nSize; ++nIndex)
             {
                 try
                 {
-                    /* Reset stream read position. */
-                    qRelay.second.Reset();
-
                     /* Get atomic pointer to reduce locking around CONNECTIONS scope. */
                     memory::atomic_ptr<ProtocolType>& CONNECTION = CONNECTIONS->at(nIndex);
 
                     /* Relay if there are active subscriptions. */
-                    const DataStream ssRelay = CONNECTION->RelayFilter(qRelay.first, qRelay.second);
-                    if(ssRelay.size() != 0)
+                    if(pRelay)
                     {
-                        /* Build the sender packet. */
-                        typename ProtocolType::packet_t PACKET = typename ProtocolType::packet_t(qRelay.first);
-                        PACKET.SetData(ssRelay);
+                        /* Reset stream read position. */
+                        qRelay.second.Reset();
+
+                        /* Write the shared packet, or build one with only the subscribed data. */
+                        DataStream ssRelay(SER_NETWORK, MIN_PROTO_VERSION);
+                        if(CONNECTION->RelayFilter(qRelay.first, qRelay.second, ssRelay))
+                            CONNECTION->WritePacket(pRelay);
+                        else if(ssRelay.size() != 0)
+                        {
+                            /* Build the sender packet. */
+                            typename ProtocolType::packet_t PACKET = typename ProtocolType::packet_t(qRelay.first);
+                            PACKET.SetData(ssRelay);
 
-                        /* Write packet to socket. */
-                        CONNECTION->WritePacket(PACKET);
+                            /* Write packet to socket. */
+                            CONNECTION->WritePacket(PACKET);
+                        }
                     }
 
                     /* Attempt to flush data when buffer is available. */
@@ -0,0 +1,462 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/include/download.h>
+
+#include <LLD/include/global.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/checkpoints.h>
+#include <TAO/Ledger/include/timelocks.h>
+#include <TAO/Ledger/types/client.h>
+#include <TAO/Ledger/types/state.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace LLP
+{
+
+    namespace Download
+    {
+
+        /* A queued header waiting for its block body. */
+        struct Entry
+        {
+            /* The hash of the block. */
+            uint1024_t hashBlock;
+
+            /* The height of the block. */
+            uint32_t nHeight;
+
+            /* The session the body was requested from, zero if unassigned. */
+            uint64_t nSession;
+
+            /* The session that last failed to deliver the body. */
+            uint64_t nFailed;
+
+            /* The time the body was last requested or received. */
+            uint64_t nTime;
+
+            /* Flag to indicate the body was received. */
+            bool fReceived;
+        };
+
+
+        /* The requests of a single peer. */
+        struct Peer
+        {
+            /* The block bodies in flight. */
+            uint32_t nInFlight;
+
+            /* The time in milliseconds the queue was last scanned for this peer. */
+            uint64_t nLastScan;
+        };
+
+
+        /* Mutex for thread concurrency. */
+        std::mutex DOWNLOAD_MUTEX;
+
+
+        /* Flag to indicate a download is running. */
+        std::atomic<bool> fActive(false);
+
+
+        /* The headers that haven't connected, in height order. */
+        std::deque<Entry> queue;
+
+
+        /* The requests of each peer, by session-id. */
+        std::map<uint64_t, Peer> mapPeers;
+
+
+        /* The sessions that were asked for block bodies. */
+        std::set<uint64_t> setSessions;
+
+
+        /* The last header queued, or the block the download started from. */
+        uint1024_t hashLastHeader = 0;
+
+
+        /* The height of the last header. */
+        uint32_t nLastHeight = 0;
+
+
+        /* The last header when headers were last requested. */
+        uint1024_t hashRequested = 0;
+
+
+        /* Flag to indicate headers were requested and not all received. */
+        bool fHeadersRequested = false;
+
+
+        /* Flag to indicate the sync node has no more headers. */
+        bool fHeadersDone = false;
+
+
+        /* The height of the last header found to be an ancestor of a hardcoded checkpoint. */
+        uint32_t nLastAssumed = 0;
+
+
+        /* Take a body off a peer's requests. Must hold DOWNLOAD_MUTEX. */
+        void unassign(Entry& entry)
+        {
+            if(entry.nSession == 0)
+                return;
+
+            /* Decrement the peer's requests. */
+            auto it = mapPeers.find(entry.nSession);
+            if(it != mapPeers.end() && it->second.nInFlight > 0)
+                --it->second.nInFlight;
+
+            entry.nSession = 0;
+        }
+
+
+        /* Drop the headers that have connected to the best chain. Must hold DOWNLOAD_MUTEX. */
+        void prune()
+        {
+            const uint32_t nBestHeight = TAO::Ledger::ChainState::nBestHeight.load();
+            while(!queue.empty() && queue.front().nHeight <= nBestHeight)
+            {
+                unassign(queue.front());
+                queue.pop_front();
+            }
+        }
+
+
+        /* Start a new headers-first download from a block we already have. */
+        void Start(const uint1024_t& hashStart)
+        {
+            TAO::Ledger::BlockState state;
+            if(!LLD::Ledger->ReadBlock(hashStart, state))
+            {
+                debug::error(FUNCTION, "failed to read start block ", hashStart.SubString());
+                return;
+            }
+
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* Peers keep their session in setSessions, bodies still in flight are accepted. */
+            queue.clear();
+            mapPeers.clear();
+
+            hashLastHeader    = hashStart;
+            nLastHeight       = state.nHeight;
+            hashRequested     = 0;
+            fHeadersRequested = false;
+            fHeadersDone      = false;
+            nLastAssumed      = nLastHeight;
+
+            fActive.store(true);
+
+            debug::log(0, FUNCTION, "Headers-first download from height ", nLastHeight);
+        }
+
+
+        /* Stop the download and clear the queue. */
+        void Stop()
+        {
+            LOCK(DOWNLOAD_MUTEX);
+
+            fActive.store(false);
+
+            /* Blocks from the peers that were downloading are unsolicited again. */
+            queue.clear();
+            mapPeers.clear();
+            setSessions.clear();
+
+            fHeadersRequested = false;
+            fHeadersDone      = false;
+        }
+
+
+        /* Determines if a headers-first download is running. */
+        bool Active()
+        {
+            return fActive.load();
+        }
+
+
+        /* Determines if every header was received and every queued block has connected. */
+        bool Complete()
+        {
+            LOCK(DOWNLOAD_MUTEX);
+            prune();
+
+            return fActive.load() && fHeadersDone && queue.empty();
+        }
+
+
+        /* Check a header from the sync node and queue it for download. */
+        bool AddHeader(const TAO::Ledger::ClientBlock& block)
+        {
+            const uint1024_t hashBlock = block.GetHash();
+
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* Check that we are still downloading. */
+            if(!fActive.load())
+                return false;
+
+            /* Lists can start with the block they were asked from. */
+            if(hashBlock == hashLastHeader)
+                return true;
+
+            /* Check that the header extends the last one. */
+            if(block.hashPrevBlock != hashLastHeader)
+            {
+                /* Only the first headers can fork off a block we already have. */
+                if(!queue.empty() || !LLD::Ledger->HasBlock(block.hashPrevBlock))
+                    return debug::error(FUNCTION, "header ", hashBlock.SubString(), " doesn't connect to ", hashLastHeader.SubString());
+
+                TAO::Ledger::BlockState statePrev;
+                if(!LLD::Ledger->ReadBlock(block.hashPrevBlock, statePrev))
+                    return debug::error(FUNCTION, "failed to read previous block ", block.hashPrevBlock.SubString());
+
+                hashLastHeader = block.hashPrevBlock;
+                nLastHeight    = statePrev.nHeight;
+            }
+
+            /* Check the height. */
+            if(block.nHeight != nLastHeight + 1)
+                return debug::error(FUNCTION, "header height ", block.nHeight, " doesn't follow ", nLastHeight);
+
+            /* Headers of blocks we already have just move the start along. */
+            if(queue.empty() && LLD::Ledger->HasBlock(hashBlock))
+            {
+                hashLastHeader = hashBlock;
+                nLastHeight    = block.nHeight;
+
+                return true;
+            }
+
+            /* Make sure the header was created within an active channel. */
+            if(block.GetChannel() > (config::GetBoolArg("-private") ? 3 : 2))
+                return debug::error(FUNCTION, "channel out of range");
+
+            /* Check that the time was within range. */
+            if(block.GetBlockTime() > runtime::unifiedtimestamp() + runtime::maxdrift())
+                return debug::error(FUNCTION, "header timestamp too far in the future");
+
+            /* Check the time-locks, the rest of the checks run when the body connects. */
+            if(!TAO::Ledger::BlockVersionActive(block.GetBlockTime(), block.nVersion))
+                return debug::error(FUNCTION, "header created with invalid version");
+
+            if(!TAO::Ledger::NetworkActive(block.GetBlockTime()))
+                return debug::error(FUNCTION, "header created before network time-lock");
+
+            if(!TAO::Ledger::ChannelActive(block.GetBlockTime(), block.GetChannel()))
+                return debug::error(FUNCTION, "header created before channel time-lock");
+
+            /* Queue the header. */
+            Entry entry;
+            entry.hashBlock = hashBlock;
+            entry.nHeight   = block.nHeight;
+            entry.nSession  = 0;
+            entry.nFailed   = 0;
+            entry.nTime     = 0;
+            entry.fReceived = false;
+
+            queue.push_back(entry);
+
+            hashLastHeader = hashBlock;
+            nLastHeight    = block.nHeight;
+
+            /* Reaching a hardcoded checkpoint shows the headers before it are its ancestors. */
+            auto it = TAO::Ledger::mapCheckpoints.find(block.nHeight);
+            if(it != TAO::Ledger::mapCheckpoints.end() && it->second == hashBlock)
+            {
+                for(const auto& queued : queue)
+                    if(queued.nHeight > nLastAssumed)
+                        TAO::Ledger::AssumeValid(queued.hashBlock, queued.nHeight);
+
+                nLastAssumed = block.nHeight;
+            }
+
+            return true;
+        }
+
+
+        /* Determines if the sync node should be asked for more headers, marking them as requested. */
+        bool RequestHeaders(uint1024_t &hashFrom)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+            prune();
+
+            /* Keep a bounded queue of headers ahead of the best chain. */
+            if(!fActive.load() || fHeadersRequested || fHeadersDone || queue.size() >= MAX_DOWNLOAD_HEADERS)
+                return false;
+
+            fHeadersRequested = true;
+            hashRequested     = hashLastHeader;
+            hashFrom          = hashLastHeader;
+
+            return true;
+        }
+
+
+        /* Mark the end of a list of headers from the sync node. */
+        void HeadersReceived(const bool fLast)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* A list that added nothing means the sync node has no more. */
+            if(fLast || hashLastHeader == hashRequested)
+            {
+                fHeadersDone = true;
+
+                debug::log(0, FUNCTION, "Headers complete at height ", nLastHeight);
+            }
+
+            fHeadersRequested = false;
+        }
+
+
+        /* Assign the next block bodies to download to a peer. */
+        bool Request(const uint64_t nSession, std::vector<uint1024_t> &vHashes)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* Check that we are still downloading. */
+            if(!fActive.load())
+                return false;
+
+            /* Top up a peer once half of its requests have arrived. */
+            Peer& peer = mapPeers[nSession];
+            if(peer.nInFlight > MAX_PEER_REQUESTS / 2)
+                return false;
+
+            /* Don't rescan the window for an idle peer on every event. */
+            const uint64_t nNow = runtime::timestamp(true);
+            if(peer.nInFlight > 0 && peer.nLastScan + 100 > nNow)
+                return false;
+
+            peer.nLastScan = nNow;
+            prune();
+
+            /* Assign unrequested or timed out bodies within the window. */
+            const uint32_t nBestHeight = TAO::Ledger::ChainState::nBestHeight.load();
+            const uint64_t nTimeout    = config::GetArg("-downloadtimeout", DOWNLOAD_TIMEOUT) * 1000;
+            for(auto& entry : queue)
+            {
+                /* Check the window and this peer's limit. */
+                if(entry.nHeight > nBestHeight + MAX_DOWNLOAD_WINDOW || peer.nInFlight >= MAX_PEER_REQUESTS)
+                    break;
+
+                /* Ask again for the next block if it arrived but never connected. */
+                if(entry.fReceived)
+                {
+                    if(entry.nHeight != nBestHeight + 1 || entry.nTime + nTimeout > nNow)
+                        continue;
+
+                    entry.fReceived = false;
+                }
+
+                /* Take bodies that didn't arrive in time off their peer. */
+                if(entry.nSession != 0)
+                {
+                    if(entry.nTime + nTimeout > nNow)
+                        continue;
+
+                    entry.nFailed = entry.nSession;
+                    unassign(entry);
+                }
+
+                /* Don't ask a peer again for a body it failed to deliver. */
+                if(entry.nFailed == nSession)
+                    continue;
+
+                entry.nSession = nSession;
+                entry.nTime    = nNow;
+                ++peer.nInFlight;
+
+                vHashes.push_back(entry.hashBlock);
+            }
+
+            /* Allow this session to send us blocks. */
+            if(!vHashes.empty())
+                setSessions.insert(nSession);
+
+            return !vHashes.empty();
+        }
+
+
+        /* Determines if a peer has been asked for block bodies. */
+        bool Requested(const uint64_t nSession)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+            return setSessions.count(nSession);
+        }
+
+
+        /* Mark a block body as received. */
+        void Received(const uint1024_t& hashBlock, const uint32_t nHeight, const bool fRejected)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* Queued heights are consecutive, so the entry is found by its offset. */
+            if(queue.empty() || nHeight < queue.front().nHeight)
+                return;
+
+            const uint64_t nIndex = nHeight - queue.front().nHeight;
+            if(nIndex >= queue.size())
+                return;
+
+            Entry& entry = queue[nIndex];
+            if(entry.hashBlock != hashBlock)
+                return;
+
+            /* Rejected bodies are asked for from another peer. */
+            const uint64_t nSession = entry.nSession;
+            unassign(entry);
+
+            entry.nFailed   = fRejected ? nSession : 0;
+            entry.nTime     = runtime::timestamp(true);
+            entry.fReceived = !fRejected;
+
+            prune();
+        }
+
+
+        /* Return the blocks assigned to a peer that disconnected. */
+        void Release(const uint64_t nSession)
+        {
+            LOCK(DOWNLOAD_MUTEX);
+
+            /* Unassign the bodies still in flight. */
+            for(auto& entry : queue)
+                if(entry.nSession == nSession && !entry.fReceived)
+                    unassign(entry);
+
+            mapPeers.erase(nSession);
+            setSessions.erase(nSession);
+        }
+
+
+        /* Get the number of headers queued that haven't connected yet. */
+        uint32_t Size()
+        {
+            LOCK(DOWNLOAD_MUTEX);
+            return static_cast<uint32_t>(queue.size());
+        }
+    }
+}
@@ -13,6 +13,7 @@ ________________________________________________________________________________
 
 #include <LLC/include/random.h>
 
+#include <LLP/include/block_cache.h>
 #include <LLP/include/global.h>
 #include <LLP/include/network.h>
 
@@ -63,6 +64,9 @@ namespace LLP
         /* Shutdown the P2P server and its subsystems. */
         Shutdown<P2PNode>(P2P_SERVER);
 
+        /* Free the blocks cached for syncing peers. */
+        BlockCache::Shutdown();
+
         /* After all servers shut down, clean up underlying network resources. */
         NetworkShutdown();
     }
@@ -0,0 +1,90 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_INCLUDE_BLOCK_CACHE_H
+#define NEXUS_LLP_INCLUDE_BLOCK_CACHE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace LLP
+{
+
+    /** BlockCache
+     *
+     *  Cache of block messages already framed for the network, for serving blocks to syncing peers.
+     *
+     *  Sync, tritium and legacy blocks are rebuilt from every transaction on disk each time they
+     *  are sent. The cache keeps the finished packet by block hash and specifier, so each block is
+     *  built once and written to every peer that asks for it by reference. The packets are kept
+     *  in memory up to -blockcache megabytes, least recently used first out, and with
+     *  -blockcachedisk also in a database on disk.
+     *
+     *  The disk cache is kept in two generations of up to half of -blockcachedisksize megabytes
+     *  each, since sector files never give back the space of erased records. When the current
+     *  generation fills up, the previous one is removed and a new one started. Packets read from
+     *  the previous generation are carried forward. Disk reads and writes are done outside of
+     *  the lock on the memory cache, only opening a generation holds it.
+     *
+     **/
+    namespace BlockCache
+    {
+
+        /** The default megabytes of packets kept in memory. **/
+        const uint64_t DEFAULT_BLOCK_CACHE = 64;
+
+
+        /** The default megabytes of packets kept on disk. **/
+        const uint64_t DEFAULT_BLOCK_CACHE_DISK = 1024;
+
+
+        /** Get
+         *
+         *  Get the packet of a block from the cache.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nSpecifier The specifier the block was sent with.
+         *  @param[out] pPacket The serialized packet.
+         *
+         *  @return true if the packet was in the cache.
+         *
+         **/
+        bool Get(const uint1024_t& hashBlock, const uint8_t nSpecifier, std::shared_ptr<std::vector<uint8_t>>& pPacket);
+
+
+        /** Put
+         *
+         *  Add the packet of a block to the cache. The packet must not be changed after this call.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nSpecifier The specifier the block was sent with.
+         *  @param[in] pPacket The serialized packet.
+         *
+         **/
+        void Put(const uint1024_t& hashBlock, const uint8_t nSpecifier, const std::shared_ptr<std::vector<uint8_t>>& pPacket);
+
+
+        /** Shutdown
+         *
+         *  Clear the cache and close the database on disk.
+         *
+         **/
+        void Shutdown();
+    }
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_INCLUDE_DOWNLOAD_H
+#define NEXUS_LLP_INCLUDE_DOWNLOAD_H
+
+#include <LLC/types/uint1024.h>
+
+#include <cstdint>
+#include <vector>
+
+/* Forward declarations. */
+namespace TAO { namespace Ledger { class ClientBlock; } }
+
+namespace LLP
+{
+
+    /** Download
+     *
+     *  Scheduler for a headers-first synchronization.
+     *
+     *  The sync node supplies the chain of headers, which are checked and queued in height order.
+     *  The bodies of the queued headers are then requested in parallel from every capable peer,
+     *  within a window ahead of the best chain. Bodies arriving out of order wait in the orphan
+     *  pool of TAO::Ledger::Process until their previous block connects.
+     *
+     **/
+    namespace Download
+    {
+
+        /** The most headers queued ahead of the best chain before asking the sync node for more. **/
+        const uint32_t MAX_DOWNLOAD_HEADERS = 32768;
+
+
+        /** The most block bodies requested ahead of the best chain. **/
+        const uint32_t MAX_DOWNLOAD_WINDOW = 1024;
+
+
+        /** The most block bodies in flight from a single peer. **/
+        const uint32_t MAX_PEER_REQUESTS = 128;
+
+
+        /** The default seconds before a block body that hasn't arrived is requested from another peer, set with -downloadtimeout. **/
+        const uint32_t DOWNLOAD_TIMEOUT = 20;
+
+
+        /** Start
+         *
+         *  Start a new headers-first download from a block we already have.
+         *
+         *  @param[in] hashStart The block to queue headers after.
+         *
+         **/
+        void Start(const uint1024_t& hashStart);
+
+
+        /** Stop
+         *
+         *  Stop the download, clear the queue and forget the peers that were asked for blocks.
+         *
+         **/
+        void Stop();
+
+
+        /** Active
+         *
+         *  Determines if a headers-first download is running.
+         *
+         *  @return true if the download is active.
+         *
+         **/
+        bool Active();
+
+
+        /** Complete
+         *
+         *  Determines if every header was received and every queued block has connected.
+         *
+         *  @return true if the download has nothing left to do.
+         *
+         **/
+        bool Complete();
+
+
+        /** AddHeader
+         *
+         *  Check a header from the sync node and queue it for download.
+         *
+         *  @param[in] block The header to add.
+         *
+         *  @return true if the header was queued or is already in the ledger.
+         *
+         **/
+        bool AddHeader(const TAO::Ledger::ClientBlock& block);
+
+
+        /** RequestHeaders
+         *
+         *  Determines if the sync node should be asked for more headers, marking them as requested.
+         *
+         *  @param[out] hashFrom The last queued header to list from.
+         *
+         *  @return true if more headers should be requested.
+         *
+         **/
+        bool RequestHeaders(uint1024_t &hashFrom);
+
+
+        /** HeadersReceived
+         *
+         *  Mark the end of a list of headers from the sync node.
+         *
+         *  @param[in] fLast Flag to indicate the sync node has no more headers.
+         *
+         **/
+        void HeadersReceived(const bool fLast);
+
+
+        /** Request
+         *
+         *  Assign the next block bodies to download to a peer.
+         *
+         *  @param[in] nSession The session-id of the peer.
+         *  @param[out] vHashes The blocks the peer should be asked for.
+         *
+         *  @return true if any blocks were assigned.
+         *
+         **/
+        bool Request(const uint64_t nSession, std::vector<uint1024_t> &vHashes);
+
+
+        /** Requested
+         *
+         *  Determines if a peer has been asked for block bodies.
+         *
+         *  @param[in] nSession The session-id of the peer.
+         *
+         *  @return true if the peer is downloading blocks.
+         *
+         **/
+        bool Requested(const uint64_t nSession);
+
+
+        /** Received
+         *
+         *  Mark a block body as received.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nHeight The height of the block.
+         *  @param[in] fRejected Flag to ask another peer for the block.
+         *
+         **/
+        void Received(const uint1024_t& hashBlock, const uint32_t nHeight, const bool fRejected = false);
+
+
+        /** Release
+         *
+         *  Return the blocks assigned to a peer that disconnected.
+         *
+         *  @param[in] nSession The session-id of the peer.
+         *
+         **/
+        void Release(const uint64_t nSession);
+
+
+        /** Size
+         *
+         *  Get the number of headers queued that haven't connected yet.
+         *
+         *  @return the size of the queue.
+         *
+         **/
+        uint32_t Size();
+    }
+}
+
+#endif
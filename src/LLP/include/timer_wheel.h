@@ -0,0 +1,143 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_LLP_INCLUDE_TIMER_WHEEL_H
+#define NEXUS_LLP_INCLUDE_TIMER_WHEEL_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace LLP
+{
+
+    /** The resolution of the timer wheel for idle connections, in milliseconds. **/
+    const uint32_t WHEEL_RESOLUTION = 10;
+
+
+    /** The number of buckets in the timer wheel for idle connections. **/
+    const uint32_t WHEEL_SIZE = 256;
+
+
+    /** TimerWheel
+     *
+     *  Hashed timer wheel of connection slots, used by the data threads to check idle connections.
+     *
+     *  Time is counted in ticks of WHEEL_RESOLUTION milliseconds. Each slot has at most one schedule,
+     *  scheduling it again replaces the last one. Slots due more than a turn ahead wait in their
+     *  bucket until the turn they are due on.
+     *
+     **/
+    class TimerWheel
+    {
+        /** The slots in each bucket with the tick they are due. **/
+        std::vector< std::vector<std::pair<uint32_t, uint64_t>> > vBuckets;
+
+
+        /** The tick each slot is due, zero if it isn't scheduled. **/
+        std::vector<uint64_t> vDue;
+
+
+        /** The last tick expired. **/
+        uint64_t nTick;
+
+
+    public:
+
+        /** Constructor
+         *
+         *  @param[in] nTickIn The current tick.
+         *
+         **/
+        TimerWheel(const uint64_t nTickIn);
+
+
+        /** Tick
+         *
+         *  Get the last tick expired.
+         *
+         **/
+        uint64_t Tick() const;
+
+
+        /** Skip
+         *
+         *  Skip the turns of the wheel missed before the last one, so a late caller doesn't spin
+         *  through every tick it missed.
+         *
+         *  @param[in] nTickNow The current tick.
+         *
+         **/
+        void Skip(const uint64_t nTickNow);
+
+
+        /** Schedule
+         *
+         *  Schedule a slot, replacing its last schedule. Ticks already expired are due on the next one.
+         *
+         *  @param[in] nIndex The slot to schedule.
+         *  @param[in] nDue The tick the slot is due.
+         *
+         **/
+        void Schedule(const uint32_t nIndex, uint64_t nDue);
+
+
+        /** Cancel
+         *
+         *  Remove the schedule of a slot.
+         *
+         *  @param[in] nIndex The slot to cancel.
+         *
+         **/
+        void Cancel(const uint32_t nIndex);
+
+
+        /** Scheduled
+         *
+         *  Get the tick a slot is due.
+         *
+         *  @param[in] nIndex The slot to check.
+         *
+         *  @return the tick the slot is due, zero if it isn't scheduled.
+         *
+         **/
+        uint64_t Scheduled(const uint32_t nIndex) const;
+
+
+        /** Next
+         *
+         *  Find the next tick with a bucket to expire.
+         *
+         *  @param[in] nLimit The tick to search up to, excluded.
+         *  @param[out] nNext The next tick with slots.
+         *
+         *  @return true if a tick with slots was found before the limit.
+         *
+         **/
+        bool Next(const uint64_t nLimit, uint64_t &nNext) const;
+
+
+        /** Expire
+         *
+         *  Advance to the current tick, taking the slots that became due off the wheel.
+         *
+         *  @param[in] nTickNow The current tick.
+         *  @param[out] vExpired The slots that became due.
+         *
+         **/
+        void Expire(const uint64_t nTickNow, std::vector<uint32_t> &vExpired);
+    };
+}
+
+#endif
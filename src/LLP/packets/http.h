@@ -256,15 +256,15 @@ namespace LLP
         }
 
 
-        /** GetBytes
+        /** GetHeader
          *
-         *  Serializes class into a byte buffer. Used to write Packet to
-         *  Sockets.
+         *  Serializes the status line and header fields into a byte buffer.
+         *  Used to write Packet to Sockets.
          *
          *  @return Returns a byte buffer.
          *
          **/
-        std::vector<uint8_t> GetBytes() const
+        std::vector<uint8_t> GetHeader() const
         {
             //TODO: use constant format (not ...) -> ostringstream
             std::string strReply = debug::safe_printstr
@@ -288,14 +288,44 @@ namespace LLP
             for(const auto& header : mapHeaders)
                 strReply += debug::safe_printstr(header.first, ": ", header.second, "\r\n");;
 
-            /* Add end of header and content. */
-            strReply += debug::safe_printstr("\r\n", strContent);
+            /* Add end of header. */
+            strReply += "\r\n";
 
             //get the bytes to submit over socket
             std::vector<uint8_t> vBytes(strReply.begin(), strReply.end());
 
             return vBytes;
         }
+
+
+        /** GetData
+         *
+         *  Gets the content written after the header.
+         *
+         *  @return Returns a byte buffer.
+         *
+         **/
+        std::vector<uint8_t> GetData() const
+        {
+            return std::vector<uint8_t>(strContent.begin(), strContent.end());
+        }
+
+
+        /** GetBytes
+         *
+         *  Serializes class into a byte buffer. Used to write Packet to
+         *  Sockets.
+         *
+         *  @return Returns a byte buffer.
+         *
+         **/
+        std::vector<uint8_t> GetBytes() const
+        {
+            std::vector<uint8_t> vBytes = GetHeader();
+            vBytes.insert(vBytes.end(), strContent.begin(), strContent.end());
+
+            return vBytes;
+        }
     };
 }
 
@@ -234,6 +234,33 @@ namespace LLP
         }
 
 
+        /** GetHeader
+         *
+         *  Serializes the message and length into a Byte Vector. Used to write Packet to Sockets.
+         *
+         *  @return Returns the serialized header.
+         *
+         **/
+        std::vector<uint8_t> GetHeader() const
+        {
+            DataStream ssHeader(SER_NETWORK, MIN_PROTO_VERSION);
+            ssHeader << *this;
+
+            return std::vector<uint8_t>(ssHeader.begin(), ssHeader.end());
+        }
+
+
+        /** GetData
+         *
+         *  Gets the data written after the header.
+         *
+         **/
+        const std::vector<uint8_t>& GetData() const
+        {
+            return DATA;
+        }
+
+
         /** GetBytes
          *
          *  Serializes class into a Byte Vector. Used to write Packet to Sockets.
@@ -243,10 +270,7 @@ namespace LLP
          **/
         std::vector<uint8_t> GetBytes() const
         {
-            DataStream ssHeader(SER_NETWORK, MIN_PROTO_VERSION);
-            ssHeader << *this;
-
-            std::vector<uint8_t> vBytes(ssHeader.begin(), ssHeader.end());
+            std::vector<uint8_t> vBytes = GetHeader();
             vBytes.insert(vBytes.end(), DATA.begin(), DATA.end());
 
             return vBytes;
@@ -190,12 +190,12 @@ namespace LLP
         }
 
 
-        /** GetBytes
+        /** GetHeader
          *
-         *  Serializes class into a byte vector. Used to write packet to sockets.
+         *  Serializes the header and length into a byte vector. Used to write packet to sockets.
          *
          **/
-        std::vector<uint8_t> GetBytes() const
+        std::vector<uint8_t> GetHeader() const
         {
             std::vector<uint8_t> BYTES(1, HEADER);
 
@@ -205,12 +205,37 @@ namespace LLP
                 BYTES.push_back(static_cast<uint8_t>(LENGTH >> 16));
                 BYTES.push_back(static_cast<uint8_t>(LENGTH >> 8));
                 BYTES.push_back(static_cast<uint8_t>(LENGTH));
-
-                BYTES.insert(BYTES.end(),  DATA.begin(), DATA.end());
             }
 
             return BYTES;
         }
+
+
+        /** GetData
+         *
+         *  Gets the data written after the header, which request packets don't have.
+         *
+         **/
+        const std::vector<uint8_t>& GetData() const
+        {
+            static const std::vector<uint8_t> EMPTY;
+
+            return HEADER < 128 ? DATA : EMPTY;
+        }
+
+
+        /** GetBytes
+         *
+         *  Serializes class into a byte vector. Used to write packet to sockets.
+         *
+         **/
+        std::vector<uint8_t> GetBytes() const
+        {
+            std::vector<uint8_t> BYTES = GetHeader();
+            BYTES.insert(BYTES.end(), GetData().begin(), GetData().end());
+
+            return BYTES;
+        }
     };
 }
 
@@ -11,6 +11,8 @@
 
 ____________________________________________________________________________________________*/
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <stdio.h>
@@ -24,6 +26,7 @@ ________________________________________________________________________________
 #ifndef WIN32
 #include <arpa/inet.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #endif
 
 #include <openssl/ssl.h>
@@ -42,7 +45,9 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qBuffer            ( )
+    , nBufferOffset      (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               ( )
@@ -64,7 +69,9 @@ namespace LLP
     , nLastSend          (socket.nLastSend.load())
     , nLastRecv          (socket.nLastRecv.load())
     , nError             (socket.nError.load())
-    , vBuffer            (socket.vBuffer)
+    , qBuffer            (socket.qBuffer)
+    , nBufferOffset      (socket.nBufferOffset)
+    , nBuffered          (socket.nBuffered.load())
     , fBufferFull        (socket.fBufferFull.load())
     , nConsecutiveErrors (socket.nConsecutiveErrors.load())
     , addr               (socket.addr)
@@ -98,7 +105,9 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qBuffer            ( )
+    , nBufferOffset      (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               (addrIn)
@@ -215,7 +224,9 @@ namespace LLP
     , nLastSend          (0)
     , nLastRecv          (0)
     , nError             (0)
-    , vBuffer            ( )
+    , qBuffer            ( )
+    , nBufferOffset      (0)
+    , nBuffered          (0)
     , fBufferFull        (false)
     , nConsecutiveErrors (0)
     , addr               ( )
@@ -752,53 +763,66 @@ namespace LLP
     /* Write data into the socket buffer non-blocking */
     int32_t Socket::Write(const std::vector<uint8_t>& vData, size_t nBytes)
     {
-        int32_t nSent = 0;
+        return write({ std::make_pair(vData.data(), nBytes) });
+    }
+
+
+    /* Write a header and its data into the socket buffer non-blocking. */
+    int32_t Socket::Write(const std::vector<uint8_t>& vHeader, const std::vector<uint8_t>& vData)
+    {
+        return write({ std::make_pair(vHeader.data(), vHeader.size()), std::make_pair(vData.data(), vData.size()) });
+    }
+
+
+    /* Write shared data into the socket buffer non-blocking. */
+    int32_t Socket::Write(const std::shared_ptr<std::vector<uint8_t>>& pData)
+    {
+        const uint64_t nBytes = pData->size();
+        if(nBytes == 0)
+            return 0;
 
         {
             LOCK(DATA_MUTEX);
 
             /* Check overflow buffer. */
-            if(vBuffer.size() > 0)
+            if(nBuffered.load() > 0)
             {
-                debug::log(3, FUNCTION, "vBuffer ", vBuffer.size(), " bytes");
-
-                vBuffer.insert(vBuffer.end(), vData.begin(), vData.end());
+                qBuffer.push_back(pData);
+                nBuffered += nBytes;
 
                 return static_cast<int32_t>(nBytes);
             }
         }
 
-        /* Write the packet. */
+        /* Write the data. */
+        int32_t nSent = 0;
         {
             LOCK(SOCKET_MUTEX);
-
-            if(pSSL)
-                nSent = static_cast<int32_t>(SSL_write(pSSL, (int8_t*)&vData[0], nBytes));
-            else
-            {
-            #ifdef WIN32
-                nSent = static_cast<int32_t>(send(fd, (char*)&vData[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #else
-                nSent = static_cast<int32_t>(send(fd, (int8_t*)&vData[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #endif
-            }
+            nSent = send_chunks({ std::make_pair(pData->data(), nBytes) });
         }
 
+        /* Buffer everything if a plain socket would have blocked, so the packet isn't lost. */
+        if(nSent < 0 && !pSSL && error_code() == 0)
+            nSent = 0;
 
         /* Handle for error state. */
         if(nSent < 0)
-        {
-            if(pSSL)
-                nError = SSL_get_error(pSSL, nSent);
-            else
-                nError = WSAGetLastError();
-        }
+            return nSent;
 
-        /* If not all data was sent non-blocking, recurse until it is complete. */
-        else if(nSent != vData.size())
+        /* If not all data was sent non-blocking, buffer the rest by reference. */
+        if(static_cast<uint64_t>(nSent) != nBytes)
         {
             LOCK(DATA_MUTEX);
-            vBuffer.insert(vBuffer.end(), vData.begin() + nSent, vData.end());
+
+            /* The sent bytes can only be skipped with the offset when this is the oldest chunk. */
+            if(qBuffer.empty())
+            {
+                qBuffer.push_back(pData);
+                nBufferOffset = nSent;
+                nBuffered    += (nBytes - nSent);
+            }
+            else
+                buffer(pData->data() + nSent, nBytes - nSent);
         }
         else //don't update last sent unless all the data was written to the buffer
             nLastSend = runtime::timestamp(true);
@@ -810,62 +834,66 @@ namespace LLP
     /* Flushes data out of the overflow buffer */
     int Socket::Flush()
     {
-        int32_t nSent   = 0;
-        uint32_t nBytes = 0;
-        uint32_t nSize  = 0;
-
-        {
-            LOCK(DATA_MUTEX);
-            nSize = static_cast<uint32_t>(vBuffer.size());
-        }
-
         /* Don't flush if buffer doesn't have any data. */
-        if(nSize == 0)
+        if(nBuffered.load() == 0)
             return 0;
 
         /* maximum transmission unit. */
         const uint32_t MTU = 16384;
 
         /* Set the maximum bytes to flush to 2^16 or maximum socket buffers. */
-        nBytes = std::min(nSize, std::min((uint32_t)config::GetArg("-maxsendsize", MTU), MTU));
+        const uint64_t nLimit = std::min((uint32_t)config::GetArg("-maxsendsize", MTU), MTU);
 
         /* If there were any errors, handle them gracefully. */
+        int32_t nSent = 0;
         {
             LOCK2(DATA_MUTEX);
             LOCK(SOCKET_MUTEX);
 
-            if(pSSL)
-                nSent = static_cast<int32_t>(SSL_write(pSSL, (int8_t *)&vBuffer[0], nBytes));
-            else
+            /* Gather the oldest chunks up to the limit, starting after the bytes already sent. */
+            std::vector<std::pair<const uint8_t*, size_t>> vChunks;
+
+            uint64_t nBytes  = 0;
+            uint64_t nOffset = nBufferOffset;
+            for(const auto& pChunk : qBuffer)
             {
-            #ifdef WIN32
-                nSent = static_cast<int32_t>(send(fd, (char*)&vBuffer[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #else
-                nSent = static_cast<int32_t>(send(fd, (int8_t*)&vBuffer[0], nBytes, MSG_NOSIGNAL | MSG_DONTWAIT));
-            #endif
+                if(nBytes >= nLimit || vChunks.size() >= 64)
+                    break;
+
+                const uint64_t nSize = std::min(pChunk->size() - nOffset, nLimit - nBytes);
+                vChunks.push_back(std::make_pair(pChunk->data() + nOffset, nSize));
+
+                nBytes += nSize;
+                nOffset = 0;
             }
 
+            nSent = send_chunks(vChunks);
+
+            /* Drop the bytes that were sent without moving the rest of the buffer. */
+            uint64_t nRemove = (nSent > 0 ? nSent : 0);
+            nBuffered -= nRemove;
+            while(nRemove > 0)
+            {
+                const uint64_t nLeft = qBuffer.front()->size() - nBufferOffset;
+                if(nRemove < nLeft)
+                {
+                    nBufferOffset += nRemove;
+                    break;
+                }
+
+                nRemove      -= nLeft;
+                nBufferOffset = 0;
+                qBuffer.pop_front();
+            }
         }
 
         /* Handle errors on flush. */
         if(nSent < 0)
-        {
-            if(pSSL)
-                nError = SSL_get_error(pSSL, nSent);
-            else
-                nError = WSAGetLastError();
-
             ++nConsecutiveErrors;
-        }
 
         /* If not all data was sent non-blocking, recurse until it is complete. */
         else if(nSent > 0)
         {
-            LOCK(DATA_MUTEX);
-
-            /* Erase from current buffer. */
-            vBuffer.erase(vBuffer.begin(), vBuffer.begin() + nSent);
-
             /* Update socket timers. */
             nLastSend          = runtime::timestamp(true);
             nConsecutiveErrors = 0;
@@ -897,7 +925,7 @@ namespace LLP
     /* Check that the socket has data that is buffered. */
     uint64_t Socket::Buffered() const
     {
-        return vBuffer.size();
+        return nBuffered.load();
     }
 
 
@@ -978,4 +1006,153 @@ namespace LLP
         return false;
     }
 
+
+    /* Sends a list of chunks, buffering what the socket doesn't take. */
+    int32_t Socket::write(const std::vector<std::pair<const uint8_t*, size_t>>& vChunks)
+    {
+        /* Get the total bytes to write. */
+        uint64_t nBytes = 0;
+        for(const auto& chunk : vChunks)
+            nBytes += chunk.second;
+
+        {
+            LOCK(DATA_MUTEX);
+
+            /* Check overflow buffer. */
+            if(nBuffered.load() > 0)
+            {
+                debug::log(3, FUNCTION, "buffered ", nBuffered.load(), " bytes");
+
+                for(const auto& chunk : vChunks)
+                    buffer(chunk.first, chunk.second);
+
+                return static_cast<int32_t>(nBytes);
+            }
+        }
+
+        /* Write the packet. */
+        int32_t nSent = 0;
+        {
+            LOCK(SOCKET_MUTEX);
+            nSent = send_chunks(vChunks);
+        }
+
+        /* Buffer everything if a plain socket would have blocked, so the packet isn't lost. */
+        if(nSent < 0 && !pSSL && error_code() == 0)
+            nSent = 0;
+
+        /* Handle for error state. */
+        if(nSent < 0)
+            return nSent;
+
+        /* If not all data was sent non-blocking, buffer the rest to flush later. */
+        if(static_cast<uint64_t>(nSent) != nBytes)
+        {
+            LOCK(DATA_MUTEX);
+
+            uint64_t nSkip = static_cast<uint64_t>(nSent);
+            for(const auto& chunk : vChunks)
+            {
+                if(nSkip >= chunk.second)
+                {
+                    nSkip -= chunk.second;
+                    continue;
+                }
+
+                buffer(chunk.first + nSkip, chunk.second - nSkip);
+                nSkip = 0;
+            }
+        }
+        else //don't update last sent unless all the data was written to the buffer
+            nLastSend = runtime::timestamp(true);
+
+        return nSent;
+    }
+
+
+    /* Sends a list of chunks in one gathered write, or one chunk at a time for SSL. */
+    int32_t Socket::send_chunks(const std::vector<std::pair<const uint8_t*, size_t>>& vChunks)
+    {
+        int32_t nSent = 0;
+
+    #ifndef WIN32
+        /* Plain sockets send every chunk with one system call. */
+        if(!pSSL)
+        {
+            std::vector<iovec> vIov;
+            for(const auto& chunk : vChunks)
+            {
+                if(chunk.second == 0)
+                    continue;
+
+                iovec iov;
+                iov.iov_base = const_cast<uint8_t*>(chunk.first);
+                iov.iov_len  = chunk.second;
+
+                vIov.push_back(iov);
+            }
+
+            if(vIov.empty())
+                return 0;
+
+            msghdr msg;
+            std::memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = &vIov[0];
+            msg.msg_iovlen = vIov.size();
+
+            nSent = static_cast<int32_t>(sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT));
+            if(nSent < 0)
+                nError = WSAGetLastError();
+
+            return nSent;
+        }
+    #endif
+
+        /* Send one chunk at a time, stopping at the first that isn't sent in full. */
+        for(const auto& chunk : vChunks)
+        {
+            if(chunk.second == 0)
+                continue;
+
+            int32_t nWrite = 0;
+            if(pSSL)
+                nWrite = static_cast<int32_t>(SSL_write(pSSL, chunk.first, static_cast<int32_t>(chunk.second)));
+            else
+                nWrite = static_cast<int32_t>(send(fd, (char*)chunk.first, chunk.second, MSG_NOSIGNAL | MSG_DONTWAIT));
+
+            /* Handle for error state, which is only returned if nothing was sent. */
+            if(nWrite <= 0)
+            {
+                if(pSSL)
+                    nError = SSL_get_error(pSSL, nWrite);
+                else
+                    nError = WSAGetLastError();
+
+                return (nSent > 0 ? nSent : nWrite);
+            }
+
+            nSent += nWrite;
+            if(static_cast<size_t>(nWrite) < chunk.second)
+                break;
+        }
+
+        return nSent;
+    }
+
+
+    /* Adds data to the end of the send buffer. */
+    void Socket::buffer(const uint8_t* pData, size_t nSize)
+    {
+        if(nSize == 0)
+            return;
+
+        /* Join small writes into the newest chunk, so a backlog of small packets sends in few chunks.
+         * Chunks shared with other sockets are never changed. */
+        if(!qBuffer.empty() && qBuffer.back().use_count() == 1 && qBuffer.back()->size() + nSize <= 16384)
+            qBuffer.back()->insert(qBuffer.back()->end(), pData, pData + nSize);
+        else
+            qBuffer.push_back(std::make_shared<std::vector<uint8_t>>(pData, pData + nSize));
+
+        nBuffered += nSize;
+    }
 }
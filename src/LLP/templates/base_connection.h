@@ -169,15 +169,21 @@ namespace LLP
         static std::string Name() { return "Base"; }
 
 
-        /** Notifications
+        /** RelayFilter
          *
          *  Filter out relay requests with notifications node is subscribed to.
          *
+         *  @param[in] message The message to relay.
+         *  @param[in] ssData The data of the message.
+         *  @param[out] ssRelay The filtered data to relay, if not relaying the whole message.
+         *
+         *  @return true if the whole message is relayed unchanged.
+         *
          **/
         template<typename MessageType>
-        const DataStream RelayFilter(const MessageType& message, const DataStream& ssData) const
+        bool RelayFilter(const MessageType& message, const DataStream& ssData, DataStream& ssRelay) const
         {
-            return ssData; //copy over relay like normal for all items to be relayed
+            return true; //relay like normal for all items to be relayed
         }
 
 
@@ -283,6 +289,17 @@ namespace LLP
         void WritePacket(const PacketType& PACKET);
 
 
+        /** WritePacket
+         *
+         *  Write a packet that was framed once for many connections to the TCP stream.
+         *  The bytes are buffered by reference and must not be changed after this call.
+         *
+         *  @param[in] pBytes The serialized packet.
+         *
+         **/
+        void WritePacket(const std::shared_ptr<std::vector<uint8_t>>& pBytes);
+
+
         /** ReadPacket
          *
          *  Non-Blocking Packet reader to build a packet from TCP Connection.
@@ -343,6 +360,20 @@ namespace LLP
          **/
         void WaitEvent();
 
+
+    private:
+
+        /** reserve
+         *
+         *  Checks that the send buffer has room for a packet, flagging the buffer full if not.
+         *
+         *  @param[in] nBytes The size of the packet.
+         *
+         *  @return true if the packet can be written.
+         *
+         **/
+        bool reserve(const uint64_t nBytes);
+
     };
 
 }
@@ -68,6 +68,14 @@ namespace LLP
         std::mutex SLOT_MUTEX;
 
 
+        /** The generation of the connection in each slot, changed when a slot gets a new connection. **/
+        std::vector<uint32_t> vGenerations;
+
+
+        /** The generation given to the last connection added. **/
+        std::atomic<uint32_t> nGeneration;
+
+
     public:
 
         /* Variables to track Connection / Request Count. */
@@ -157,6 +165,11 @@ namespace LLP
                     else
                         CONNECTIONS->at(nSlot).store(pnode);
 
+                    /* Give the slot a new generation so the data thread watches the new socket. */
+                    if(nSlot >= vGenerations.size())
+                        vGenerations.resize(nSlot + 1, 0);
+                    vGenerations[nSlot] = ++nGeneration;
+
                     /* Fire the connected event. */
                     memory::atomic_ptr<ProtocolType>& CONNECTION = CONNECTIONS->at(nSlot);
                     CONNECTION->Event(EVENTS::CONNECT);
@@ -229,6 +242,11 @@ namespace LLP
                     else
                         CONNECTIONS->at(nSlot).store(pnode);
 
+                    /* Give the slot a new generation so the data thread watches the new socket. */
+                    if(nSlot >= vGenerations.size())
+                        vGenerations.resize(nSlot + 1, 0);
+                    vGenerations[nSlot] = ++nGeneration;
+
                     /* Fire the connected event. */
                     memory::atomic_ptr<ProtocolType>& CONNECTION = CONNECTIONS->at(nSlot);
                     CONNECTION->Event(EVENTS::CONNECT);
@@ -367,6 +385,41 @@ namespace LLP
          **/
         uint32_t find_slot();
 
+
+        /** check
+         *
+         *  Checks a connection for errors, timeouts and DDOS, fires its generic event,
+         *  and reads and processes a packet if one is complete.
+         *
+         *  @param[in] nIndex The data thread index of the connection.
+         *  @param[in] nEvents The poll events signaled for the socket.
+         *
+         *  @return true if the connection is still active.
+         *
+         **/
+        bool check(uint32_t nIndex, int16_t nEvents);
+
+
+        /** poll_loop
+         *
+         *  Polls every socket and checks every connection on each pass.
+         *
+         **/
+        void poll_loop();
+
+
+    #ifdef __linux__
+
+        /** epoll_loop
+         *
+         *  Waits on an edge-triggered epoll set and only checks the connections with
+         *  new data, plus idle connections once per interval from a timer wheel.
+         *
+         **/
+        void epoll_loop();
+
+    #endif
+
     };
 }
 
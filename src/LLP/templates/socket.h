@@ -19,9 +19,12 @@ ________________________________________________________________________________
 #include <LLP/include/base_address.h>
 
 #include <vector>
+#include <deque>
 #include <cstdint>
+#include <memory>
 #include <mutex>
 #include <atomic>
+#include <utility>
 
 
 typedef struct ssl_st SSL;
@@ -68,8 +71,16 @@ namespace LLP
         std::atomic<int32_t> nError;
 
 
-        /** Oversize buffer for large packets. **/
-        std::vector<uint8_t> vBuffer;
+        /** Chunks of data waiting to be sent, oldest first. Chunks can be shared with other sockets. **/
+        std::deque<std::shared_ptr<std::vector<uint8_t>>> qBuffer;
+
+
+        /** The bytes of the oldest chunk that were already sent. **/
+        uint64_t nBufferOffset;
+
+
+        /** The total bytes waiting to be sent. **/
+        std::atomic<uint64_t> nBuffered;
 
 
         /** Flag to catch if buffer write failed. **/
@@ -205,6 +216,33 @@ namespace LLP
         int32_t Write(const std::vector<uint8_t>& vData, size_t nBytes);
 
 
+        /** Write
+         *
+         *  Write a header and its data into the socket buffer non-blocking,
+         *  gathering both into one send without joining them first.
+         *
+         *  @param[in] vHeader The byte vector of the header to be written
+         *  @param[in] vData The byte vector of data to be written after the header
+         *
+         *  @return the total bytes that were written
+         *
+         **/
+        int32_t Write(const std::vector<uint8_t>& vHeader, const std::vector<uint8_t>& vData);
+
+
+        /** Write
+         *
+         *  Write shared data into the socket buffer non-blocking. Data that isn't sent
+         *  right away is buffered by reference, so it must not be changed after this call.
+         *
+         *  @param[in] pData The shared byte vector of data to be written
+         *
+         *  @return the total bytes that were written
+         *
+         **/
+        int32_t Write(const std::shared_ptr<std::vector<uint8_t>>& pData);
+
+
         /** Flush
          *
          *  Flushes data out of the overflow buffer
@@ -287,6 +325,42 @@ namespace LLP
          **/
         int32_t error_code() const;
 
+
+        /** write
+         *
+         *  Sends a list of chunks, buffering what the socket doesn't take.
+         *
+         *  @param[in] vChunks The pointers and sizes of the chunks to write.
+         *
+         *  @return the total bytes that were written
+         *
+         **/
+        int32_t write(const std::vector<std::pair<const uint8_t*, size_t>>& vChunks);
+
+
+        /** send_chunks
+         *
+         *  Sends a list of chunks in one gathered write, or one chunk at a time
+         *  for SSL. Must be called with SOCKET_MUTEX held.
+         *
+         *  @param[in] vChunks The pointers and sizes of the chunks to send.
+         *
+         *  @return the total bytes that were sent, or the error of the first send.
+         *
+         **/
+        int32_t send_chunks(const std::vector<std::pair<const uint8_t*, size_t>>& vChunks);
+
+
+        /** buffer
+         *
+         *  Adds data to the end of the send buffer. Must be called with DATA_MUTEX held.
+         *
+         *  @param[in] pData The data to buffer.
+         *  @param[in] nSize The size of the data.
+         *
+         **/
+        void buffer(const uint8_t* pData, size_t nSize);
+
     };
 
 }
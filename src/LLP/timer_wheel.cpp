@@ -0,0 +1,118 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLP/include/timer_wheel.h>
+
+namespace LLP
+{
+
+    /* Constructor. */
+    TimerWheel::TimerWheel(const uint64_t nTickIn)
+    : vBuckets (WHEEL_SIZE)
+    , vDue     ( )
+    , nTick    (nTickIn)
+    {
+    }
+
+
+    /* Get the last tick expired. */
+    uint64_t TimerWheel::Tick() const
+    {
+        return nTick;
+    }
+
+
+    /* Skip the turns of the wheel missed before the last one. */
+    void TimerWheel::Skip(const uint64_t nTickNow)
+    {
+        if(nTickNow > nTick + WHEEL_SIZE)
+            nTick = nTickNow - WHEEL_SIZE;
+    }
+
+
+    /* Schedule a slot, replacing its last schedule. */
+    void TimerWheel::Schedule(const uint32_t nIndex, uint64_t nDue)
+    {
+        /* A bucket behind the wheel would wait a full turn. */
+        if(nDue <= nTick)
+            nDue = nTick + 1;
+
+        if(nIndex >= vDue.size())
+            vDue.resize(nIndex + 1, 0);
+
+        /* Older entries of the slot are skipped as they expire. */
+        vDue[nIndex] = nDue;
+        vBuckets[nDue % WHEEL_SIZE].push_back(std::make_pair(nIndex, nDue));
+    }
+
+
+    /* Remove the schedule of a slot. */
+    void TimerWheel::Cancel(const uint32_t nIndex)
+    {
+        if(nIndex < vDue.size())
+            vDue[nIndex] = 0;
+    }
+
+
+    /* Get the tick a slot is due. */
+    uint64_t TimerWheel::Scheduled(const uint32_t nIndex) const
+    {
+        if(nIndex >= vDue.size())
+            return 0;
+
+        return vDue[nIndex];
+    }
+
+
+    /* Find the next tick with a bucket to expire. */
+    bool TimerWheel::Next(const uint64_t nLimit, uint64_t &nNext) const
+    {
+        for(nNext = nTick + 1; nNext < nLimit && nNext <= nTick + WHEEL_SIZE; ++nNext)
+            if(!vBuckets[nNext % WHEEL_SIZE].empty())
+                return true;
+
+        return false;
+    }
+
+
+    /* Advance to the current tick, taking the slots that became due off the wheel. */
+    void TimerWheel::Expire(const uint64_t nTickNow, std::vector<uint32_t> &vExpired)
+    {
+        /* Catch up at most one turn of the wheel. */
+        Skip(nTickNow);
+
+        while(nTick < nTickNow)
+        {
+            ++nTick;
+
+            std::vector<std::pair<uint32_t, uint64_t>> vBucket;
+            vBucket.swap(vBuckets[nTick % WHEEL_SIZE]);
+            for(const auto& entry : vBucket)
+            {
+                /* Skip entries replaced by a newer schedule. */
+                if(vDue[entry.first] != entry.second)
+                    continue;
+
+                /* Keep entries due on a later turn of the wheel. */
+                if(entry.second > nTick)
+                {
+                    vBuckets[nTick % WHEEL_SIZE].push_back(entry);
+                    continue;
+                }
+
+                vDue[entry.first] = 0;
+                vExpired.push_back(entry.first);
+            }
+        }
+    }
+}
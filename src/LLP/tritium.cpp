@@ -17,6 +17,8 @@ ________________________________________________________________________________
 #include <LLD/cache/binary_key.h>
 
 #include <LLP/types/tritium.h>
+#include <LLP/include/block_cache.h>
+#include <LLP/include/download.h>
 #include <LLP/include/global.h>
 #include <LLP/include/manager.h>
 #include <LLP/templates/events.h>
@@ -133,6 +135,7 @@ namespace LLP
     , hashCheckpoint(0)
     , hashBestChain(0)
     , hashLastIndex(0)
+    , hashCompact(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
     , strFullVersion()
@@ -162,6 +165,7 @@ namespace LLP
     , hashCheckpoint(0)
     , hashBestChain(0)
     , hashLastIndex(0)
+    , hashCompact(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
     , strFullVersion()
@@ -191,6 +195,7 @@ namespace LLP
     , hashCheckpoint(0)
     , hashBestChain(0)
     , hashLastIndex(0)
+    , hashCompact(0)
     , nConsecutiveOrphans(0)
     , nConsecutiveFails(0)
     , strFullVersion()
@@ -360,6 +365,60 @@ namespace LLP
                 }
 
 
+                /* Drive a headers-first sync from the sync node. */
+                if(Download::Active() && nCurrentSession != 0 && nCurrentSession == TAO::Ledger::nSyncSession.load())
+                {
+                    /* Finish with a regular sync once every queued block has connected. */
+                    if(Download::Complete())
+                    {
+                        Download::Stop();
+
+                        debug::log(0, NODE, "Headers-first download COMPLETE at height ", TAO::Ledger::ChainState::nBestHeight.load());
+
+                        /* Ask for the blocks found since the headers were listed. */
+                        PushMessage(ACTION::LIST,
+                            uint8_t(SPECIFIER::SYNC),
+                            uint8_t(TYPES::BLOCK),
+                            uint8_t(TYPES::LOCATOR),
+                            TAO::Ledger::Locator(TAO::Ledger::ChainState::hashBestChain.load()),
+                            uint1024_t(0)
+                        );
+                    }
+
+                    /* Keep the queue of headers topped up. */
+                    uint1024_t hashFrom;
+                    if(Download::RequestHeaders(hashFrom))
+                    {
+                        PushMessage(ACTION::LIST,
+                            uint8_t(SPECIFIER::HEADERS),
+                            uint8_t(TYPES::BLOCK),
+                            uint8_t(TYPES::UINT1024_T),
+                            hashFrom,
+                            uint1024_t(0)
+                        );
+                    }
+                }
+
+
+                /* Download block bodies of a headers-first sync from every capable peer. */
+                if(Download::Active() && nCurrentSession != 0 && nProtocolVersion >= MIN_HEADERS_VERSION)
+                {
+                    std::vector<uint1024_t> vHashes;
+                    if(Download::Request(nCurrentSession, vHashes))
+                    {
+                        /* Ask for all of the assigned bodies in one message. */
+                        DataStream ssRequest(SER_NETWORK, PROTOCOL_VERSION);
+                        for(const auto& hashBlock : vHashes)
+                            ssRequest << uint8_t(SPECIFIER::SYNC) << uint8_t(TYPES::BLOCK) << hashBlock;
+
+                        WritePacket(NewMessage(ACTION::GET, ssRequest));
+
+                        /* Debug output. */
+                        debug::log(3, NODE, "Requested ", vHashes.size(), " blocks");
+                    }
+                }
+
+
                 /* Unreliabilitiy re-requesting (max time since getblocks) */
                 if(TAO::Ledger::ChainState::Synchronizing()
                 && nCurrentSession == TAO::Ledger::nSyncSession.load()
@@ -484,6 +543,9 @@ namespace LLP
                     }
                 }
 
+                /* Give the blocks this node was downloading to other peers. */
+                Download::Release(nCurrentSession);
+
                 /* Reset session, notifications, subscriptions etc */
                 nCurrentSession = 0;
                 nUnsubscribed = 0;
@@ -1199,15 +1261,17 @@ namespace LLP
                     ssPacket >> nType;
 
                     /* Check for legacy or transactions specifiers. */
-                    bool fLegacy = false, fTransactions = false, fSyncBlock = false, fClientBlock = false;
+                    bool fLegacy = false, fTransactions = false, fSyncBlock = false, fClientBlock = false, fHeaders = false;
                     if(nType == SPECIFIER::LEGACY || nType == SPECIFIER::TRANSACTIONS
-                    || nType == SPECIFIER::SYNC   || nType == SPECIFIER::CLIENT)
+                    || nType == SPECIFIER::SYNC   || nType == SPECIFIER::CLIENT
+                    || nType == SPECIFIER::HEADERS)
                     {
                         /* Set specifiers. */
                         fLegacy       = (nType == SPECIFIER::LEGACY);
                         fTransactions = (nType == SPECIFIER::TRANSACTIONS);
                         fSyncBlock    = (nType == SPECIFIER::SYNC);
                         fClientBlock  = (nType == SPECIFIER::CLIENT);
+                        fHeaders      = (nType == SPECIFIER::HEADERS);
 
                         /* Go to next type in stream. */
                         ssPacket >> nType;
@@ -1334,13 +1398,7 @@ namespace LLP
 
                                     /* Handle for special sync block type specifier. */
                                     if(fSyncBlock)
-                                    {
-                                        /* Build the sync block from state. */
-                                        TAO::Ledger::SyncBlock block(state);
-
-                                        /* Push message in response. */
-                                        PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::SYNC), block);
-                                    }
+                                        PushBlock(state, SPECIFIER::SYNC);
 
                                     /* Handle for a client block header. */
                                     else if(fClientBlock)
@@ -1351,25 +1409,29 @@ namespace LLP
                                         /* Push message in response. */
                                         PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::CLIENT), block);
                                     }
+
+                                    /* Handle for headers of a headers-first sync, sent in the client block format. */
+                                    else if(fHeaders)
+                                    {
+                                        /* Build the header from state. */
+                                        TAO::Ledger::ClientBlock block(state);
+
+                                        /* Push message in response. */
+                                        PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::HEADERS), block);
+                                    }
                                     else
                                     {
                                         /* Check for version to send correct type */
                                         if(state.nVersion < 7)
-                                        {
-                                            /* Build the legacy block from state. */
-                                            Legacy::LegacyBlock block(state);
-
-                                            /* Push message in response. */
-                                            PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::LEGACY), block);
-                                        }
+                                            PushBlock(state, SPECIFIER::LEGACY);
                                         else
                                         {
-                                            /* Build the legacy block from state. */
-                                            TAO::Ledger::TritiumBlock block(state);
-
                                             /* Check for transactions. */
                                             if(fTransactions)
                                             {
+                                                /* Build the tritium block from state for its transactions without producers. */
+                                                TAO::Ledger::TritiumBlock block(state);
+
                                                 /* Loop through transactions. */
                                                 for(const auto& proof : block.vtx)
                                                 {
@@ -1401,7 +1463,7 @@ namespace LLP
                                             }
 
                                             /* Push message in response. */
-                                            PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::TRITIUM), block);
+                                            PushBlock(state, SPECIFIER::TRITIUM);
                                         }
                                     }
 
@@ -1449,6 +1511,10 @@ namespace LLP
                             if(fSyncBlock)
                                 return debug::drop(NODE, "cannot use SPECIFIER::SYNC for transaction lists");
 
+                            /* Check for invalid specifiers. */
+                            if(fHeaders)
+                                return debug::drop(NODE, "cannot use SPECIFIER::HEADERS for transaction lists");
+
                             /* Check for legacy. */
                             if(fLegacy)
                             {
@@ -1768,15 +1834,18 @@ namespace LLP
                     ssPacket >> nType;
 
                     /* Check for legacy or transactions specifiers. */
-                    bool fLegacy = false, fPoolstake = false, fTransactions = false, fClient = false;
+                    bool fLegacy = false, fPoolstake = false, fTransactions = false, fClient = false, fSyncBlock = false, fCompact = false;
                     if(nType == SPECIFIER::LEGACY || nType == SPECIFIER::POOLSTAKE
-                    || nType == SPECIFIER::TRANSACTIONS || nType == SPECIFIER::CLIENT)
+                    || nType == SPECIFIER::TRANSACTIONS || nType == SPECIFIER::CLIENT
+                    || nType == SPECIFIER::SYNC || nType == SPECIFIER::COMPACT)
                     {
                         /* Set specifiers. */
                         fLegacy       = (nType == SPECIFIER::LEGACY);
                         fPoolstake    = (nType == SPECIFIER::POOLSTAKE);
                         fTransactions = (nType == SPECIFIER::TRANSACTIONS);
                         fClient       = (nType == SPECIFIER::CLIENT);
+                        fSyncBlock    = (nType == SPECIFIER::SYNC);
+                        fCompact      = (nType == SPECIFIER::COMPACT);
 
                         /* Go to next type in stream. */
                         ssPacket >> nType;
@@ -1804,6 +1873,33 @@ namespace LLP
                             TAO::Ledger::BlockState state;
                             if(LLD::Ledger->ReadBlock(hashBlock, state))
                             {
+                                /* Handle for the block bodies of a headers-first sync. */
+                                if(fSyncBlock)
+                                {
+                                    /* Build the sync block from state. */
+                                    TAO::Ledger::SyncBlock block(state);
+
+                                    /* Push the sync block as response. */
+                                    PushMessage(TYPES::BLOCK, uint8_t(SPECIFIER::SYNC), block);
+
+                                    /* Debug output. */
+                                    debug::log(3, NODE, "ACTION::GET: SYNC::BLOCK ", hashBlock.SubString());
+
+                                    break;
+                                }
+
+                                /* Handle for compact blocks, which legacy blocks can't be. */
+                                if(fCompact && state.nVersion >= 7)
+                                {
+                                    /* Push the compact block from the cache. */
+                                    PushBlock(state, SPECIFIER::COMPACT);
+
+                                    /* Debug output. */
+                                    debug::log(3, NODE, "ACTION::GET: COMPACT::BLOCK ", hashBlock.SubString());
+
+                                    break;
+                                }
+
                                 /* Push legacy blocks for less than version 7. */
                                 if(state.nVersion < 7)
                                 {
@@ -1884,8 +1980,62 @@ namespace LLP
                         /* Standard type for a transaction. */
                         case TYPES::TRANSACTION:
                         {
+                            /* Handle for the missing transactions of a compact block. */
+                            if(fCompact)
+                            {
+                                /* Check for client mode since this method should never be called except by a client. */
+                                if(config::fClient.load())
+                                    return debug::drop(NODE, "ACTION::GET::COMPACT::TRANSACTION disabled in -client mode");
+
+                                /* Get the block and the indexes of its missing transactions. */
+                                uint1024_t hashBlock;
+                                std::vector<uint32_t> vIndexes;
+                                ssPacket >> hashBlock >> vIndexes;
+
+                                /* Check the database for the block. */
+                                TAO::Ledger::BlockState state;
+                                if(!LLD::Ledger->ReadBlock(hashBlock, state) || state.nVersion < 7)
+                                    break;
+
+                                /* Push the transactions in block order so they are accepted in sequence. */
+                                TAO::Ledger::TritiumBlock block(state);
+                                for(const auto& nIndex : vIndexes)
+                                {
+                                    /* Check the index is in the block. */
+                                    if(nIndex >= block.vtx.size())
+                                        return debug::drop(NODE, "ACTION::GET::COMPACT::TRANSACTION: index ", nIndex, " out of range");
+
+                                    /* Basic checks for legacy transactions. */
+                                    const auto& proof = block.vtx[nIndex];
+                                    if(proof.first == TAO::Ledger::TRANSACTION::LEGACY)
+                                    {
+                                        /* Check the legacy database. */
+                                        Legacy::Transaction tx;
+                                        if(LLD::Legacy->ReadTx(proof.second, tx, TAO::Ledger::FLAGS::MEMPOOL))
+                                            PushMessage(TYPES::TRANSACTION, uint8_t(SPECIFIER::LEGACY), tx);
+                                    }
+
+                                    /* Basic checks for tritium transactions. */
+                                    else if(proof.first == TAO::Ledger::TRANSACTION::TRITIUM)
+                                    {
+                                        /* Check the ledger database. */
+                                        TAO::Ledger::Transaction tx;
+                                        if(LLD::Ledger->ReadTx(proof.second, tx, TAO::Ledger::FLAGS::MEMPOOL))
+                                            PushMessage(TYPES::TRANSACTION, uint8_t(SPECIFIER::TRITIUM), tx);
+                                    }
+                                }
+
+                                /* Push the compact block again to be rebuilt with them. */
+                                PushBlock(state, SPECIFIER::COMPACT);
+
+                                /* Debug output. */
+                                debug::log(3, NODE, "ACTION::GET: COMPACT::TRANSACTION ", vIndexes.size(), " for ", hashBlock.SubString());
+
+                                break;
+                            }
+
                             /* Check for valid specifier. */
-                            if(fTransactions || fClient)
+                            if(fTransactions || fClient || fSyncBlock)
                                 return debug::drop(NODE, "ACTION::GET::TRANSACTION: invalid specifier for TYPES::TRANSACTION");
 
                             /* Get the index of transaction. */
@@ -2324,7 +2474,14 @@ namespace LLP
                             {
                                 /* Check the database for the block. */
                                 if(!LLD::Ledger->HasBlock(hashBlock))
+                                {
+                                    /* Ask for a compact block, rebuilt from our memory pool. */
+                                    if(nProtocolVersion >= MIN_COMPACT_VERSION && !TAO::Ledger::ChainState::Synchronizing()
+                                    && config::GetBoolArg("-compactblocks", true))
+                                        ssResponse << uint8_t(SPECIFIER::COMPACT);
+
                                     ssResponse << uint8_t(TYPES::BLOCK) << hashBlock;
+                                }
 
                                 /* Debug output. */
                                 debug::log(3, NODE, "ACTION::NOTIFY: BLOCK ", hashBlock.SubString());
@@ -2530,8 +2687,12 @@ namespace LLP
                                     uint1024_t hashLast;
                                     ssPacket >> hashLast;
 
+                                    /* Check for the end of a list of headers. */
+                                    if(nCurrentSession == TAO::Ledger::nSyncSession.load() && Download::Active())
+                                        Download::HeadersReceived(hashLast == hashBestChain);
+
                                     /* Check if is sync node. */
-                                    if(nCurrentSession == TAO::Ledger::nSyncSession.load())
+                                    else if(nCurrentSession == TAO::Ledger::nSyncSession.load())
                                     {
                                         /* Check for complete synchronization. */
                                         if(hashLast == TAO::Ledger::ChainState::hashBestChain.load()
@@ -2618,6 +2779,9 @@ namespace LLP
                                 fSynchronized.store(true);
                                 TAO::Ledger::nSyncSession.store(0);
 
+                                /* Stop any headers-first download. */
+                                Download::Stop();
+
                                 /* Unsubcribe from last. */
                                 Unsubscribe(SUBSCRIPTION::LASTINDEX);
 
@@ -2782,8 +2946,9 @@ namespace LLP
             /* Handle incoming block. */
             case TYPES::BLOCK:
             {
-                /* Check for subscription. */
-                if(!(nSubscriptions & SUBSCRIPTION::BLOCK) && TAO::Ledger::nSyncSession.load() != nCurrentSession)
+                /* Check for subscription, blocks of a headers-first sync come from any peer asked for them. */
+                if(!(nSubscriptions & SUBSCRIPTION::BLOCK) && TAO::Ledger::nSyncSession.load() != nCurrentSession
+                && !Download::Requested(nCurrentSession))
                     return debug::drop(NODE, "TYPES::BLOCK: unsolicited data");
 
                 /* Star the sync timer if this is the first sync block */
@@ -2834,6 +2999,7 @@ namespace LLP
 
                     /* Handle for a tritium transaction. */
                     case SPECIFIER::TRITIUM:
+                    case SPECIFIER::COMPACT:
                     {
                         /* Check for client mode since this method should never be called except by a client. */
                         if(config::fClient.load())
@@ -2841,7 +3007,17 @@ namespace LLP
 
                         /* Get the block from the stream. */
                         TAO::Ledger::TritiumBlock block;
-                        ssPacket >> block;
+                        if(nSpecifier == SPECIFIER::COMPACT)
+                        {
+                            /* Rebuild the block from short ids, waiting on the peer for anything missing. */
+                            TAO::Ledger::CompactBlock compact;
+                            ssPacket >> compact;
+
+                            if(!RebuildBlock(compact, block))
+                                break;
+                        }
+                        else
+                            ssPacket >> block;
 
                         /* Process the block. */
                         TAO::Ledger::Process(block, nStatus);
@@ -2933,6 +3109,9 @@ namespace LLP
 
                             /* Process the block. */
                             TAO::Ledger::Process(tritium, nStatus);
+
+                            /* Let the download know the block arrived. */
+                            Download::Received(tritium.GetHash(), block.nHeight, (nStatus & TAO::Ledger::PROCESS::REJECTED));
                         }
                         else
                         {
@@ -2945,12 +3124,44 @@ namespace LLP
 
                             /* Process the block. */
                             TAO::Ledger::Process(legacy, nStatus);
+
+                            /* Let the download know the block arrived. */
+                            Download::Received(legacy.GetHash(), block.nHeight, (nStatus & TAO::Ledger::PROCESS::REJECTED));
                         }
 
                         break;
                     }
 
 
+                    /* Handle for the headers of a headers-first sync. */
+                    case SPECIFIER::HEADERS:
+                    {
+                        /* Check for client mode since this method should never be called except by a client. */
+                        if(config::fClient.load())
+                            return debug::drop(NODE, "TYPES::BLOCK::HEADERS: disabled in -client mode");
+
+                        /* Headers are only listed by the sync node. */
+                        if(nCurrentSession != TAO::Ledger::nSyncSession.load())
+                            return debug::drop(NODE, "TYPES::BLOCK::HEADERS: unsolicited headers");
+
+                        /* Get the header from the stream. */
+                        TAO::Ledger::ClientBlock block;
+                        ssPacket >> block;
+
+                        /* Queue the header for download. */
+                        if(!Download::AddHeader(block))
+                        {
+                            ++nConsecutiveFails;
+                            break;
+                        }
+
+                        /* Headers keep the sync node from timing out. */
+                        nLastTimeReceived.store(runtime::timestamp());
+
+                        break;
+                    }
+
+
                     /* Handle for a tritium transaction. */
                     case SPECIFIER::CLIENT:
                     {
@@ -2997,7 +3208,7 @@ namespace LLP
                     nConsecutiveFails   = 0;
 
                     /* Reset last time received. */
-                    if(nCurrentSession == TAO::Ledger::nSyncSession.load())
+                    if(nCurrentSession == TAO::Ledger::nSyncSession.load() || Download::Active())
                         nLastTimeReceived.store(runtime::timestamp());
                 }
 
@@ -3258,7 +3469,8 @@ namespace LLP
                                 }
 
                                 /* Flush to disk and clear mempool. */
-                                LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK);
+                                if(!LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK))
+                                    return debug::error(FUNCTION, "tx ", hashTx.SubString(), " failed to commit");
                                 TAO::Ledger::mempool.Remove(hashTx);
 
                                 if(config::nVerbose >= 3)
@@ -3321,7 +3533,8 @@ namespace LLP
                                     }
 
                                     /* Flush to disk and clear mempool. */
-                                    LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK);
+                                    if(!LLD::TxnCommit(TAO::Ledger::FLAGS::BLOCK))
+                                        return debug::error(FUNCTION, "tx ", hashTx.SubString(), " failed to commit");
                                     TAO::Ledger::mempool.Remove(hashTx);
 
                                     debug::log(0, hashTx.SubString(), " ACCEPTED");
@@ -4031,12 +4244,102 @@ namespace LLP
     }
 
 
-    /* Checks if a node is subscribed to receive a notification. */
-    const DataStream TritiumNode::RelayFilter(const uint16_t nMsg, const DataStream& ssData) const
+    /* Writes a sync, legacy or tritium block message from the block cache, building and caching it on a miss. */
+    void TritiumNode::PushBlock(const TAO::Ledger::BlockState& state, const uint8_t nSpecifier)
+    {
+        /* Check the cache for the packet. */
+        const uint1024_t hashBlock = state.GetHash();
+
+        std::shared_ptr<std::vector<uint8_t>> pPacket;
+        if(!BlockCache::Get(hashBlock, nSpecifier, pPacket))
+        {
+            /* Build the block from state. */
+            DataStream ssData(SER_NETWORK, MIN_PROTO_VERSION);
+            ssData << nSpecifier;
+
+            switch(nSpecifier)
+            {
+                case SPECIFIER::SYNC:
+                    ssData << TAO::Ledger::SyncBlock(state);
+                    break;
+
+                case SPECIFIER::LEGACY:
+                    ssData << Legacy::LegacyBlock(state);
+                    break;
+
+                case SPECIFIER::TRITIUM:
+                    ssData << TAO::Ledger::TritiumBlock(state);
+                    break;
+
+                case SPECIFIER::COMPACT:
+                    ssData << TAO::Ledger::CompactBlock(TAO::Ledger::TritiumBlock(state));
+                    break;
+
+                default:
+                    debug::error(FUNCTION, "cannot cache block specifier ", uint32_t(nSpecifier));
+                    return;
+            }
+
+            /* Frame the packet once for every peer that asks for the block. */
+            pPacket = std::make_shared<std::vector<uint8_t>>(NewMessage(TYPES::BLOCK, ssData).GetBytes());
+            BlockCache::Put(hashBlock, nSpecifier, pPacket);
+        }
+
+        /* Write the cached packet. */
+        WritePacket(pPacket);
+
+        debug::log(4, NODE, "sent block ", hashBlock.SubString(), " of ", pPacket->size(), " bytes");
+    }
+
+
+    /* Rebuilds a compact block from the memory pool. */
+    bool TritiumNode::RebuildBlock(const TAO::Ledger::CompactBlock& compact, TAO::Ledger::TritiumBlock& block)
     {
-        /* The data stream to relay*/
-        DataStream ssRelay(SER_NETWORK, MIN_PROTO_VERSION);
+        /* Skip blocks that are already on disk. */
+        const uint1024_t hashBlock = compact.GetHash();
+        if(LLD::Ledger->HasBlock(hashBlock))
+            return false;
+
+        /* Get the transactions held in the memory pool. */
+        std::vector<uint512_t> vLedger, vLegacy;
+        TAO::Ledger::mempool.Hashes(vLedger);
+        TAO::Ledger::mempool.Hashes(vLegacy, true);
+
+        /* Check if the block was rebuilt. */
+        std::vector<uint32_t> vMissing;
+        const bool fBuilt = compact.Build(vLedger, vLegacy, block, vMissing);
+        if(fBuilt && vMissing.empty())
+        {
+            debug::log(3, NODE, "rebuilt compact block ", hashBlock.SubString(), " with ", block.vtx.size(), " transactions");
+
+            hashCompact = 0;
+            return true;
+        }
+
+        /* Ask for the missing transactions once, the block is sent again after them. */
+        if(fBuilt && hashCompact != hashBlock)
+        {
+            debug::log(2, NODE, "requesting ", vMissing.size(), " missing transactions for compact block ", hashBlock.SubString());
+
+            hashCompact = hashBlock;
+            PushMessage(ACTION::GET, uint8_t(SPECIFIER::COMPACT), uint8_t(TYPES::TRANSACTION), hashBlock, vMissing);
+
+            return false;
+        }
+
+        /* Ask for the full block with its transactions. */
+        debug::log(2, NODE, "compact block ", hashBlock.SubString(), " not rebuilt, requesting full block");
+
+        hashCompact = 0;
+        PushMessage(ACTION::GET, uint8_t(SPECIFIER::TRANSACTIONS), uint8_t(TYPES::BLOCK), hashBlock);
+
+        return false;
+    }
+
 
+    /* Checks if a node is subscribed to receive a notification. */
+    bool TritiumNode::RelayFilter(const uint16_t nMsg, const DataStream& ssData, DataStream& ssRelay) const
+    {
         /* Switch based on message type */
         switch(nMsg)
         {
@@ -4053,19 +4356,14 @@ namespace LLP
                     case TYPES::P2PCONNECTION:
                     {
                         /* Ensure the peer is on a high enough version to receive the P2PCONNECTION message */
-                        if(nProtocolVersion >= MIN_TRITIUM_VERSION)
-                            ssRelay = ssData;
-                        break;
+                        return (nProtocolVersion >= MIN_TRITIUM_VERSION);
                     }
                     default:
                     {
                         /* Default to letting the message be relayed */
-                        ssRelay = ssData;
-                        break;
+                        return true;
                     }
                 }
-
-                break;
             }
 
             /* Filter notifications. */
@@ -4320,23 +4618,20 @@ namespace LLP
                         default:
                         {
                             debug::error(FUNCTION, "Malformed binary stream");
-                            return ssRelay;
+                            return false;
                         }
                     }
                 }
 
-                break;
+                /* The notifications are only kept or dropped, so the same size means all of them were kept. */
+                return (ssRelay.size() == ssData.size());
             }
             default:
             {
                 /* default behaviour is to let the message be relayed */
-                ssRelay = ssData;
-                break;
+                return true;
             }
         }
-
-
-        return ssRelay;
     }
 
 
@@ -4406,6 +4701,9 @@ namespace LLP
             /* Reset the current sync node. */
             TAO::Ledger::nSyncSession.store(0);
 
+            /* Stop downloading without headers to follow. */
+            Download::Stop();
+
             /* Logging to verify (for debugging). */
             debug::log(0, FUNCTION, "No Sync Nodes Available");
         }
@@ -4692,6 +4990,31 @@ namespace LLP
         /* Subscribe t3o this node. */
         Subscribe(SUBSCRIPTION::LASTINDEX | SUBSCRIPTION::BESTCHAIN | SUBSCRIPTION::BESTHEIGHT);
 
+        /* List headers first and download the blocks from every peer when the sync node supports it. */
+        if(!config::fClient.load() && nProtocolVersion >= MIN_HEADERS_VERSION && config::GetBoolArg("-headersfirst", true))
+        {
+            /* Start the download from our best chain. */
+            Download::Start(TAO::Ledger::ChainState::hashBestChain.load());
+
+            /* Ask for the first headers from a locator, in case we are on a fork. */
+            uint1024_t hashFrom;
+            if(Download::RequestHeaders(hashFrom))
+            {
+                PushMessage(ACTION::LIST,
+                    uint8_t(SPECIFIER::HEADERS),
+                    uint8_t(TYPES::BLOCK),
+                    uint8_t(TYPES::LOCATOR),
+                    TAO::Ledger::Locator(hashFrom),
+                    uint1024_t(0)
+                );
+            }
+
+            return;
+        }
+
+        /* Otherwise stop any headers-first download of a previous sync node. */
+        Download::Stop();
+
         /* Ask for list of blocks if this is current sync node. */
         PushMessage(ACTION::LIST,
             config::fClient.load() ? uint8_t(SPECIFIER::CLIENT) : uint8_t(SPECIFIER::SYNC),
@@ -25,6 +25,7 @@ ________________________________________________________________________________
 #include <LLP/templates/ddos.h>
 #include <LLP/templates/trigger.h>
 
+#include <TAO/Ledger/types/compactblock.h>
 #include <TAO/Ledger/types/tritium.h>
 
 #include <Util/include/memory.h>
@@ -107,6 +108,8 @@ namespace LLP
                 TRANSACTIONS = 0x43, //specify to send memory transactions first
                 CLIENT       = 0x44, //specify for blocks to be sent and received for clients
                 POOLSTAKE    = 0x45, //specify for pooled coinstake transactions
+                HEADERS      = 0x46, //specify for block headers of a headers-first sync
+                COMPACT      = 0x47, //specify for blocks with short transaction ids
             };
         }
 
@@ -291,6 +294,10 @@ namespace LLP
         uint1024_t hashLastIndex;
 
 
+        /** The last compact block asked for missing transactions. **/
+        uint1024_t hashCompact;
+
+
         /** Counter of total orphans. **/
         uint32_t nConsecutiveOrphans;
 
@@ -403,10 +410,14 @@ namespace LLP
          *
          *  Checks if a node is subscribed to receive a notification.
          *
-         *  @return a data stream with relevant relay information
+         *  @param[in] nMsg The message to relay.
+         *  @param[in] ssData The data of the message.
+         *  @param[out] ssRelay The relevant relay information, if not relaying the whole message.
+         *
+         *  @return true if the node is subscribed to the whole message.
          *
          **/
-        const DataStream RelayFilter(const uint16_t nMsg, const DataStream& ssData) const;
+        bool RelayFilter(const uint16_t nMsg, const DataStream& ssData, DataStream& ssRelay) const;
 
 
         /** Auth
@@ -503,6 +514,32 @@ namespace LLP
         }
 
 
+        /** PushBlock
+         *
+         *  Writes a sync, legacy, tritium or compact block message from the block cache,
+         *  building and caching it on a miss.
+         *
+         *  @param[in] state The block state to send.
+         *  @param[in] nSpecifier The specifier of the block format.
+         *
+         **/
+        void PushBlock(const TAO::Ledger::BlockState& state, const uint8_t nSpecifier);
+
+
+        /** RebuildBlock
+         *
+         *  Rebuilds a compact block from the memory pool. Missing transactions are asked for once,
+         *  after which the full block is asked for instead.
+         *
+         *  @param[in] compact The compact block received.
+         *  @param[out] block The rebuilt tritium block.
+         *
+         *  @return true if the block was rebuilt and can be processed.
+         *
+         **/
+        bool RebuildBlock(const TAO::Ledger::CompactBlock& compact, TAO::Ledger::TritiumBlock& block);
+
+
         /** BlockingMessage
          *
          *  Adds a tritium packet to the queue and waits for the peer to send a COMPLETED message.
@@ -547,7 +547,8 @@ namespace Legacy
         }
 
         /* Commit the transaction to database. */
-        LLD::TxnCommit();
+        if(!LLD::TxnCommit())
+            return debug::error(FUNCTION, "failed to commit block to database");
 
         return true;
     }
@@ -44,14 +44,8 @@ namespace TAO
 
             RLOCK(MUTEX);
 
-            /* Check the mempool. */
-            if(mapLegacy.count(nTxHash))
-                return false;
-
-            /* Add to the map. */
-            mapLegacy[nTxHash] = tx;
-
-            return true;
+            /* Add to the map if not in the mempool. */
+            return mapLegacy.insert(nTxHash, tx);
         }
 
 
@@ -95,7 +89,7 @@ namespace TAO
                 {
                     /* Add to conflicts map. */
                     debug::error(FUNCTION, "LEGACY CONFLICT: INPUTS CLAIMED ", vin.prevout.hash.SubString(), ", ", vin.prevout.n);
-                    mapLegacyConflicts[hashTx] = tx;
+                    mapLegacyConflicts.set(hashTx, tx);
 
                     return false;
                 }
@@ -229,7 +223,7 @@ namespace TAO
                 mapInputs[tx.vin[i].prevout] = hashTx;
 
             /* Add to the legacy map. */
-            mapLegacy[hashTx] = tx;
+            mapLegacy.set(hashTx, tx);
 
             /* Relay tx if creating ourselves. */
             if(!pnode && LLP::TRITIUM_SERVER)
@@ -260,13 +254,9 @@ namespace TAO
         /* Gets a legacy transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, Legacy::Transaction &tx, bool &fConflicted) const
         {
-            RLOCK(MUTEX);
-
             /* Check in conflict memory. */
-            if(mapLegacyConflicts.count(hashTx))
+            if(mapLegacyConflicts.get(hashTx, tx))
             {
-                /* Get from conflicts map. */
-                tx = mapLegacyConflicts.at(hashTx);
                 fConflicted = true;
 
                 debug::log(0, FUNCTION, "CONFLICTED TRANSACTION: ", hashTx.SubString());
@@ -274,40 +264,22 @@ namespace TAO
                 return true;
             }
 
-            /* Check the memory map. */
-            if(mapLegacy.count(hashTx))
-            {
-                /* Get the transaction from memory. */
-                tx = mapLegacy.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            /* Get the transaction from memory. */
+            return mapLegacy.get(hashTx, tx);
         }
 
         /* Gets a legacy transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, Legacy::Transaction &tx) const
         {
-            RLOCK(MUTEX);
-
-            /* Check the memory map. */
-            if(!mapLegacy.count(hashTx))
-                return false;
-
             /* Get the transaction from memory. */
-            tx = mapLegacy.at(hashTx);
-
-            return true;
+            return mapLegacy.get(hashTx, tx);
         }
 
 
         /* Gets the size of the memory pool. */
         uint32_t Mempool::SizeLegacy()
         {
-            RLOCK(MUTEX);
-
-            return mapLegacy.size();
+            return static_cast<uint32_t>(mapLegacy.size());
         }
 
     }
@@ -63,6 +63,7 @@ namespace Legacy
         vin           = tx.vin;
         vout          = tx.vout;
         nLockTime     = tx.nLockTime;
+        hashCache     = tx.hashCache;
         hashBlock     = tx.hashBlock;
         vMerkleBranch = tx.vMerkleBranch;
         nIndex        = tx.nIndex;
@@ -79,6 +80,7 @@ namespace Legacy
         vin           = std::move(tx.vin);
         vout          = std::move(tx.vout);
         nLockTime     = std::move(tx.nLockTime);
+        hashCache     = std::move(tx.hashCache);
         hashBlock     = std::move(tx.hashBlock);
         vMerkleBranch = std::move(tx.vMerkleBranch);
         nIndex        = std::move(tx.nIndex);
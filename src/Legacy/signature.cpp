@@ -82,6 +82,7 @@ namespace Legacy
         }
 
         Transaction txTmp(txTo);
+        txTmp.hashCache = 0; //the copy is changed below
 
         /* Precompute the input count. */
         uint32_t nTxInSize = static_cast<uint32_t>(txTmp.vin.size());
@@ -51,6 +51,7 @@ namespace Legacy
     , vin       ( )
     , vout      ( )
     , nLockTime (0)
+    , hashCache (0)
     {
     }
 
@@ -62,6 +63,7 @@ namespace Legacy
     , vin       (tx.vin)
     , vout      (tx.vout)
     , nLockTime (tx.nLockTime)
+    , hashCache (tx.hashCache)
     {
     }
 
@@ -73,6 +75,7 @@ namespace Legacy
     , vin       (std::move(tx.vin))
     , vout      (std::move(tx.vout))
     , nLockTime (std::move(tx.nLockTime))
+    , hashCache (std::move(tx.hashCache))
     {
     }
 
@@ -84,6 +87,7 @@ namespace Legacy
     , vin       (tx.vin)
     , vout      (tx.vout)
     , nLockTime (tx.nLockTime)
+    , hashCache (tx.hashCache)
     {
     }
 
@@ -95,6 +99,7 @@ namespace Legacy
     , vin       (std::move(tx.vin))
     , vout      (std::move(tx.vout))
     , nLockTime (std::move(tx.nLockTime))
+    , hashCache (std::move(tx.hashCache))
     {
     }
 
@@ -107,6 +112,7 @@ namespace Legacy
         vin       = tx.vin;
         vout      = tx.vout;
         nLockTime = tx.nLockTime;
+        hashCache = tx.hashCache;
 
         return *this;
     }
@@ -120,6 +126,7 @@ namespace Legacy
         vin       = std::move(tx.vin);
         vout      = std::move(tx.vout);
         nLockTime = std::move(tx.nLockTime);
+        hashCache = std::move(tx.hashCache);
 
         return *this;
     }
@@ -133,6 +140,7 @@ namespace Legacy
         vin       = tx.vin;
         vout      = tx.vout;
         nLockTime = tx.nLockTime;
+        hashCache = tx.hashCache;
 
         return *this;
     }
@@ -146,6 +154,7 @@ namespace Legacy
         vin       = std::move(tx.vin);
         vout      = std::move(tx.vout);
         nLockTime = std::move(tx.nLockTime);
+        hashCache = std::move(tx.hashCache);
 
         return *this;
     }
@@ -164,6 +173,7 @@ namespace Legacy
     , vin       ( )
     , vout      ( )
     , nLockTime (0)
+    , hashCache (0)
     {
         /* Loop through the contracts. */
         for(uint32_t n = 0; n < tx.Size(); ++n)
@@ -184,6 +194,7 @@ namespace Legacy
 		vin.clear();
 		vout.clear();
 		nLockTime = 0;
+		hashCache = 0;
 	}
 
 
@@ -197,6 +208,10 @@ namespace Legacy
 	/* Returns the hash of this object. */
 	uint512_t Transaction::GetHash() const
 	{
+        /* Check for a cached hash. */
+        if(hashCache != 0)
+            return hashCache;
+
         // Most of the time is spent allocating and deallocating DataStream's
 	    // buffer.  If this ever needs to be optimized further, make a CStaticStream
 	    // class with its buffer on the stack.
@@ -69,6 +69,10 @@ namespace Legacy
 		uint32_t nLockTime;
 
 
+		/** Memory only, the hash of a transaction read from a stream. Never set for transactions built in memory. **/
+		mutable uint512_t hashCache;
+
+
 		//serialization methods
 		IMPLEMENT_SERIALIZE
 		(
@@ -77,6 +81,13 @@ namespace Legacy
 			READWRITE(vin);
 			READWRITE(vout);
 			READWRITE(nLockTime);
+
+			/* Hash once when read, the transaction won't change after. */
+			if(fRead)
+			{
+				hashCache = 0;
+				hashCache = GetHash();
+			}
 		)
 
 
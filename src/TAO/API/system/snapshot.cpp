@@ -0,0 +1,53 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/snapshot.h>
+
+#include <TAO/API/include/global.h>
+#include <TAO/API/system/types/system.h>
+
+#include <Util/include/args.h>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* API Layer namespace. */
+    namespace API
+    {
+        /* Writes a snapshot of the ledger databases at the best chain. */
+        json::json System::Snapshot(const json::json& params, bool fHelp)
+        {
+            if(fHelp || params.size() != 0)
+                return std::string("create/snapshot: no parameters required");
+
+            /* Snapshots are always written to the data directory. */
+            const std::string strPath = config::GetDataDir() + "snapshot.dat";
+
+            /* Write the snapshot, block commits only wait while it takes its cut. */
+            LLD::Snapshot::Header header;
+            uint256_t hashCommit = 0;
+            if(!LLD::Snapshot::Export(strPath, header, hashCommit))
+                throw APIException(-309, "Failed to write snapshot");
+
+            /* Build json response. */
+            json::json jsonRet;
+            jsonRet["path"]       = strPath;
+            jsonRet["height"]     = header.nHeight;
+            jsonRet["hash"]       = header.hashBlock.GetHex();
+            jsonRet["commitment"] = hashCommit.GetHex();
+
+            return jsonRet;
+        }
+    }
+}
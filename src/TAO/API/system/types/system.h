@@ -140,6 +140,20 @@ namespace TAO
 
 
 
+            /** Snapshot
+             *
+             *  Writes a snapshot of the ledger databases at the best chain
+             *
+             *  @param[in] params The parameters from the API call.
+             *  @param[in] fHelp Trigger for help data.
+             *
+             *  @return The return object in JSON.
+             *
+             **/
+            json::json Snapshot(const json::json& params, bool fHelp);
+
+
+
         private:
 
             /** count_registers
@@ -0,0 +1,418 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <TAO/Ledger/include/blockindex.h>
+#include <TAO/Ledger/types/state.h>
+
+#include <LLD/include/global.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Default Constructor. */
+        CompactState::CompactState()
+        : hashBlock      (0)
+        , hashPrevBlock  (0)
+        , hashNextBlock  (0)
+        , nHeight        (0)
+        , nChannel       (0)
+        , nChannelHeight (0)
+        , nBits          (0)
+        , nTime          (0)
+        , nChainTrust    (0)
+        {
+        }
+
+
+        /* Block State Constructor. */
+        CompactState::CompactState(const BlockState& state)
+        : hashBlock      (state.GetHash())
+        , hashPrevBlock  (state.hashPrevBlock)
+        , hashNextBlock  (state.hashNextBlock)
+        , nHeight        (state.nHeight)
+        , nChannel       (state.GetChannel())
+        , nChannelHeight (state.nChannelHeight)
+        , nBits          (state.nBits)
+        , nTime          (state.GetBlockTime())
+        , nChainTrust    (state.nChainTrust)
+        {
+        }
+
+
+        /* Determines if the state is in a null state. */
+        bool CompactState::IsNull() const
+        {
+            return hashBlock == 0;
+        }
+
+
+        namespace BlockIndex
+        {
+
+            /* Channel links that haven't been resolved yet, or that have no block to point to. */
+            const uint1024_t LINK_UNKNOWN = 0;
+            const uint1024_t LINK_NONE    = ~uint1024_t(0);
+
+
+            /* The channels a block can be produced in. */
+            const uint32_t MAX_CHANNELS = 4;
+
+
+            /* A resident header with its channel back-links. */
+            struct IndexEntry
+            {
+                /* The compact header. */
+                CompactState state;
+
+                /* The hash of the last block of each channel at or before this one. */
+                uint1024_t hashLast[MAX_CHANNELS];
+            };
+
+
+            /* Bucket block hashes by their low bits, which are already uniformly distributed. */
+            struct IndexHash
+            {
+                size_t operator()(const uint1024_t& hashBlock) const
+                {
+                    return static_cast<size_t>(hashBlock.Get64(0));
+                }
+            };
+
+
+            /* Mutex for thread concurrency. */
+            std::mutex INDEX_MUTEX;
+
+
+            /* The resident headers, keyed by their full hash. */
+            std::unordered_map<uint1024_t, IndexEntry, IndexHash> mapIndex;
+
+
+            /* The highest block indexed, used to prune old heights. */
+            uint32_t nMaxHeight = 0;
+
+
+            /* Flag to indicate a ledger transaction is open, changes are journaled until it ends. */
+            bool fTxn = false;
+
+
+            /* The entries as they were before the open transaction changed them, flagged false if they weren't resident. */
+            std::map<uint1024_t, std::pair<bool, IndexEntry>> mapUndo;
+
+
+            /* The highest block indexed before the open transaction. */
+            uint32_t nUndoHeight = 0;
+
+
+            /* Record an entry before the open transaction changes it. Must hold INDEX_MUTEX. */
+            void journal(const uint1024_t& hashBlock)
+            {
+                if(!fTxn || mapUndo.count(hashBlock))
+                    return;
+
+                auto it = mapIndex.find(hashBlock);
+                if(it == mapIndex.end())
+                    mapUndo[hashBlock] = std::make_pair(false, IndexEntry());
+                else
+                    mapUndo[hashBlock] = std::make_pair(true, it->second);
+            }
+
+
+            /* Find a resident entry. Must hold INDEX_MUTEX. */
+            IndexEntry* find(const uint1024_t& hashBlock)
+            {
+                auto it = mapIndex.find(hashBlock);
+                if(it == mapIndex.end())
+                    return nullptr;
+
+                return &it->second;
+            }
+
+
+            /* Add or refresh an entry, linking it to its previous block if resident. Must hold INDEX_MUTEX. */
+            IndexEntry* insert(const CompactState& state)
+            {
+                journal(state.hashBlock);
+
+                /* Headers don't change once written, only the next block pointer does. */
+                IndexEntry* pentry = find(state.hashBlock);
+                if(pentry)
+                {
+                    pentry->state = state;
+                    return pentry;
+                }
+
+                IndexEntry& entry = mapIndex[state.hashBlock];
+                entry.state = state;
+
+                /* Inherit the channel links of the previous block. */
+                const IndexEntry* pprev = find(state.hashPrevBlock);
+                for(uint32_t n = 0; n < MAX_CHANNELS; ++n)
+                {
+                    if(state.nHeight == 0 || (pprev && pprev->state.nHeight == 0))
+                        entry.hashLast[n] = LINK_NONE;
+                    else
+                        entry.hashLast[n] = pprev ? pprev->hashLast[n] : LINK_UNKNOWN;
+                }
+
+                /* The genesis doesn't count as a block of its channel. */
+                if(state.nHeight > 0 && state.nChannel < MAX_CHANNELS)
+                    entry.hashLast[state.nChannel] = state.hashBlock;
+
+                nMaxHeight = std::max(nMaxHeight, state.nHeight);
+
+                return &entry;
+            }
+
+
+            /* Read an entry from the ledger. Must hold INDEX_MUTEX. */
+            IndexEntry* load(const uint1024_t& hashBlock)
+            {
+                BlockState state;
+                if(!LLD::Ledger->ReadBlock(hashBlock, state))
+                    return nullptr;
+
+                return insert(CompactState(state));
+            }
+
+
+            /* Drop the oldest heights once the index is full. Must hold INDEX_MUTEX. */
+            void prune()
+            {
+                /* An open transaction prunes when it commits, so an abort has nothing to bring back. */
+                if(fTxn || mapIndex.size() <= MAX_BLOCK_INDEX)
+                    return;
+
+                /* Keep the most recent half, links into the pruned part resolve again on demand. */
+                const uint32_t nCutoff = (nMaxHeight > MAX_BLOCK_INDEX / 2) ? nMaxHeight - MAX_BLOCK_INDEX / 2 : 0;
+                for(auto it = mapIndex.begin(); it != mapIndex.end(); )
+                {
+                    if(it->second.state.nHeight < nCutoff)
+                        it = mapIndex.erase(it);
+                    else
+                        ++it;
+                }
+            }
+
+
+            /* Load the headers of the most recent blocks of the best chain. */
+            void Initialize(const uint1024_t& hashBest)
+            {
+                /* Collect the headers walking back from the best block. */
+                std::vector<CompactState> vStates;
+
+                uint1024_t hashBlock = hashBest;
+                for(uint32_t n = 0; n < BLOCK_INDEX_WARMUP && hashBlock != 0; ++n)
+                {
+                    BlockState state;
+                    if(!LLD::Ledger->ReadBlock(hashBlock, state))
+                        break;
+
+                    vStates.push_back(CompactState(state));
+                    hashBlock = state.hashPrevBlock;
+                }
+
+                /* Insert oldest first so each block inherits the links of its previous block. */
+                LOCK(INDEX_MUTEX);
+                for(auto it = vStates.rbegin(); it != vStates.rend(); ++it)
+                    insert(*it);
+
+                debug::log(0, FUNCTION, "Loaded ", vStates.size(), " block headers");
+            }
+
+
+            /* Add or refresh the header of a block state as it is written. */
+            void Update(const BlockState& state)
+            {
+                const CompactState compact(state);
+
+                LOCK(INDEX_MUTEX);
+                insert(compact);
+                prune();
+            }
+
+
+            /* Remove a block header as it is erased. */
+            void Erase(const uint1024_t& hashBlock)
+            {
+                LOCK(INDEX_MUTEX);
+
+                /* Links to the erased block resolve again on demand. */
+                journal(hashBlock);
+                mapIndex.erase(hashBlock);
+            }
+
+
+            /* Get the header of a block, reading it from the ledger if it isn't resident. */
+            bool Get(const uint1024_t& hashBlock, CompactState& state)
+            {
+                LOCK(INDEX_MUTEX);
+
+                IndexEntry* pentry = find(hashBlock);
+                if(!pentry)
+                    pentry = load(hashBlock);
+
+                if(!pentry)
+                    return false;
+
+                state = pentry->state;
+                return true;
+            }
+
+
+            /* Get the last block of a channel at or before a given block, excluding the genesis. */
+            bool GetLast(const uint1024_t& hashBlock, const uint32_t nChannel, CompactState& state)
+            {
+                if(nChannel >= MAX_CHANNELS)
+                    return false;
+
+                LOCK(INDEX_MUTEX);
+
+                IndexEntry* pentry = find(hashBlock);
+                if(!pentry)
+                    pentry = load(hashBlock);
+
+                if(!pentry)
+                    return false;
+
+                /* Walk back until a block of the channel or a resolved link is found. */
+                std::vector<IndexEntry*> vPath;
+                uint1024_t hashResult = LINK_UNKNOWN;
+                while(true)
+                {
+                    /* Check for genesis. */
+                    if(pentry->state.nHeight == 0)
+                    {
+                        hashResult = LINK_NONE;
+                        break;
+                    }
+
+                    /* Check the link of this channel. */
+                    const uint1024_t& hashLink = pentry->hashLast[nChannel];
+                    if(hashLink == LINK_NONE || (hashLink != LINK_UNKNOWN && mapIndex.count(hashLink)))
+                    {
+                        hashResult = hashLink;
+                        break;
+                    }
+
+                    /* Iterate backwards, reading any block that isn't resident. */
+                    vPath.push_back(pentry);
+
+                    IndexEntry* pprev = find(pentry->state.hashPrevBlock);
+                    if(!pprev)
+                        pprev = load(pentry->state.hashPrevBlock);
+
+                    if(!pprev)
+                        return debug::error(FUNCTION, "failed to read previous block ", pentry->state.hashPrevBlock.SubString());
+
+                    pentry = pprev;
+                }
+
+                /* Remember the answer along the walk so the next search is a single lookup. */
+                for(auto& pvisited : vPath)
+                {
+                    journal(pvisited->state.hashBlock);
+                    pvisited->hashLast[nChannel] = hashResult;
+                }
+
+                if(hashResult == LINK_NONE)
+                    return false;
+
+                state = mapIndex[hashResult].state;
+                return true;
+            }
+
+
+            /* Get the number of resident headers. */
+            uint64_t Size()
+            {
+                LOCK(INDEX_MUTEX);
+                return mapIndex.size();
+            }
+
+
+            /* Remove every resident header. */
+            void Clear()
+            {
+                LOCK(INDEX_MUTEX);
+
+                mapIndex.clear();
+                nMaxHeight = 0;
+
+                /* Nothing is left for an abort to bring back. */
+                mapUndo.clear();
+                nUndoHeight = 0;
+            }
+
+
+            /* Start journaling changes for a ledger transaction. */
+            void TxnBegin()
+            {
+                LOCK(INDEX_MUTEX);
+
+                mapUndo.clear();
+                nUndoHeight = nMaxHeight;
+                fTxn        = true;
+            }
+
+
+            /* Keep the changes of a ledger transaction that was applied. */
+            void TxnCommit()
+            {
+                LOCK(INDEX_MUTEX);
+
+                mapUndo.clear();
+                fTxn = false;
+
+                prune();
+            }
+
+
+            /* Revert the changes of a ledger transaction that wasn't applied. */
+            void TxnAbort()
+            {
+                LOCK(INDEX_MUTEX);
+
+                /* Check that a transaction was started. */
+                if(!fTxn)
+                    return;
+
+                /* Put back every entry as it was before the transaction. */
+                for(const auto& undo : mapUndo)
+                {
+                    if(undo.second.first)
+                        mapIndex[undo.first] = undo.second.second;
+                    else
+                        mapIndex.erase(undo.first);
+                }
+
+                mapUndo.clear();
+                nMaxHeight = nUndoHeight;
+                fTxn       = false;
+            }
+        }
+    }
+}
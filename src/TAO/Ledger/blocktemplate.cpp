@@ -0,0 +1,275 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/global.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Ledger/include/constants.h>
+#include <TAO/Ledger/include/enum.h>
+
+#include <TAO/Ledger/types/blocktemplate.h>
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/tritium.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+#include <Util/include/runtime.h>
+
+#include <algorithm>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Higher fee rates first, then older chains. */
+        bool BlockTemplate::Priority::operator<(const Priority& priority) const
+        {
+            if(nFeeRate != priority.nFeeRate)
+                return nFeeRate > priority.nFeeRate;
+
+            if(nOrder != priority.nOrder)
+                return nOrder < priority.nOrder;
+
+            return hashGenesis < priority.hashGenesis;
+        }
+
+
+        /* Get the fees a chain pays per kilobyte. */
+        uint64_t BlockTemplate::FeeRate(const uint64_t nFees, const uint64_t nBytes)
+        {
+            return (nFees * 1000) / std::max(nBytes, uint64_t(1));
+        }
+
+
+        /* Default Constructor. */
+        BlockTemplate::BlockTemplate()
+        : TEMPLATE_MUTEX ( )
+        , hashBestChain  (0)
+        , mapChains      ( )
+        , setPriority    ( )
+        , setRetry       ( )
+        , vChecked       ( )
+        , nOrder         (0)
+        {
+        }
+
+
+        /* Singleton instance. */
+        BlockTemplate& BlockTemplate::GetInstance()
+        {
+            static BlockTemplate ret;
+            return ret;
+        }
+
+
+        /* Add the highest ranked transactions that fit to a block. */
+        void BlockTemplate::Add(TAO::Ledger::TritiumBlock& block, const uint1024_t& hashBest)
+        {
+            LOCK(TEMPLATE_MUTEX);
+
+            /* Every transaction adds the same size to the block. */
+            uint64_t nSize = ::GetSerializeSize(block, SER_NETWORK, LLP::PROTOCOL_VERSION);
+            const std::pair<uint8_t, uint512_t> pairEntry(TRANSACTION::TRITIUM, 0);
+            const uint64_t nEntry = ::GetSerializeSize(pairEntry, uint32_t(SER_NETWORK), LLP::PROTOCOL_VERSION);
+
+            /* Check the ranked chains together again if any of them changed since the last block. */
+            if(Update(hashBest))
+                Check(nSize);
+
+            /* Add the checked transactions in order of rank. */
+            for(const auto& hashTx : vChecked)
+            {
+                /* Check the Size limits of the Current Block. */
+                if(nSize + 256 >= MAX_BLOCK_SIZE)
+                    return;
+
+                /* Add the transaction to the block. */
+                block.vtx.push_back(std::make_pair(TRANSACTION::TRITIUM, hashTx));
+                nSize += nEntry;
+            }
+        }
+
+
+        /* Read the signature chains the memory pool changed since the last update. */
+        bool BlockTemplate::Update(const uint1024_t& hashBest)
+        {
+            /* Start over when the best chain changes, keeping the order chains were seen in. */
+            std::map<uint256_t, Chain> mapPrev;
+            const bool fAll = (hashBest != hashBestChain);
+            if(fAll)
+            {
+                mapPrev.swap(mapChains);
+                setPriority.clear();
+                vChecked.clear();
+
+                hashBestChain = hashBest;
+            }
+
+            /* Get the chains to read. */
+            std::set<uint256_t> setGenesis;
+            mempool.Updated(setGenesis, fAll);
+            setGenesis.insert(setRetry.begin(), setRetry.end());
+            setRetry.clear();
+
+            if(setGenesis.empty())
+                return fAll;
+
+            /* Read the chains from the memory pool. */
+            for(const auto& hashGenesis : setGenesis)
+            {
+                /* Keep the place of a chain that was seen before. */
+                uint64_t nChainOrder = 0;
+                if(mapChains.count(hashGenesis))
+                    nChainOrder = mapChains[hashGenesis].priority.nOrder;
+                else if(mapPrev.count(hashGenesis))
+                    nChainOrder = mapPrev[hashGenesis].priority.nOrder;
+                else
+                    nChainOrder = nOrder++;
+
+                Erase(hashGenesis);
+
+                /* Get the transactions of the chain in sequence. */
+                std::vector<TAO::Ledger::Transaction> vtx;
+                if(!mempool.Get(hashGenesis, vtx))
+                    continue;
+
+                /* Take the transactions up to the first that can't be mined yet. */
+                Chain chain;
+                uint64_t nFees = 0;
+                uint64_t nBytes = 0;
+                for(const auto& tx : vtx)
+                {
+                    /* Don't add transactions that are coinbase or coinstake. */
+                    if(tx.IsCoinBase() || tx.IsCoinStake())
+                    {
+                        debug::log(2, FUNCTION, "Skipping transaction ", tx.GetHash().SubString(), " - tx is coinbase/coinstake");
+                        break;
+                    }
+
+                    /* Check for timestamp violations. */
+                    if(tx.nTimestamp > runtime::unifiedtimestamp() + runtime::maxdrift())
+                    {
+                        setRetry.insert(hashGenesis);
+
+                        debug::log(2, FUNCTION, "Skipping transaction ", tx.GetHash().SubString(), " - timesamp too far in future");
+                        break;
+                    }
+
+                    /* Add the transaction to the chain. */
+                    chain.vtx.push_back(tx);
+                    nFees  += tx.Fees();
+                    nBytes += ::GetSerializeSize(tx, SER_NETWORK, LLP::PROTOCOL_VERSION);
+                }
+
+                /* Check that any of the chain can be mined. */
+                if(chain.vtx.empty())
+                    continue;
+
+                /* Rank the chain by the fees it pays per kilobyte. */
+                chain.priority.nFeeRate    = FeeRate(nFees, nBytes);
+                chain.priority.nOrder      = nChainOrder;
+                chain.priority.hashGenesis = hashGenesis;
+
+                setPriority.insert(chain.priority);
+                mapChains[hashGenesis] = chain;
+            }
+
+            return true;
+        }
+
+
+        /* Check the ranked chains together against the best chain, in the order they go in a block. */
+        void BlockTemplate::Check(const uint64_t nBase)
+        {
+            vChecked.clear();
+            uint64_t nSize = nBase;
+
+            /* Every transaction adds the same size to the block. */
+            const std::pair<uint8_t, uint512_t> pairEntry(TRANSACTION::TRITIUM, 0);
+            const uint64_t nEntry = ::GetSerializeSize(pairEntry, uint32_t(SER_NETWORK), LLP::PROTOCOL_VERSION);
+
+            /* Start a ACID transaction (to be disposed). */
+            LLD::TxnBegin(FLAGS::MINER);
+
+            /* Check the chains in order of rank, each on top of the ones before it. */
+            for(const auto& priority : setPriority)
+            {
+                const Chain& chain = mapChains.at(priority.hashGenesis);
+                for(const auto& tx : chain.vtx)
+                {
+                    /* Nothing more fits in a block. */
+                    if(nSize + 256 >= MAX_BLOCK_SIZE)
+                    {
+                        LLD::TxnAbort(FLAGS::MINER);
+                        return;
+                    }
+
+                    const uint512_t hashTx = tx.GetHash();
+
+                    /* Only the first transaction of a new signature chain can go in a block, since the ones after
+                       it need the genesis on disk. They are checked again when the next block changes the best chain.
+                       A skipped transaction isn't connected, so the chains after it don't build on it. */
+                    uint512_t hashLast = 0;
+                    if(!tx.IsFirst() && !LLD::Ledger->ReadLast(tx.hashGenesis, hashLast))
+                    {
+                        debug::log(2, FUNCTION, "Skipping transaction ", hashTx.SubString(), " - genesis not on disk");
+                        break;
+                    }
+
+                    /* Check the pre-states and post-states. */
+                    if(!tx.Verify(FLAGS::MINER))
+                    {
+                        setRetry.insert(priority.hashGenesis);
+
+                        debug::log(2, FUNCTION, "Skipping transaction ", hashTx.SubString(), " - failed to verify");
+                        break;
+                    }
+
+                    /* Check to see if this transaction connects. */
+                    if(!tx.Connect(FLAGS::MINER))
+                    {
+                        setRetry.insert(priority.hashGenesis);
+
+                        debug::log(2, FUNCTION, "Skipping transaction ", hashTx.SubString(), " - failed to connect");
+                        break;
+                    }
+
+                    /* Add the transaction to the template. */
+                    vChecked.push_back(hashTx);
+                    nSize += nEntry;
+                }
+            }
+
+            /* Abort the temporary ACID transaction. */
+            LLD::TxnAbort(FLAGS::MINER);
+        }
+
+
+        /* Remove a signature chain from the template. */
+        void BlockTemplate::Erase(const uint256_t& hashGenesis)
+        {
+            /* Find the chain. */
+            auto it = mapChains.find(hashGenesis);
+            if(it == mapChains.end())
+                return;
+
+            setPriority.erase(it->second.priority);
+            mapChains.erase(it);
+        }
+    }
+}
@@ -16,6 +16,7 @@ ________________________________________________________________________________
 #include <LLP/types/tritium.h>
 #include <LLP/include/global.h>
 
+#include <TAO/Ledger/include/blockindex.h>
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/constants.h>
 #include <TAO/Ledger/include/create.h>
@@ -197,9 +198,13 @@ namespace TAO
                 /* Set the best to older block. */
                 LLD::TxnBegin();
                 state.SetBest();
-                LLD::TxnCommit();
+                if(!LLD::TxnCommit())
+                    return debug::error(FUNCTION, "failed to commit best chain to database");
             }
 
+            /* Warm the block index with the most recent headers. */
+            BlockIndex::Initialize(hashBestChain.load());
+
             /* Fill out the best chain stats. */
             nBestHeight     = stateBest.load().nHeight;
             nBestChainTrust = stateBest.load().nChainTrust;
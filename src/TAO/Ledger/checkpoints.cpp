@@ -20,7 +20,12 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/checkpoints.h>
 
+#include <Util/include/args.h>
+#include <Util/include/mutex.h>
+
 #include <cmath>
+#include <map>
+#include <mutex>
 
 /* Global TAO namespace. */
 namespace TAO
@@ -144,5 +149,59 @@ namespace TAO
 
             return true;
         }
+
+
+        /* The ancestors of a hardcoded checkpoint that haven't connected, by height. */
+        std::map<uint32_t, uint1024_t> mapAssumeValid;
+
+
+        /* Mutex for the assumed valid blocks. */
+        std::mutex ASSUME_MUTEX;
+
+
+        /* Mark a block as an ancestor of a hardcoded checkpoint, found from the chain of headers. */
+        void AssumeValid(const uint1024_t& hashBlock, const uint32_t nHeight)
+        {
+            /* Hardcoded checkpoints are only for mainnet. */
+            if(config::fTestNet.load() || nHeight > CHECKPOINT_HEIGHT)
+                return;
+
+            LOCK(ASSUME_MUTEX);
+
+            /* Drop the blocks that have connected. */
+            mapAssumeValid.erase(mapAssumeValid.begin(), mapAssumeValid.upper_bound(ChainState::nBestHeight.load()));
+
+            mapAssumeValid[nHeight] = hashBlock;
+        }
+
+
+        /* Check if a block was found to be an ancestor of a hardcoded checkpoint. */
+        bool IsCheckpointAncestor(const uint1024_t& hashBlock, const uint32_t nHeight)
+        {
+            /* Hardcoded checkpoints are only for mainnet, and nothing past the last one is an ancestor. */
+            if(nHeight > CHECKPOINT_HEIGHT || config::fTestNet.load())
+                return false;
+
+            LOCK(ASSUME_MUTEX);
+
+            /* Only blocks the headers showed to be ancestors of a checkpoint are trusted. */
+            auto it = mapAssumeValid.find(nHeight);
+            return (it != mapAssumeValid.end() && it->second == hashBlock);
+        }
+
+
+        /* Check if a block's contract conditions can be skipped while synchronizing. */
+        bool IsAssumedValid(const uint1024_t& hashBlock, const uint32_t nHeight)
+        {
+            /* Only skip verification during the initial download. */
+            if(!ChainState::Synchronizing())
+                return false;
+
+            /* Check that assume valid wasn't disabled. */
+            if(!config::GetBoolArg("-assumevalid", true))
+                return false;
+
+            return IsCheckpointAncestor(hashBlock, nHeight);
+        }
     }
 }
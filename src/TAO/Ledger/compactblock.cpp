@@ -0,0 +1,255 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+
+#include <LLC/hash/SK.h>
+
+#include <LLD/hash/xxh3.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Ledger/include/enum.h>
+
+#include <TAO/Ledger/types/compactblock.h>
+#include <TAO/Ledger/types/tritium.h>
+
+#include <Util/include/debug.h>
+#include <Util/include/runtime.h>
+#include <Util/templates/datastream.h>
+
+#include <set>
+#include <unordered_map>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Default constructor. */
+        CompactBlock::CompactBlock()
+        : Block     ( )
+        , nTime     (runtime::unifiedtimestamp())
+        , producer  ( )
+        , vProducer ( )
+        , ssSystem  ( )
+        , vShort    ( )
+        {
+        }
+
+
+        /* Copy constructor. */
+        CompactBlock::CompactBlock(const CompactBlock& block)
+        : Block     (block)
+        , nTime     (block.nTime)
+        , producer  (block.producer)
+        , vProducer (block.vProducer)
+        , ssSystem  (block.ssSystem)
+        , vShort    (block.vShort)
+        {
+        }
+
+
+        /* Move constructor. */
+        CompactBlock::CompactBlock(CompactBlock&& block) noexcept
+        : Block     (std::move(block))
+        , nTime     (std::move(block.nTime))
+        , producer  (std::move(block.producer))
+        , vProducer (std::move(block.vProducer))
+        , ssSystem  (std::move(block.ssSystem))
+        , vShort    (std::move(block.vShort))
+        {
+        }
+
+
+        /* Copy assignment. */
+        CompactBlock& CompactBlock::operator=(const CompactBlock& block)
+        {
+            nVersion       = block.nVersion;
+            hashPrevBlock  = block.hashPrevBlock;
+            hashMerkleRoot = block.hashMerkleRoot;
+            nChannel       = block.nChannel;
+            nHeight        = block.nHeight;
+            nBits          = block.nBits;
+            nNonce         = block.nNonce;
+            vOffsets       = block.vOffsets;
+            vchBlockSig    = block.vchBlockSig;
+            vMissing       = block.vMissing;
+            hashMissing    = block.hashMissing;
+            fConflicted    = block.fConflicted;
+
+            nTime          = block.nTime;
+            producer       = block.producer;
+            vProducer      = block.vProducer;
+            ssSystem       = block.ssSystem;
+            vShort         = block.vShort;
+
+            return *this;
+        }
+
+
+        /* Move assignment. */
+        CompactBlock& CompactBlock::operator=(CompactBlock&& block) noexcept
+        {
+            nVersion       = std::move(block.nVersion);
+            hashPrevBlock  = std::move(block.hashPrevBlock);
+            hashMerkleRoot = std::move(block.hashMerkleRoot);
+            nChannel       = std::move(block.nChannel);
+            nHeight        = std::move(block.nHeight);
+            nBits          = std::move(block.nBits);
+            nNonce         = std::move(block.nNonce);
+            vOffsets       = std::move(block.vOffsets);
+            vchBlockSig    = std::move(block.vchBlockSig);
+            vMissing       = std::move(block.vMissing);
+            hashMissing    = std::move(block.hashMissing);
+            fConflicted    = std::move(block.fConflicted);
+
+            nTime          = std::move(block.nTime);
+            producer       = std::move(block.producer);
+            vProducer      = std::move(block.vProducer);
+            ssSystem       = std::move(block.ssSystem);
+            vShort         = std::move(block.vShort);
+
+            return *this;
+        }
+
+
+        /* Destructor. */
+        CompactBlock::~CompactBlock()
+        {
+        }
+
+
+        /* Copy Constructor. */
+        CompactBlock::CompactBlock(const TritiumBlock& block)
+        : Block     (block)
+        , nTime     (block.nTime)
+        , producer  (block.producer)
+        , vProducer (block.vProducer)
+        , ssSystem  (block.ssSystem)
+        , vShort    ( )
+        {
+            /* Swap the transaction hashes for their short ids. */
+            vShort.reserve(block.vtx.size());
+            for(const auto& tx : block.vtx)
+                vShort.push_back(std::make_pair(tx.first, ShortID(tx.second)));
+        }
+
+
+        /* Get the Signature Hash of the block, the same as the tritium block it was made from. */
+        uint1024_t CompactBlock::SignatureHash() const
+        {
+            /* Create a data stream to get the hash. */
+            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
+            ss.reserve(256);
+
+            /* Serialize the data to hash into a stream. */
+            ss << nVersion << hashPrevBlock << hashMerkleRoot << nChannel << nHeight << nBits << nNonce << nTime << vOffsets;
+
+            return LLC::SK1024(ss.begin(), ss.end());
+        }
+
+
+        /* Get the short id of a transaction in this block. */
+        uint64_t CompactBlock::ShortID(const uint512_t& hashTx) const
+        {
+            return XXH64(hashTx.begin(), hashTx.end() - hashTx.begin(), hashMerkleRoot.Get64(0));
+        }
+
+
+        /* Rebuild the tritium block from the transactions a node holds. */
+        bool CompactBlock::Build(const std::vector<uint512_t>& vLedger, const std::vector<uint512_t>& vLegacy,
+                                 TritiumBlock& block, std::vector<uint32_t> &vMissing) const
+        {
+            /* Index the held transactions by short id. */
+            std::set<uint64_t> setCollided;
+            auto index = [&](const std::vector<uint512_t>& vHashes, std::unordered_map<uint64_t, uint512_t> &mapShort)
+            {
+                /* Record ids given by more than one hash. */
+                mapShort.reserve(vHashes.size());
+                for(const auto& hashTx : vHashes)
+                {
+                    auto it = mapShort.emplace(ShortID(hashTx), hashTx);
+                    if(!it.second && it.first->second != hashTx)
+                        setCollided.insert(it.first->first);
+                }
+            };
+
+            std::unordered_map<uint64_t, uint512_t> mapLedger, mapLegacy;
+            index(vLedger, mapLedger);
+            index(vLegacy, mapLegacy);
+
+            /* Copy the header and producers. */
+            block = TritiumBlock(static_cast<const Block&>(*this));
+            block.nTime     = nTime;
+            block.producer  = producer;
+            block.vProducer = vProducer;
+            block.ssSystem  = ssSystem;
+
+            /* Match the short ids, leaving a null hash where a transaction isn't held. */
+            vMissing.clear();
+            block.vtx.reserve(vShort.size());
+            for(uint32_t n = 0; n < vShort.size(); ++n)
+            {
+                /* Get the transactions of the same type. */
+                const std::unordered_map<uint64_t, uint512_t>* pmapShort = nullptr;
+                if(vShort[n].first == TRANSACTION::LEGACY)
+                    pmapShort = &mapLegacy;
+                else if(vShort[n].first == TRANSACTION::TRITIUM)
+                    pmapShort = &mapLedger;
+                else
+                    return debug::error(FUNCTION, "unknown transaction type");
+
+                /* Check that the id gives one transaction. */
+                if(setCollided.count(vShort[n].second))
+                    return debug::error(FUNCTION, "short id ", vShort[n].second, " matches more than one transaction");
+
+                auto it = pmapShort->find(vShort[n].second);
+                if(it == pmapShort->end())
+                {
+                    block.vtx.push_back(std::make_pair(vShort[n].first, uint512_t(0)));
+                    vMissing.push_back(n);
+
+                    continue;
+                }
+
+                block.vtx.push_back(std::make_pair(vShort[n].first, it->second));
+            }
+
+            /* The missing transactions are filled in once they are held. */
+            if(!vMissing.empty())
+                return true;
+
+            /* Check the rebuilt transactions against the merkle root. */
+            std::vector<uint512_t> vHashes;
+            vHashes.reserve(block.vtx.size() + std::max(vProducer.size(), size_t(1)));
+            for(const auto& tx : block.vtx)
+                vHashes.push_back(tx.second);
+
+            if(nVersion < 9)
+                vHashes.push_back(producer.GetHash());
+            else
+            {
+                for(const auto& tx : vProducer)
+                    vHashes.push_back(tx.GetHash());
+            }
+
+            if(hashMerkleRoot != BuildMerkleTree(vHashes))
+                return debug::error(FUNCTION, "hashMerkleRoot mismatch for rebuilt block");
+
+            return true;
+        }
+    }
+}
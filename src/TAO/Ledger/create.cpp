@@ -36,6 +36,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/include/genesis_block.h>
 
+#include <TAO/Ledger/types/blocktemplate.h>
 #include <TAO/Ledger/types/mempool.h>
 #include <TAO/Ledger/types/client.h>
 
@@ -160,109 +161,18 @@ namespace TAO
             /* Clear the transactions. */
             block.vtx.clear();
 
-            /* Check the memory pool. */
-            std::vector<uint512_t> vMempool;
-            mempool.List(vMempool);
-
-            /* Start a ACID transaction (to be disposed). */
-            LLD::TxnBegin(FLAGS::MINER);
-
-            debug::log(3, "BEGIN-------------------------------------");
-
-            /* Loop through the list of transactions. */
-            std::set<uint512_t> setDependents;
-            for(const auto& hash : vMempool)
-            {
-                /* Check the Size limits of the Current Block. */
-                if(::GetSerializeSize(block, SER_NETWORK, LLP::PROTOCOL_VERSION) + 256 >= MAX_BLOCK_SIZE)
-                    break;
-
-                /* Get the transaction from the memory pool. */
-                TAO::Ledger::Transaction tx;
-                if(!mempool.Get(hash, tx))
-                    continue;
-
-                /* Don't add transactions that are coinbase or coinstake. */
-                if(tx.IsCoinBase() || tx.IsCoinStake())
-                {
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - tx is coinbase/coinstake");
-                    continue;
-                }
-
-                /* Check for failed dependants. */
-                if(setDependents.count(tx.hashPrevTx))
-                {
-                    setDependents.insert(hash);
-
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - INVALID dependent");
-                    continue;
-                }
-
-                /* Check for timestamp violations. */
-                if(tx.nTimestamp > runtime::unifiedtimestamp() + runtime::maxdrift())
-                {
-                    setDependents.insert(hash);
-
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - timesamp too far in future");
-                    continue;
-                }
-
-                /* Check the pre-states and post-states. */
-                if(!tx.Verify(FLAGS::MINER))
-                {
-                    setDependents.insert(hash);
-
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - failed to verify");
-                    continue;
-                }
-
-                /* Check to see if this transaction connects. */
-                if(!tx.Connect(FLAGS::MINER))
-                {
-                    setDependents.insert(hash);
-
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - failed to connect");
-                    continue;
-                }
-
-                /* Check that the hashlast is on disk. If it is not, then the sig chain genesis must also be in this block.  If for
-                   any reason the genesis transaction should be in this block but failed one of the above rules, then we could end
-                   up with a subsequent transaction also in this block for which the genesis is not going to exist.  In which case
-                   we need to omit this transaction also. The simplest solution for this is to skip any transactions that are not
-                   the first in the sequence if the hash last is not currently on disk. If a sig chain transcation and subsequent
-                   transaction genuinely should be in the same block, then ths will just result in the subsequent transaction being
-                   left out of this block and included in the next.*/
-                uint512_t hashLast = 0;
-                if(!tx.IsFirst() && !LLD::Ledger->ReadLast(tx.hashGenesis, hashLast) )
-                {
-                    setDependents.insert(hash);
-
-                    debug::log(2, FUNCTION, "Skipping transaction ", hash.SubString(), " - genesis not on disk");
-                    continue;
-                }
-
-                /* Dump sequence on verbose 3 levels. */
-                if(config::nVerbose >= 3)
-                    tx.print();
-
-                /* Add the transaction to the block. */
-                block.vtx.push_back(std::make_pair(TRANSACTION::TRITIUM, hash));
-            }
-
-            debug::log(3, "END-------------------------------------");
-
-            /* Abort the temporary ACID transaction. */
-            LLD::TxnAbort(FLAGS::MINER);
+            /* Cache the best chain before processing. */
+            TAO::Ledger::BlockState stateBest = TAO::Ledger::ChainState::stateBest.load();
 
-            /* Clear for legacy. */
-            vMempool.clear();
+            /* Add the ledger transactions ranked by the block template. */
+            BlockTemplate::GetInstance().Add(block, stateBest.GetHash());
 
             /* Retrieve list of transaction hashes from mempool. Limit list to a sane size that would typically more than fill a
              * legacy block, rather than pulling entire pool if it is very large. */
+            std::vector<uint512_t> vMempool;
             TAO::Ledger::mempool.List(vMempool, 100, true);
 
             /* Loop through the list of transactions. */
-            TAO::Ledger::BlockState stateBest = TAO::Ledger::ChainState::stateBest.load();
             for(const auto& hash : vMempool)
             {
                 /* Check the Size limits of the Current Block. */
@@ -0,0 +1,214 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_INCLUDE_BLOCKINDEX_H
+#define NEXUS_TAO_LEDGER_INCLUDE_BLOCKINDEX_H
+
+#include <LLC/types/uint1024.h>
+
+#include <cstdint>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        class BlockState;
+
+
+        /** The most block headers kept resident, older heights are pruned past this. **/
+        const uint32_t MAX_BLOCK_INDEX = 1 << 16;
+
+
+        /** The blocks back from the best chain loaded into the index on startup. **/
+        const uint32_t BLOCK_INDEX_WARMUP = 1440;
+
+
+        /** CompactState
+         *
+         *  The header fields of a block state needed to walk the chain, without its transactions.
+         *
+         **/
+        struct CompactState
+        {
+            /** The hash of the block. **/
+            uint1024_t hashBlock;
+
+
+            /** The hash of the previous block. **/
+            uint1024_t hashPrevBlock;
+
+
+            /** The hash of the next block in the best chain. **/
+            uint1024_t hashNextBlock;
+
+
+            /** The height of the block. **/
+            uint32_t nHeight;
+
+
+            /** The channel the block was produced in. **/
+            uint32_t nChannel;
+
+
+            /** The height of the block in its channel. **/
+            uint32_t nChannelHeight;
+
+
+            /** The difficulty bits of the block. **/
+            uint32_t nBits;
+
+
+            /** The timestamp of the block. **/
+            uint64_t nTime;
+
+
+            /** The chain trust at the block. **/
+            uint64_t nChainTrust;
+
+
+            /** Default Constructor. **/
+            CompactState();
+
+
+            /** Block State Constructor. **/
+            CompactState(const BlockState& state);
+
+
+            /** IsNull
+             *
+             *  Determines if the state is in a null state.
+             *
+             **/
+            bool IsNull() const;
+        };
+
+
+        /** BlockIndex
+         *
+         *  Resident index of compact block headers with per-channel back-links.
+         *
+         *  Each entry links to the last block of every channel at or before it, so finding the
+         *  previous block of a channel is a lookup instead of a walk over full block states.
+         *  Entries are added as blocks are written, and read from the ledger on a miss. Changes made
+         *  while a ledger transaction is open are journaled and reverted if the transaction aborts.
+         *
+         **/
+        namespace BlockIndex
+        {
+
+            /** Initialize
+             *
+             *  Load the headers of the most recent blocks of the best chain.
+             *
+             *  @param[in] hashBest The hash of the best block.
+             *
+             **/
+            void Initialize(const uint1024_t& hashBest);
+
+
+            /** Update
+             *
+             *  Add or refresh the header of a block state as it is written.
+             *
+             *  @param[in] state The block state written.
+             *
+             **/
+            void Update(const BlockState& state);
+
+
+            /** Erase
+             *
+             *  Remove a block header as it is erased.
+             *
+             *  @param[in] hashBlock The hash of the block erased.
+             *
+             **/
+            void Erase(const uint1024_t& hashBlock);
+
+
+            /** Get
+             *
+             *  Get the header of a block, reading it from the ledger if it isn't resident.
+             *
+             *  @param[in] hashBlock The hash of the block.
+             *  @param[out] state The compact header of the block.
+             *
+             *  @return True if the block was found.
+             *
+             **/
+            bool Get(const uint1024_t& hashBlock, CompactState& state);
+
+
+            /** GetLast
+             *
+             *  Get the last block of a channel at or before a given block, excluding the genesis.
+             *
+             *  @param[in] hashBlock The hash of the block to search back from.
+             *  @param[in] nChannel The channel to find.
+             *  @param[out] state The compact header of the block found.
+             *
+             *  @return True if a block of the channel was found.
+             *
+             **/
+            bool GetLast(const uint1024_t& hashBlock, const uint32_t nChannel, CompactState& state);
+
+
+            /** Size
+             *
+             *  Get the number of resident headers.
+             *
+             **/
+            uint64_t Size();
+
+
+            /** Clear
+             *
+             *  Remove every resident header.
+             *
+             **/
+            void Clear();
+
+
+            /** TxnBegin
+             *
+             *  Start journaling changes for a ledger transaction.
+             *
+             **/
+            void TxnBegin();
+
+
+            /** TxnCommit
+             *
+             *  Keep the changes of a ledger transaction that was applied.
+             *
+             **/
+            void TxnCommit();
+
+
+            /** TxnAbort
+             *
+             *  Revert the changes of a ledger transaction that wasn't applied.
+             *
+             **/
+            void TxnAbort();
+
+        }
+    }
+}
+
+#endif
@@ -63,6 +63,46 @@ namespace TAO
         bool HardenCheckpoint(const BlockState& state);
 
 
+        /** AssumeValid
+         *
+         *  Mark a block as an ancestor of a hardcoded checkpoint, found from the chain of headers.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nHeight The height of the block.
+         *
+         **/
+        void AssumeValid(const uint1024_t& hashBlock, const uint32_t nHeight);
+
+
+        /** IsCheckpointAncestor
+         *
+         *  Check if a block was found to be an ancestor of the last hardcoded checkpoint and hasn't
+         *  connected yet.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nHeight The height of the block.
+         *
+         *  @returns true if the block is a known ancestor.
+         *
+         **/
+        bool IsCheckpointAncestor(const uint1024_t& hashBlock, const uint32_t nHeight);
+
+
+        /** IsAssumedValid
+         *
+         *  Check if a block's contract conditions can be skipped while synchronizing, because it
+         *  is a known ancestor of the last hardcoded checkpoint. State transitions are still applied.
+         *  Signatures and legacy scripts are skipped for every block while synchronizing.
+         *
+         *  @param[in] hashBlock The hash of the block.
+         *  @param[in] nHeight The height of the block.
+         *
+         *  @returns true if the block is assumed valid.
+         *
+         **/
+        bool IsAssumedValid(const uint1024_t& hashBlock, const uint32_t nHeight);
+
+
         /** Checkpoint Height.
          *
          *  The height of the last hardcoded checkpoint.
@@ -51,6 +51,9 @@ namespace TAO
         , mapClaimed         ( )
         , mapInputs          ( )
         , setOrphansByIndex  ( )
+        , mapGenesis         ( )
+        , setUpdated         ( )
+        , fUpdatedAll        (false)
         {
         }
 
@@ -69,12 +72,11 @@ namespace TAO
 
             RLOCK(MUTEX);
 
-            /* Check the mempool. */
-            if(mapLedger.count(hashTx))
+            /* Add to the map if not in the mempool. */
+            if(!mapLedger.insert(hashTx, tx))
                 return false;
 
-            /* Add to the map. */
-            mapLedger[hashTx] = tx;
+            IndexGenesis(tx, hashTx);
 
             return true;
         }
@@ -140,11 +142,11 @@ namespace TAO
                 }
 
                 /* Check for conflicts. */
-                if(mapClaimed.count(tx.hashPrevTx) || mapConflicts.count(tx.hashPrevTx))
+                if(mapClaimed.count(tx.hashPrevTx) || mapConflicts.has(tx.hashPrevTx))
                 {
                     /* Add to conflicts map. */
                     debug::error(FUNCTION, "CONFLICT: prev tx ", (mapClaimed.count(tx.hashPrevTx) ? "CLAIMED " : "CONFLICTED "), tx.hashPrevTx.SubString());
-                    mapConflicts[hashTx] = tx;
+                    mapConflicts.set(hashTx, tx);
 
                     return false;
                 }
@@ -159,7 +161,7 @@ namespace TAO
                 {
                     /* Add to conflicts map. */
                     debug::error(FUNCTION, "CONFLICT: hash last mismatch ", tx.hashPrevTx.SubString());
-                    mapConflicts[hashTx] = tx;
+                    mapConflicts.set(hashTx, tx);
 
                     return false;
                 }
@@ -183,7 +185,8 @@ namespace TAO
             LLD::TxnCommit(FLAGS::MEMPOOL);
 
             /* Set the internal memory. */
-            mapLedger[hashTx] = tx;
+            mapLedger.set(hashTx, tx);
+            IndexGenesis(tx, hashTx);
 
             /* Update map claimed if not first tx. */
             if(!tx.IsFirst())
@@ -254,13 +257,9 @@ namespace TAO
         /* Gets a transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, TAO::Ledger::Transaction &tx, bool &fConflicted) const
         {
-            RLOCK(MUTEX);
-
             /* Check in conflict memory. */
-            if(mapConflicts.count(hashTx))
+            if(mapConflicts.get(hashTx, tx))
             {
-                /* Get from conflicts map. */
-                tx = mapConflicts.at(hashTx);
                 fConflicted = true;
 
                 debug::log(0, FUNCTION, "CONFLICTED TRANSACTION: ", hashTx.SubString());
@@ -269,31 +268,15 @@ namespace TAO
             }
 
             /* Check in ledger memory. */
-            if(mapLedger.count(hashTx))
-            {
-                tx = mapLedger.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            return mapLedger.get(hashTx, tx);
         }
 
 
         /* Gets a transaction from mempool */
         bool Mempool::Get(const uint512_t& hashTx, TAO::Ledger::Transaction &tx) const
         {
-            RLOCK(MUTEX);
-
             /* Check in ledger memory. */
-            if(mapLedger.count(hashTx))
-            {
-                tx = mapLedger.at(hashTx);
-
-                return true;
-            }
-
-            return false;
+            return mapLedger.get(hashTx, tx);
         }
 
 
@@ -302,54 +285,32 @@ namespace TAO
         {
             RLOCK(MUTEX);
 
-            /* Check through the ledger map for the genesis. */
-            for(const auto& tx : mapLedger)
-            {
-                /* Check for non-conflicted genesis-id's. */
-                if(tx.second.hashGenesis == hashGenesis)
-                    vtx.push_back(tx.second);
-            }
-
-            /* Check that a transaction was found. */
-            if(vtx.size() == 0)
+            /* Get the transactions in sequence from the genesis index. */
+            std::vector<uint512_t> vHashes;
+            if(!Chain(hashGenesis, vHashes))
                 return false;
 
-            /* Sort the list by sequence numbers. */
-            std::sort(vtx.begin(), vtx.end());
+            /* Copy out the transactions. */
+            vtx.reserve(vtx.size() + vHashes.size());
+            for(const auto& hashTx : vHashes)
+                vtx.push_back(*mapLedger.find(hashTx));
 
-            /* Check that the mempool transactions are in correct order. */
-            uint512_t hashLast = vtx[0].GetHash();
-            for(uint32_t n = 1; n < vtx.size(); ++n)
-            {
-                /* Check that transaction is in sequence. */
-                if(vtx[n].hashPrevTx != hashLast)
-                {
-                    debug::log(0, FUNCTION, "Last hash mismatch");
-
-                    /* Resize to forget about mismatched sequences. */
-                    vtx.resize(n);
-
-                    break;
-                }
-
-                /* Set last hash. */
-                hashLast = vtx[n].GetHash();
-            }
-
-            return (vtx.size() > 0);
+            return true;
         }
 
 
         /* Gets a transaction by genesis. */
         bool Mempool::Get(const uint256_t& hashGenesis, TAO::Ledger::Transaction &tx) const
         {
-            /* Get the list of transactions by genesis. */
-            std::vector<TAO::Ledger::Transaction> vtx;
-            if(!Get(hashGenesis, vtx))
+            RLOCK(MUTEX);
+
+            /* Get the transactions in sequence from the genesis index. */
+            std::vector<uint512_t> vHashes;
+            if(!Chain(hashGenesis, vHashes))
                 return false;
 
             /* Return last item in list (newest). */
-            tx = vtx.back();
+            tx = *mapLedger.find(vHashes.back());
 
             return true;
         }
@@ -358,9 +319,7 @@ namespace TAO
         /* Checks if a transaction exists. */
         bool Mempool::Has(const uint512_t& hashTx) const
         {
-            RLOCK(MUTEX);
-
-            return mapLedger.count(hashTx) || mapLegacy.count(hashTx) || mapConflicts.count(hashTx);
+            return mapLedger.has(hashTx) || mapLegacy.has(hashTx) || mapConflicts.has(hashTx);
         }
 
 
@@ -369,12 +328,7 @@ namespace TAO
         {
             RLOCK(MUTEX);
 
-            /* Check through the ledger map for the genesis. */
-            for(const auto& tx : mapLedger)
-                if(tx.second.hashGenesis == hashGenesis)
-                    return true;
-
-            return false;
+            return mapGenesis.count(hashGenesis);
         }
 
 
@@ -384,35 +338,36 @@ namespace TAO
             RLOCK(MUTEX);
 
             /* Erase from conflicted memory. */
-            if(mapConflicts.count(hashTx))
-                mapConflicts.erase(hashTx);
+            mapConflicts.erase(hashTx);
 
             /* Erase from legacy conflicted memory. */
-            if(mapLegacyConflicts.count(hashTx))
-                mapLegacyConflicts.erase(hashTx);
+            mapLegacyConflicts.erase(hashTx);
 
             /* Erase from orphans memory. */
             if(setOrphansByIndex.count(hashTx))
                 setOrphansByIndex.erase(hashTx);
 
             /* Find the transaction in pool. */
-            if(mapLedger.count(hashTx))
+            std::shared_ptr<const TAO::Ledger::Transaction> ptx = mapLedger.find(hashTx);
+            if(ptx)
             {
                 /* Get a reference from the map. */
-                const TAO::Ledger::Transaction& tx = mapLedger[hashTx];
+                const TAO::Ledger::Transaction& tx = *ptx;
 
                 /* Erase from the memory map. */
                 mapClaimed.erase(tx.hashPrevTx);
                 mapOrphans.erase(tx.hashPrevTx);
+                EraseGenesis(tx, hashTx);
                 mapLedger.erase(hashTx);
 
                 return true;
             }
 
             /* Find the legacy transaction in pool. */
-            if(mapLegacy.count(hashTx))
+            std::shared_ptr<const Legacy::Transaction> plegacy = mapLegacy.find(hashTx);
+            if(plegacy)
             {
-                const Legacy::Transaction& tx = mapLegacy[hashTx];
+                const Legacy::Transaction& tx = *plegacy;
 
                 /* Erase the claimed inputs */
                 uint32_t nSize = static_cast<uint32_t>(tx.vin.size());
@@ -426,6 +381,25 @@ namespace TAO
         }
 
 
+        /* Gets the genesis whose ledger transactions changed since the last call. */
+        void Mempool::Updated(std::set<uint256_t> &setGenesis, const bool fAll)
+        {
+            RLOCK(MUTEX);
+
+            /* Get every genesis if asked for or if changes were dropped. */
+            if(fAll || fUpdatedAll)
+            {
+                for(const auto& list : mapGenesis)
+                    setGenesis.insert(list.first);
+            }
+            else
+                setGenesis.insert(setUpdated.begin(), setUpdated.end());
+
+            setUpdated.clear();
+            fUpdatedAll = false;
+        }
+
+
         /* Check the memory pool for consistency. */
         void Mempool::Check()
         {
@@ -433,21 +407,13 @@ namespace TAO
 
             //TODO: evict conflicted transctions from mempool
 
-            /* Create map of transactions by genesis. */
+            /* Copy the transactions by genesis, in sequence order, since removals change the index. */
             std::map<uint256_t, std::vector<TAO::Ledger::Transaction> > mapTransactions;
-
-            /* Loop through all the transactions. */
-            for(const auto& tx : mapLedger)
+            for(const auto& list : mapGenesis)
             {
-                /* Cache the genesis. */
-                const uint256_t& hashGenesis = tx.second.hashGenesis;
-
-                /* Check in map for push back. */
-                if(!mapTransactions.count(hashGenesis))
-                    mapTransactions[hashGenesis] = std::vector<TAO::Ledger::Transaction>();
-
-                /* Push to back of map. */
-                mapTransactions[hashGenesis].push_back(tx.second);
+                std::vector<TAO::Ledger::Transaction>& vtx = mapTransactions[list.first];
+                for(const auto& entry : list.second)
+                    vtx.push_back(*mapLedger.find(entry.second));
             }
 
             /* Loop transctions map by genesis. */
@@ -456,9 +422,6 @@ namespace TAO
                 /* Get reference of the vector. */
                 std::vector<TAO::Ledger::Transaction>& vtx = list.second;
 
-                /* Sort the list by sequence numbers. */
-                std::sort(vtx.begin(), vtx.end());
-
                 /* Add the hashes into list. */
                 uint512_t hashLast = 0;
 
@@ -492,13 +455,15 @@ namespace TAO
                             }
 
                             /* Find the transaction in pool. */
-                            if(mapLedger.count(tx->GetHash()))
+                            const uint512_t hashTx = tx->GetHash();
+                            if(mapLedger.has(hashTx))
                             {
-                                debug::log(0, "DELETED ", tx->GetHash().SubString());
+                                debug::log(0, "DELETED ", hashTx.SubString());
 
                                 /* Erase from the memory map. */
                                 mapClaimed.erase(tx->hashPrevTx);
-                                mapLedger.erase(tx->GetHash());
+                                EraseGenesis(*tx, hashTx);
+                                mapLedger.erase(hashTx);
                             }
                         }
 
@@ -578,101 +543,137 @@ namespace TAO
             /* If legacy flag set, skip over getting tritium transactions. */
             if(!fLegacy)
             {
-                /* Create map of transactions by genesis. */
-                std::map<uint256_t, std::vector<TAO::Ledger::Transaction> > mapTransactions;
-
-                /* Loop through all the transactions. */
-                for(const auto& tx : mapLedger)
-                {
-                    /* Check that this transaction isn't conflicted. */
-                    //if(mapConflicts.count(tx.first))
-                    //    continue;
-
-                    /* Cache the genesis. */
-                    const uint256_t& hashGenesis = tx.second.hashGenesis;
-
-                    /* Check in map for push back. */
-                    if(!mapTransactions.count(hashGenesis))
-                        mapTransactions[hashGenesis] = std::vector<TAO::Ledger::Transaction>();
-
-                    /* Push to back of map. */
-                    mapTransactions[hashGenesis].push_back(tx.second);
-                }
-
-                /* Loop transctions map by genesis. */
-                for(auto& list : mapTransactions)
+                /* Loop transctions by genesis, already in sequence order. */
+                for(const auto& list : mapGenesis)
                 {
-                    /* Get reference of the vector. */
-                    std::vector<TAO::Ledger::Transaction>& vtx = list.second;
-
-                    /* Sort the list by sequence numbers. */
-                    std::sort(vtx.begin(), vtx.end());
-
-                    /* Add the hashes into list. */
-                    uint512_t hashLast = 0;
+                    /* Get the first transaction of the genesis. */
+                    const TAO::Ledger::Transaction& txFirst = *mapLedger.find(list.second.begin()->second);
 
                     /* Check last hash for valid transactions. */
-                    if(!vtx[0].IsFirst())
+                    if(!txFirst.IsFirst())
                     {
                         /* Read last index from disk. */
+                        uint512_t hashLast = 0;
                         if(!LLD::Ledger->ReadLast(list.first, hashLast))
                             break; //NOTE: this may need an error
 
                         /* Check the last hash. */
-                        if(vtx[0].hashPrevTx != hashLast)
+                        if(txFirst.hashPrevTx != hashLast)
                             break;
                     }
 
-                    /* Set last from next transaction. */
-                    hashLast = vtx[0].GetHash();
+                    /* Get the transactions that follow each other. */
+                    std::vector<uint512_t> vChain;
+                    Chain(list.first, vChain);
 
-                    /* Loop through transaction by genesis. */
-                    for(uint32_t n = 1; n <= vtx.size(); ++n)
+                    /* Add to the output queue. */
+                    for(uint32_t n = 1; n <= vChain.size(); ++n)
                     {
-                        /* Add to the output queue. */
-                        vHashes.push_back(hashLast);
+                        vHashes.push_back(vChain[n - 1]);
 
                         /* Check for end of index. */
-                        if(n == vtx.size())
+                        if(n == vChain.size())
                             break;
 
                         /* Check count. */
                         if(--nCount == 0)
                             return true;
-
-                        /* Check that transaction is in sequence. */
-                        if(vtx[n].hashPrevTx != hashLast)
-                            break; //SKIP ANY ORPHANS FOUND
-
-                        /* Set last hash. */
-                        hashLast = vtx[n].GetHash();
                     }
                 }
             }
             else
             {
-                /* Loop transctions map by genesis. */
-                for(const auto& list : mapLegacy)
-                {
-                    /* Push legacy transactions last. */
-                    vHashes.push_back(list.first);;
-
-                    /* Check for end of line. */
-                    if(--nCount == 0)
-                        return true;
-                }
+                /* Push legacy transactions last. */
+                mapLegacy.keys(vHashes, vHashes.size() + nCount);
             }
 
             return vHashes.size() > 0;
         }
 
 
+        /* Gets the hashes of every transaction in the pool, conflicts included. */
+        void Mempool::Hashes(std::vector<uint512_t> &vHashes, const bool fLegacy) const
+        {
+            /* The sharded maps lock their own shards. */
+            if(fLegacy)
+            {
+                mapLegacy.keys(vHashes);
+                mapLegacyConflicts.keys(vHashes);
+            }
+            else
+            {
+                mapLedger.keys(vHashes);
+                mapConflicts.keys(vHashes);
+            }
+        }
+
+
         /* Gets the size of the memory pool. */
         uint32_t Mempool::Size()
         {
-            RLOCK(MUTEX);
-
             return static_cast<uint32_t>(mapLedger.size() + mapLegacy.size());
         }
+
+
+        /* Add a ledger transaction to the index by genesis. */
+        void Mempool::IndexGenesis(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx)
+        {
+            mapGenesis[tx.hashGenesis].insert(std::make_pair(tx.nSequence, hashTx));
+            Update(tx.hashGenesis);
+        }
+
+
+        /* Remove a ledger transaction from the index by genesis. */
+        void Mempool::EraseGenesis(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx)
+        {
+            /* Find the transactions of the genesis. */
+            auto it = mapGenesis.find(tx.hashGenesis);
+            if(it == mapGenesis.end())
+                return;
+
+            /* Drop the genesis with its last transaction. */
+            it->second.erase(std::make_pair(tx.nSequence, hashTx));
+            if(it->second.empty())
+                mapGenesis.erase(it);
+
+            Update(tx.hashGenesis);
+        }
+
+
+        /* Record a genesis whose ledger transactions changed. */
+        void Mempool::Update(const uint256_t& hashGenesis)
+        {
+            /* Stop tracking single changes when nothing reads them. */
+            if(setUpdated.size() >= MAX_MEMPOOL_UPDATED)
+            {
+                setUpdated.clear();
+                fUpdatedAll = true;
+            }
+
+            if(!fUpdatedAll)
+                setUpdated.insert(hashGenesis);
+        }
+
+
+        /* Gets the hashes of the pending transactions of a genesis that follow each other. */
+        bool Mempool::Chain(const uint256_t& hashGenesis, std::vector<uint512_t> &vHashes) const
+        {
+            /* Find the transactions of the genesis. */
+            auto it = mapGenesis.find(hashGenesis);
+            if(it == mapGenesis.end())
+                return false;
+
+            /* Check that the mempool transactions are in correct order. */
+            for(const auto& entry : it->second)
+            {
+                /* Check that transaction is in sequence. */
+                if(!vHashes.empty() && mapLedger.find(entry.second)->hashPrevTx != vHashes.back())
+                    break; //SKIP ANY ORPHANS FOUND
+
+                vHashes.push_back(entry.second);
+            }
+
+            return true;
+        }
     }
 }
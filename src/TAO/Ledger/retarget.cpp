@@ -13,6 +13,7 @@ ________________________________________________________________________________
 
 #include <LLC/types/bignum.h>
 
+#include <TAO/Ledger/include/blockindex.h>
 #include <TAO/Ledger/include/supply.h>
 #include <TAO/Ledger/include/prime.h>
 #include <TAO/Ledger/include/difficulty.h>
@@ -47,18 +48,22 @@ namespace TAO
         {
             uint64_t nIterator = 0, nWeightedAverage = 0;
 
-            /* Find the introductory block. */
-            BlockState first = state;
+            /* Find the introductory block, only its header is needed. */
+            const uint32_t nChannel = state.GetChannel();
+
+            uint1024_t hashPrev = state.hashPrevBlock;
+            uint64_t nFirstTime = state.GetBlockTime();
             for(int32_t nIndex = nDepth; nIndex > 0; --nIndex)
             {
-                /* Find the previous block. */
-                BlockState last = first.Prev();
-                if(!GetLastState(last, state.GetChannel()))
+                /* Find the previous block of the channel from the block index. */
+                CompactState last;
+                if(hashPrev == 0 || !BlockIndex::GetLast(hashPrev, nChannel, last))
                     break;
 
                 /* Calculate the time. */
-                uint64_t nTime = std::max(first.GetBlockTime() - last.GetBlockTime(), uint64_t(1)) * nIndex * 3;
-                first = last;
+                uint64_t nTime = std::max(nFirstTime - last.nTime, uint64_t(1)) * nIndex * 3;
+                hashPrev   = last.hashPrevBlock;
+                nFirstTime = last.nTime;
 
                 /* Weight the iterator based on the weight constant. */
                 nIterator += (nIndex * 3);
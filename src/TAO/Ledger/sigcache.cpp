@@ -0,0 +1,74 @@
+/*__________________________________________________________________________________________
+
+			(c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+			(c) Copyright The Nexus Developers 2014 - 2019
+
+			Distributed under the MIT software license, see the accompanying
+			file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+			"ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/hash/SK.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Ledger/types/sigcache.h>
+
+#include <Util/include/mutex.h>
+#include <Util/templates/datastream.h>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Default Constructor. */
+        SignatureCache::SignatureCache()
+        : CACHE_MUTEX ( )
+        , setVerified (MAX_SIGNATURE_CACHE)
+        {
+        }
+
+
+        /* Singleton instance. */
+        SignatureCache& SignatureCache::GetInstance()
+        {
+            static SignatureCache ret;
+            return ret;
+        }
+
+
+        /* Hash a public key and signature together. */
+        uint512_t SignatureCache::Key(const std::vector<uint8_t>& vchPubKey, const std::vector<uint8_t>& vchSig)
+        {
+            /* Serialize with length prefixes so bytes can't shift between the key and signature. */
+            DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
+            ss.reserve(vchPubKey.size() + vchSig.size() + 8);
+            ss << vchPubKey << vchSig;
+
+            return LLC::SK512(ss.begin(), ss.end());
+        }
+
+
+        /* Check if a signature was already verified. */
+        bool SignatureCache::Has(const uint512_t& hashTx, const uint512_t& hashKey)
+        {
+            LOCK(CACHE_MUTEX);
+            return setVerified.count(std::make_pair(hashTx, hashKey)) > 0;
+        }
+
+
+        /* Remember a verified signature. */
+        void SignatureCache::Add(const uint512_t& hashTx, const uint512_t& hashKey)
+        {
+            LOCK(CACHE_MUTEX);
+            setVerified.insert(std::make_pair(hashTx, hashKey));
+        }
+    }
+}
@@ -29,6 +29,7 @@ ________________________________________________________________________________
 #include <TAO/Register/include/verify.h>
 
 #include <TAO/Ledger/include/ambassador.h>
+#include <TAO/Ledger/include/blockindex.h>
 #include <TAO/Ledger/include/developer.h>
 #include <TAO/Ledger/include/chainstate.h>
 #include <TAO/Ledger/include/checkpoints.h>
@@ -61,10 +62,27 @@ namespace TAO
         /* Get the block state object. */
         bool GetLastState(BlockState &state, uint32_t nChannel)
         {
-            /* Get the genesis block hash. */
-            uint1024_t hashGenesis =  ChainState::Genesis();
+            /* Return false on genesis. */
+            if(state.nHeight == 0)
+                return false;
 
-            /* Loop back 1440 blocks. */
+            /* Return true on channel found. */
+            if(state.GetChannel() == nChannel)
+                return true;
+
+            /* Jump straight to the last block of the channel using the block index. */
+            CompactState stateLast;
+            if(BlockIndex::GetLast(state.hashPrevBlock, nChannel, stateLast))
+            {
+                BlockState stateFound;
+                if(LLD::Ledger->ReadBlock(stateLast.hashBlock, stateFound))
+                {
+                    state = stateFound;
+                    return true;
+                }
+            }
+
+            /* Loop back to the genesis if the index has no block of the channel. */
             while(true)
             {
                 /* Return false on genesis. */
@@ -40,6 +40,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/developer.h>
 #include <TAO/Ledger/include/constants.h>
 #include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/checkpoints.h>
 #include <TAO/Ledger/include/dispatch.h>
 #include <TAO/Ledger/include/enum.h>
 #include <TAO/Ledger/include/stake.h>
@@ -47,6 +48,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/types/merkle.h>
 #include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigcache.h>
 
 #include <Util/include/debug.h>
 #include <Util/include/runtime.h>
@@ -73,6 +75,7 @@ namespace TAO
         , nNextType    (0)
         , vchPubKey    ( )
         , vchSig       ( )
+        , hashCache    (0)
         {
         }
 
@@ -91,6 +94,7 @@ namespace TAO
         , nNextType    (tx.nNextType)
         , vchPubKey    (tx.vchPubKey)
         , vchSig       (tx.vchSig)
+        , hashCache    (tx.hashCache)
         {
         }
 
@@ -109,6 +113,7 @@ namespace TAO
         , nNextType    (std::move(tx.nNextType))
         , vchPubKey    (std::move(tx.vchPubKey))
         , vchSig       (std::move(tx.vchSig))
+        , hashCache    (std::move(tx.hashCache))
         {
         }
 
@@ -127,6 +132,7 @@ namespace TAO
         , nNextType    (tx.nNextType)
         , vchPubKey    (tx.vchPubKey)
         , vchSig       (tx.vchSig)
+        , hashCache    (tx.hashCache)
         {
         }
 
@@ -145,6 +151,7 @@ namespace TAO
         , nNextType    (std::move(tx.nNextType))
         , vchPubKey    (std::move(tx.vchPubKey))
         , vchSig       (std::move(tx.vchSig))
+        , hashCache    (std::move(tx.hashCache))
         {
         }
 
@@ -164,6 +171,7 @@ namespace TAO
             nNextType    = tx.nNextType;
             vchPubKey    = tx.vchPubKey;
             vchSig       = tx.vchSig;
+            hashCache    = tx.hashCache;
 
             return *this;
         }
@@ -184,6 +192,7 @@ namespace TAO
             nNextType    = std::move(tx.nNextType);
             vchPubKey    = std::move(tx.vchPubKey);
             vchSig       = std::move(tx.vchSig);
+            hashCache    = std::move(tx.hashCache);
 
             return *this;
         }
@@ -204,6 +213,7 @@ namespace TAO
             nNextType    = tx.nNextType;
             vchPubKey    = tx.vchPubKey;
             vchSig       = tx.vchSig;
+            hashCache    = tx.hashCache;
 
             return *this;
         }
@@ -224,6 +234,7 @@ namespace TAO
             nNextType    = std::move(tx.nNextType);
             vchPubKey    = std::move(tx.vchPubKey);
             vchSig       = std::move(tx.vchSig);
+            hashCache    = std::move(tx.hashCache);
 
             return *this;
         }
@@ -270,6 +281,9 @@ namespace TAO
             if(n >= MAX_TRANSACTION_CONTRACTS)
                 throw debug::exception(FUNCTION, "contract create out of bounds");
 
+            /* Contracts may be written through the reference. */
+            hashCache = 0;
+
             /* Allocate a new contract if on write. */
             if(n >= vContracts.size())
                 vContracts.resize(n + 1);
@@ -289,7 +303,7 @@ namespace TAO
 
 
         /* Determines if the transaction is a valid transaciton and passes ledger level checks. */
-        bool Transaction::Check() const
+        bool Transaction::Check(const bool fSignature) const
         {
             /* Check transaction version */
             if(!TransactionVersionActive(nTimestamp, nVersion))
@@ -441,45 +455,65 @@ namespace TAO
                     return debug::error(FUNCTION, "genesis transaction contains invalid contracts.");
             }
 
-            /* Verify the block signature (if not synchronizing) */
-            if(!TAO::Ledger::ChainState::Synchronizing())
+            /* Verify the signature (if not synchronizing) */
+            if(fSignature && !TAO::Ledger::ChainState::Synchronizing() && !VerifySignature())
+                return false;
+
+            return true;
+        }
+
+
+        /* Verify the signature of the transaction against its public key. */
+        bool Transaction::VerifySignature() const
+        {
+            /* Check for empty signatures. */
+            if(vchSig.size() == 0)
+                return debug::error(FUNCTION, "transaction with empty signature");
+
+            /* Skip signatures already verified when the transaction was accepted. */
+            const uint512_t hashTx  = GetHash();
+            const uint512_t hashKey = SignatureCache::Key(vchPubKey, vchSig);
+            if(SignatureCache::GetInstance().Has(hashTx, hashKey))
+                return true;
+
+            /* Switch based on signature type. */
+            switch(nKeyType)
             {
-                /* Switch based on signature type. */
-                switch(nKeyType)
+                /* Support for the FALCON signature scheeme. */
+                case SIGNATURE::FALCON:
                 {
-                    /* Support for the FALCON signature scheeme. */
-                    case SIGNATURE::FALCON:
-                    {
-                        /* Create the FL Key object. */
-                        LLC::FLKey key;
+                    /* Create the FL Key object. */
+                    LLC::FLKey key;
 
-                        /* Set the public key and verify. */
-                        key.SetPubKey(vchPubKey);
-                        if(!key.Verify(GetHash().GetBytes(), vchSig))
-                            return debug::error(FUNCTION, "invalid transaction signature");
+                    /* Set the public key and verify. */
+                    key.SetPubKey(vchPubKey);
+                    if(!key.Verify(hashTx.GetBytes(), vchSig))
+                        return debug::error(FUNCTION, "invalid transaction signature");
 
-                        break;
-                    }
-
-                    /* Support for the BRAINPOOL signature scheme. */
-                    case SIGNATURE::BRAINPOOL:
-                    {
-                        /* Create EC Key object. */
-                        LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
+                    break;
+                }
 
-                        /* Set the public key and verify. */
-                        key.SetPubKey(vchPubKey);
-                        if(!key.Verify(GetHash().GetBytes(), vchSig))
-                            return debug::error(FUNCTION, "invalid transaction signature");
+                /* Support for the BRAINPOOL signature scheme. */
+                case SIGNATURE::BRAINPOOL:
+                {
+                    /* Create EC Key object. */
+                    LLC::ECKey key = LLC::ECKey(LLC::BRAINPOOL_P512_T1, 64);
 
-                        break;
-                    }
+                    /* Set the public key and verify. */
+                    key.SetPubKey(vchPubKey);
+                    if(!key.Verify(hashTx.GetBytes(), vchSig))
+                        return debug::error(FUNCTION, "invalid transaction signature");
 
-                    default:
-                        return debug::error(FUNCTION, "unknown signature type");
+                    break;
                 }
+
+                default:
+                    return debug::error(FUNCTION, "unknown signature type");
             }
 
+            /* Remember the signature for block validation. */
+            SignatureCache::GetInstance().Add(hashTx, hashKey);
+
             return true;
         }
 
@@ -805,6 +839,9 @@ namespace TAO
         /* Build the transaction contracts. */
         bool Transaction::Build()
         {
+            /* Building changes the register pre-states. */
+            hashCache = 0;
+
             /* Create a temporary map for pre-states. */
             std::map<uint256_t, TAO::Register::State> mapStates;
 
@@ -977,6 +1014,9 @@ namespace TAO
             uint512_t hashPrev = 0;
             uint32_t nContract = 0;
 
+            /* Ancestors of the last hardcoded checkpoint skip contract conditions during the initial download. */
+            const bool fConditions = !(nFlags == FLAGS::BLOCK && pblock && IsAssumedValid(pblock->GetHash(), pblock->nHeight));
+
             /* Run through all the contracts. */
             for(const auto& contract : vContracts)
             {
@@ -1020,7 +1060,7 @@ namespace TAO
                 contract.Bind(this);
 
                 /* Execute the contracts to final state. */
-                if(!TAO::Operation::Execute(contract, nFlags, nCost))
+                if(!TAO::Operation::Execute(contract, nFlags, nCost, fConditions))
                     return false;
 
                 /* If transaction fees should apply, calculate the additional transaction cost for the contract */
@@ -1269,6 +1309,10 @@ namespace TAO
         /* Gets the hash of the transaction object. */
         uint512_t Transaction::GetHash() const
         {
+            /* Check for a cached hash. */
+            if(hashCache != 0)
+                return hashCache;
+
             DataStream ss(SER_GETHASH, nVersion);
             ss << *this;
 
@@ -1348,6 +1392,9 @@ namespace TAO
         /* Sets the Next Hash from the key */
         void Transaction::NextHash(const uint512_t& hashSecret, const uint8_t nType)
         {
+            /* The next hash is part of the transaction hash. */
+            hashCache = 0;
+
             /* Get the secret from new key. */
             std::vector<uint8_t> vBytes = hashSecret.GetBytes();
             LLC::CSecret vchSecret(vBytes.begin(), vBytes.end());
@@ -1409,6 +1456,9 @@ namespace TAO
         /* Signs the transaction with the private key and sets the public key */
         bool Transaction::Sign(const uint512_t& hashSecret)
         {
+            /* Fields may have been set directly since the hash was cached. */
+            hashCache = 0;
+
             /* Get the secret from new key. */
             std::vector<uint8_t> vBytes = hashSecret.GetBytes();
             LLC::CSecret vchSecret(vBytes.begin(), vBytes.end());
@@ -37,6 +37,7 @@ ________________________________________________________________________________
 #include <TAO/Ledger/include/supply.h>
 #include <TAO/Ledger/include/timelocks.h>
 #include <TAO/Ledger/types/syncblock.h>
+#include <TAO/Ledger/types/verifier.h>
 
 #include <TAO/Register/include/enum.h>
 #include <TAO/Register/types/address.h>
@@ -62,6 +63,7 @@ namespace TAO
         , vProducer ( )
         , ssSystem  ( )
         , vtx       ( )
+        , hashCache (0)
         {
         }
 
@@ -74,6 +76,7 @@ namespace TAO
         , vProducer (block.vProducer)
         , ssSystem  (block.ssSystem)
         , vtx       (block.vtx)
+        , hashCache (block.hashCache)
         {
         }
 
@@ -86,6 +89,7 @@ namespace TAO
         , vProducer (std::move(block.vProducer))
         , ssSystem  (std::move(block.ssSystem))
         , vtx       (std::move(block.vtx))
+        , hashCache (std::move(block.hashCache))
         {
         }
 
@@ -109,6 +113,7 @@ namespace TAO
             nTime          = block.nTime;
             ssSystem       = block.ssSystem;
             vtx            = block.vtx;
+            hashCache      = block.hashCache;
 
             if(block.nVersion < 9)
                 producer   = block.producer;
@@ -138,6 +143,7 @@ namespace TAO
             nTime          = std::move(block.nTime);
             ssSystem       = std::move(block.ssSystem);
             vtx            = std::move(block.vtx);
+            hashCache      = std::move(block.hashCache);
 
             if(block.nVersion < 9)
                 producer   = std::move(block.producer);
@@ -162,6 +168,7 @@ namespace TAO
         , vProducer ( )
         , ssSystem  ( )
         , vtx       ( )
+        , hashCache (0)
         {
         }
 
@@ -174,6 +181,7 @@ namespace TAO
         , vProducer ( )
         , ssSystem  (state.ssSystem)
         , vtx       ()
+        , hashCache (0)
         {
             if(nVersion < 9)
             {
@@ -224,6 +232,7 @@ namespace TAO
         , vProducer ( )
         , ssSystem  (block.ssSystem)
         , vtx       ( )
+        , hashCache (0)
         {
             /* Check for version conversions. */
             if(block.nVersion < 7)
@@ -326,12 +335,16 @@ namespace TAO
             vtx.clear();
             vProducer.clear();
             producer = Transaction();
+
+            hashCache = 0;
         }
 
 
         /* Update the nTime of the current block. */
         void TritiumBlock::UpdateTime()
         {
+            hashCache = 0;
+
             nTime = static_cast<uint32_t>(std::max(ChainState::stateBest.load().GetBlockTime() + 1, runtime::unifiedtimestamp()));
         }
 
@@ -403,8 +416,8 @@ namespace TAO
                 if(GetBlockTime() > (uint64_t)producer.nTimestamp + ((nVersion < 4) ? 1200 : 3600))
                     return debug::error(FUNCTION, "producer transaction timestamp is too early");
 
-                /* Check that the producer is a valid transaction. */
-                if(!producer.Check())
+                /* Check that the producer is a valid transaction, its signature is verified with the block's. */
+                if(!producer.Check(false))
                     return debug::error(FUNCTION, "producer transaction is invalid");
             }
             else
@@ -418,8 +431,8 @@ namespace TAO
                     if(GetBlockTime() > (uint64_t)txProducer.nTimestamp + 3600)
                         return debug::error(FUNCTION, "producer transaction timestamp is too early");
 
-                    /* Check that the producer is a valid transaction. */
-                    if(!txProducer.Check())
+                    /* Check that the producer is a valid transaction, its signature is verified with the block's. */
+                    if(!txProducer.Check(false))
                         return debug::error(FUNCTION, "producer transaction is invalid");
                 }
             }
@@ -572,6 +585,11 @@ namespace TAO
 
             /* Get the signature operations for legacy tx's. */
             uint32_t nSize = (uint32_t)vtx.size();
+
+            /* The tritium transactions to verify signatures for. */
+            std::vector<TAO::Ledger::Transaction> vTritium;
+            vTritium.reserve(nSize);
+
             for(uint32_t i = 0; i < nSize; ++i)
             {
                 /* Insert txid into set to check for duplicates. */
@@ -627,6 +645,9 @@ namespace TAO
 
                     /* Set the last hash for given genesis. */
                     mapLast[tx.hashGenesis] = tx.GetHash();
+
+                    /* Add to the signature batch. */
+                    vTritium.push_back(std::move(tx));
                 }
                 else
                     return debug::error(FUNCTION, "unknown transaction type");
@@ -684,8 +705,33 @@ namespace TAO
             if(hashMerkleRoot != BuildMerkleTree(vHashes))
                 return debug::error(FUNCTION, "hashMerkleRoot mismatch");
 
+            /* Signatures are skipped during the initial download. */
+            const bool fSynchronizing = TAO::Ledger::ChainState::Synchronizing();
+
+            /* Verify transaction signatures across the verification threads (if not synchronizing) */
+            if(!fSynchronizing)
+            {
+                std::vector<const TAO::Ledger::Transaction*> vVerify;
+                vVerify.reserve(vTritium.size() + vProducer.size() + 1);
+
+                for(const auto& tx : vTritium)
+                    vVerify.push_back(&tx);
+
+                /* Add the producer(s). */
+                if(nVersion < 9)
+                    vVerify.push_back(&producer);
+                else
+                {
+                    for(const auto& txProducer : vProducer)
+                        vVerify.push_back(&txProducer);
+                }
+
+                if(!SignatureVerifier::GetInstance().Verify(vVerify))
+                    return debug::error(FUNCTION, "transaction signature verification failed");
+            }
+
             /* Verify producer signature(s) (if not synchronizing) */
-            if(!TAO::Ledger::ChainState::Synchronizing())
+            if(!fSynchronizing)
             {
                 TAO::Ledger::Transaction txProducer;
 
@@ -874,7 +920,8 @@ namespace TAO
             }
 
             /* Commit the transaction to database. */
-            LLD::TxnCommit();
+            if(!LLD::TxnCommit())
+                return debug::error(FUNCTION, "failed to commit block to database");
 
             /* Check for best chain. */
             if(GetHash() == ChainState::hashBestChain.load())
@@ -1169,6 +1216,10 @@ namespace TAO
         /* Get the Signarture Hash of the block. Used to verify work claims. */
         uint1024_t TritiumBlock::SignatureHash() const
         {
+            /* Check for a cached hash. */
+            if(hashCache != 0)
+                return hashCache;
+
             /* Create a data stream to get the hash. */
             DataStream ss(SER_GETHASH, LLP::PROTOCOL_VERSION);
             ss.reserve(256);
@@ -0,0 +1,197 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_BLOCKTEMPLATE_H
+#define NEXUS_TAO_LEDGER_TYPES_BLOCKTEMPLATE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <TAO/Ledger/types/transaction.h>
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+        class TritiumBlock;
+
+
+        /** BlockTemplate
+         *
+         *  Ledger transactions from the memory pool that are ready to be mined, ranked for new blocks.
+         *
+         *  Transactions are kept by signature chain, since a chain can only go into a block in
+         *  sequence. Chains are ranked by the fees they pay per byte, and chains with the same
+         *  fee rate keep the order they were first seen in.
+         *
+         *  A chain is read from the memory pool once, and only read again when the memory pool
+         *  adds or removes one of its transactions. The template is rebuilt when the best chain
+         *  changes. Chains can spend from each other, so after any change the ranked chains are
+         *  checked together in one transaction, in the order they go in a block, and the result
+         *  is kept until the next change.
+         *
+         **/
+        class BlockTemplate
+        {
+        public:
+
+            /** Priority
+             *
+             *  The rank of a signature chain in the template.
+             *
+             **/
+            struct Priority
+            {
+                /** The fees paid per kilobyte of the chain. **/
+                uint64_t nFeeRate;
+
+
+                /** The order the chain was first seen in. **/
+                uint64_t nOrder;
+
+
+                /** The genesis of the chain. **/
+                uint256_t hashGenesis;
+
+
+                /** Higher fee rates first, then older chains. **/
+                bool operator<(const Priority& priority) const;
+            };
+
+
+        private:
+
+            /** Chain
+             *
+             *  The transactions of a signature chain that can be mined.
+             *
+             **/
+            struct Chain
+            {
+                /** The transactions of the chain, in sequence. **/
+                std::vector<TAO::Ledger::Transaction> vtx;
+
+
+                /** The rank of the chain. **/
+                Priority priority;
+            };
+
+
+            /** Mutex for thread concurrency. **/
+            std::mutex TEMPLATE_MUTEX;
+
+
+            /** The best chain the template was checked against. **/
+            uint1024_t hashBestChain;
+
+
+            /** The checked signature chains by genesis. **/
+            std::map<uint256_t, Chain> mapChains;
+
+
+            /** The signature chains ranked for new blocks. **/
+            std::set<Priority> setPriority;
+
+
+            /** Signature chains that failed a check, to check again next time. **/
+            std::set<uint256_t> setRetry;
+
+
+            /** The transactions that passed checking together, in the order they go in a block. **/
+            std::vector<uint512_t> vChecked;
+
+
+            /** The order given to the next new chain. **/
+            uint64_t nOrder;
+
+
+        public:
+
+            /** FeeRate
+             *
+             *  Get the fees a chain pays per kilobyte.
+             *
+             *  @param[in] nFees The fees paid by the chain.
+             *  @param[in] nBytes The serialized size of the chain.
+             *
+             *  @return The fees paid per kilobyte.
+             *
+             **/
+            static uint64_t FeeRate(const uint64_t nFees, const uint64_t nBytes);
+
+
+            /** Default Constructor. **/
+            BlockTemplate();
+
+
+            /** Singleton instance. **/
+            static BlockTemplate& GetInstance();
+
+
+            /** Add
+             *
+             *  Add the highest ranked transactions that fit to a block.
+             *
+             *  @param[out] block The block to add the transactions to.
+             *  @param[in] hashBest The best chain the block builds on.
+             *
+             **/
+            void Add(TAO::Ledger::TritiumBlock& block, const uint1024_t& hashBest);
+
+
+        private:
+
+            /** Update
+             *
+             *  Read the signature chains the memory pool changed since the last update.
+             *
+             *  @param[in] hashBest The best chain to build on.
+             *
+             *  @return True if any chain changed.
+             *
+             **/
+            bool Update(const uint1024_t& hashBest);
+
+
+            /** Check
+             *
+             *  Check the ranked chains together against the best chain, in the order they go in a block.
+             *  A chain stops at its first transaction that fails.
+             *
+             *  @param[in] nBase The size of the block before any transactions are added.
+             *
+             **/
+            void Check(const uint64_t nBase);
+
+
+            /** Erase
+             *
+             *  Remove a signature chain from the template.
+             *
+             *  @param[in] hashGenesis The genesis of the chain.
+             *
+             **/
+            void Erase(const uint256_t& hashGenesis);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,173 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_COMPACTBLOCK_H
+#define NEXUS_TAO_LEDGER_TYPES_COMPACTBLOCK_H
+
+#include <TAO/Register/types/stream.h>
+
+#include <TAO/Ledger/types/block.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/templates/serialize.h>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        class TritiumBlock;
+
+
+        /** CompactBlock
+         *
+         *  A tritium block that refers to its transactions by short 64-bit ids instead of their
+         *  full hashes, for relaying new blocks to nodes that already hold most of the
+         *  transactions in their memory pool.
+         *
+         *  Short ids are salted by the block's merkle root, which isn't known until the block is
+         *  made, so transactions can't be made ahead of time to collide with each other. Any
+         *  collision that does happen fails the merkle check of the rebuilt block.
+         *
+         **/
+        class CompactBlock : public Block
+        {
+        public:
+
+            /** The Block's timestamp. This number is locked into the signature hash. **/
+            uint64_t nTime;
+
+
+            /** Producer Transaction (pre-version 9). **/
+            Transaction producer;
+
+
+            /** Producer Transactions (v9+). **/
+            std::vector<Transaction> vProducer;
+
+
+            /** System Script
+             *
+             *  The critical system level pre-states and post-states.
+             *
+             **/
+            TAO::Register::Stream  ssSystem;
+
+
+            /** The short transaction ids.
+             *  uint8_t = TransactionType (per enum)
+             *  uint64_t = Short id of the tx hash
+             **/
+            std::vector<std::pair<uint8_t, uint64_t> > vShort;
+
+
+            /** Serialization **/
+            IMPLEMENT_SERIALIZE
+            (
+                READWRITE(nVersion);
+                READWRITE(hashPrevBlock);
+                READWRITE(hashMerkleRoot);
+                READWRITE(nChannel);
+                READWRITE(nHeight);
+                READWRITE(nBits);
+                READWRITE(nNonce);
+                READWRITE(nTime);
+                READWRITE(vchBlockSig);
+
+                if(nVersion < 9)
+                    READWRITE(producer);
+                else
+                    READWRITE(vProducer);
+
+                READWRITE(ssSystem);
+                READWRITE(vOffsets);
+                READWRITE(vShort);
+            )
+
+
+            /** The default constructor. **/
+            CompactBlock();
+
+
+            /** Copy constructor. **/
+            CompactBlock(const CompactBlock& block);
+
+
+            /** Move constructor. **/
+            CompactBlock(CompactBlock&& block) noexcept;
+
+
+            /** Copy assignment. **/
+            CompactBlock& operator=(const CompactBlock& block);
+
+
+            /** Move assignment. **/
+            CompactBlock& operator=(CompactBlock&& block) noexcept;
+
+
+            /** Default Destructor **/
+            virtual ~CompactBlock();
+
+
+            /** Copy Constructor. **/
+            CompactBlock(const TritiumBlock& block);
+
+
+            /** SignatureHash
+             *
+             *  Get the Signature Hash of the block, the same as the tritium block it was made from.
+             *
+             *  @return Returns a 1024-bit signature hash.
+             *
+             **/
+            uint1024_t SignatureHash() const override;
+
+
+            /** ShortID
+             *
+             *  Get the short id of a transaction in this block.
+             *
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             *  @return The short id of the hash.
+             *
+             **/
+            uint64_t ShortID(const uint512_t& hashTx) const;
+
+
+            /** Build
+             *
+             *  Rebuild the tritium block from the transactions a node holds.
+             *
+             *  @param[in] vLedger The hashes of the ledger transactions held.
+             *  @param[in] vLegacy The hashes of the legacy transactions held.
+             *  @param[out] block The rebuilt block, complete when no transactions are missing.
+             *  @param[out] vMissing The indexes of the transactions that aren't held.
+             *
+             *  @return false if the short ids can't be matched to one transaction each, or the
+             *          rebuilt block fails its merkle root, so the full block must be asked for.
+             *
+             **/
+            bool Build(const std::vector<uint512_t>& vLedger, const std::vector<uint512_t>& vLegacy,
+                       TritiumBlock& block, std::vector<uint32_t> &vMissing) const;
+
+        };
+    }
+}
+
+#endif
@@ -25,6 +25,7 @@ ________________________________________________________________________________
 #include <Legacy/types/outpoint.h>
 
 #include <Util/include/mutex.h>
+#include <Util/templates/sharded_map.h>
 
 namespace LLP
 {
@@ -39,35 +40,42 @@ namespace TAO
     namespace Ledger
     {
 
+        /** The most changed genesis tracked before every genesis is checked instead. **/
+        const uint32_t MAX_MEMPOOL_UPDATED = 65536;
+
+
         /** Mempool
          *
          *  The memory pool class where transactions are stored until they are validated
          *  and added to the ledger.
          *
+         *  Transactions are kept in sharded maps, so lookups by txid only lock one shard and never
+         *  wait on MUTEX. MUTEX orders the changes to the pool and guards the indexes.
+         *
          **/
         class Mempool
         {
         public:
 
-            /* Mutex to local access to the mempool */
+            /* Mutex to order changes to the mempool and the memory states they connect to. */
             mutable std::recursive_mutex MUTEX;
 
         private:
 
             /** The transactions in the ledger memory pool. **/
-            std::map<uint512_t, Legacy::Transaction> mapLegacy;
+            sharded_map<uint512_t, Legacy::Transaction> mapLegacy;
 
 
             /** The transactions in conflicted legacy memory pool. */
-            std::map<uint512_t, Legacy::Transaction> mapLegacyConflicts;
+            sharded_map<uint512_t, Legacy::Transaction> mapLegacyConflicts;
 
 
             /** The transactions in the ledger memory pool. **/
-            std::map<uint512_t, TAO::Ledger::Transaction> mapLedger;
+            sharded_map<uint512_t, TAO::Ledger::Transaction> mapLedger;
 
 
             /** The transactions in the conflicted ledger memory pool. **/
-            std::map<uint512_t, TAO::Ledger::Transaction> mapConflicts;
+            sharded_map<uint512_t, TAO::Ledger::Transaction> mapConflicts;
 
 
             /** Oprhan transactions in queue. **/
@@ -85,6 +93,18 @@ namespace TAO
             /** Set to keep track of duplicate orphans by index. **/
             std::set<uint512_t> setOrphansByIndex;
 
+
+            /** Ledger transactions in the memory pool by genesis, ordered by sequence. **/
+            std::map<uint256_t, std::set<std::pair<uint32_t, uint512_t>>> mapGenesis;
+
+
+            /** Genesis whose ledger transactions changed since the block template last checked. **/
+            std::set<uint256_t> setUpdated;
+
+
+            /** Flag for if too many genesis changed to track, so every genesis needs to be checked. **/
+            bool fUpdatedAll;
+
         public:
 
             /** Default Constructor. **/
@@ -291,6 +311,17 @@ namespace TAO
             bool Remove(const uint512_t& hashTx);
 
 
+            /** Updated
+             *
+             *  Gets the genesis whose ledger transactions changed since the last call.
+             *
+             *  @param[out] setGenesis The genesis that changed.
+             *  @param[in] fAll Flag to get every genesis with transactions in the pool.
+             *
+             **/
+            void Updated(std::set<uint256_t> &setGenesis, const bool fAll = false);
+
+
             /** Check
              *
              *  Check the memory pool for consistency.
@@ -312,6 +343,18 @@ namespace TAO
             bool List(std::vector<uint512_t> &vHashes, uint32_t nCount = std::numeric_limits<uint32_t>::max(), bool fLegacy = false);
 
 
+            /** Hashes
+             *
+             *  Gets the hashes of every transaction in the pool, including conflicts and chains that
+             *  aren't ready to be mined.
+             *
+             *  @param[out] vHashes The transaction hashes.
+             *  @param[in] fLegacy Flag to get legacy transactions instead of ledger transactions.
+             *
+             **/
+            void Hashes(std::vector<uint512_t> &vHashes, const bool fLegacy = false) const;
+
+
             /** Size
              *
              *  Gets the size of the memory pool.
@@ -326,6 +369,54 @@ namespace TAO
              *
              **/
             uint32_t SizeLegacy();
+
+
+        private:
+
+            /** IndexGenesis
+             *
+             *  Add a ledger transaction to the index by genesis.
+             *
+             *  @param[in] tx The transaction to index.
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             **/
+            void IndexGenesis(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx);
+
+
+            /** EraseGenesis
+             *
+             *  Remove a ledger transaction from the index by genesis.
+             *
+             *  @param[in] tx The transaction to remove.
+             *  @param[in] hashTx The hash of the transaction.
+             *
+             **/
+            void EraseGenesis(const TAO::Ledger::Transaction& tx, const uint512_t& hashTx);
+
+
+            /** Update
+             *
+             *  Record a genesis whose ledger transactions changed.
+             *
+             *  @param[in] hashGenesis The genesis that changed.
+             *
+             **/
+            void Update(const uint256_t& hashGenesis);
+
+
+            /** Chain
+             *
+             *  Gets the hashes of the pending transactions of a genesis that follow each other
+             *  from the lowest sequence.
+             *
+             *  @param[in] hashGenesis The genesis to get transactions for.
+             *  @param[out] vHashes The hashes of the transactions in sequence order.
+             *
+             *  @return true if the genesis has a transaction in the pool.
+             *
+             **/
+            bool Chain(const uint256_t& hashGenesis, std::vector<uint512_t> &vHashes) const;
         };
 
         extern Mempool mempool;
@@ -123,6 +123,13 @@ namespace TAO
                     READWRITE(vMerkleBranch);
                     READWRITE(nIndex);
                 }
+
+                /* Hash once when read, the transaction won't change after. */
+                if(fRead)
+                {
+                    hashCache = 0;
+                    hashCache = GetHash();
+                }
             )
 
 
@@ -0,0 +1,106 @@
+/*__________________________________________________________________________________________
+
+			(c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+			(c) Copyright The Nexus Developers 2014 - 2019
+
+			Distributed under the MIT software license, see the accompanying
+			file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+			"ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_SIGCACHE_H
+#define NEXUS_TAO_LEDGER_TYPES_SIGCACHE_H
+
+#include <LLC/types/uint1024.h>
+
+#include <Util/templates/mruset.h>
+
+#include <mutex>
+#include <vector>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /** The most verified signatures remembered. **/
+        const uint32_t MAX_SIGNATURE_CACHE = 32768;
+
+
+        /** SignatureCache
+         *
+         *  Bounded set of transaction signatures already verified.
+         *
+         *  Signatures verified when a transaction enters the mempool don't need to be verified
+         *  again when the block containing it arrives. Entries are keyed by the transaction hash
+         *  and a hash over the public key and signature, since the transaction hash doesn't
+         *  cover either of them. Only valid signatures are remembered.
+         *
+         **/
+        class SignatureCache
+        {
+            /** Mutex for thread concurrency. **/
+            std::mutex CACHE_MUTEX;
+
+
+            /** The most recently verified signatures. **/
+            mruset<std::pair<uint512_t, uint512_t>> setVerified;
+
+
+        public:
+
+            /** Default Constructor. **/
+            SignatureCache();
+
+
+            /** Singleton instance. **/
+            static SignatureCache& GetInstance();
+
+
+            /** Key
+             *
+             *  Hash a public key and signature together.
+             *
+             *  @param[in] vchPubKey The public key.
+             *  @param[in] vchSig The signature.
+             *
+             *  @return The hash of the public key and signature.
+             *
+             **/
+            static uint512_t Key(const std::vector<uint8_t>& vchPubKey, const std::vector<uint8_t>& vchSig);
+
+
+            /** Has
+             *
+             *  Check if a signature was already verified.
+             *
+             *  @param[in] hashTx The hash of the transaction.
+             *  @param[in] hashKey The hash of the public key and signature.
+             *
+             *  @return true if the signature was verified.
+             *
+             **/
+            bool Has(const uint512_t& hashTx, const uint512_t& hashKey);
+
+
+            /** Add
+             *
+             *  Remember a verified signature.
+             *
+             *  @param[in] hashTx The hash of the transaction.
+             *  @param[in] hashKey The hash of the public key and signature.
+             *
+             **/
+            void Add(const uint512_t& hashTx, const uint512_t& hashKey);
+        };
+    }
+}
+
+#endif
@@ -90,6 +90,10 @@ namespace TAO
             std::vector<uint8_t> vchPubKey;
             std::vector<uint8_t> vchSig;
 
+            /* Memory only, the hash of a transaction read from a stream. Cleared when the transaction
+             * is changed through its methods, and never set for transactions built in memory. */
+            mutable uint512_t hashCache;
+
             /* serialization macros */
             IMPLEMENT_SERIALIZE
             (
@@ -114,6 +118,13 @@ namespace TAO
                 /* Handle for when not getting hash or skipsig. */
                 if(!(nSerType & SER_GETHASH) && !(nSerType & SER_SKIPSIG))
                     READWRITE(vchSig);
+
+                /* Hash once when read, the transaction won't change after. */
+                if(fRead)
+                {
+                    hashCache = 0;
+                    hashCache = GetHash();
+                }
             )
 
 
@@ -201,10 +212,22 @@ namespace TAO
              *
              *  Determines if the transaction is a valid transaciton and passes ledger level checks.
              *
+             *  @param[in] fSignature Flag to verify the signature, cleared when it is verified in a batch.
+             *
              *  @return true if transaction is valid.
              *
              **/
-            bool Check() const;
+            bool Check(const bool fSignature = true) const;
+
+
+            /** VerifySignature
+             *
+             *  Verify the signature of the transaction against its public key.
+             *
+             *  @return true if the signature is valid.
+             *
+             **/
+            bool VerifySignature() const;
 
 
             /** Verify
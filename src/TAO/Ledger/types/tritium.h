@@ -82,6 +82,10 @@ namespace TAO
             std::vector<std::pair<uint8_t, uint512_t> > vtx;
 
 
+            /** MEMORY ONLY: signature hash of a block read from a stream. Never set for blocks built in memory. **/
+            mutable uint1024_t hashCache;
+
+
             /** Serialization **/
             IMPLEMENT_SERIALIZE
             (
@@ -103,6 +107,13 @@ namespace TAO
                 READWRITE(ssSystem);
                 READWRITE(vOffsets);
                 READWRITE(vtx);
+
+                /* Hash once when read, the block won't change after. */
+                if(fRead)
+                {
+                    hashCache = 0;
+                    hashCache = SignatureHash();
+                }
             )
 
 
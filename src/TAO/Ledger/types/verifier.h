@@ -0,0 +1,161 @@
+/*__________________________________________________________________________________________
+
+			(c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+			(c) Copyright The Nexus Developers 2014 - 2019
+
+			Distributed under the MIT software license, see the accompanying
+			file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+			"ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_TAO_LEDGER_TYPES_VERIFIER_H
+#define NEXUS_TAO_LEDGER_TYPES_VERIFIER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        class Transaction;
+
+
+        /** SignatureVerifier
+         *
+         *  Pool of threads that verify the signatures of a batch of transactions concurrently.
+         *
+         *  The calling thread works through the batch alongside the pool, so a batch always
+         *  completes even without worker threads. The first invalid signature stops the batch.
+         *
+         **/
+        class SignatureVerifier
+        {
+            /** Batch
+             *
+             *  The transactions being verified and the shared progress through them.
+             *
+             **/
+            struct Batch
+            {
+                /** The transactions to verify. **/
+                const std::vector<const Transaction*>& vtx;
+
+
+                /** The sequence number of this batch. **/
+                const uint64_t nSequence;
+
+
+                /** The next transaction to take. **/
+                std::atomic<uint32_t> nNext;
+
+
+                /** Flag set on the first invalid signature. **/
+                std::atomic<bool> fFailed;
+
+
+                /** The worker threads still verifying this batch. **/
+                uint32_t nWorkers;
+
+
+                /** Batch Constructor. **/
+                Batch(const std::vector<const Transaction*>& vtxIn, const uint64_t nSequenceIn)
+                : vtx       (vtxIn)
+                , nSequence (nSequenceIn)
+                , nNext     (0)
+                , fFailed   (false)
+                , nWorkers  (0)
+                {
+                }
+            };
+
+
+            /** Mutex to allow one batch at a time. **/
+            std::mutex BATCH_MUTEX;
+
+
+            /** Mutex to protect the current batch. **/
+            std::mutex VERIFY_MUTEX;
+
+
+            /** Condition to wake the workers and the caller. **/
+            std::condition_variable CONDITION;
+
+
+            /** The batch being verified. **/
+            std::shared_ptr<Batch> pBatch;
+
+
+            /** The sequence number of the last batch. **/
+            uint64_t nSequence;
+
+
+            /** Flag to stop the worker threads. **/
+            bool fShutdown;
+
+
+            /** The worker threads. **/
+            std::vector<std::thread> vThreads;
+
+
+        public:
+
+            /** Default Constructor. **/
+            SignatureVerifier();
+
+
+            /** Default Destructor. **/
+            ~SignatureVerifier();
+
+
+            /** Singleton instance. **/
+            static SignatureVerifier& GetInstance();
+
+
+            /** Verify
+             *
+             *  Verify the signatures of a batch of transactions.
+             *
+             *  @param[in] vtx The transactions to verify.
+             *
+             *  @return true if every signature is valid.
+             *
+             **/
+            bool Verify(const std::vector<const Transaction*>& vtx);
+
+
+        private:
+
+            /** Thread
+             *
+             *  Worker thread joining each new batch.
+             *
+             **/
+            void Thread();
+
+
+            /** Work
+             *
+             *  Verify transactions of a batch until it is exhausted or fails.
+             *
+             *  @param[in] batch The batch to work on.
+             *
+             **/
+            static void Work(Batch& batch);
+        };
+    }
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*__________________________________________________________________________________________
+
+			(c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+			(c) Copyright The Nexus Developers 2014 - 2019
+
+			Distributed under the MIT software license, see the accompanying
+			file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+			"ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <TAO/Ledger/types/verifier.h>
+#include <TAO/Ledger/types/transaction.h>
+
+#include <Util/include/args.h>
+#include <Util/include/debug.h>
+#include <Util/include/mutex.h>
+
+#include <algorithm>
+
+/* Global TAO namespace. */
+namespace TAO
+{
+
+    /* Ledger Layer namespace. */
+    namespace Ledger
+    {
+
+        /* Default Constructor. */
+        SignatureVerifier::SignatureVerifier()
+        : BATCH_MUTEX  ( )
+        , VERIFY_MUTEX ( )
+        , CONDITION    ( )
+        , pBatch       ( )
+        , nSequence    (0)
+        , fShutdown    (false)
+        , vThreads     ( )
+        {
+            /* The calling thread verifies too, so one less worker than cores. */
+            const uint32_t nCores   = std::max(1u, std::thread::hardware_concurrency());
+            const uint32_t nThreads = static_cast<uint32_t>(config::GetArg("-verifythreads", nCores - 1));
+
+            for(uint32_t n = 0; n < nThreads; ++n)
+                vThreads.push_back(std::thread(&SignatureVerifier::Thread, this));
+        }
+
+
+        /* Default Destructor. */
+        SignatureVerifier::~SignatureVerifier()
+        {
+            {
+                LOCK(VERIFY_MUTEX);
+                fShutdown = true;
+            }
+            CONDITION.notify_all();
+
+            for(auto& thread : vThreads)
+                if(thread.joinable())
+                    thread.join();
+        }
+
+
+        /* Singleton instance. */
+        SignatureVerifier& SignatureVerifier::GetInstance()
+        {
+            static SignatureVerifier ret;
+            return ret;
+        }
+
+
+        /* Verify the signatures of a batch of transactions. */
+        bool SignatureVerifier::Verify(const std::vector<const Transaction*>& vtx)
+        {
+            /* Small batches aren't worth waking the pool for. */
+            if(vtx.size() < 2 || vThreads.empty())
+            {
+                for(const auto& ptx : vtx)
+                    if(!ptx->VerifySignature())
+                        return false;
+
+                return true;
+            }
+
+            LOCK(BATCH_MUTEX);
+
+            /* Publish the batch to the workers. */
+            std::shared_ptr<Batch> pbatch;
+            {
+                LOCK(VERIFY_MUTEX);
+
+                pbatch = std::make_shared<Batch>(vtx, ++nSequence);
+                pBatch = pbatch;
+            }
+            CONDITION.notify_all();
+
+            /* Work on the batch from this thread too. */
+            Work(*pbatch);
+
+            /* Stop new workers joining and wait for the ones still verifying. */
+            {
+                std::unique_lock<std::mutex> lock(VERIFY_MUTEX);
+                pBatch.reset();
+
+                CONDITION.wait(lock, [&pbatch]{ return pbatch->nWorkers == 0; });
+            }
+
+            return !pbatch->fFailed.load();
+        }
+
+
+        /* Worker thread joining each new batch. */
+        void SignatureVerifier::Thread()
+        {
+            uint64_t nLast = 0;
+            while(true)
+            {
+                /* Wait for a batch this thread hasn't worked on. */
+                std::shared_ptr<Batch> pbatch;
+                {
+                    std::unique_lock<std::mutex> lock(VERIFY_MUTEX);
+                    CONDITION.wait(lock, [this, nLast]{ return fShutdown || (pBatch && pBatch->nSequence != nLast); });
+
+                    if(fShutdown)
+                        return;
+
+                    pbatch = pBatch;
+                    nLast  = pbatch->nSequence;
+
+                    ++pbatch->nWorkers;
+                }
+
+                Work(*pbatch);
+
+                /* Let the caller know once the last worker is done. */
+                {
+                    LOCK(VERIFY_MUTEX);
+                    --pbatch->nWorkers;
+                }
+                CONDITION.notify_all();
+            }
+        }
+
+
+        /* Verify transactions of a batch until it is exhausted or fails. */
+        void SignatureVerifier::Work(Batch& batch)
+        {
+            const uint32_t nSize = static_cast<uint32_t>(batch.vtx.size());
+            while(!batch.fFailed.load())
+            {
+                const uint32_t nIndex = batch.nNext++;
+                if(nIndex >= nSize)
+                    break;
+
+                if(!batch.vtx[nIndex]->VerifySignature())
+                    batch.fFailed = true;
+            }
+        }
+    }
+}
@@ -59,6 +59,13 @@ namespace TAO
 
         /* Executes a given contract and calculates its cost. */
         bool Execute(const Contract& contract, const uint8_t nFlags, uint64_t &nCost)
+        {
+            return Execute(contract, nFlags, nCost, true);
+        }
+
+
+        /* Executes a given contract and calculates its cost, optionally without evaluating conditions. */
+        bool Execute(const Contract& contract, const uint8_t nFlags, uint64_t &nCost, const bool fConditions)
         {
             /* Reset the contract streams. */
             contract.Reset();
@@ -110,8 +117,8 @@ namespace TAO
                         uint32_t nContract = 0;
                         contract >> nContract;
 
-                        /* DISABLED for -client mode. */
-                        if(!config::fClient.load())
+                        /* DISABLED for -client mode and blocks assumed valid. */
+                        if(!config::fClient.load() && fConditions)
                         {
                             /* Verify the operation rules. */
                             const Contract condition = LLD::Ledger->ReadContract(hashTx, nContract);
@@ -420,8 +427,8 @@ namespace TAO
                             if(!Claim::Verify(contract, transfer))
                                 return false;
 
-                            /* Check for conditions. */
-                            if(!transfer.Empty(Contract::CONDITIONS))
+                            /* Check for conditions (if not assumed valid). */
+                            if(fConditions && !transfer.Empty(Contract::CONDITIONS))
                             {
                                 /* Get the condition. */
                                 uint8_t nType = 0;
@@ -879,8 +886,8 @@ namespace TAO
                             if(!Credit::Verify(contract, debit, nFlags))
                                 return false;
 
-                            /* Check for conditions. */
-                            if(!debit.Empty(Contract::CONDITIONS))
+                            /* Check for conditions (if not assumed valid). */
+                            if(fConditions && !debit.Empty(Contract::CONDITIONS))
                             {
                                 /* Get the condition. */
                                 uint8_t nType = 0;
@@ -54,6 +54,22 @@ namespace TAO
          **/
         bool Execute(const Contract& contract, const uint8_t nFlags, uint64_t &nCost);
 
+
+        /** Execute
+         *
+         *  Executes a given contract and calculates its cost, optionally without evaluating
+         *  the conditions of the contracts it validates, claims or credits.
+         *
+         *  @param[in] contract The contract to execute
+         *  @param[in] nFlags The flags to execute with.
+         *  @param[out] nCost The calculated cost to execute this contract
+         *  @param[in] fConditions Flag to evaluate conditions, false only for blocks assumed valid.
+         *
+         *  @return True if operations executed successfully, false otherwise.
+         *
+         **/
+        bool Execute(const Contract& contract, const uint8_t nFlags, uint64_t &nCost, const bool fConditions);
+
     }
 }
 
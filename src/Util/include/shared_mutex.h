@@ -0,0 +1,194 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_INCLUDE_SHARED_MUTEX_H
+#define NEXUS_UTIL_INCLUDE_SHARED_MUTEX_H
+
+#include <condition_variable>
+#include <cstdint>
+
+#include <Util/include/mutex.h>
+
+
+/* Macro preprocessor definitions for reader / writer locks. */
+#define READER_LOCK(mut) shared_lock rlk(mut)
+#define WRITER_LOCK(mut) std::unique_lock<shared_mutex> wlk(mut)
+
+
+/** shared_mutex
+ *
+ *  Reader / writer mutex for C++11 builds that don't have std::shared_mutex.
+ *  Any number of readers may hold the lock at once, while a writer holds it exclusively.
+ *  Writers are given preference so a steady stream of readers can't starve them.
+ *
+ **/
+class shared_mutex
+{
+    /** Internal mutex for protecting the lock state. **/
+    std::mutex INTERNAL_MUTEX;
+
+
+    /** Condition to wake up waiting readers. **/
+    std::condition_variable READER_CONDITION;
+
+
+    /** Condition to wake up waiting writers. **/
+    std::condition_variable WRITER_CONDITION;
+
+
+    /** Total number of readers currently holding the lock. **/
+    uint32_t nReaders;
+
+
+    /** Total number of writers waiting for the lock. **/
+    uint32_t nWaiting;
+
+
+    /** Flag to determine if a writer is holding the lock. **/
+    bool fWriter;
+
+public:
+
+    /** Default Constructor. **/
+    shared_mutex()
+    : INTERNAL_MUTEX   ( )
+    , READER_CONDITION ( )
+    , WRITER_CONDITION ( )
+    , nReaders         (0)
+    , nWaiting         (0)
+    , fWriter          (false)
+    {
+    }
+
+
+    /** Copy Constructor. **/
+    shared_mutex(const shared_mutex&)            = delete;
+
+
+    /** Copy Assignment. **/
+    shared_mutex& operator=(const shared_mutex&) = delete;
+
+
+    /** lock
+     *
+     *  Acquire the lock exclusively.
+     *
+     **/
+    void lock()
+    {
+        std::unique_lock<std::mutex> lk(INTERNAL_MUTEX);
+
+        /* Wait for readers and any other writer to release. */
+        ++nWaiting;
+        WRITER_CONDITION.wait(lk, [this]{ return !fWriter && nReaders == 0; });
+        --nWaiting;
+
+        fWriter = true;
+    }
+
+
+    /** unlock
+     *
+     *  Release the exclusive lock.
+     *
+     **/
+    void unlock()
+    {
+        {
+            LOCK(INTERNAL_MUTEX);
+            fWriter = false;
+        }
+
+        /* Wake up the next writer, and readers if no more writers are waiting. */
+        WRITER_CONDITION.notify_one();
+        READER_CONDITION.notify_all();
+    }
+
+
+    /** lock_shared
+     *
+     *  Acquire the lock shared with other readers.
+     *
+     **/
+    void lock_shared()
+    {
+        std::unique_lock<std::mutex> lk(INTERNAL_MUTEX);
+
+        /* Wait for any active or pending writers. */
+        READER_CONDITION.wait(lk, [this]{ return !fWriter && nWaiting == 0; });
+
+        ++nReaders;
+    }
+
+
+    /** unlock_shared
+     *
+     *  Release the shared lock.
+     *
+     **/
+    void unlock_shared()
+    {
+        bool fNotify = false;
+        {
+            LOCK(INTERNAL_MUTEX);
+            fNotify = (--nReaders == 0 && nWaiting > 0);
+        }
+
+        /* Wake up a writer if we were the last reader. */
+        if(fNotify)
+            WRITER_CONDITION.notify_one();
+    }
+};
+
+
+/** shared_lock
+ *
+ *  Scoped shared ownership of a shared_mutex.
+ *
+ **/
+class shared_lock
+{
+    /** Reference to the mutex being held. **/
+    shared_mutex& MUTEX;
+
+public:
+
+    /** Default Constructor. **/
+    shared_lock() = delete;
+
+
+    /** Copy Constructor. **/
+    shared_lock(const shared_lock&)            = delete;
+
+
+    /** Copy Assignment. **/
+    shared_lock& operator=(const shared_lock&) = delete;
+
+
+    /** Lock Constructor. **/
+    explicit shared_lock(shared_mutex& MUTEX_IN)
+    : MUTEX (MUTEX_IN)
+    {
+        MUTEX.lock_shared();
+    }
+
+
+    /** Default Destructor. **/
+    ~shared_lock()
+    {
+        MUTEX.unlock_shared();
+    }
+};
+
+#endif
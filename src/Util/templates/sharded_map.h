@@ -0,0 +1,270 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#pragma once
+#ifndef NEXUS_UTIL_TEMPLATES_SHARDED_MAP_H
+#define NEXUS_UTIL_TEMPLATES_SHARDED_MAP_H
+
+#include <Util/include/shared_mutex.h>
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+/** sharded_map
+ *
+ *  Map of hashes split over shards that each have their own reader / writer lock.
+ *
+ *  Values are immutable once added, and held by shared pointer. A reader only holds the lock
+ *  of one shard long enough to copy the pointer, so it never waits on a reader or writer of
+ *  another shard, and reads the value after the lock is released. A value replaced or erased
+ *  meanwhile stays alive until the last reader drops it.
+ *
+ *  Keys are base_uint hashes. The low word of the key picks the shard.
+ *
+ **/
+template<typename KeyType, typename ValueType, uint32_t SHARDS = 16>
+class sharded_map
+{
+    /** Shard
+     *
+     *  One part of the map with its lock.
+     *
+     **/
+    struct Shard
+    {
+        /** Reader / writer lock for the shard. **/
+        mutable shared_mutex MUTEX;
+
+
+        /** The values in the shard. **/
+        std::map<KeyType, std::shared_ptr<const ValueType>> mapValues;
+    };
+
+
+    /** The shards of the map. **/
+    std::array<Shard, SHARDS> vShards;
+
+
+    /** The total values in the map. **/
+    std::atomic<uint64_t> nSize;
+
+
+    /** Get the shard of a key. **/
+    Shard& shard(const KeyType& key)
+    {
+        return vShards[key.Get64(0) % SHARDS];
+    }
+
+
+    /** Get the shard of a key. **/
+    const Shard& shard(const KeyType& key) const
+    {
+        return vShards[key.Get64(0) % SHARDS];
+    }
+
+public:
+
+    /** Default Constructor. **/
+    sharded_map()
+    : vShards ( )
+    , nSize   (0)
+    {
+    }
+
+
+    /** Copy Constructor. **/
+    sharded_map(const sharded_map&)            = delete;
+
+
+    /** Copy Assignment. **/
+    sharded_map& operator=(const sharded_map&) = delete;
+
+
+    /** insert
+     *
+     *  Add a value if the key isn't in the map.
+     *
+     *  @param[in] key The key to add.
+     *  @param[in] value The value to add.
+     *
+     *  @return true if the value was added.
+     *
+     **/
+    bool insert(const KeyType& key, const ValueType& value)
+    {
+        /* Copy the value outside of the lock. */
+        std::shared_ptr<const ValueType> ptr = std::make_shared<const ValueType>(value);
+
+        Shard& s = shard(key);
+        WRITER_LOCK(s.MUTEX);
+
+        if(!s.mapValues.emplace(key, ptr).second)
+            return false;
+
+        ++nSize;
+        return true;
+    }
+
+
+    /** set
+     *
+     *  Add a value, replacing the value of the key if it is in the map.
+     *
+     *  @param[in] key The key to set.
+     *  @param[in] value The value to set.
+     *
+     **/
+    void set(const KeyType& key, const ValueType& value)
+    {
+        /* Copy the value outside of the lock. */
+        std::shared_ptr<const ValueType> ptr = std::make_shared<const ValueType>(value);
+
+        Shard& s = shard(key);
+        WRITER_LOCK(s.MUTEX);
+
+        std::shared_ptr<const ValueType>& entry = s.mapValues[key];
+        if(!entry)
+            ++nSize;
+
+        entry.swap(ptr);
+    }
+
+
+    /** erase
+     *
+     *  Remove a key from the map.
+     *
+     *  @param[in] key The key to remove.
+     *
+     *  @return true if the key was in the map.
+     *
+     **/
+    bool erase(const KeyType& key)
+    {
+        /* Keep the value alive until the lock is released. */
+        std::shared_ptr<const ValueType> ptr;
+        {
+            Shard& s = shard(key);
+            WRITER_LOCK(s.MUTEX);
+
+            auto it = s.mapValues.find(key);
+            if(it == s.mapValues.end())
+                return false;
+
+            ptr.swap(it->second);
+            s.mapValues.erase(it);
+        }
+
+        --nSize;
+        return true;
+    }
+
+
+    /** has
+     *
+     *  Determines if a key is in the map.
+     *
+     **/
+    bool has(const KeyType& key) const
+    {
+        const Shard& s = shard(key);
+        READER_LOCK(s.MUTEX);
+
+        return s.mapValues.count(key) > 0;
+    }
+
+
+    /** find
+     *
+     *  Get the value of a key without copying it.
+     *
+     *  @param[in] key The key to find.
+     *
+     *  @return The value, or null if the key isn't in the map.
+     *
+     **/
+    std::shared_ptr<const ValueType> find(const KeyType& key) const
+    {
+        const Shard& s = shard(key);
+        READER_LOCK(s.MUTEX);
+
+        auto it = s.mapValues.find(key);
+        if(it == s.mapValues.end())
+            return nullptr;
+
+        return it->second;
+    }
+
+
+    /** get
+     *
+     *  Get a copy of the value of a key.
+     *
+     *  @param[in] key The key to get.
+     *  @param[out] value The value of the key.
+     *
+     *  @return true if the key is in the map.
+     *
+     **/
+    bool get(const KeyType& key, ValueType& value) const
+    {
+        /* Copy the value outside of the lock. */
+        std::shared_ptr<const ValueType> ptr = find(key);
+        if(!ptr)
+            return false;
+
+        value = *ptr;
+        return true;
+    }
+
+
+    /** keys
+     *
+     *  Get the keys in the map, a shard at a time.
+     *
+     *  @param[out] vKeys The keys in the map.
+     *  @param[in] nLimit The most keys to get.
+     *
+     **/
+    void keys(std::vector<KeyType>& vKeys, const uint64_t nLimit = std::numeric_limits<uint64_t>::max()) const
+    {
+        for(const Shard& s : vShards)
+        {
+            READER_LOCK(s.MUTEX);
+            for(const auto& entry : s.mapValues)
+            {
+                if(vKeys.size() >= nLimit)
+                    return;
+
+                vKeys.push_back(entry.first);
+            }
+        }
+    }
+
+
+    /** size
+     *
+     *  Get the total values in the map.
+     *
+     **/
+    uint64_t size() const
+    {
+        return nSize.load();
+    }
+};
+
+#endif
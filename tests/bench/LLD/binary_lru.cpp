@@ -3,6 +3,7 @@
 #include <LLC/include/random.h>
 
 #include <LLD/cache/binary_lru.h>
+#include <LLD/templates/key.h>
 
 #include <LLD/include/version.h>
 
@@ -16,7 +17,8 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
     debug::log(0, "===== Begin Binary LRU Benchmarks =====");
 
     //benchmarks
-    LLD::BinaryLRU* cache = new LLD::BinaryLRU();
+    LLD::BinaryLRU* cache = new LLD::BinaryLRU(256 * 1024 * 1024);
+    LLD::SectorKey key;
     uint256_t hash = LLC::GetRand256();
     {
         runtime::timer timer;
@@ -30,7 +32,7 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
             DataStream ssData(SER_LLD, LLD::DATABASE_VERSION);
             ssData << uint1024_t(4934943);
 
-            cache->Put(ssKey.Bytes(), ssData.Bytes());
+            cache->Put(key, ssKey.Bytes(), ssData.Bytes());
         }
 
         uint64_t nTime = timer.ElapsedMicroseconds();
@@ -57,5 +59,8 @@ TEST_CASE( "Binary LRU Benchmarks", "[LLD]")
     }
 
 
+    debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Hits::", ANSI_COLOR_RESET, cache->HitRate() * 100.0, " %");
+    delete cache;
+
     debug::log(0, "===== End Binary LRU Benchmarks =====\n");
 }
@@ -0,0 +1,85 @@
+#include <Util/include/runtime.h>
+#include <Util/include/args.h>
+
+#include <LLC/include/random.h>
+
+#include <LLD/keychain/hashmap.h>
+
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+
+TEST_CASE( "Binary Hashmap Concurrent Read Benchmarks", "[LLD]")
+{
+    debug::log(0, "===== Begin Binary Hashmap Concurrent Read Benchmarks =====");
+
+    //keychain to run against
+    LLD::BinaryHashMap* hashmap = new LLD::BinaryHashMap(config::GetDataDir() + "hashmap/keychain/", LLD::FLAGS::APPEND, 256 * 256);
+
+    //build the keys
+    const uint32_t nTotal = 100000;
+    std::vector< std::vector<uint8_t> > vKeys;
+
+    uint256_t hash = LLC::GetRand256();
+    {
+        runtime::timer timer;
+        timer.Start();
+
+        for(uint32_t i = 0; i < nTotal; ++i)
+        {
+            DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+            ssKey << std::make_pair(std::string("data"), hash + i);
+
+            LLD::SectorKey cKey(LLD::STATE::READY, ssKey.Bytes(), 0, i, 0);
+            hashmap->Put(cKey);
+
+            vKeys.push_back(ssKey.Bytes());
+        }
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Put::", ANSI_COLOR_RESET, (nTotal * 1.0) / nTime, " million records / second");
+    }
+
+
+    //read all keys from an increasing number of threads
+    for(uint32_t nThreads = 1; nThreads <= 8; nThreads *= 2)
+    {
+        std::atomic<uint32_t> nFound(0);
+
+        runtime::timer timer;
+        timer.Start();
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t t = 0; t < nThreads; ++t)
+        {
+            vThreads.push_back(std::thread([&, t]
+            {
+                //each thread starts at a different offset so they don't walk the same buckets in lockstep
+                for(uint32_t i = 0; i < nTotal; ++i)
+                {
+                    LLD::SectorKey cKey;
+                    if(hashmap->Get(vKeys[(i + t * (nTotal / nThreads)) % nTotal], cKey))
+                        ++nFound;
+                }
+            }));
+        }
+
+        for(auto& thread : vThreads)
+            thread.join();
+
+        uint64_t nTime = timer.ElapsedMicroseconds();
+        debug::log(0, ANSI_COLOR_BRIGHT_CYAN, "Get::", ANSI_COLOR_RESET, nThreads, " threads ", (nTotal * nThreads * 1.0) / nTime, " million records / second");
+
+        REQUIRE(nFound.load() == nTotal * nThreads);
+    }
+
+    delete hashmap;
+
+    debug::log(0, "===== End Binary Hashmap Concurrent Read Benchmarks =====\n");
+}
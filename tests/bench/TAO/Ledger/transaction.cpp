@@ -0,0 +1,80 @@
+#include <Util/include/runtime.h>
+
+#include <LLC/include/random.h>
+
+#include <LLP/include/version.h>
+
+#include <Legacy/types/transaction.h>
+
+#include <TAO/Operation/include/enum.h>
+
+#include <TAO/Ledger/types/transaction.h>
+#include <TAO/Ledger/types/tritium.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Time a number of GetHash calls on an object. */
+template<typename Type>
+void BenchHash(const std::string& strName, const Type& object)
+{
+    runtime::timer timer;
+    timer.Start();
+
+    uint64_t nCheck = 0;
+    for(int i = 0; i < 100000; i++)
+        nCheck += object.GetHash().Get64();
+
+    uint64_t nTime = std::max(timer.ElapsedMicroseconds(), uint64_t(1));
+    debug::log(0, ANSI_COLOR_BRIGHT_CYAN, strName, "::", ANSI_COLOR_RESET, 100000.0 / nTime, " million hashes / second (", nCheck & 0xff, ")");
+}
+
+
+/* Round trip an object through a stream, as it arrives from the network. */
+template<typename Type>
+Type ReadBack(const Type& object)
+{
+    DataStream ssData(SER_NETWORK, LLP::PROTOCOL_VERSION);
+    ssData << object;
+
+    Type objectRead;
+    ssData >> objectRead;
+
+    return objectRead;
+}
+
+
+TEST_CASE( "Transaction Hash Benchmarks", "[ledger]")
+{
+    debug::log(0, "===== Begin Transaction Hash Benchmarks =====");
+
+    /* Tritium transaction with a few contracts. */
+    TAO::Ledger::Transaction tx;
+    for(uint32_t n = 0; n < 4; ++n)
+        tx[n] << uint8_t(TAO::Operation::OP::WRITE) << LLC::GetRand256() << std::vector<uint8_t>(128, 0xff);
+
+    BenchHash("Tritium::Built", tx);
+    BenchHash("Tritium::Read", ReadBack(tx));
+
+    /* Legacy transaction with a few outputs. */
+    Legacy::Transaction txLegacy;
+    txLegacy.vout.resize(4);
+    for(auto& txout : txLegacy.vout)
+        txout.nValue = LLC::GetRand();
+
+    BenchHash("Legacy::Built", txLegacy);
+    BenchHash("Legacy::Read", ReadBack(txLegacy));
+
+    /* Tritium block header. */
+    TAO::Ledger::TritiumBlock block;
+    block.nVersion      = 7;
+    block.hashPrevBlock = LLC::GetRand1024();
+    block.vtx.push_back(std::make_pair(uint8_t(0), LLC::GetRand512()));
+
+    BenchHash("TritiumBlock::Built", block);
+    BenchHash("TritiumBlock::Read", ReadBack(block));
+
+    debug::log(0, "===== End Transaction Hash Benchmarks =====\n");
+}
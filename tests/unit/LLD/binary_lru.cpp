@@ -0,0 +1,133 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/cache/binary_lru.h>
+#include <LLD/templates/key.h>
+#include <LLD/include/version.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <thread>
+
+namespace
+{
+    /* Build a binary key for a record number. */
+    std::vector<uint8_t> CacheKey(const std::string& strType, const uint32_t nRecord)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << std::make_pair(strType, nRecord);
+
+        return ssKey.Bytes();
+    }
+}
+
+
+TEST_CASE("LLD binary cache tests", "[LLD]")
+{
+    const std::vector<uint8_t> vData(160, 0xaf);
+    const LLD::SectorKey cKey;
+
+    SECTION("Capacity is accounted in bytes")
+    {
+        LLD::BinaryLRU cache(1024 * 1024);
+        for(uint32_t i = 0; i < 20000; ++i)
+            cache.Put(cKey, CacheKey("bytes", i), vData);
+
+        REQUIRE(cache.Size() <= 1024 * 1024);
+        REQUIRE(cache.Size() > 512 * 1024);
+    }
+
+    SECTION("Updates and removes")
+    {
+        LLD::BinaryLRU cache(1024 * 1024);
+        cache.Put(cKey, CacheKey("update", 0), vData);
+        REQUIRE(cache.Has(CacheKey("update", 0)));
+
+        std::vector<uint8_t> vUpdate(32, 0x01), vRead;
+        cache.Put(cKey, CacheKey("update", 0), vUpdate);
+        REQUIRE(cache.Get(CacheKey("update", 0), vRead));
+        REQUIRE(vRead == vUpdate);
+
+        REQUIRE(cache.Remove(CacheKey("update", 0)));
+        REQUIRE(!cache.Has(CacheKey("update", 0)));
+        REQUIRE(!cache.Remove(CacheKey("update", 0)));
+        REQUIRE(cache.Size() == 0);
+    }
+
+    SECTION("Scans don't flush the working set")
+    {
+        LLD::BinaryLRU cache(1024 * 1024);
+
+        /* A working set of a quarter of the cache, read a few times. */
+        const uint32_t nHot = 1024;
+        for(uint32_t nPass = 0; nPass < 4; ++nPass)
+        {
+            for(uint32_t i = 0; i < nHot; ++i)
+            {
+                std::vector<uint8_t> vRead;
+                if(!cache.Get(CacheKey("hot", i), vRead))
+                    cache.Put(cKey, CacheKey("hot", i), vData);
+            }
+        }
+
+        /* One pass over ten times the cache in records read once, while the working set is still in use.
+         * Hot records are read back slower than the cache turns over, so plain LRU would lose them all. */
+        for(uint32_t i = 0; i < 40000; ++i)
+        {
+            std::vector<uint8_t> vRead;
+            if(!cache.Get(CacheKey("scan", i), vRead))
+                cache.Put(cKey, CacheKey("scan", i), vData);
+
+            if(i % 8 == 0 && !cache.Get(CacheKey("hot", (i / 8) % nHot), vRead))
+                cache.Put(cKey, CacheKey("hot", (i / 8) % nHot), vData);
+        }
+
+        /* Almost all of the working set survives. */
+        uint32_t nFound = 0;
+        for(uint32_t i = 0; i < nHot; ++i)
+            nFound += cache.Has(CacheKey("hot", i)) ? 1 : 0;
+
+        REQUIRE(nFound > nHot * 9 / 10);
+    }
+
+    SECTION("Concurrent readers and writers")
+    {
+        LLD::BinaryLRU cache(1024 * 1024);
+
+        std::vector<std::thread> vThreads;
+        for(uint32_t nThread = 0; nThread < 8; ++nThread)
+        {
+            vThreads.push_back(std::thread([&cache, &vData, &cKey, nThread]()
+            {
+                for(uint32_t i = 0; i < 10000; ++i)
+                {
+                    const std::vector<uint8_t> vKey = CacheKey("threads", (i * 7 + nThread) % 4096);
+
+                    std::vector<uint8_t> vRead;
+                    if(!cache.Get(vKey, vRead))
+                        cache.Put(cKey, vKey, vData);
+                    else if(i % 16 == 0)
+                        cache.Remove(vKey);
+                }
+            }));
+        }
+
+        for(auto& thread : vThreads)
+            thread.join();
+
+        REQUIRE(cache.Size() <= 1024 * 1024);
+        REQUIRE(cache.HitRate() > 0.0);
+    }
+}
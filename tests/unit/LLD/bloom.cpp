@@ -0,0 +1,63 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/bloom.h>
+#include <LLD/hash/xxh3.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("LLD bloom filter tests", "[LLD]")
+{
+    const uint64_t nTotal = 10000;
+
+    /* Eight bits per key, as the hashmap files use. */
+    LLD::BloomFilter bloom(nTotal * 8);
+    REQUIRE(bloom.Bits() == nTotal * 8);
+
+    for(uint64_t i = 0; i < nTotal; ++i)
+        bloom.Insert(XXH64(&i, sizeof(i), 0));
+
+    /* Every inserted key is found. */
+    for(uint64_t i = 0; i < nTotal; ++i)
+    {
+        REQUIRE(bloom.Contains(XXH64(&i, sizeof(i), 0)));
+    }
+
+    /* Keys that were never inserted are mostly ruled out. */
+    uint64_t nFalse = 0;
+    for(uint64_t i = nTotal; i < nTotal * 2; ++i)
+        if(bloom.Contains(XXH64(&i, sizeof(i), 0)))
+            ++nFalse;
+
+    REQUIRE(nFalse < nTotal / 20);
+
+    /* The bits survive a round trip through a file. */
+    std::string strPath = config::GetDataDir() + "_BLOOM_TEST";
+    {
+        LLD::BinaryFile file(strPath, true);
+        REQUIRE(bloom.Write(file, 8));
+
+        LLD::BloomFilter copy(bloom.Bits());
+        REQUIRE(copy.Read(file, 8));
+
+        for(uint64_t i = 0; i < nTotal; ++i)
+        {
+            REQUIRE(copy.Contains(XXH64(&i, sizeof(i), 0)));
+        }
+    }
+
+    REQUIRE(filesystem::remove(strPath));
+}
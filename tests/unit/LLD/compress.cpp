@@ -0,0 +1,143 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/compress.h>
+#include <LLD/include/enum.h>
+#include <LLD/templates/key.h>
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+namespace
+{
+    /* Sector database compressing its records, without a type index. */
+    class CompressTestDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+    {
+    public:
+
+        CompressTestDB()
+        : SectorDatabase(std::string("_COMPRESS_TEST"), LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::COMPRESS, 1024, 1024 * 1024)
+        {
+        }
+    };
+
+
+    /* Build a record value that compresses, unless it is short. */
+    std::string Record(const uint32_t nIndex)
+    {
+        std::string strRecord = debug::safe_printstr("record", nIndex);
+        if(nIndex % 3 != 0)
+            strRecord.append(1024, 'x');
+
+        return strRecord;
+    }
+}
+
+TEST_CASE("LLD record compression tests", "[LLD]")
+{
+    /* Redundant data should compress and round trip. */
+    std::vector<uint8_t> vData;
+    for(uint32_t i = 0; i < 4096; ++i)
+        vData.push_back(static_cast<uint8_t>(i % 16));
+
+    std::vector<uint8_t> vCompressed;
+    REQUIRE(LLD::Compress(vData, vCompressed));
+    REQUIRE(vCompressed.size() < vData.size());
+
+    std::vector<uint8_t> vDecompressed;
+    REQUIRE(LLD::Decompress(vCompressed, vDecompressed));
+    REQUIRE(vDecompressed == vData);
+
+    /* Small records are left alone. */
+    std::vector<uint8_t> vSmall(LLD::MIN_COMPRESS_SIZE - 1, 0);
+    REQUIRE_FALSE(LLD::Compress(vSmall, vCompressed));
+
+    /* Corrupted input must fail rather than return garbage. */
+    vCompressed.resize(vCompressed.size() / 2);
+    REQUIRE_FALSE(LLD::Decompress(vCompressed, vDecompressed));
+
+    std::vector<uint8_t> vEmpty;
+    REQUIRE_FALSE(LLD::Decompress(vEmpty, vDecompressed));
+}
+
+
+TEST_CASE("LLD sector key compressed state tests", "[LLD]")
+{
+    /* The compressed bit must not change the key state. */
+    LLD::SectorKey cKey(LLD::STATE::READY | LLD::STATE::COMPRESSED, std::vector<uint8_t>(8, 1), 0, 0, 0);
+    REQUIRE(cKey.Ready());
+    REQUIRE(cKey.IsCompressed());
+    REQUIRE_FALSE(cKey.IsTxn());
+    REQUIRE_FALSE(cKey.Empty());
+
+    LLD::SectorKey cRaw(LLD::STATE::READY, std::vector<uint8_t>(8, 1), 0, 0, 0);
+    REQUIRE(cRaw.Ready());
+    REQUIRE_FALSE(cRaw.IsCompressed());
+}
+
+
+TEST_CASE("LLD compressed batch read tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_COMPRESS_TEST/";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    {
+        CompressTestDB db;
+
+        /* Interleave compressed and raw records of two types. */
+        for(uint32_t i = 0; i < 100; ++i)
+        {
+            REQUIRE(db.Write(std::make_pair(std::string("key"), i), Record(i), (i % 4 == 0) ? "alpha" : "beta"));
+        }
+
+        /* Compressed records are found by type without an index. */
+        std::vector<std::string> vAlpha;
+        REQUIRE(db.BatchRead("alpha", vAlpha, -1));
+        REQUIRE(vAlpha.size() == 25);
+        for(uint32_t i = 0; i < vAlpha.size(); ++i)
+        {
+            REQUIRE(vAlpha[i] == Record(i * 4));
+        }
+
+        std::vector<std::string> vBeta;
+        REQUIRE(db.BatchRead("beta", vBeta, -1));
+        REQUIRE(vBeta.size() == 75);
+        REQUIRE(vBeta[0] == Record(1));
+
+        /* Limits and starting keys page through the type. */
+        std::vector<std::string> vPage;
+        REQUIRE(db.BatchRead(std::make_pair(std::string("key"), uint32_t(8)), "alpha", vPage, 2));
+        REQUIRE(vPage.size() == 2);
+        REQUIRE(vPage[0] == Record(12));
+        REQUIRE(vPage[1] == Record(16));
+
+        REQUIRE(db.BatchRead(std::make_pair(std::string("key"), uint32_t(5)), "beta", vPage, 3));
+        REQUIRE(vPage.size() == 3);
+        REQUIRE(vPage[0] == Record(6));
+        REQUIRE(vPage[2] == Record(9));
+
+        /* Nothing of the type follows the last record. */
+        REQUIRE(!db.BatchRead(std::make_pair(std::string("key"), uint32_t(96)), "alpha", vPage, 1));
+        REQUIRE(vPage.size() == 0);
+    }
+
+    REQUIRE(filesystem::remove_directories(strPath));
+}
@@ -0,0 +1,167 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/keychain/hashmap.h>
+#include <LLD/include/version.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/runtime.h>
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE("LLD hashmap online split tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_HASHMAP_TEST/";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    /* Build keys longer than the maximum key size, with the counter where key compression keeps it. */
+    const uint32_t nTotal = 2000;
+    std::vector< std::vector<uint8_t> > vKeys;
+    for(uint32_t i = 0; i < nTotal; ++i)
+    {
+        DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+        ssKey << std::string("hashmap-split-tests") << i << std::string("compressed-key");
+
+        vKeys.push_back(ssKey.Bytes());
+    }
+
+    /* Write far more keys than initial buckets and wait for the rehash thread to catch up. */
+    {
+        LLD::BinaryHashMap hashmap(strPath, LLD::FLAGS::CREATE | LLD::FLAGS::WRITE, 64);
+        for(uint32_t i = 0; i < nTotal; ++i)
+        {
+            LLD::SectorKey cKey(LLD::STATE::READY, vKeys[i], 0, i, 8);
+            REQUIRE(hashmap.Put(cKey));
+        }
+
+        /* Keys end up in buckets past the initial ones once they are split. */
+        bool fSplit = false;
+        for(uint32_t nWait = 0; nWait < 100 && !fSplit; ++nWait)
+        {
+            runtime::sleep(100);
+            fSplit = (hashmap.GetBucket(vKeys[nTotal - 1]) >= 64 || hashmap.GetBucket(vKeys[0]) >= 64);
+        }
+        REQUIRE(fSplit);
+
+        /* Every key is still found during and after the splits. */
+        runtime::sleep(1000);
+        hashmap.AverageProbes();
+        for(uint32_t i = 0; i < nTotal; ++i)
+        {
+            LLD::SectorKey cKey;
+            REQUIRE(hashmap.Get(vKeys[i], cKey));
+            REQUIRE(cKey.nSectorStart == i);
+        }
+
+        /* Chains are back to a few files per lookup. */
+        REQUIRE(hashmap.AverageProbes() < 4.0);
+
+        /* Erase every other key. */
+        for(uint32_t i = 0; i < nTotal; i += 2)
+        {
+            REQUIRE(hashmap.Erase(vKeys[i]));
+        }
+    }
+
+    /* Reopening picks up the split state. */
+    {
+        LLD::BinaryHashMap hashmap(strPath, LLD::FLAGS::CREATE | LLD::FLAGS::WRITE, 64);
+        for(uint32_t i = 0; i < nTotal; ++i)
+        {
+            LLD::SectorKey cKey;
+            REQUIRE(hashmap.Get(vKeys[i], cKey) == (i % 2 == 1));
+        }
+
+        /* Updates go to the split buckets. */
+        LLD::SectorKey cUpdate(LLD::STATE::READY, vKeys[1], 1, 99, 8);
+        REQUIRE(hashmap.Put(cUpdate));
+
+        LLD::SectorKey cKey;
+        REQUIRE(hashmap.Get(vKeys[1], cKey));
+        REQUIRE(cKey.nSectorFile == 1);
+    }
+
+    REQUIRE(filesystem::remove_directories(strPath));
+}
+
+
+TEST_CASE("LLD hashmap erase tests", "[LLD]")
+{
+    /* Find two keys sharing a bucket. */
+    std::vector< std::vector<uint8_t> > vKeys;
+    {
+        LLD::BinaryHashMap hashmap(config::GetDataDir() + "_HASHMAP_ERASE/", LLD::FLAGS::CREATE | LLD::FLAGS::WRITE, 64);
+        for(uint32_t i = 0; vKeys.size() < 2; ++i)
+        {
+            DataStream ssKey(SER_LLD, LLD::DATABASE_VERSION);
+            ssKey << std::string("hashmap-erase-tests") << i;
+
+            if(vKeys.empty() || hashmap.GetBucket(ssKey.Bytes()) == hashmap.GetBucket(vKeys[0]))
+                vKeys.push_back(ssKey.Bytes());
+        }
+    }
+
+    /* Append mode keeps older versions, erasing the newest brings back the one before it. */
+    {
+        std::string strPath = config::GetDataDir() + "_HASHMAP_ERASE_APPEND/";
+        LLD::BinaryHashMap hashmap(strPath, LLD::FLAGS::CREATE | LLD::FLAGS::APPEND, 64);
+
+        REQUIRE(hashmap.Put(LLD::SectorKey(LLD::STATE::READY, vKeys[0], 0, 1, 8)));
+        REQUIRE(hashmap.Put(LLD::SectorKey(LLD::STATE::READY, vKeys[0], 0, 2, 8)));
+
+        LLD::SectorKey cKey;
+        REQUIRE(hashmap.Get(vKeys[0], cKey));
+        REQUIRE(cKey.nSectorStart == 2);
+
+        REQUIRE(hashmap.Erase(vKeys[0]));
+        REQUIRE(hashmap.Get(vKeys[0], cKey));
+        REQUIRE(cKey.nSectorStart == 1);
+
+        REQUIRE(hashmap.Erase(vKeys[0]));
+        REQUIRE(!hashmap.Get(vKeys[0], cKey));
+        REQUIRE(!hashmap.Erase(vKeys[0]));
+
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    /* Other keychains erase every copy, so a stale one can't resurface. */
+    {
+        std::string strPath = config::GetDataDir() + "_HASHMAP_ERASE_UPDATE/";
+        LLD::BinaryHashMap hashmap(strPath, LLD::FLAGS::CREATE | LLD::FLAGS::WRITE, 64);
+
+        /* The second key of the bucket goes in a new file, erasing it leaves a free slot in front of the first. */
+        REQUIRE(hashmap.Put(LLD::SectorKey(LLD::STATE::READY, vKeys[0], 0, 1, 8)));
+        REQUIRE(hashmap.Put(LLD::SectorKey(LLD::STATE::READY, vKeys[1], 0, 2, 8)));
+        REQUIRE(hashmap.Erase(vKeys[1]));
+
+        /* Updating the first key fills the free slot, leaving a stale copy behind it. */
+        REQUIRE(hashmap.Put(LLD::SectorKey(LLD::STATE::READY, vKeys[0], 0, 3, 8)));
+
+        LLD::SectorKey cKey;
+        REQUIRE(hashmap.Get(vKeys[0], cKey));
+        REQUIRE(cKey.nSectorStart == 3);
+
+        REQUIRE(hashmap.Erase(vKeys[0]));
+        REQUIRE(!hashmap.Get(vKeys[0], cKey));
+        REQUIRE(!hashmap.Erase(vKeys[0]));
+
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    REQUIRE(filesystem::remove_directories(config::GetDataDir() + "_HASHMAP_ERASE/"));
+}
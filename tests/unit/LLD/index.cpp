@@ -0,0 +1,116 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/sector.h>
+#include <LLD/keychain/hashmap.h>
+#include <LLD/cache/binary_lru.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+namespace
+{
+    /* Sector database with its type index enabled. */
+    class IndexTestDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+    {
+    public:
+
+        IndexTestDB()
+        : SectorDatabase(std::string("_INDEX_TEST"), LLD::FLAGS::CREATE | LLD::FLAGS::FORCE | LLD::FLAGS::INDEX, 1024, 1024 * 1024)
+        {
+        }
+    };
+}
+
+
+TEST_CASE("LLD sector type index tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_INDEX_TEST/";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    {
+        IndexTestDB db;
+
+        /* Interleave two types of records. */
+        for(uint32_t i = 0; i < 100; ++i)
+        {
+            REQUIRE(db.Write(std::make_pair(std::string("key"), i), debug::safe_printstr("record", i), (i % 4 == 0) ? "alpha" : "beta"));
+        }
+
+        std::vector<std::string> vAlpha;
+        REQUIRE(db.BatchRead("alpha", vAlpha, -1));
+        REQUIRE(vAlpha.size() == 25);
+        REQUIRE(vAlpha[1] == "record4");
+
+        /* Limits and starting keys page through the type. */
+        std::vector<std::string> vPage;
+        REQUIRE(db.BatchRead(std::make_pair(std::string("key"), uint32_t(8)), "alpha", vPage, 2));
+        REQUIRE(vPage.size() == 2);
+        REQUIRE(vPage[0] == "record12");
+        REQUIRE(vPage[1] == "record16");
+
+        /* Erased records and records that changed type in place drop out. */
+        REQUIRE(db.Erase(std::make_pair(std::string("key"), uint32_t(0))));
+        REQUIRE(db.Write(std::make_pair(std::string("key"), uint32_t(4)), std::string("record4"), "beta"));
+
+        /* A record rewritten to a new sector is only returned once. */
+        REQUIRE(db.Write(std::make_pair(std::string("key"), uint32_t(8)), std::string("record8 moved to a larger sector"), "alpha"));
+
+        REQUIRE(db.BatchRead("alpha", vAlpha, -1));
+        REQUIRE(vAlpha.size() == 23);
+        REQUIRE(vAlpha.back() == "record8 moved to a larger sector");
+
+        /* Prefixes cover every matching type. */
+        LLD::SectorCursor cursor;
+        REQUIRE(db.Seek(cursor, "", true));
+
+        uint32_t nTotal = 0;
+        std::string strValue;
+        while(db.Next(cursor, strValue))
+            ++nTotal;
+
+        REQUIRE(nTotal == 99);
+    }
+
+    /* Reopening loads the saved index. */
+    {
+        IndexTestDB db;
+
+        std::vector<std::string> vBeta;
+        REQUIRE(db.BatchRead("beta", vBeta, -1));
+        REQUIRE(vBeta.size() == 76);
+    }
+
+    /* An index left unclean is rebuilt from the sector files. */
+    {
+        LLD::BinaryFile file(strPath + "datachain/_index", false);
+        const uint8_t fUnclean = 0;
+        REQUIRE(file.Write(&fUnclean, 1, 1));
+    }
+
+    {
+        IndexTestDB db;
+
+        std::vector<std::string> vBeta;
+        REQUIRE(db.BatchRead("beta", vBeta, -1));
+        REQUIRE(vBeta.size() == 76);
+        REQUIRE(vBeta[0] == "record1");
+    }
+
+    REQUIRE(filesystem::remove_directories(strPath));
+}
@@ -0,0 +1,171 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/templates/journal.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+TEST_CASE("LLD journal tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_JOURNAL_TEST/";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    REQUIRE(filesystem::create_directories(strPath));
+
+    std::vector<uint8_t> vRecord1(100, 1);
+    std::vector<uint8_t> vRecord2(200, 2);
+
+    /* Write and sync a commit spanning two databases. */
+    {
+        LLD::Journal journal(strPath + "journal.dat");
+        REQUIRE(journal.IsOpen());
+
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vCommit;
+        vCommit.push_back(std::make_pair(std::string("_LEDGER"), vRecord1));
+        vCommit.push_back(std::make_pair(std::string("_REGISTER"), vRecord2));
+
+        REQUIRE(journal.Write(vCommit));
+        REQUIRE(journal.Sync());
+    }
+
+    /* Records come back in order, then append a torn record. */
+    {
+        LLD::Journal journal(strPath + "journal.dat");
+
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.size() == 2);
+        REQUIRE(vRecords[0].first == "_LEDGER");
+        REQUIRE(vRecords[0].second == vRecord1);
+        REQUIRE(vRecords[1].first == "_REGISTER");
+        REQUIRE(vRecords[1].second == vRecord2);
+
+        /* Sync a second commit then tear it in half. */
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vCommit;
+        vCommit.push_back(std::make_pair(std::string("_LEDGER"), vRecord2));
+        vCommit.push_back(std::make_pair(std::string("_TRUST"), vRecord2));
+
+        const uint64_t nSize = journal.Size();
+        REQUIRE(journal.Write(vCommit));
+        REQUIRE(journal.Sync());
+
+        LLD::BinaryFile file(strPath + "journal.dat");
+        REQUIRE(file.Truncate(nSize + (journal.Size() - nSize) / 2));
+    }
+
+    /* The torn commit is dropped as a whole and overwritten by new commits. */
+    {
+        LLD::Journal journal(strPath + "journal.dat");
+
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.size() == 2);
+
+        REQUIRE(journal.Write({ std::make_pair(std::string("_CONTRACT"), vRecord1) }));
+        REQUIRE(journal.Sync());
+
+        vRecords.clear();
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.size() == 3);
+        REQUIRE(vRecords[2].first == "_CONTRACT");
+
+        /* Checkpoint clears everything. */
+        REQUIRE(journal.Checkpoint());
+        REQUIRE(journal.Size() == 0);
+
+        vRecords.clear();
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.empty());
+    }
+
+    /* Deferred syncs group commits until a limit is reached. */
+    {
+        LLD::Journal journal(strPath + "journal.dat", 3, 60 * 60 * 1000);
+        REQUIRE(journal.Checkpoint());
+
+        REQUIRE(journal.Write({ std::make_pair(std::string("_LEDGER"), vRecord1) }));
+        REQUIRE(journal.Sync(false));
+        REQUIRE(journal.Pending() == 1);
+
+        REQUIRE(journal.Write({ std::make_pair(std::string("_LEDGER"), vRecord1) }));
+        REQUIRE(journal.Sync(false));
+        REQUIRE(journal.Pending() == 2);
+
+        /* The commit limit flushes the whole group. */
+        REQUIRE(journal.Write({ std::make_pair(std::string("_LEDGER"), vRecord1) }));
+        REQUIRE(journal.Sync(false));
+        REQUIRE(journal.Pending() == 0);
+
+        /* A forced sync never waits. */
+        REQUIRE(journal.Write({ std::make_pair(std::string("_LEDGER"), vRecord1) }));
+        REQUIRE(journal.Sync(false));
+        REQUIRE(journal.Pending() == 1);
+
+        REQUIRE(journal.Sync());
+        REQUIRE(journal.Pending() == 0);
+
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.size() == 4);
+        REQUIRE(journal.Checkpoint());
+    }
+
+    /* The interval limit flushes the group once it has passed. */
+    {
+        LLD::Journal journal(strPath + "journal.dat", 1000, 0);
+
+        REQUIRE(journal.Write({ std::make_pair(std::string("_LEDGER"), vRecord1) }));
+        REQUIRE(journal.Sync(false));
+        REQUIRE(journal.Pending() == 0);
+        REQUIRE(journal.Checkpoint());
+    }
+
+    /* Concurrent writers lose nothing. */
+    {
+        LLD::Journal journal(strPath + "journal.dat");
+
+        std::atomic<uint32_t> nSynced(0);
+        std::vector<std::thread> vThreads;
+        for(uint32_t t = 0; t < 8; ++t)
+        {
+            vThreads.push_back(std::thread([&]
+            {
+                for(uint32_t i = 0; i < 50; ++i)
+                {
+                    if(journal.Write({ std::make_pair(std::string("_LOCAL"), vRecord1) }) && journal.Sync())
+                        ++nSynced;
+                }
+            }));
+        }
+
+        for(auto& thread : vThreads)
+            thread.join();
+
+        REQUIRE(nSynced.load() == 400);
+
+        std::vector< std::pair<std::string, std::vector<uint8_t>> > vRecords;
+        REQUIRE(journal.Read(vRecords));
+        REQUIRE(vRecords.size() == 400);
+    }
+
+    REQUIRE(filesystem::remove_directories(strPath));
+}
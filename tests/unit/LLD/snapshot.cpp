@@ -0,0 +1,301 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/snapshot.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+#include <Util/include/mutex.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    /* Sector database logging its keys. */
+    class SnapshotTestDB : public LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>
+    {
+    public:
+
+        SnapshotTestDB(const std::string& strName)
+        : SectorDatabase(strName, LLD::FLAGS::CREATE | LLD::FLAGS::FORCE, 1024, 1024 * 1024)
+        {
+            LogKeys();
+        }
+    };
+}
+
+
+TEST_CASE("LLD key log tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_KEYLOG_TEST/";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    REQUIRE(filesystem::create_directories(strPath));
+
+    std::vector<uint8_t> vKey1(40, 1), vKey2(40, 2), vKey3(40, 3);
+
+    /* Later entries of a key replace the earlier ones. */
+    {
+        LLD::KeyLog log(strPath + "_keys");
+        REQUIRE(log.Open(true));
+        REQUIRE(log.Complete());
+
+        REQUIRE(log.Append(LLD::KEYLOG::RECORD, vKey1));
+        REQUIRE(log.Append(LLD::KEYLOG::RECORD, vKey2));
+        REQUIRE(log.Append(LLD::KEYLOG::INDEXED, vKey3, vKey1));
+        REQUIRE(log.Append(LLD::KEYLOG::ERASED, vKey2));
+
+        std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>> mapKeys;
+        REQUIRE(log.Read(mapKeys));
+        REQUIRE(mapKeys.size() == 2);
+        REQUIRE(mapKeys[vKey1].first == LLD::KEYLOG::RECORD);
+        REQUIRE(mapKeys[vKey3].first == LLD::KEYLOG::INDEXED);
+        REQUIRE(mapKeys[vKey3].second == vKey1);
+
+        /* Reading from an offset gives only the keys changed after it, erased ones included. */
+        const uint64_t nCut = log.Size();
+        REQUIRE(log.Append(LLD::KEYLOG::RECORD, vKey2));
+        REQUIRE(log.Append(LLD::KEYLOG::ERASED, vKey1));
+
+        mapKeys.clear();
+        REQUIRE(log.Read(mapKeys, nCut, 0, true));
+        REQUIRE(mapKeys.size() == 2);
+        REQUIRE(mapKeys[vKey2].first == LLD::KEYLOG::RECORD);
+        REQUIRE(mapKeys[vKey1].first == LLD::KEYLOG::ERASED);
+
+        /* Reading to an offset leaves out the keys changed after it. */
+        mapKeys.clear();
+        REQUIRE(log.Read(mapKeys, 0, nCut));
+        REQUIRE(mapKeys.size() == 2);
+        REQUIRE(mapKeys.count(vKey1));
+        REQUIRE(!mapKeys.count(vKey2));
+
+        REQUIRE(log.Append(LLD::KEYLOG::ERASED, vKey2));
+        REQUIRE(log.Append(LLD::KEYLOG::RECORD, vKey1));
+    }
+
+    /* A torn entry left by a crash is dropped when an unclean log is opened. */
+    {
+        LLD::BinaryFile file(strPath + "_keys", false);
+
+        const uint64_t nSize = file.Size();
+        const uint8_t vTorn[3] = { LLD::KEYLOG::RECORD, 40, 7 };
+        const uint8_t fUnclean = 0;
+        REQUIRE(file.Write(vTorn, 3, nSize));
+        REQUIRE(file.Write(&fUnclean, 1, 2));
+    }
+
+    {
+        LLD::KeyLog log(strPath + "_keys");
+        REQUIRE(log.Open(false));
+        REQUIRE(log.Complete());
+        REQUIRE(log.Append(LLD::KEYLOG::RECORD, vKey2));
+
+        std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>> mapKeys;
+        REQUIRE(log.Read(mapKeys));
+        REQUIRE(mapKeys.size() == 3);
+        REQUIRE(mapKeys.count(vKey2));
+    }
+
+    /* A log started on a database with records can't list every key. */
+    {
+        LLD::KeyLog log(strPath + "_keys2");
+        REQUIRE(log.Open(false));
+        REQUIRE(!log.Complete());
+    }
+
+    REQUIRE(filesystem::remove_directories(strPath));
+}
+
+
+TEST_CASE("LLD snapshot tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_SNAPSHOT_TEST/";
+    std::string strFile = config::GetDataDir() + "_SNAPSHOT_TEST.dat";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    uint256_t hashCommit = 0;
+    {
+        SnapshotTestDB db(std::string("_SNAPSHOT_TEST"));
+
+        /* Records, a key-only entry, an index and an erased record. */
+        for(uint32_t i = 0; i < 1000; ++i)
+        {
+            REQUIRE(db.Write(std::make_pair(std::string("record"), i), debug::safe_printstr("value", i)));
+        }
+
+        REQUIRE(db.Write(std::make_pair(std::string("key"), uint32_t(1))));
+        REQUIRE(db.Index(std::make_pair(std::string("index"), uint32_t(1)), std::make_pair(std::string("record"), uint32_t(7))));
+        REQUIRE(db.Erase(std::make_pair(std::string("record"), uint32_t(999))));
+
+        /* Records written in a transaction are logged at commit. */
+        db.TxnBegin();
+        REQUIRE(db.Write(std::make_pair(std::string("record"), uint32_t(5)), std::string("value5 updated in a transaction")));
+        REQUIRE(db.Write(std::make_pair(std::string("record"), uint32_t(1000)), std::string("value1000")));
+        REQUIRE(db.TxnCommit());
+
+        std::vector<LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>*> vDatabases = { &db };
+        REQUIRE(LLD::Snapshot::Write(strFile, vDatabases, uint1024_t(42), 42, hashCommit));
+
+        /* The same database gives the same snapshot. */
+        uint256_t hashAgain = 0;
+        REQUIRE(LLD::Snapshot::Write(strFile, vDatabases, uint1024_t(42), 42, hashAgain));
+        REQUIRE(hashAgain == hashCommit);
+    }
+
+    /* The snapshot checks out against its commitment. */
+    LLD::Snapshot::Header header;
+    uint256_t hashVerify = 0;
+    REQUIRE(LLD::Snapshot::Verify(strFile, header, hashVerify));
+    REQUIRE(hashVerify == hashCommit);
+    REQUIRE(header.nHeight == 42);
+    REQUIRE(header.vNames.size() == 1);
+
+    /* Load it into an empty database. */
+    REQUIRE(filesystem::remove_directories(strPath));
+    {
+        SnapshotTestDB db(std::string("_SNAPSHOT_TEST"));
+
+        std::vector<LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>*> vDatabases = { &db };
+        REQUIRE(!LLD::Snapshot::Read(strFile, vDatabases, uint256_t(0), header));
+        REQUIRE(!LLD::Snapshot::Read(strFile, vDatabases, uint256_t(1), header));
+        REQUIRE(LLD::Snapshot::Read(strFile, vDatabases, hashCommit, header));
+
+        std::string strValue;
+        REQUIRE(db.Read(std::make_pair(std::string("record"), uint32_t(0)), strValue));
+        REQUIRE(strValue == "value0");
+
+        REQUIRE(db.Read(std::make_pair(std::string("record"), uint32_t(5)), strValue));
+        REQUIRE(strValue == "value5 updated in a transaction");
+
+        REQUIRE(db.Read(std::make_pair(std::string("record"), uint32_t(1000)), strValue));
+        REQUIRE(strValue == "value1000");
+
+        REQUIRE(db.Read(std::make_pair(std::string("index"), uint32_t(1)), strValue));
+        REQUIRE(strValue == "value7");
+
+        REQUIRE(db.Exists(std::make_pair(std::string("key"), uint32_t(1))));
+        REQUIRE(!db.Exists(std::make_pair(std::string("record"), uint32_t(999))));
+
+        /* The loaded database can be exported again, to the same snapshot. */
+        uint256_t hashReload = 0;
+        REQUIRE(LLD::Snapshot::Write(strFile, vDatabases, uint1024_t(42), 42, hashReload));
+        REQUIRE(hashReload == hashCommit);
+    }
+
+    /* A corrupted chunk fails verification. */
+    {
+        std::fstream stream(strFile, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekg(200);
+        const char nByte = static_cast<char>(stream.get());
+
+        stream.seekp(200);
+        stream.put(static_cast<char>(~nByte));
+    }
+
+    REQUIRE(!LLD::Snapshot::Verify(strFile, header, hashVerify));
+
+    REQUIRE(filesystem::remove_directories(strPath));
+    REQUIRE(filesystem::remove(strFile));
+}
+
+
+TEST_CASE("LLD snapshot while writing tests", "[LLD]")
+{
+    std::string strPath = config::GetDataDir() + "_SNAPSHOT_LIVE/";
+    std::string strFile = config::GetDataDir() + "_SNAPSHOT_LIVE.dat";
+    std::string strHeld = config::GetDataDir() + "_SNAPSHOT_HELD.dat";
+    if(filesystem::exists(strPath))
+    {
+        REQUIRE(filesystem::remove_directories(strPath));
+    }
+
+    {
+        SnapshotTestDB db(std::string("_SNAPSHOT_LIVE"));
+
+        for(uint32_t i = 0; i < 2000; ++i)
+        {
+            REQUIRE(db.Write(std::make_pair(std::string("record"), i), debug::safe_printstr("value", i)));
+        }
+
+        REQUIRE(db.Index(std::make_pair(std::string("index"), uint32_t(1)), std::make_pair(std::string("record"), uint32_t(7))));
+
+        /* Update records in place, move them, erase them and add new ones while the snapshot is written. */
+        std::mutex MUTEX;
+        std::atomic<bool> fStop(false);
+        std::thread t([&db, &MUTEX, &fStop]()
+        {
+            for(uint32_t i = 0; !fStop.load(); ++i)
+            {
+                LOCK(MUTEX);
+
+                const uint32_t nRecord = (i * 7919) % 2500;
+                if(i % 5 == 0)
+                    db.Erase(std::make_pair(std::string("record"), nRecord));
+                else if(i % 3 == 0)
+                    db.Write(std::make_pair(std::string("record"), nRecord), debug::safe_printstr("moved", i, "to a larger sector"));
+                else
+                    db.Write(std::make_pair(std::string("record"), nRecord), debug::safe_printstr("value", nRecord));
+            }
+        });
+
+        /* The snapshot is the same as one written with writes held off at the end. */
+        uint256_t hashHeld = 0;
+        LLD::Snapshot::Header header;
+        uint256_t hashCommit = 0;
+        std::vector<LLD::SectorDatabase<LLD::BinaryHashMap, LLD::BinaryLRU>*> vDatabases = { &db };
+        const bool fWritten = LLD::Snapshot::Write(strFile, vDatabases, MUTEX,
+            [&strHeld, &vDatabases, &hashHeld](uint1024_t& hashBlock, uint32_t& nHeight)
+            {
+                hashBlock = 42;
+                nHeight   = 42;
+
+                return LLD::Snapshot::Write(strHeld, vDatabases, hashBlock, nHeight, hashHeld);
+            },
+            header, hashCommit);
+
+        fStop.store(true);
+        t.join();
+
+        REQUIRE(fWritten);
+        REQUIRE(hashCommit == hashHeld);
+        REQUIRE(header.nHeight == 42);
+
+        /* Updates in place aren't logged once the snapshot is written. */
+        const uint64_t nEnd = db.TrackKeys(false);
+        REQUIRE(db.Write(std::make_pair(std::string("record"), uint32_t(1)), std::string("value1")));
+
+        std::map<std::vector<uint8_t>, std::pair<uint8_t, std::vector<uint8_t>>> mapKeys;
+        REQUIRE(db.ReadKeys(mapKeys, nEnd, 0));
+        REQUIRE(mapKeys.empty());
+    }
+
+    LLD::Snapshot::Header header;
+    uint256_t hashVerify = 0;
+    REQUIRE(LLD::Snapshot::Verify(strFile, header, hashVerify));
+    REQUIRE(!filesystem::exists(strFile + ".stage"));
+
+    REQUIRE(filesystem::remove_directories(strPath));
+    REQUIRE(filesystem::remove(strFile));
+    REQUIRE(filesystem::remove(strHeld));
+}
@@ -0,0 +1,86 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/include/block_cache.h>
+
+#include <Util/include/args.h>
+#include <Util/include/filesystem.h>
+
+TEST_CASE( "LLP::BlockCache", "[block_cache]")
+{
+    /* Keep one megabyte of packets in memory. */
+    config::mapArgs["-blockcache"] = "1";
+
+    std::shared_ptr<std::vector<uint8_t>> pPacket;
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(1), 1, pPacket));
+
+    /* Packets are kept by hash and specifier. */
+    std::shared_ptr<std::vector<uint8_t>> pFirst = std::make_shared<std::vector<uint8_t>>(400 * 1024, 1);
+    LLP::BlockCache::Put(uint1024_t(1), 1, pFirst);
+
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(1), 1, pPacket));
+    REQUIRE(pPacket == pFirst);
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(1), 2, pPacket));
+
+    /* The least recently used packet is removed over the limit. */
+    LLP::BlockCache::Put(uint1024_t(2), 1, std::make_shared<std::vector<uint8_t>>(400 * 1024, 2));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(1), 1, pPacket));
+
+    LLP::BlockCache::Put(uint1024_t(3), 1, std::make_shared<std::vector<uint8_t>>(400 * 1024, 3));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(1), 1, pPacket));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(3), 1, pPacket));
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(2), 1, pPacket));
+
+    LLP::BlockCache::Shutdown();
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(1), 1, pPacket));
+
+    /* Packets written through to disk outlive the memory cache. */
+    config::mapArgs["-blockcachedisk"] = "1";
+
+    LLP::BlockCache::Put(uint1024_t(4), 1, std::make_shared<std::vector<uint8_t>>(1000, 4));
+    LLP::BlockCache::Shutdown();
+
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(4), 1, pPacket));
+    REQUIRE(*pPacket == std::vector<uint8_t>(1000, 4));
+
+    /* The disk cache keeps two generations of half its size, the oldest is removed. */
+    config::mapArgs["-blockcachedisksize"] = "1";
+    for(uint32_t n = 5; n <= 8; ++n)
+        LLP::BlockCache::Put(uint1024_t(n), 1, std::make_shared<std::vector<uint8_t>>(300 * 1024, n));
+
+    LLP::BlockCache::Shutdown();
+    REQUIRE(!filesystem::exists(config::GetDataDir() + "_BLOCKCACHE/1/"));
+
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(4), 1, pPacket));
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(6), 1, pPacket));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(7), 1, pPacket));
+    REQUIRE(*pPacket == std::vector<uint8_t>(300 * 1024, 7));
+
+    /* A packet read from the previous generation is carried forward, the others go with it. */
+    LLP::BlockCache::Put(uint1024_t(9), 1, std::make_shared<std::vector<uint8_t>>(300 * 1024, 9));
+    LLP::BlockCache::Shutdown();
+
+    REQUIRE(!filesystem::exists(config::GetDataDir() + "_BLOCKCACHE/2/"));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(7), 1, pPacket));
+    REQUIRE(LLP::BlockCache::Get(uint1024_t(9), 1, pPacket));
+    REQUIRE(!LLP::BlockCache::Get(uint1024_t(8), 1, pPacket));
+
+    LLP::BlockCache::Shutdown();
+    REQUIRE(filesystem::remove_directories(config::GetDataDir() + "_BLOCKCACHE/"));
+
+    config::mapArgs.erase("-blockcachedisksize");
+    config::mapArgs.erase("-blockcachedisk");
+    config::mapArgs.erase("-blockcache");
+}
@@ -0,0 +1,126 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLD/include/global.h>
+
+#include <LLP/include/download.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/timelocks.h>
+#include <TAO/Ledger/types/client.h>
+#include <TAO/Ledger/types/state.h>
+
+#include <Util/include/args.h>
+#include <Util/include/runtime.h>
+
+TEST_CASE( "LLP::Download", "[download]")
+{
+    /* Start from a block at the height of the best chain. */
+    const uint32_t nBest = TAO::Ledger::ChainState::nBestHeight.load();
+
+    TAO::Ledger::BlockState state;
+    state.nHeight = nBest;
+    state.nBits   = 777;
+
+    const uint1024_t hashStart = state.GetHash();
+    REQUIRE(LLD::Ledger->WriteBlock(hashStart, state));
+
+    LLP::Download::Start(hashStart);
+    REQUIRE(LLP::Download::Active());
+
+    /* Queue four headers. */
+    std::vector<uint1024_t> vBlocks;
+    uint1024_t hashPrev = hashStart;
+    for(uint32_t n = 1; n <= 4; ++n)
+    {
+        TAO::Ledger::ClientBlock block;
+        block.nVersion      = TAO::Ledger::CurrentBlockVersion();
+        block.hashPrevBlock = hashPrev;
+        block.nChannel      = 2;
+        block.nHeight       = nBest + n;
+        block.nBits         = 777;
+        block.nNonce        = n;
+        block.nTime         = runtime::unifiedtimestamp();
+
+        REQUIRE(LLP::Download::AddHeader(block));
+
+        hashPrev = block.GetHash();
+        vBlocks.push_back(hashPrev);
+    }
+
+    REQUIRE(LLP::Download::Size() == 4);
+    REQUIRE(!LLP::Download::Requested(1));
+
+    /* The first peer is assigned every body in order. */
+    std::vector<uint1024_t> vHashes;
+    REQUIRE(LLP::Download::Request(1, vHashes));
+    REQUIRE(vHashes == vBlocks);
+    REQUIRE(LLP::Download::Requested(1));
+
+    /* Bodies in flight are not assigned twice. */
+    vHashes.clear();
+    REQUIRE(!LLP::Download::Request(2, vHashes));
+    REQUIRE(!LLP::Download::Requested(2));
+
+    /* A peer that disconnects returns the bodies it didn't deliver. */
+    LLP::Download::Received(vBlocks[0], nBest + 1);
+    LLP::Download::Release(1);
+    REQUIRE(!LLP::Download::Requested(1));
+
+    REQUIRE(LLP::Download::Request(2, vHashes));
+    REQUIRE(vHashes == std::vector<uint1024_t>({vBlocks[1], vBlocks[2], vBlocks[3]}));
+
+    /* A rejected body goes to another peer. */
+    LLP::Download::Received(vBlocks[1], nBest + 2, true);
+    runtime::sleep(200);
+
+    vHashes.clear();
+    REQUIRE(!LLP::Download::Request(2, vHashes));
+    REQUIRE(LLP::Download::Request(3, vHashes));
+    REQUIRE(vHashes == std::vector<uint1024_t>({vBlocks[1]}));
+
+    /* Bodies that don't arrive in time go to another peer, and the next block is asked for again if it never connected. */
+    config::mapArgs["-downloadtimeout"] = "1";
+    runtime::sleep(1100);
+
+    vHashes.clear();
+    REQUIRE(LLP::Download::Request(3, vHashes));
+    REQUIRE(vHashes == std::vector<uint1024_t>({vBlocks[0], vBlocks[2], vBlocks[3]}));
+
+    /* The peer that timed out isn't asked again for the same body. */
+    vHashes.clear();
+    REQUIRE(LLP::Download::Request(2, vHashes));
+    REQUIRE(vHashes == std::vector<uint1024_t>({vBlocks[1]}));
+
+    /* Stopping forgets the peers that were downloading. */
+    LLP::Download::Stop();
+    REQUIRE(!LLP::Download::Active());
+    REQUIRE(LLP::Download::Size() == 0);
+    REQUIRE(!LLP::Download::Requested(2));
+    REQUIRE(!LLP::Download::Requested(3));
+
+    vHashes.clear();
+    REQUIRE(!LLP::Download::Request(2, vHashes));
+
+    /* A download with every header received and nothing queued is complete. */
+    LLP::Download::Start(hashStart);
+    REQUIRE(!LLP::Download::Complete());
+
+    LLP::Download::HeadersReceived(true);
+    REQUIRE(LLP::Download::Complete());
+
+    LLP::Download::Stop();
+    config::mapArgs.erase("-downloadtimeout");
+}
@@ -0,0 +1,83 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/include/base_address.h>
+#include <LLP/include/network.h>
+#include <LLP/templates/socket.h>
+
+#ifndef WIN32
+
+TEST_CASE( "LLP::Socket send buffer", "[socket]")
+{
+    int32_t vSockets[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, vSockets) == 0);
+
+    /* Keep the socket buffer small so most writes are buffered. */
+    int32_t nSendSize = 4096;
+    setsockopt(vSockets[0], SOL_SOCKET, SO_SNDBUF, &nSendSize, sizeof(nSendSize));
+
+    LLP::Socket socket(vSockets[0], LLP::BaseAddress(), false);
+
+    /* Write headers and data of different sizes. */
+    std::vector<uint8_t> vExpected;
+    for(uint32_t n = 0; n < 16; ++n)
+    {
+        std::vector<uint8_t> vHeader(4, static_cast<uint8_t>(n));
+        std::vector<uint8_t> vData(n * 10000 + 1, static_cast<uint8_t>(n * 7));
+
+        REQUIRE(socket.Write(vHeader, vData) >= 0);
+
+        vExpected.insert(vExpected.end(), vHeader.begin(), vHeader.end());
+        vExpected.insert(vExpected.end(), vData.begin(), vData.end());
+    }
+
+    std::vector<uint8_t> vPlain(100, 0xff);
+    REQUIRE(socket.Write(vPlain, vPlain.size()) >= 0);
+    vExpected.insert(vExpected.end(), vPlain.begin(), vPlain.end());
+
+    /* Shared data is buffered by reference and can go to more than one socket. */
+    std::shared_ptr<std::vector<uint8_t>> pShared = std::make_shared<std::vector<uint8_t>>(50000, 0xaa);
+    REQUIRE(socket.Write(pShared) >= 0);
+    REQUIRE(socket.Write(pShared) >= 0);
+    REQUIRE(pShared.use_count() > 1);
+
+    vExpected.insert(vExpected.end(), pShared->begin(), pShared->end());
+    vExpected.insert(vExpected.end(), pShared->begin(), pShared->end());
+
+    REQUIRE(socket.Write(vPlain, vPlain.size()) >= 0);
+    vExpected.insert(vExpected.end(), vPlain.begin(), vPlain.end());
+
+    REQUIRE(socket.Buffered() > 0);
+
+    /* Read the other end while flushing until everything arrives in order. */
+    std::vector<uint8_t> vReceived;
+    std::vector<uint8_t> vRead(65536);
+    for(uint32_t nTries = 0; nTries < 100000 && vReceived.size() < vExpected.size(); ++nTries)
+    {
+        socket.Flush();
+
+        int32_t nRead = static_cast<int32_t>(recv(vSockets[1], (char*)&vRead[0], vRead.size(), MSG_DONTWAIT));
+        if(nRead > 0)
+            vReceived.insert(vReceived.end(), vRead.begin(), vRead.begin() + nRead);
+    }
+
+    REQUIRE(socket.Buffered() == 0);
+    REQUIRE(vReceived == vExpected);
+    REQUIRE(pShared.use_count() == 1);
+
+    close(vSockets[1]);
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <unit/catch2/catch.hpp>
+
+#include <LLP/include/timer_wheel.h>
+
+#include <algorithm>
+
+TEST_CASE( "LLP::TimerWheel", "[timer_wheel]")
+{
+    LLP::TimerWheel wheel(1000);
+    std::vector<uint32_t> vExpired;
+
+    /* Slots expire on the tick they are due, not before. */
+    wheel.Schedule(1, 1010);
+    wheel.Schedule(2, 1020);
+    REQUIRE(wheel.Scheduled(1) == 1010);
+    REQUIRE(wheel.Scheduled(3) == 0);
+
+    uint64_t nNext = 0;
+    REQUIRE(wheel.Next(1100, nNext));
+    REQUIRE(nNext == 1010);
+    REQUIRE(!wheel.Next(1010, nNext));
+
+    wheel.Expire(1009, vExpired);
+    REQUIRE(vExpired.empty());
+
+    wheel.Expire(1010, vExpired);
+    REQUIRE(vExpired == std::vector<uint32_t>({1}));
+    REQUIRE(wheel.Scheduled(1) == 0);
+
+    /* Rescheduling replaces the last schedule. */
+    wheel.Schedule(2, 1030);
+
+    vExpired.clear();
+    wheel.Expire(1025, vExpired);
+    REQUIRE(vExpired.empty());
+
+    wheel.Expire(1030, vExpired);
+    REQUIRE(vExpired == std::vector<uint32_t>({2}));
+
+    /* Cancelled slots don't expire. */
+    wheel.Schedule(3, 1035);
+    wheel.Cancel(3);
+
+    vExpired.clear();
+    wheel.Expire(1040, vExpired);
+    REQUIRE(vExpired.empty());
+
+    /* Slots due more than a turn ahead wait for their turn of the wheel. */
+    wheel.Schedule(4, 1040 + LLP::WHEEL_SIZE + 5);
+
+    wheel.Expire(1045, vExpired);
+    REQUIRE(vExpired.empty());
+
+    wheel.Expire(1040 + LLP::WHEEL_SIZE + 5, vExpired);
+    REQUIRE(vExpired == std::vector<uint32_t>({4}));
+
+    /* Ticks already expired are due on the next one. */
+    wheel.Schedule(5, 1000);
+    REQUIRE(wheel.Scheduled(5) == wheel.Tick() + 1);
+
+    vExpired.clear();
+    wheel.Expire(wheel.Tick() + 1, vExpired);
+    REQUIRE(vExpired == std::vector<uint32_t>({5}));
+
+    /* A late caller skips the turns it missed, and still expires every slot that was due. */
+    const uint64_t nTick = wheel.Tick();
+    wheel.Schedule(6, nTick + 3);
+    wheel.Schedule(7, nTick + 100);
+
+    vExpired.clear();
+    wheel.Expire(nTick + 10 * LLP::WHEEL_SIZE, vExpired);
+    REQUIRE(wheel.Tick() == nTick + 10 * LLP::WHEEL_SIZE);
+    REQUIRE(vExpired.size() == 2);
+    REQUIRE(std::count(vExpired.begin(), vExpired.end(), 6) == 1);
+    REQUIRE(std::count(vExpired.begin(), vExpired.end(), 7) == 1);
+}
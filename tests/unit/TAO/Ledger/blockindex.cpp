@@ -0,0 +1,151 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <LLD/include/global.h>
+
+#include <TAO/Ledger/include/blockindex.h>
+#include <TAO/Ledger/types/state.h>
+
+#include <unit/catch2/catch.hpp>
+
+
+/* Create a block state of a channel following a previous block. */
+TAO::Ledger::BlockState IndexState(const TAO::Ledger::BlockState& prev, const uint32_t nChannel, const uint32_t nBits)
+{
+    TAO::Ledger::BlockState state;
+    state.hashPrevBlock = prev.GetHash();
+    state.nChannel      = nChannel;
+    state.nHeight       = prev.nHeight + 1;
+    state.nBits         = nBits;
+
+    return state;
+}
+
+
+TEST_CASE( "Block index fork and erase tests", "[ledger]")
+{
+    using namespace TAO::Ledger;
+
+    /* A root block with a chain and a fork after the first block. */
+    BlockState root;
+    root.nHeight = 0;
+    root.nBits   = 9001;
+
+    BlockState a1 = IndexState(root, 1, 9001);
+    BlockState a2 = IndexState(a1,   2, 9001);
+    BlockState a3 = IndexState(a2,   2, 9001);
+    BlockState b2 = IndexState(a1,   1, 9002);
+    BlockState b3 = IndexState(b2,   2, 9002);
+
+    for(const auto& state : {root, a1, a2, a3, b2, b3})
+    {
+        REQUIRE(LLD::Ledger->WriteBlock(state.GetHash(), state));
+    }
+
+    /* Each branch links to its own channel blocks. */
+    CompactState last;
+    REQUIRE(BlockIndex::GetLast(a3.GetHash(), 1, last));
+    REQUIRE(last.hashBlock == a1.GetHash());
+
+    REQUIRE(BlockIndex::GetLast(a3.GetHash(), 2, last));
+    REQUIRE(last.hashBlock == a3.GetHash());
+
+    REQUIRE(BlockIndex::GetLast(b3.GetHash(), 1, last));
+    REQUIRE(last.hashBlock == b2.GetHash());
+
+    REQUIRE(BlockIndex::GetLast(b3.GetHash(), 2, last));
+    REQUIRE(last.hashBlock == b3.GetHash());
+
+    /* The root doesn't count as a block of its channel. */
+    REQUIRE(!BlockIndex::GetLast(b2.GetHash(), 2, last));
+    REQUIRE(!BlockIndex::GetLast(a3.GetHash(), 0, last));
+
+    /* An erased block is gone from both branches. */
+    REQUIRE(LLD::Ledger->EraseBlock(a1.GetHash()));
+    REQUIRE(!BlockIndex::Get(a1.GetHash(), last));
+    REQUIRE(!BlockIndex::GetLast(a3.GetHash(), 1, last));
+
+    /* Writing it again relinks the blocks after it. */
+    REQUIRE(LLD::Ledger->WriteBlock(a1.GetHash(), a1));
+    REQUIRE(BlockIndex::GetLast(a3.GetHash(), 1, last));
+    REQUIRE(last.hashBlock == a1.GetHash());
+
+    REQUIRE(BlockIndex::GetLast(b3.GetHash(), 1, last));
+    REQUIRE(last.hashBlock == b2.GetHash());
+
+    /* Changes of an aborted transaction are reverted. */
+    BlockState c4 = IndexState(a3, 3, 9003);
+
+    LLD::TxnBegin();
+    REQUIRE(LLD::Ledger->WriteBlock(c4.GetHash(), c4));
+    REQUIRE(LLD::Ledger->EraseBlock(a3.GetHash()));
+
+    REQUIRE(BlockIndex::GetLast(c4.GetHash(), 3, last));
+    REQUIRE(last.hashBlock == c4.GetHash());
+    LLD::TxnAbort();
+
+    REQUIRE(!BlockIndex::Get(c4.GetHash(), last));
+    REQUIRE(BlockIndex::Get(a3.GetHash(), last));
+    REQUIRE(BlockIndex::GetLast(a3.GetHash(), 2, last));
+    REQUIRE(last.hashBlock == a3.GetHash());
+
+    /* Changes of a committed transaction are kept. */
+    LLD::TxnBegin();
+    REQUIRE(LLD::Ledger->WriteBlock(c4.GetHash(), c4));
+    REQUIRE(LLD::TxnCommit());
+
+    REQUIRE(BlockIndex::GetLast(c4.GetHash(), 1, last));
+    REQUIRE(last.hashBlock == a1.GetHash());
+}
+
+
+TEST_CASE( "Block index pruning tests", "[ledger]")
+{
+    using namespace TAO::Ledger;
+
+    BlockIndex::Clear();
+
+    /* Fill the index past its limit with headers that aren't on disk. */
+    BlockState root;
+    root.nHeight = 0;
+    root.nBits   = 9004;
+
+    BlockIndex::Update(root);
+
+    BlockState state = root;
+    uint1024_t hashFirst = 0;
+    for(uint32_t n = 1; n <= MAX_BLOCK_INDEX; ++n)
+    {
+        state = IndexState(state, 2, 9004);
+        BlockIndex::Update(state);
+
+        if(n == 1)
+            hashFirst = state.GetHash();
+    }
+
+    /* The oldest half is dropped. */
+    REQUIRE(BlockIndex::Size() == MAX_BLOCK_INDEX / 2 + 1);
+
+    CompactState last;
+    REQUIRE(!BlockIndex::Get(root.GetHash(), last));
+    REQUIRE(!BlockIndex::Get(hashFirst, last));
+
+    REQUIRE(BlockIndex::Get(state.GetHash(), last));
+    REQUIRE(last.nHeight == MAX_BLOCK_INDEX);
+
+    REQUIRE(BlockIndex::GetLast(state.GetHash(), 2, last));
+    REQUIRE(last.hashBlock == state.GetHash());
+
+    BlockIndex::Clear();
+    REQUIRE(BlockIndex::Size() == 0);
+}
@@ -0,0 +1,154 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+
+#include <LLC/include/random.h>
+
+#include <TAO/Operation/include/enum.h>
+
+#include <TAO/Register/include/create.h>
+#include <TAO/Register/types/address.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/blocktemplate.h>
+#include <TAO/Ledger/types/mempool.h>
+#include <TAO/Ledger/types/sigchain.h>
+#include <TAO/Ledger/types/tritium.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <algorithm>
+#include <set>
+
+namespace
+{
+    /* Accept the first transaction of a new signature chain into the memory pool. */
+    uint512_t AcceptGenesis()
+    {
+        using namespace TAO::Operation;
+
+        uint512_t hashPrivKey1 = LLC::GetRand512();
+        uint512_t hashPrivKey2 = LLC::GetRand512();
+
+        TAO::Ledger::Transaction tx;
+        tx.hashGenesis = TAO::Ledger::SignatureChain::Genesis(SecureString(LLC::GetRand256().ToString().c_str()));
+        tx.nSequence   = 0;
+        tx.nTimestamp  = runtime::timestamp();
+        tx.nKeyType    = TAO::Ledger::SIGNATURE::BRAINPOOL;
+        tx.nNextType   = TAO::Ledger::SIGNATURE::BRAINPOOL;
+        tx.NextHash(hashPrivKey2, TAO::Ledger::SIGNATURE::BRAINPOOL);
+
+        TAO::Register::Address hashToken = TAO::Register::Address(TAO::Register::Address::TOKEN);
+        TAO::Register::Object token = TAO::Register::CreateToken(hashToken, 1000, 100);
+        tx[0] << uint8_t(OP::CREATE) << hashToken << uint8_t(TAO::Register::REGISTER::OBJECT) << token.GetState();
+
+        REQUIRE(tx.Build());
+        tx.Sign(hashPrivKey1);
+
+        REQUIRE(TAO::Ledger::mempool.Accept(tx));
+
+        return tx.GetHash();
+    }
+
+
+    /* Get the ledger transactions the template adds to a new block. */
+    std::vector<uint512_t> Template()
+    {
+        TAO::Ledger::TritiumBlock block;
+        TAO::Ledger::BlockTemplate::GetInstance().Add(block, TAO::Ledger::ChainState::stateBest.load().GetHash());
+
+        std::vector<uint512_t> vHashes;
+        for(const auto& entry : block.vtx)
+            vHashes.push_back(entry.second);
+
+        return vHashes;
+    }
+}
+
+
+TEST_CASE( "Block template ranking tests", "[ledger]")
+{
+    using TAO::Ledger::BlockTemplate;
+
+    /* Fees are ranked per kilobyte, so a small chain paying less can rank above a large one. */
+    REQUIRE(BlockTemplate::FeeRate(1000, 500) == 2000);
+    REQUIRE(BlockTemplate::FeeRate(1000, 250) > BlockTemplate::FeeRate(2000, 1000));
+    REQUIRE(BlockTemplate::FeeRate(0, 0) == 0);
+
+    /* Higher fee rates first, then the order chains were first seen in. */
+    BlockTemplate::Priority cheap  = { BlockTemplate::FeeRate(1500, 1000), 0, LLC::GetRand256() };
+    BlockTemplate::Priority small  = { BlockTemplate::FeeRate(1000, 250),  3, LLC::GetRand256() };
+    BlockTemplate::Priority older  = { BlockTemplate::FeeRate(1000, 500),  1, LLC::GetRand256() };
+    BlockTemplate::Priority newer  = { BlockTemplate::FeeRate(1000, 500),  2, LLC::GetRand256() };
+
+    std::set<BlockTemplate::Priority> setPriority = { newer, cheap, older, small };
+    std::vector<uint256_t> vOrder;
+    for(const auto& priority : setPriority)
+        vOrder.push_back(priority.hashGenesis);
+
+    REQUIRE(vOrder.size() == 4);
+    REQUIRE(vOrder[0] == small.hashGenesis);
+    REQUIRE(vOrder[1] == older.hashGenesis);
+    REQUIRE(vOrder[2] == newer.hashGenesis);
+    REQUIRE(vOrder[3] == cheap.hashGenesis);
+}
+
+
+TEST_CASE( "Block template update tests", "[ledger]")
+{
+    /* Start from an empty memory pool so other tests don't show up in the template. */
+    std::vector<uint512_t> vExisting;
+    TAO::Ledger::mempool.List(vExisting);
+    for(const auto& hash : vExisting)
+    {
+        REQUIRE(TAO::Ledger::mempool.Remove(hash));
+    }
+
+    REQUIRE(Template().empty());
+
+    /* A new chain is added to the template. */
+    const uint512_t hashFirst = AcceptGenesis();
+    {
+        std::vector<uint512_t> vHashes = Template();
+        REQUIRE(vHashes.size() == 1);
+        REQUIRE(vHashes[0] == hashFirst);
+    }
+
+    /* Chains with the same fee rate follow the order they were seen in. */
+    const uint512_t hashSecond = AcceptGenesis();
+    {
+        std::vector<uint512_t> vHashes = Template();
+        REQUIRE(vHashes.size() == 2);
+        REQUIRE(vHashes[0] == hashFirst);
+        REQUIRE(vHashes[1] == hashSecond);
+    }
+
+    /* A chain the memory pool drops leaves the template, without disturbing the others. */
+    REQUIRE(TAO::Ledger::mempool.Remove(hashFirst));
+    {
+        std::vector<uint512_t> vHashes = Template();
+        REQUIRE(vHashes.size() == 1);
+        REQUIRE(vHashes[0] == hashSecond);
+    }
+
+    /* An unchanged memory pool gives the same template. */
+    {
+        std::vector<uint512_t> vHashes = Template();
+        REQUIRE(vHashes.size() == 1);
+        REQUIRE(vHashes[0] == hashSecond);
+    }
+
+    REQUIRE(TAO::Ledger::mempool.Remove(hashSecond));
+    REQUIRE(Template().empty());
+}
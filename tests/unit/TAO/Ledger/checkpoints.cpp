@@ -0,0 +1,69 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/include/chainstate.h>
+#include <TAO/Ledger/include/checkpoints.h>
+
+#include <Util/include/args.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE( "Assume valid checkpoint cutoff tests", "[ledger]")
+{
+    using namespace TAO::Ledger;
+
+    /* Hardcoded checkpoints are only for mainnet. */
+    config::fTestNet.store(false);
+
+    const uint32_t nBest = ChainState::nBestHeight.load();
+
+    /* A block at the last checkpoint is a known ancestor, only with its own hash. */
+    uint1024_t hashCheckpoint = LLC::GetRand1024();
+    AssumeValid(hashCheckpoint, CHECKPOINT_HEIGHT);
+
+    REQUIRE(IsCheckpointAncestor(hashCheckpoint, CHECKPOINT_HEIGHT));
+    REQUIRE(!IsCheckpointAncestor(LLC::GetRand1024(), CHECKPOINT_HEIGHT));
+    REQUIRE(!IsCheckpointAncestor(hashCheckpoint, CHECKPOINT_HEIGHT - 1));
+
+    /* Nothing past the last checkpoint is assumed valid. */
+    uint1024_t hashBeyond = LLC::GetRand1024();
+    AssumeValid(hashBeyond, CHECKPOINT_HEIGHT + 1);
+
+    REQUIRE(!IsCheckpointAncestor(hashBeyond, CHECKPOINT_HEIGHT + 1));
+    REQUIRE(IsCheckpointAncestor(hashCheckpoint, CHECKPOINT_HEIGHT));
+
+    /* Blocks at or below the best chain are dropped as new headers arrive. */
+    uint1024_t hashConnected = LLC::GetRand1024();
+    AssumeValid(hashConnected, nBest);
+    REQUIRE(IsCheckpointAncestor(hashConnected, nBest));
+
+    AssumeValid(LLC::GetRand1024(), nBest + 1);
+    REQUIRE(!IsCheckpointAncestor(hashConnected, nBest));
+
+    /* Verification is only skipped while synchronizing. */
+    REQUIRE(!IsAssumedValid(hashCheckpoint, CHECKPOINT_HEIGHT));
+
+    /* Testnet never assumes valid. */
+    config::fTestNet.store(true);
+    REQUIRE(!IsCheckpointAncestor(hashCheckpoint, CHECKPOINT_HEIGHT));
+
+    uint1024_t hashTestnet = LLC::GetRand1024();
+    AssumeValid(hashTestnet, nBest + 2);
+
+    config::fTestNet.store(false);
+    REQUIRE(!IsCheckpointAncestor(hashTestnet, nBest + 2));
+
+    config::fTestNet.store(true);
+}
@@ -0,0 +1,118 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+
+#include <LLC/include/random.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/compactblock.h>
+#include <TAO/Ledger/types/tritium.h>
+
+#include <Util/templates/datastream.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE( "Compact block tests", "[ledger]")
+{
+    /* A block of legacy and tritium transaction hashes. */
+    TAO::Ledger::TritiumBlock block;
+    block.nVersion      = 9;
+    block.hashPrevBlock = LLC::GetRand1024();
+    block.nChannel      = 2;
+    block.nHeight       = 100;
+    block.nBits         = 333;
+    block.nNonce        = 222;
+    block.nTime         = 999;
+
+    std::vector<uint512_t> vLedger, vLegacy, vHashes;
+    for(uint32_t n = 0; n < 20; ++n)
+    {
+        const uint512_t hashTx = LLC::GetRand512();
+        if(n % 4 == 0)
+        {
+            block.vtx.push_back(std::make_pair(TAO::Ledger::TRANSACTION::LEGACY, hashTx));
+            vLegacy.push_back(hashTx);
+        }
+        else
+        {
+            block.vtx.push_back(std::make_pair(TAO::Ledger::TRANSACTION::TRITIUM, hashTx));
+            vLedger.push_back(hashTx);
+        }
+
+        vHashes.push_back(hashTx);
+    }
+
+    block.hashMerkleRoot = block.BuildMerkleTree(vHashes);
+
+    /* Transactions held that aren't in the block. */
+    for(uint32_t n = 0; n < 100; ++n)
+        vLedger.push_back(LLC::GetRand512());
+
+    /* The compact block is smaller and has the same hash. */
+    TAO::Ledger::CompactBlock compact(block);
+    REQUIRE(compact.GetHash() == block.GetHash());
+    REQUIRE(compact.vShort.size() == block.vtx.size());
+
+    DataStream ssBlock(SER_NETWORK, LLP::PROTOCOL_VERSION);
+    ssBlock << block;
+
+    DataStream ssCompact(SER_NETWORK, LLP::PROTOCOL_VERSION);
+    ssCompact << compact;
+    REQUIRE(ssCompact.size() < ssBlock.size());
+
+    TAO::Ledger::CompactBlock compact2;
+    ssCompact >> compact2;
+    REQUIRE(compact2.GetHash() == block.GetHash());
+    REQUIRE(compact2.vShort == compact.vShort);
+
+    /* Rebuild from every transaction held. */
+    {
+        TAO::Ledger::TritiumBlock rebuilt;
+        std::vector<uint32_t> vMissing;
+        REQUIRE(compact2.Build(vLedger, vLegacy, rebuilt, vMissing));
+        REQUIRE(vMissing.empty());
+        REQUIRE(rebuilt.vtx == block.vtx);
+        REQUIRE(rebuilt.GetHash() == block.GetHash());
+    }
+
+    /* Rebuild with transactions missing. */
+    {
+        std::vector<uint512_t> vPartial(vLedger.begin() + 2, vLedger.end());
+
+        TAO::Ledger::TritiumBlock rebuilt;
+        std::vector<uint32_t> vMissing;
+        REQUIRE(compact2.Build(vPartial, vLegacy, rebuilt, vMissing));
+        REQUIRE(vMissing == std::vector<uint32_t>({1, 2}));
+        REQUIRE(rebuilt.vtx[3] == block.vtx[3]);
+    }
+
+    /* A transaction of the wrong type isn't matched. */
+    {
+        TAO::Ledger::TritiumBlock rebuilt;
+        std::vector<uint32_t> vMissing;
+        REQUIRE(compact2.Build(vHashes, { }, rebuilt, vMissing));
+        REQUIRE(vMissing.size() == 5);
+    }
+
+    /* A block that fails its merkle root must be asked for in full. */
+    {
+        TAO::Ledger::CompactBlock compact3(block);
+        compact3.vShort[0] = compact3.vShort[1];
+
+        TAO::Ledger::TritiumBlock rebuilt;
+        std::vector<uint32_t> vMissing;
+        REQUIRE(!compact3.Build(vLedger, vLegacy, rebuilt, vMissing));
+    }
+}
@@ -178,6 +178,19 @@ TEST_CASE( "Mempool and memory sequencing tests", "[mempool]")
             REQUIRE(object2.get<uint8_t>("byte") == uint8_t(55));
             REQUIRE(object2.get<std::string>("test") == std::string("this string"));
 
+            //check the transactions by genesis
+            REQUIRE(TAO::Ledger::mempool.Has(hashGenesis));
+
+            std::vector<TAO::Ledger::Transaction> vtx;
+            REQUIRE(TAO::Ledger::mempool.Get(hashGenesis, vtx));
+            REQUIRE(vtx.size() == 3);
+            REQUIRE(vtx[0].nSequence == 0);
+            REQUIRE(vtx[2].GetHash() == tx.GetHash());
+
+            TAO::Ledger::Transaction txLast;
+            REQUIRE(TAO::Ledger::mempool.Get(hashGenesis, txLast));
+            REQUIRE(txLast.GetHash() == tx.GetHash());
+
             //set previous
             hashPrevTx = tx.GetHash();
         }
@@ -0,0 +1,55 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/types/sigcache.h>
+
+#include <unit/catch2/catch.hpp>
+
+TEST_CASE( "Signature cache tests", "[ledger]")
+{
+    TAO::Ledger::SignatureCache& cache = TAO::Ledger::SignatureCache::GetInstance();
+
+    std::vector<uint8_t> vchPubKey = {0x01, 0x02, 0x03, 0x04};
+    std::vector<uint8_t> vchSig    = {0x05, 0x06, 0x07, 0x08};
+
+    /* Same inputs give the same key. */
+    REQUIRE(TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig) == TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig));
+
+    /* Shifting a byte across the key/signature boundary gives a different key. */
+    {
+        std::vector<uint8_t> vchShiftKey = {0x01, 0x02, 0x03};
+        std::vector<uint8_t> vchShiftSig = {0x04, 0x05, 0x06, 0x07, 0x08};
+
+        REQUIRE(TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig) != TAO::Ledger::SignatureCache::Key(vchShiftKey, vchShiftSig));
+        REQUIRE(TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig) != TAO::Ledger::SignatureCache::Key(vchSig, vchPubKey));
+    }
+
+    /* Moving the whole key into the signature gives a different key. */
+    {
+        std::vector<uint8_t> vchAll = {0x05, 0x06, 0x07, 0x08, 0x01, 0x02, 0x03, 0x04};
+        REQUIRE(TAO::Ledger::SignatureCache::Key(std::vector<uint8_t>(), vchAll) != TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig));
+    }
+
+    /* Only added signatures are found, and only for their own transaction. */
+    uint512_t hashTx  = LLC::GetRand512();
+    uint512_t hashKey = TAO::Ledger::SignatureCache::Key(vchPubKey, vchSig);
+    REQUIRE_FALSE(cache.Has(hashTx, hashKey));
+
+    cache.Add(hashTx, hashKey);
+    REQUIRE(cache.Has(hashTx, hashKey));
+    REQUIRE_FALSE(cache.Has(LLC::GetRand512(), hashKey));
+    REQUIRE_FALSE(cache.Has(hashTx, TAO::Ledger::SignatureCache::Key(vchSig, vchPubKey)));
+}
@@ -11,8 +11,16 @@
 
 ____________________________________________________________________________________________*/
 
+#include <LLC/include/random.h>
+
+#include <LLP/include/version.h>
+
+#include <TAO/Operation/include/enum.h>
+
 #include <TAO/Ledger/types/transaction.h>
 
+#include <Util/templates/datastream.h>
+
 #include <unit/catch2/catch.hpp>
 
 //test greater than operator
@@ -39,3 +47,37 @@ TEST_CASE( "Transaction::operator<", "[ledger]" )
     REQUIRE(tx1 < tx2);
     REQUIRE_FALSE(tx2 < tx1);
 }
+
+
+//test the hash cached on deserialization
+TEST_CASE( "Transaction::GetHash cache", "[ledger]" )
+{
+    TAO::Ledger::Transaction tx;
+    tx.nSequence = 7;
+    tx[0] << uint8_t(TAO::Operation::OP::WRITE) << LLC::GetRand256() << std::vector<uint8_t>(64, 0xff);
+
+    /* Transactions built in memory are never cached. */
+    const uint512_t hashTx = tx.GetHash();
+    REQUIRE(tx.hashCache == 0);
+
+    DataStream ssTx(SER_NETWORK, LLP::PROTOCOL_VERSION);
+    ssTx << tx;
+
+    /* Transactions read from a stream hash once. */
+    TAO::Ledger::Transaction txRead;
+    ssTx >> txRead;
+    REQUIRE(txRead.hashCache == hashTx);
+    REQUIRE(txRead.GetHash() == hashTx);
+
+    /* Copies keep the cache, assignments replace it. */
+    TAO::Ledger::Transaction txCopy = txRead;
+    REQUIRE(txCopy.GetHash() == hashTx);
+
+    txCopy = tx;
+    REQUIRE(txCopy.hashCache == 0);
+
+    /* Writing a contract clears it. */
+    txRead[1] << uint8_t(TAO::Operation::OP::WRITE) << LLC::GetRand256() << std::vector<uint8_t>(8, 0x00);
+    REQUIRE(txRead.hashCache == 0);
+    REQUIRE(txRead.GetHash() != hashTx);
+}
@@ -0,0 +1,112 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To The Voice of The People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/include/random.h>
+
+#include <TAO/Ledger/include/enum.h>
+#include <TAO/Ledger/types/sigcache.h>
+#include <TAO/Ledger/types/transaction.h>
+#include <TAO/Ledger/types/verifier.h>
+
+#include <Util/include/args.h>
+#include <Util/include/runtime.h>
+
+#include <unit/catch2/catch.hpp>
+
+namespace
+{
+    /* Create a batch of signed transactions. */
+    std::vector<TAO::Ledger::Transaction> SignedBatch(const uint32_t nSize)
+    {
+        std::vector<TAO::Ledger::Transaction> vtx(nSize);
+        for(auto& tx : vtx)
+        {
+            tx.hashGenesis = LLC::GetRand256();
+            tx.nTimestamp  = runtime::timestamp();
+            tx.nKeyType    = TAO::Ledger::SIGNATURE::BRAINPOOL;
+            tx.nNextType   = TAO::Ledger::SIGNATURE::BRAINPOOL;
+
+            REQUIRE(tx.Sign(LLC::GetRand512()));
+        }
+
+        return vtx;
+    }
+
+
+    /* Count the transactions of a batch whose signature was verified. */
+    uint32_t Verified(const std::vector<TAO::Ledger::Transaction>& vtx)
+    {
+        uint32_t nVerified = 0;
+        for(const auto& tx : vtx)
+            if(TAO::Ledger::SignatureCache::GetInstance().Has(tx.GetHash(), TAO::Ledger::SignatureCache::Key(tx.vchPubKey, tx.vchSig)))
+                ++nVerified;
+
+        return nVerified;
+    }
+
+
+    /* Get pointers to a batch for the verifier. */
+    std::vector<const TAO::Ledger::Transaction*> Pointers(const std::vector<TAO::Ledger::Transaction>& vtx)
+    {
+        std::vector<const TAO::Ledger::Transaction*> vptx;
+        for(const auto& tx : vtx)
+            vptx.push_back(&tx);
+
+        return vptx;
+    }
+}
+
+
+TEST_CASE( "Signature verifier tests", "[ledger]")
+{
+    for(const std::string strThreads : {"0", "3"})
+    {
+        config::mapArgs["-verifythreads"] = strThreads;
+        TAO::Ledger::SignatureVerifier verifier;
+
+        /* A valid batch verifies every signature. */
+        {
+            std::vector<TAO::Ledger::Transaction> vtx = SignedBatch(8);
+            REQUIRE(verifier.Verify(Pointers(vtx)));
+            REQUIRE(Verified(vtx) == 8);
+        }
+
+        /* An invalid signature anywhere fails the batch. */
+        {
+            std::vector<TAO::Ledger::Transaction> vtx = SignedBatch(8);
+            vtx[5].vchSig.clear();
+
+            REQUIRE(!verifier.Verify(Pointers(vtx)));
+        }
+
+        /* The first invalid signature stops the rest of the batch being verified. */
+        {
+            std::vector<TAO::Ledger::Transaction> vtx = SignedBatch(32);
+            vtx[0].vchSig.clear();
+
+            REQUIRE(!verifier.Verify(Pointers(vtx)));
+
+            /* Without workers nothing runs after it, workers only finish the ones already taken. */
+            if(strThreads == "0")
+            {
+                REQUIRE(Verified(vtx) == 0);
+            }
+            else
+            {
+                REQUIRE(Verified(vtx) < 16);
+            }
+        }
+    }
+
+    config::mapArgs.erase("-verifythreads");
+}
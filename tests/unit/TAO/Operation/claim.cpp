@@ -160,3 +160,89 @@ TEST_CASE("Claim Primitive Tests", "[operation]")
 
     }
 }
+
+
+TEST_CASE("Claim Primitive Tests - skipped conditions", "[operation]")
+{
+    //create object
+    uint256_t hashAsset  = TAO::Register::Address(TAO::Register::Address::OBJECT);
+    uint256_t hashGenesis  = LLC::GetRand256();
+    hashGenesis.SetType(TAO::Ledger::GENESIS::TESTNET);
+
+    uint256_t hashGenesis2  = LLC::GetRand256();
+    hashGenesis2.SetType(TAO::Ledger::GENESIS::TESTNET);
+
+    // create an asset
+    {
+        TAO::Ledger::Transaction tx;
+        tx.hashGenesis = hashGenesis;
+        tx.nSequence   = 1;
+        tx.nTimestamp  = runtime::timestamp();
+
+        //create asset
+        TAO::Register::Object asset = TAO::Register::CreateAsset();
+
+        // add some data
+        asset << std::string("data") << uint8_t(TAO::Register::TYPES::STRING) << std::string("somedata");
+
+        //payload
+        tx[0] << uint8_t(TAO::Operation::OP::CREATE) << hashAsset << uint8_t(TAO::Register::REGISTER::OBJECT) << asset.GetState();
+
+        /* verify prestates and poststates, commit to disk */
+        REQUIRE(tx.Build());
+        REQUIRE(tx.Verify());
+        REQUIRE(TAO::Operation::Execute(tx[0], TAO::Ledger::FLAGS::BLOCK));
+    }
+
+    /* Transfer the asset with a condition that can never be satisfied. */
+    {
+        TAO::Ledger::Transaction tx;
+        tx.hashGenesis = hashGenesis;
+        tx.nSequence   = 2;
+        tx.nTimestamp  = runtime::timestamp();
+
+        TAO::Ledger::Transaction tx2;
+        tx2.hashGenesis = hashGenesis2;
+        tx2.nSequence   = 1;
+        tx2.nTimestamp  = runtime::timestamp();
+
+        /* transfer payload */
+        tx[0] << uint8_t(TAO::Operation::OP::CONDITION) << uint8_t(TAO::Operation::OP::TRANSFER) << hashAsset << hashGenesis2 << uint8_t(TAO::Operation::TRANSFER::CLAIM);
+
+        /* conditions */
+        tx[0] <= uint8_t(TAO::Operation::OP::TYPES::UINT64_T) <= uint64_t(1);
+        tx[0] <= uint8_t(TAO::Operation::OP::EQUALS) <= uint8_t(TAO::Operation::OP::TYPES::UINT64_T) <= uint64_t(2);
+
+        /* verify prestates and poststates, write tx, commit to disk */
+        REQUIRE(tx.Build());
+        REQUIRE(tx.Verify());
+        REQUIRE(LLD::Ledger->WriteTx(tx.GetHash(), tx));
+        REQUIRE(LLD::Ledger->IndexBlock(tx.GetHash(), TAO::Ledger::ChainState::Genesis()));
+        REQUIRE(TAO::Operation::Execute(tx[0], TAO::Ledger::FLAGS::BLOCK));
+
+        /* claim payload */
+        tx2[0] << uint8_t(TAO::Operation::OP::CLAIM) << tx.GetHash() << uint32_t(0) << hashAsset;
+
+        REQUIRE(tx2.Build());
+        REQUIRE(tx2.Verify());
+        REQUIRE(LLD::Ledger->WriteTx(tx2.GetHash(), tx2));
+
+        /* The conditions fail the claim when they are evaluated. */
+        uint64_t nCost = 0;
+        REQUIRE_FALSE(TAO::Operation::Execute(tx2[0], TAO::Ledger::FLAGS::BLOCK, nCost, true));
+        std::string error = debug::GetLastError();
+        REQUIRE(error.find("OP::CLAIM: conditions not satisfied") != std::string::npos);
+
+        /* Blocks assumed valid skip them and still apply the claim. */
+        REQUIRE(TAO::Operation::Execute(tx2[0], TAO::Ledger::FLAGS::BLOCK, nCost, false));
+
+        /* check register values */
+        {
+            TAO::Register::Object asset;
+            REQUIRE(LLD::Register->ReadState(hashAsset, asset));
+
+            /* check that the asset belongs to the new owner. */
+            REQUIRE(asset.hashOwner == hashGenesis2);
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*__________________________________________________________________________________________
+
+            (c) Hash(BEGIN(Satoshi[2010]), END(Sunny[2012])) == Videlicet[2014] ++
+
+            (c) Copyright The Nexus Developers 2014 - 2019
+
+            Distributed under the MIT software license, see the accompanying
+            file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+            "ad vocem populi" - To the Voice of the People
+
+____________________________________________________________________________________________*/
+
+#include <LLC/types/uint1024.h>
+
+#include <Util/templates/sharded_map.h>
+
+#include <unit/catch2/catch.hpp>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+TEST_CASE("sharded_map tests", "[util]")
+{
+    sharded_map<uint512_t, std::string> map;
+
+    /* Insert only adds keys that aren't in the map. */
+    REQUIRE(map.insert(uint512_t(1), std::string("one")));
+    REQUIRE(!map.insert(uint512_t(1), std::string("uno")));
+    REQUIRE(map.insert(uint512_t(17), std::string("seventeen")));
+    REQUIRE(map.size() == 2);
+
+    std::string strValue;
+    REQUIRE(map.get(uint512_t(1), strValue));
+    REQUIRE(strValue == "one");
+
+    /* Set replaces the value. */
+    map.set(uint512_t(1), std::string("uno"));
+    REQUIRE(map.get(uint512_t(1), strValue));
+    REQUIRE(strValue == "uno");
+    REQUIRE(map.size() == 2);
+
+    /* A value found stays alive after it is erased. */
+    std::shared_ptr<const std::string> ptr = map.find(uint512_t(17));
+    REQUIRE(ptr);
+    REQUIRE(map.erase(uint512_t(17)));
+    REQUIRE(!map.erase(uint512_t(17)));
+    REQUIRE(*ptr == "seventeen");
+
+    REQUIRE(!map.has(uint512_t(17)));
+    REQUIRE(!map.find(uint512_t(17)));
+    REQUIRE(map.size() == 1);
+
+    /* Keys come from every shard, up to the limit. */
+    for(uint32_t i = 100; i < 200; ++i)
+    {
+        REQUIRE(map.insert(uint512_t(i), std::to_string(i)));
+    }
+
+    std::vector<uint512_t> vKeys;
+    map.keys(vKeys);
+    REQUIRE(vKeys.size() == 101);
+
+    vKeys.clear();
+    map.keys(vKeys, 10);
+    REQUIRE(vKeys.size() == 10);
+
+    /* Readers and writers on many threads. */
+    std::vector<std::thread> vThreads;
+    for(uint32_t n = 0; n < 4; ++n)
+    {
+        vThreads.push_back(std::thread([&map, n]()
+        {
+            for(uint32_t i = 0; i < 1000; ++i)
+            {
+                const uint512_t hashKey = uint512_t(1000 + n * 1000 + i);
+                map.insert(hashKey, std::to_string(i));
+
+                std::string strRead;
+                map.get(uint512_t(100 + (i % 100)), strRead);
+
+                if(i % 2 == 0)
+                    map.erase(hashKey);
+            }
+        }));
+    }
+
+    for(auto& thread : vThreads)
+        thread.join();
+
+    REQUIRE(map.size() == 101 + 4 * 500);
+
+    vKeys.clear();
+    map.keys(vKeys);
+    REQUIRE(vKeys.size() == map.size());
+}